@@ -3,7 +3,7 @@
 #include <stdexcept>
 
 // ANDGate Implementation
-ANDGate::ANDGate(const std::string &gateLabel) : Gate(GateType::And, gateLabel)
+ANDGate::ANDGate(const std::string &gateLabel, std::pmr::memory_resource *resource) : Gate(GateType::And, gateLabel, resource)
 {
     // Initialize with 2 inputs and 1 output
     inputSignals.resize(2, false);
@@ -24,8 +24,40 @@ void ANDGate::evaluate()
     outputSignal = result;
 }
 
+uint64_t ANDGate::evaluateWord(const std::vector<uint64_t> &inputWords) const
+{
+    if (inputWords.size() < 2)
+    {
+        throw std::invalid_argument("ANDGate: At least 2 inputs are required.");
+    }
+    // each lane stays 1 only while every input word has a 1 in it
+    uint64_t result = ~0ULL;
+    for (uint64_t word : inputWords)
+    {
+        result &= word;
+    }
+    return result;
+}
+
+LogicWord ANDGate::evaluateLogicWord(const std::vector<LogicWord> &inputWords) const
+{
+    if (inputWords.size() < 2)
+    {
+        throw std::invalid_argument("ANDGate: At least 2 inputs are required.");
+    }
+    // a lane is 1 when every input is a known 1, 0 as soon as one is a known 0, X otherwise
+    uint64_t ones = ~0ULL;
+    uint64_t zeros = 0;
+    for (const LogicWord &word : inputWords)
+    {
+        ones &= word.value & ~word.unknown;
+        zeros |= ~word.value & ~word.unknown;
+    }
+    return LogicWord{ones, ~(ones | zeros)};
+}
+
 // ORGate Implementation
-ORGate::ORGate(const std::string &gateLabel) : Gate(GateType::Or, gateLabel)
+ORGate::ORGate(const std::string &gateLabel, std::pmr::memory_resource *resource) : Gate(GateType::Or, gateLabel, resource)
 {
     // Initialize with 2 inputs and 1 output
     inputSignals.resize(2, false);
@@ -45,8 +77,39 @@ void ORGate::evaluate()
     outputSignal = result;
 }
 
+uint64_t ORGate::evaluateWord(const std::vector<uint64_t> &inputWords) const
+{
+    if (inputWords.size() < 2)
+    {
+        throw std::invalid_argument("ORGate: At least 2 inputs are required.");
+    }
+    uint64_t result = 0;
+    for (uint64_t word : inputWords)
+    {
+        result |= word;
+    }
+    return result;
+}
+
+LogicWord ORGate::evaluateLogicWord(const std::vector<LogicWord> &inputWords) const
+{
+    if (inputWords.size() < 2)
+    {
+        throw std::invalid_argument("ORGate: At least 2 inputs are required.");
+    }
+    // a lane is 1 as soon as one input is a known 1, 0 when every input is a known 0
+    uint64_t ones = 0;
+    uint64_t zeros = ~0ULL;
+    for (const LogicWord &word : inputWords)
+    {
+        ones |= word.value & ~word.unknown;
+        zeros &= ~word.value & ~word.unknown;
+    }
+    return LogicWord{ones, ~(ones | zeros)};
+}
+
 // NOTGate Implementation
-NOTGate::NOTGate(const std::string &gateLabel) : Gate(GateType::Not, gateLabel)
+NOTGate::NOTGate(const std::string &gateLabel, std::pmr::memory_resource *resource) : Gate(GateType::Not, gateLabel, resource)
 {
     // Initialize with 1 input and 1 output
     inputSignals.resize(1, false);
@@ -64,8 +127,26 @@ void NOTGate::evaluate()
     outputSignal = result;
 }
 
+uint64_t NOTGate::evaluateWord(const std::vector<uint64_t> &inputWords) const
+{
+    if (inputWords.size() != 1)
+    {
+        throw std::invalid_argument("NOTGate: Exactly one input is required.");
+    }
+    return ~inputWords[0];
+}
+
+LogicWord NOTGate::evaluateLogicWord(const std::vector<LogicWord> &inputWords) const
+{
+    if (inputWords.size() != 1)
+    {
+        throw std::invalid_argument("NOTGate: Exactly one input is required.");
+    }
+    return LogicWord{~inputWords[0].value & ~inputWords[0].unknown, inputWords[0].unknown};
+}
+
 //  Implement NAND (AND + inversion)
-NANDGate::NANDGate(const std::string &gateLabel) : Gate(GateType::Nand, gateLabel)
+NANDGate::NANDGate(const std::string &gateLabel, std::pmr::memory_resource *resource) : Gate(GateType::Nand, gateLabel, resource)
 {
     // Initialize with 2 inputs and 1 output
     inputSignals.resize(2, false);
@@ -84,8 +165,39 @@ void NANDGate::evaluate()
     outputSignal = result;
 }
 
+uint64_t NANDGate::evaluateWord(const std::vector<uint64_t> &inputWords) const
+{
+    if (inputWords.size() < 2)
+    {
+        throw std::invalid_argument("NANDGate: At least 2 inputs are required.");
+    }
+    uint64_t result = ~0ULL;
+    for (uint64_t word : inputWords)
+    {
+        result &= word;
+    }
+    return ~result;
+}
+
+LogicWord NANDGate::evaluateLogicWord(const std::vector<LogicWord> &inputWords) const
+{
+    if (inputWords.size() < 2)
+    {
+        throw std::invalid_argument("NANDGate: At least 2 inputs are required.");
+    }
+    // the AND lanes with the known ones and zeros swapped
+    uint64_t ones = ~0ULL;
+    uint64_t zeros = 0;
+    for (const LogicWord &word : inputWords)
+    {
+        ones &= word.value & ~word.unknown;
+        zeros |= ~word.value & ~word.unknown;
+    }
+    return LogicWord{zeros, ~(ones | zeros)};
+}
+
 //  Implement NOR (OR + inversion)
-NORGate::NORGate(const std::string &gateLabel) : Gate(GateType::Nor, gateLabel)
+NORGate::NORGate(const std::string &gateLabel, std::pmr::memory_resource *resource) : Gate(GateType::Nor, gateLabel, resource)
 {
     // Initialize with 2 inputs and 1 output
     inputSignals.resize(2, false);
@@ -105,8 +217,38 @@ void NORGate::evaluate()
     outputSignal = result;
 }
 
+uint64_t NORGate::evaluateWord(const std::vector<uint64_t> &inputWords) const
+{
+    if (inputWords.size() < 2)
+    {
+        throw std::invalid_argument("NORGate: At least 2 inputs are required.");
+    }
+    uint64_t result = 0;
+    for (uint64_t word : inputWords)
+    {
+        result |= word;
+    }
+    return ~result;
+}
+
+LogicWord NORGate::evaluateLogicWord(const std::vector<LogicWord> &inputWords) const
+{
+    if (inputWords.size() < 2)
+    {
+        throw std::invalid_argument("NORGate: At least 2 inputs are required.");
+    }
+    uint64_t ones = 0;
+    uint64_t zeros = ~0ULL;
+    for (const LogicWord &word : inputWords)
+    {
+        ones |= word.value & ~word.unknown;
+        zeros &= ~word.value & ~word.unknown;
+    }
+    return LogicWord{zeros, ~(ones | zeros)};
+}
+
 //  Implement XOR (odd parity logic)
-XORGate::XORGate(const std::string &gateLabel) : Gate(GateType::Xor, gateLabel)
+XORGate::XORGate(const std::string &gateLabel, std::pmr::memory_resource *resource) : Gate(GateType::Xor, gateLabel, resource)
 {
     // Initialize with 2 inputs and 1 output
     inputSignals.resize(2, false);
@@ -125,8 +267,40 @@ void XORGate::evaluate()
     outputSignal = result;
 }
 
+uint64_t XORGate::evaluateWord(const std::vector<uint64_t> &inputWords) const
+{
+    if (inputWords.size() < 2)
+    {
+        throw std::invalid_argument("XORGate: At least 2 inputs are required.");
+    }
+    // odd parity per lane
+    uint64_t result = 0;
+    for (uint64_t word : inputWords)
+    {
+        result ^= word;
+    }
+    return result;
+}
+
+LogicWord XORGate::evaluateLogicWord(const std::vector<LogicWord> &inputWords) const
+{
+    if (inputWords.size() < 2)
+    {
+        throw std::invalid_argument("XORGate: At least 2 inputs are required.");
+    }
+    // any unknown input makes the parity unknown
+    uint64_t parity = 0;
+    uint64_t unknown = 0;
+    for (const LogicWord &word : inputWords)
+    {
+        parity ^= word.value;
+        unknown |= word.unknown;
+    }
+    return LogicWord{parity & ~unknown, unknown};
+}
+
 //  Implement XNOR (even parity logic)
-XNORGate::XNORGate(const std::string &gateLabel) : Gate(GateType::Xnor, gateLabel)
+XNORGate::XNORGate(const std::string &gateLabel, std::pmr::memory_resource *resource) : Gate(GateType::Xnor, gateLabel, resource)
 {
     // Initialize with 2 inputs and 1 output
     inputSignals.resize(2, false);
@@ -144,8 +318,39 @@ void XNORGate::evaluate()
     outputSignal = result;
 }
 
+uint64_t XNORGate::evaluateWord(const std::vector<uint64_t> &inputWords) const
+{
+    if (inputWords.size() < 2)
+    {
+        throw std::invalid_argument("XNORGate: At least 2 inputs are required.");
+    }
+    // even parity per lane
+    uint64_t result = 0;
+    for (uint64_t word : inputWords)
+    {
+        result ^= word;
+    }
+    return ~result;
+}
+
+LogicWord XNORGate::evaluateLogicWord(const std::vector<LogicWord> &inputWords) const
+{
+    if (inputWords.size() < 2)
+    {
+        throw std::invalid_argument("XNORGate: At least 2 inputs are required.");
+    }
+    uint64_t parity = 0;
+    uint64_t unknown = 0;
+    for (const LogicWord &word : inputWords)
+    {
+        parity ^= word.value;
+        unknown |= word.unknown;
+    }
+    return LogicWord{~parity & ~unknown, unknown};
+}
+
 // BUFFER (direct pass-through)
-BufferGate::BufferGate(const std::string &gateLabel) : Gate(GateType::Buffer, gateLabel)
+BufferGate::BufferGate(const std::string &gateLabel, std::pmr::memory_resource *resource) : Gate(GateType::Buffer, gateLabel, resource)
 {
     // Initialize with 1 input and 1 output
     inputSignals.resize(1, false);
@@ -159,3 +364,22 @@ void BufferGate::evaluate()
     }
     outputSignal = inputSignals[0];
 }
+
+uint64_t BufferGate::evaluateWord(const std::vector<uint64_t> &inputWords) const
+{
+    if (inputWords.size() != 1)
+    {
+        throw std::invalid_argument("BufferGate: Exactly 1 input is required.");
+    }
+    return inputWords[0];
+}
+
+LogicWord BufferGate::evaluateLogicWord(const std::vector<LogicWord> &inputWords) const
+{
+    if (inputWords.size() != 1)
+    {
+        throw std::invalid_argument("BufferGate: Exactly 1 input is required.");
+    }
+    // a buffer drives its output, so Z comes out as X
+    return LogicWord{inputWords[0].value & ~inputWords[0].unknown, inputWords[0].unknown};
+}
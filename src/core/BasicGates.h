@@ -5,22 +5,28 @@
 class ANDGate : public Gate
 {
 public:
-    ANDGate(const std::string& gateLabel);
+    ANDGate(const std::string& gateLabel, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     void evaluate() override;
+    uint64_t evaluateWord(const std::vector<uint64_t>& inputWords) const override;
+    LogicWord evaluateLogicWord(const std::vector<LogicWord>& inputWords) const override;
 };
 
 class ORGate : public Gate
 {
 public:
-    ORGate(const std::string& gateLabel = "");
+    ORGate(const std::string& gateLabel = "", std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     void evaluate() override;
+    uint64_t evaluateWord(const std::vector<uint64_t>& inputWords) const override;
+    LogicWord evaluateLogicWord(const std::vector<LogicWord>& inputWords) const override;
 };
 
 class NOTGate : public Gate
 {
 public:
-    NOTGate(const std::string& gateLabel = "");
+    NOTGate(const std::string& gateLabel = "", std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     void evaluate() override;
+    uint64_t evaluateWord(const std::vector<uint64_t>& inputWords) const override;
+    LogicWord evaluateLogicWord(const std::vector<LogicWord>& inputWords) const override;
 
 private:
     void addInputCountRestriction() {}
@@ -29,34 +35,44 @@ private:
 class NANDGate : public Gate
 {
 public:
-    NANDGate(const std::string& gateLabel = "");
+    NANDGate(const std::string& gateLabel = "", std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     void evaluate() override;
+    uint64_t evaluateWord(const std::vector<uint64_t>& inputWords) const override;
+    LogicWord evaluateLogicWord(const std::vector<LogicWord>& inputWords) const override;
 };
 
 class NORGate : public Gate
 {
 public:
-    NORGate(const std::string& gateLabel = "");
+    NORGate(const std::string& gateLabel = "", std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     void evaluate() override;
+    uint64_t evaluateWord(const std::vector<uint64_t>& inputWords) const override;
+    LogicWord evaluateLogicWord(const std::vector<LogicWord>& inputWords) const override;
 };
 
 class XORGate : public Gate
 {
 public:
-    XORGate(const std::string& gateLabel = "");
+    XORGate(const std::string& gateLabel = "", std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     void evaluate() override;
+    uint64_t evaluateWord(const std::vector<uint64_t>& inputWords) const override;
+    LogicWord evaluateLogicWord(const std::vector<LogicWord>& inputWords) const override;
 };
 
 class XNORGate : public Gate
 {
 public:
-    XNORGate(const std::string& gateLabel = "");
+    XNORGate(const std::string& gateLabel = "", std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     void evaluate() override;
+    uint64_t evaluateWord(const std::vector<uint64_t>& inputWords) const override;
+    LogicWord evaluateLogicWord(const std::vector<LogicWord>& inputWords) const override;
 };
 
 class BufferGate : public Gate
 {
 public:
-    BufferGate(const std::string& gateLabel = "");
+    BufferGate(const std::string& gateLabel = "", std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     void evaluate() override;
+    uint64_t evaluateWord(const std::vector<uint64_t>& inputWords) const override;
+    LogicWord evaluateLogicWord(const std::vector<LogicWord>& inputWords) const override;
 };
@@ -0,0 +1,683 @@
+#include "Bdd.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include "Circuit.h"
+#include "Espresso.h"
+#include "GateFactory.h"
+#include "LevelizedSimulator.h"
+
+// handle
+
+Bdd::Bdd(BddManager *manager, uint32_t edge)
+    : manager(manager), edge(edge)
+{
+    manager->ref(edge);
+}
+
+Bdd::Bdd(const Bdd &other)
+    : manager(other.manager), edge(other.edge)
+{
+    if (manager)
+    {
+        manager->ref(edge);
+    }
+}
+
+Bdd::Bdd(Bdd &&other) noexcept
+    : manager(other.manager), edge(other.edge)
+{
+    other.manager = nullptr;
+}
+
+Bdd &Bdd::operator=(const Bdd &other)
+{
+    // reference the new edge first, in case both handles share a node
+    if (other.manager)
+    {
+        other.manager->ref(other.edge);
+    }
+    if (manager)
+    {
+        manager->deref(edge);
+    }
+    manager = other.manager;
+    edge = other.edge;
+    return *this;
+}
+
+Bdd &Bdd::operator=(Bdd &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (manager)
+        {
+            manager->deref(edge);
+        }
+        manager = other.manager;
+        edge = other.edge;
+        other.manager = nullptr;
+    }
+    return *this;
+}
+
+Bdd::~Bdd()
+{
+    if (manager)
+    {
+        manager->deref(edge);
+    }
+}
+
+bool Bdd::isOne() const
+{
+    return manager && edge == BddManager::One;
+}
+
+bool Bdd::isZero() const
+{
+    return manager && edge == BddManager::Zero;
+}
+
+Bdd Bdd::operator~() const
+{
+    if (!manager)
+    {
+        throw std::invalid_argument("Bdd: operation on a null handle");
+    }
+    return Bdd(manager, edge ^ 1);
+}
+
+Bdd Bdd::operator&(const Bdd &other) const
+{
+    if (!manager)
+    {
+        throw std::invalid_argument("Bdd: operation on a null handle");
+    }
+    return manager->ite(*this, other, manager->zero());
+}
+
+Bdd Bdd::operator|(const Bdd &other) const
+{
+    if (!manager)
+    {
+        throw std::invalid_argument("Bdd: operation on a null handle");
+    }
+    return manager->ite(*this, manager->one(), other);
+}
+
+Bdd Bdd::operator^(const Bdd &other) const
+{
+    if (!manager)
+    {
+        throw std::invalid_argument("Bdd: operation on a null handle");
+    }
+    return manager->ite(*this, ~other, other);
+}
+
+// manager
+
+BddManager::BddManager(uint32_t numVariables, size_t cacheEntries)
+    : numVariables(numVariables)
+{
+    // the terminal, never freed and never hashed
+    nodes.push_back({TerminalVariable, One, One, 0, 0});
+    buckets.assign(1 << 12, 0);
+    size_t entries = 1;
+    while (entries < cacheEntries)
+    {
+        entries <<= 1;
+    }
+    cache.assign(entries, {NoEdge, NoEdge, NoEdge, NoEdge});
+}
+
+void BddManager::ref(Edge edge)
+{
+    // a dead node holds nothing, reviving it takes its children back
+    // (recursion depth is bounded by the variable count)
+    uint32_t index = edge >> 1;
+    if (index != 0 && nodes[index].refCount++ == 0)
+    {
+        deadNodes--;
+        ref(nodes[index].high);
+        ref(nodes[index].low);
+    }
+}
+
+void BddManager::deref(Edge edge)
+{
+    uint32_t index = edge >> 1;
+    if (index != 0 && --nodes[index].refCount == 0)
+    {
+        deadNodes++;
+        deref(nodes[index].high);
+        deref(nodes[index].low);
+    }
+}
+
+void BddManager::requireOwn(const Bdd &f) const
+{
+    if (f.manager != this)
+    {
+        throw std::invalid_argument("BddManager: function belongs to another manager");
+    }
+}
+
+void BddManager::collectIfNeeded()
+{
+    // only between top-level operations, while every result in use is held by a handle
+    if (deadNodes > garbageThreshold && deadNodes * 4 > liveNodes)
+    {
+        collectGarbage();
+    }
+}
+
+BddManager::Edge BddManager::highOf(Edge edge, uint32_t variable) const
+{
+    const Node &node = nodes[edge >> 1];
+    return node.variable == variable ? node.high ^ (edge & 1) : edge;
+}
+
+BddManager::Edge BddManager::lowOf(Edge edge, uint32_t variable) const
+{
+    const Node &node = nodes[edge >> 1];
+    return node.variable == variable ? node.low ^ (edge & 1) : edge;
+}
+
+size_t BddManager::bucketOf(uint32_t variable, Edge high, Edge low) const
+{
+    uint64_t hash = (static_cast<uint64_t>(high) * 0x9E3779B97F4A7C15ULL) ^ (static_cast<uint64_t>(low) * 0xC2B2AE3D27D4EB4FULL) ^ variable;
+    hash ^= hash >> 29;
+    return static_cast<size_t>(hash) & (buckets.size() - 1);
+}
+
+void BddManager::growUniqueTable()
+{
+    std::vector<uint32_t> old(buckets.size() * 2, 0);
+    old.swap(buckets);
+    for (uint32_t head : old)
+    {
+        while (head != 0)
+        {
+            uint32_t next = nodes[head].next;
+            size_t bucket = bucketOf(nodes[head].variable, nodes[head].high, nodes[head].low);
+            nodes[head].next = buckets[bucket];
+            buckets[bucket] = head;
+            head = next;
+        }
+    }
+}
+
+BddManager::Edge BddManager::makeNode(uint32_t variable, Edge high, Edge low)
+{
+    if (high == low)
+    {
+        return high;
+    }
+    // the high edge stays regular: complement both children and the result instead
+    Edge complement = high & 1;
+    high ^= complement;
+    low ^= complement;
+
+    size_t bucket = bucketOf(variable, high, low);
+    for (uint32_t index = buckets[bucket]; index != 0; index = nodes[index].next)
+    {
+        const Node &node = nodes[index];
+        if (node.variable == variable && node.high == high && node.low == low)
+        {
+            return (index << 1) | complement;
+        }
+    }
+
+    if (liveNodes + 1 > buckets.size() * 2)
+    {
+        growUniqueTable();
+        bucket = bucketOf(variable, high, low);
+    }
+    uint32_t index;
+    if (freeList != 0)
+    {
+        index = freeList;
+        freeList = nodes[index].next;
+    }
+    else
+    {
+        if (nodes.size() >= 0x7FFFFFFF)
+        {
+            throw std::runtime_error("BddManager: node table is full");
+        }
+        index = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+    nodes[index] = {variable, high, low, 0, buckets[bucket]};
+    buckets[bucket] = index;
+    // born dead, the first reference takes the children
+    deadNodes++;
+    liveNodes++;
+    peakNodes = std::max(peakNodes, liveNodes);
+    return (index << 1) | complement;
+}
+
+Bdd BddManager::variable(uint32_t index)
+{
+    if (index >= FreeVariable)
+    {
+        throw std::out_of_range("BddManager: variable index out of range");
+    }
+    numVariables = std::max(numVariables, index + 1);
+    collectIfNeeded();
+    return Bdd(this, makeNode(index, One, Zero));
+}
+
+Bdd BddManager::ite(const Bdd &f, const Bdd &g, const Bdd &h)
+{
+    requireOwn(f);
+    requireOwn(g);
+    requireOwn(h);
+    collectIfNeeded();
+    return Bdd(this, iteRecursive(f.edge, g.edge, h.edge));
+}
+
+BddManager::Edge BddManager::iteRecursive(Edge f, Edge g, Edge h)
+{
+    // terminal cases
+    if (f == One)
+    {
+        return g;
+    }
+    if (f == Zero)
+    {
+        return h;
+    }
+    // g or h equal to f (or its complement) are constants on the branch they are taken
+    if (g == f)
+    {
+        g = One;
+    }
+    else if (g == (f ^ 1))
+    {
+        g = Zero;
+    }
+    if (h == f)
+    {
+        h = Zero;
+    }
+    else if (h == (f ^ 1))
+    {
+        h = One;
+    }
+    if (g == h)
+    {
+        return g;
+    }
+    if (g == One && h == Zero)
+    {
+        return f;
+    }
+    if (g == Zero && h == One)
+    {
+        return f ^ 1;
+    }
+
+    // standard triple: f regular (swap the branches), g regular (complement the result)
+    if (f & 1)
+    {
+        f ^= 1;
+        std::swap(g, h);
+    }
+    Edge complement = g & 1;
+    g ^= complement;
+    h ^= complement;
+
+    uint64_t hash = (static_cast<uint64_t>(f) * 0x9E3779B97F4A7C15ULL) ^ (static_cast<uint64_t>(g) * 0xC2B2AE3D27D4EB4FULL) ^
+                    (static_cast<uint64_t>(h) * 0x165667B19E3779F9ULL);
+    CacheEntry &entry = cache[(hash ^ (hash >> 31)) & (cache.size() - 1)];
+    cacheLookups++;
+    if (entry.f == f && entry.g == g && entry.h == h)
+    {
+        cacheHits++;
+        return entry.result ^ complement;
+    }
+
+    uint32_t top = std::min({variableOf(f), variableOf(g), variableOf(h)});
+    // no collection runs inside the recursion, so unreferenced results stay valid
+    Edge high = iteRecursive(highOf(f, top), highOf(g, top), highOf(h, top));
+    Edge low = iteRecursive(lowOf(f, top), lowOf(g, top), lowOf(h, top));
+    Edge result = makeNode(top, high, low);
+    entry = {f, g, h, result};
+    return result ^ complement;
+}
+
+Bdd BddManager::cofactor(const Bdd &f, uint32_t variable, bool value)
+{
+    requireOwn(f);
+    collectIfNeeded();
+    std::unordered_map<uint32_t, Edge> memo;
+    return Bdd(this, cofactorRecursive(f.edge, variable, value, memo));
+}
+
+BddManager::Edge BddManager::cofactorRecursive(Edge f, uint32_t variable, bool value, std::unordered_map<uint32_t, Edge> &memo)
+{
+    uint32_t top = variableOf(f);
+    if (top > variable)
+    {
+        // below the variable (or the terminal): f does not depend on it
+        return f;
+    }
+    if (top == variable)
+    {
+        return value ? highOf(f, top) : lowOf(f, top);
+    }
+    Edge complement = f & 1;
+    auto it = memo.find(f >> 1);
+    if (it != memo.end())
+    {
+        return it->second ^ complement;
+    }
+    Edge regular = f ^ complement;
+    Edge high = cofactorRecursive(nodes[regular >> 1].high, variable, value, memo);
+    Edge low = cofactorRecursive(nodes[regular >> 1].low, variable, value, memo);
+    Edge result = makeNode(top, high, low);
+    memo[f >> 1] = result;
+    return result ^ complement;
+}
+
+std::vector<Bdd> BddManager::fromCircuit(const Circuit &circuit)
+{
+    std::vector<Bdd> inputs;
+    inputs.reserve(circuit.getInputCount());
+    for (uint32_t i = 0; i < circuit.getInputCount(); i++)
+    {
+        inputs.push_back(variable(i));
+    }
+    return fromCircuit(circuit, inputs);
+}
+
+std::vector<Bdd> BddManager::fromCircuit(const Circuit &circuit, const std::vector<Bdd> &inputs)
+{
+    if (inputs.size() != circuit.getInputCount())
+    {
+        throw std::invalid_argument("BddManager: circuit has " + std::to_string(circuit.getInputCount()) + " inputs, got " +
+                                    std::to_string(inputs.size()) + " functions");
+    }
+    for (const Bdd &input : inputs)
+    {
+        requireOwn(input);
+    }
+
+    // the levelized order is a topological order, and throws on combinational loops
+    LevelizedSimulator levelized(circuit);
+    std::vector<Bdd> functions(circuit.getNodeCount());
+    // readers left per node, so intermediate functions are released as soon as possible
+    std::vector<uint32_t> readersLeft(circuit.getNodeCount());
+    for (Circuit::NodeId node = 0; node < circuit.getNodeCount(); node++)
+    {
+        readersLeft[node] = circuit.getFanoutCount(node);
+    }
+    std::vector<char> isOutput(circuit.getNodeCount(), 0);
+    for (Circuit::NodeId output : circuit.getOutputs())
+    {
+        isOutput[output] = 1;
+    }
+    for (uint32_t i = 0; i < circuit.getInputCount(); i++)
+    {
+        functions[circuit.getInputs()[i]] = inputs[i];
+    }
+
+    for (Circuit::NodeId node : levelized.getOrder())
+    {
+        const Circuit::NodeId *fanin = circuit.getFanin(node);
+        uint32_t count = circuit.getFaninCount(node);
+        GateType type = circuit.getGateType(node);
+        Bdd value = functions[fanin[0]];
+        switch (type)
+        {
+        case GateType::And:
+        case GateType::Nand:
+            for (uint32_t pin = 1; pin < count; pin++)
+            {
+                value &= functions[fanin[pin]];
+            }
+            break;
+        case GateType::Or:
+        case GateType::Nor:
+            for (uint32_t pin = 1; pin < count; pin++)
+            {
+                value |= functions[fanin[pin]];
+            }
+            break;
+        case GateType::Xor:
+        case GateType::Xnor:
+            for (uint32_t pin = 1; pin < count; pin++)
+            {
+                value ^= functions[fanin[pin]];
+            }
+            break;
+        case GateType::Not:
+        case GateType::Buffer:
+            break;
+        default:
+            if (GateFactory::isTriState(type) || GateFactory::isResolvedNet(type))
+            {
+                throw std::invalid_argument("BddManager: gate " + circuit.getName(node) + " can be Z, which a BDD cannot represent");
+            }
+            throw std::invalid_argument("BddManager: gate " + circuit.getName(node) + " is not combinational");
+        }
+        if (type == GateType::Nand || type == GateType::Nor || type == GateType::Xnor || type == GateType::Not)
+        {
+            value = ~value;
+        }
+        functions[node] = std::move(value);
+
+        for (uint32_t pin = 0; pin < count; pin++)
+        {
+            if (--readersLeft[fanin[pin]] == 0 && !isOutput[fanin[pin]])
+            {
+                functions[fanin[pin]] = Bdd();
+            }
+        }
+    }
+
+    std::vector<Bdd> outputs;
+    outputs.reserve(circuit.getOutputCount());
+    for (Circuit::NodeId output : circuit.getOutputs())
+    {
+        outputs.push_back(functions[output]);
+    }
+    return outputs;
+}
+
+double BddManager::satCount(const Bdd &f, uint32_t numVariables) const
+{
+    requireOwn(f);
+    // fraction of all assignments that satisfy each regular node, a complement edge is 1 - x
+    std::unordered_map<uint32_t, double> memo;
+    std::vector<uint32_t> stack{f.edge >> 1};
+    while (!stack.empty())
+    {
+        uint32_t index = stack.back();
+        if (index == 0 || memo.count(index))
+        {
+            stack.pop_back();
+            continue;
+        }
+        const Node &node = nodes[index];
+        bool ready = true;
+        for (Edge child : {node.high, node.low})
+        {
+            if ((child >> 1) != 0 && !memo.count(child >> 1))
+            {
+                stack.push_back(child >> 1);
+                ready = false;
+            }
+        }
+        if (!ready)
+        {
+            continue;
+        }
+        auto fraction = [&](Edge child)
+        {
+            double regular = (child >> 1) == 0 ? 1.0 : memo[child >> 1];
+            return (child & 1) ? 1.0 - regular : regular;
+        };
+        memo[index] = (fraction(node.high) + fraction(node.low)) / 2;
+        stack.pop_back();
+    }
+    double regular = (f.edge >> 1) == 0 ? 1.0 : memo[f.edge >> 1];
+    double fraction = (f.edge & 1) ? 1.0 - regular : regular;
+    return std::ldexp(fraction, static_cast<int>(numVariables));
+}
+
+std::vector<int> BddManager::satOne(const Bdd &f) const
+{
+    requireOwn(f);
+    if (f.edge == Zero)
+    {
+        return {};
+    }
+    // every edge other than Zero has a path to one, so the walk never backtracks
+    std::vector<int> assignment(numVariables, -1);
+    Edge edge = f.edge;
+    while ((edge >> 1) != 0)
+    {
+        uint32_t variable = variableOf(edge);
+        Edge high = highOf(edge, variable);
+        if (high != Zero)
+        {
+            assignment[variable] = 1;
+            edge = high;
+        }
+        else
+        {
+            assignment[variable] = 0;
+            edge = lowOf(edge, variable);
+        }
+    }
+    return assignment;
+}
+
+size_t BddManager::nodeCount(const Bdd &f) const
+{
+    return nodeCount(std::vector<Bdd>{f});
+}
+
+size_t BddManager::nodeCount(const std::vector<Bdd> &roots) const
+{
+    std::vector<char> seen(nodes.size(), 0);
+    std::vector<uint32_t> stack;
+    for (const Bdd &root : roots)
+    {
+        requireOwn(root);
+        stack.push_back(root.edge >> 1);
+    }
+    size_t count = 0;
+    while (!stack.empty())
+    {
+        uint32_t index = stack.back();
+        stack.pop_back();
+        if (seen[index])
+        {
+            continue;
+        }
+        seen[index] = 1;
+        count++;
+        if (index != 0)
+        {
+            stack.push_back(nodes[index].high >> 1);
+            stack.push_back(nodes[index].low >> 1);
+        }
+    }
+    return count;
+}
+
+void BddManager::addPathCubes(const Bdd &f, int output, CubeList &cubes, size_t limit) const
+{
+    requireOwn(f);
+    if (cubes.getNumInputs() < static_cast<int>(numVariables) || output < 0 || output >= cubes.getNumOutputs())
+    {
+        throw std::invalid_argument("BddManager: cube list is too narrow for the function");
+    }
+    // depth-first over the paths, `literals` holds the branch taken at every variable so far
+    std::vector<int> literals(numVariables, 2);
+    size_t added = 0;
+    struct Frame
+    {
+        Edge edge;
+        uint32_t variable; // variable whose branch led here, TerminalVariable for the root
+        int value;
+    };
+    std::vector<Frame> stack{{f.edge, TerminalVariable, 2}};
+    std::vector<uint32_t> path;
+    while (!stack.empty())
+    {
+        Frame frame = stack.back();
+        stack.pop_back();
+        // unwind the literals set deeper than this branch
+        while (!path.empty() && (frame.variable == TerminalVariable || path.back() >= frame.variable))
+        {
+            literals[path.back()] = 2;
+            path.pop_back();
+        }
+        if (frame.variable != TerminalVariable)
+        {
+            literals[frame.variable] = frame.value;
+            path.push_back(frame.variable);
+        }
+
+        if (frame.edge == Zero)
+        {
+            continue;
+        }
+        if (frame.edge == One)
+        {
+            if (++added > limit)
+            {
+                throw std::runtime_error("BddManager: function has more than " + std::to_string(limit) + " paths");
+            }
+            size_t cube = cubes.addCube();
+            for (uint32_t v : path)
+            {
+                cubes.setInput(cube, static_cast<int>(v), literals[v]);
+            }
+            cubes.setOutput(cube, output, true);
+            continue;
+        }
+        uint32_t variable = variableOf(frame.edge);
+        stack.push_back({lowOf(frame.edge, variable), variable, 0});
+        stack.push_back({highOf(frame.edge, variable), variable, 1});
+    }
+}
+
+void BddManager::collectGarbage()
+{
+    // dead nodes hold no references, so one sweep over the chains frees them all
+    for (uint32_t &head : buckets)
+    {
+        uint32_t *link = &head;
+        while (*link != 0)
+        {
+            uint32_t index = *link;
+            Node &node = nodes[index];
+            if (node.refCount != 0)
+            {
+                link = &node.next;
+                continue;
+            }
+            *link = node.next;
+            node.variable = FreeVariable;
+            node.next = freeList;
+            freeList = index;
+            liveNodes--;
+            reclaimedNodes++;
+        }
+    }
+    deadNodes = 0;
+    std::fill(cache.begin(), cache.end(), CacheEntry{NoEdge, NoEdge, NoEdge, NoEdge});
+    garbageCollections++;
+}
+
+size_t BddManager::getMemoryUsage() const
+{
+    return nodes.capacity() * sizeof(Node) + buckets.capacity() * sizeof(uint32_t) + cache.capacity() * sizeof(CacheEntry);
+}
@@ -0,0 +1,180 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class BddManager;
+class Circuit;
+class CubeList;
+
+// Reference-counted handle to one function in a BddManager. Copies share the node,
+// and the node can be reclaimed once the last handle to it is gone.
+// Every handle must be destroyed before its manager.
+class Bdd
+{
+public:
+    Bdd() = default;
+    Bdd(const Bdd &other);
+    Bdd(Bdd &&other) noexcept;
+    Bdd &operator=(const Bdd &other);
+    Bdd &operator=(Bdd &&other) noexcept;
+    ~Bdd();
+
+    bool isNull() const { return manager == nullptr; }
+    bool isOne() const;
+    bool isZero() const;
+    BddManager *getManager() const { return manager; }
+    uint32_t getEdge() const { return edge; }
+
+    Bdd operator~() const;
+    Bdd operator&(const Bdd &other) const;
+    Bdd operator|(const Bdd &other) const;
+    Bdd operator^(const Bdd &other) const;
+    Bdd &operator&=(const Bdd &other) { return *this = *this & other; }
+    Bdd &operator|=(const Bdd &other) { return *this = *this | other; }
+    Bdd &operator^=(const Bdd &other) { return *this = *this ^ other; }
+
+    // BDDs are canonical, so equal functions are the same edge
+    bool operator==(const Bdd &other) const { return manager == other.manager && edge == other.edge; }
+    bool operator!=(const Bdd &other) const { return !(*this == other); }
+
+private:
+    friend class BddManager;
+    // takes a new reference on `edge`
+    Bdd(BddManager *manager, uint32_t edge);
+
+    BddManager *manager = nullptr;
+    uint32_t edge = 0;
+};
+
+// Reduced ordered BDDs with complement edges, for functions far too wide to tabulate.
+// An edge is a node index shifted left by one with the complement flag in bit 0. Node 0
+// is the constant one, so edge 0 is true and edge 1 is false. The high edge of a stored
+// node is never complemented, which keeps every function canonical.
+//
+// Nodes are hash-consed in a chained unique table, and ITE results are memoized in a
+// direct-mapped computed table that simply overwrites on collisions. Reference counts
+// cover handles and parent nodes; only a referenced node holds references on its
+// children. A node whose count drops to zero is dead: it releases its children but
+// stays in the unique table, and is revived if it is built again before a collection.
+// Garbage collection runs between top-level operations once enough nodes are dead,
+// frees them in one sweep, and clears the computed table.
+//
+// Variables are ordered by index, variable 0 at the top. There is no dynamic reordering,
+// so the caller picks the order (interleaved operand bits for adders, for example).
+class BddManager
+{
+public:
+    using Edge = uint32_t;
+    static constexpr Edge One = 0;
+    static constexpr Edge Zero = 1;
+
+    explicit BddManager(uint32_t numVariables = 0, size_t cacheEntries = 1 << 18);
+    BddManager(const BddManager &) = delete;
+    BddManager &operator=(const BddManager &) = delete;
+
+    Bdd one() { return Bdd(this, One); }
+    Bdd zero() { return Bdd(this, Zero); }
+    // the projection function of a variable, adding variables up to `index` as needed
+    Bdd variable(uint32_t index);
+    uint32_t getVariableCount() const { return numVariables; }
+
+    // if f then g else h, the operation every connective is built on
+    Bdd ite(const Bdd &f, const Bdd &g, const Bdd &h);
+    // f with `variable` fixed to `value`
+    Bdd cofactor(const Bdd &f, uint32_t variable, bool value);
+
+    // one BDD per circuit output, in the order of circuit.getOutputs()
+    // circuit input i is variable i
+    std::vector<Bdd> fromCircuit(const Circuit &circuit);
+    // same with caller-chosen functions for the inputs, so several circuits can share
+    // variables (for equivalence checks) and the variable order can be picked freely
+    std::vector<Bdd> fromCircuit(const Circuit &circuit, const std::vector<Bdd> &inputs);
+
+    // number of assignments to variables 0 .. numVariables - 1 that satisfy f
+    double satCount(const Bdd &f, uint32_t numVariables) const;
+    // one satisfying assignment, 0/1 per variable and -1 where either value works
+    // empty if f is zero
+    std::vector<int> satOne(const Bdd &f) const;
+    // distinct nodes reachable from the roots, shared nodes and the terminal counted once
+    size_t nodeCount(const Bdd &f) const;
+    size_t nodeCount(const std::vector<Bdd> &roots) const;
+    // one disjoint cube per path from f to the one terminal, driving `output`, e.g. as the
+    // on-set for Espresso; throws std::runtime_error past `limit` cubes
+    void addPathCubes(const Bdd &f, int output, CubeList &cubes, size_t limit = 1000000) const;
+
+    // frees every dead node and clears the computed table
+    void collectGarbage();
+    // dead nodes that trigger a collection at the start of the next operation
+    void setGarbageThreshold(size_t nodes) { garbageThreshold = nodes; }
+
+    // statistics
+    size_t getNodeCount() const { return liveNodes; }
+    size_t getDeadNodeCount() const { return deadNodes; }
+    size_t getPeakNodeCount() const { return peakNodes; }
+    uint64_t getCacheLookups() const { return cacheLookups; }
+    uint64_t getCacheHits() const { return cacheHits; }
+    uint64_t getGarbageCollections() const { return garbageCollections; }
+    uint64_t getReclaimedNodes() const { return reclaimedNodes; }
+    size_t getMemoryUsage() const;
+
+private:
+    friend class Bdd;
+
+    struct Node
+    {
+        uint32_t variable;
+        Edge high;
+        Edge low;
+        uint32_t refCount;
+        // next node in the same unique-table bucket, or in the free list
+        uint32_t next;
+    };
+
+    struct CacheEntry
+    {
+        Edge f;
+        Edge g;
+        Edge h;
+        Edge result;
+    };
+
+    // variable of the terminal, below every real variable
+    static constexpr uint32_t TerminalVariable = 0xFFFFFFFF;
+    // variable of a node on the free list
+    static constexpr uint32_t FreeVariable = 0xFFFFFFFE;
+    static constexpr Edge NoEdge = 0xFFFFFFFF;
+
+    uint32_t numVariables;
+    std::vector<Node> nodes;
+    // heads of the unique-table chains, 0 marks an empty bucket (the terminal is never hashed)
+    std::vector<uint32_t> buckets;
+    std::vector<CacheEntry> cache;
+    uint32_t freeList = 0;
+
+    size_t liveNodes = 0;
+    size_t deadNodes = 0;
+    size_t peakNodes = 0;
+    size_t garbageThreshold = 1 << 16;
+    uint64_t cacheLookups = 0;
+    uint64_t cacheHits = 0;
+    uint64_t garbageCollections = 0;
+    uint64_t reclaimedNodes = 0;
+
+    void ref(Edge edge);
+    void deref(Edge edge);
+    void requireOwn(const Bdd &f) const;
+    void collectIfNeeded();
+
+    uint32_t variableOf(Edge edge) const { return nodes[edge >> 1].variable; }
+    // cofactor of `edge` for the top variable `variable`, the complement flag pushed down
+    Edge highOf(Edge edge, uint32_t variable) const;
+    Edge lowOf(Edge edge, uint32_t variable) const;
+
+    size_t bucketOf(uint32_t variable, Edge high, Edge low) const;
+    void growUniqueTable();
+    Edge makeNode(uint32_t variable, Edge high, Edge low);
+    Edge iteRecursive(Edge f, Edge g, Edge h);
+    Edge cofactorRecursive(Edge f, uint32_t variable, bool value, std::unordered_map<uint32_t, Edge> &memo);
+};
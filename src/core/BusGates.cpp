@@ -0,0 +1,80 @@
+#include "BusGates.h"
+#include "GateFactory.h"
+#include "GateKernels.h"
+
+BusGate::BusGate(GateType type, const std::string &gateLabel, std::pmr::memory_resource *resource)
+    : Gate(type, gateLabel, resource)
+{
+    inputSignals.resize(2, false);
+}
+
+void BusGate::checkInputCount(size_t count) const
+{
+    if (!GateFactory::isValidInputCount(type, static_cast<int>(count)))
+    {
+        throw std::invalid_argument(GateFactory::getGateTypeName(type) + ": wrong number of inputs.");
+    }
+}
+
+void BusGate::evaluate()
+{
+    checkInputCount(inputSignals.size());
+    std::vector<uint64_t> words;
+    for (bool signal : inputSignals)
+    {
+        words.push_back(signal ? ~0ULL : 0);
+    }
+    outputSignal = evaluateWord(words) & 1;
+}
+
+uint64_t BusGate::evaluateWord(const std::vector<uint64_t> &inputWords) const
+{
+    checkInputCount(inputWords.size());
+    // a bus may have more drivers than the identity fan-in of evaluateGateWord covers
+    std::vector<uint32_t> fanin(inputWords.size());
+    for (uint32_t i = 0; i < fanin.size(); i++)
+    {
+        fanin[i] = i;
+    }
+    return evaluateGateWord(type, inputWords.data(), fanin.data(), static_cast<uint32_t>(fanin.size()));
+}
+
+LogicWord BusGate::evaluateLogicWord(const std::vector<LogicWord> &inputWords) const
+{
+    checkInputCount(inputWords.size());
+    std::vector<uint64_t> values;
+    std::vector<uint64_t> unknowns;
+    std::vector<uint32_t> fanin;
+    for (const LogicWord &word : inputWords)
+    {
+        fanin.push_back(static_cast<uint32_t>(values.size()));
+        values.push_back(word.value);
+        unknowns.push_back(word.unknown);
+    }
+    return evaluateGateLogicWord(type, values.data(), unknowns.data(), fanin.data(), static_cast<uint32_t>(fanin.size()));
+}
+
+TriStateBuffer::TriStateBuffer(const std::string &gateLabel, std::pmr::memory_resource *resource)
+    : BusGate(GateType::TriState, gateLabel, resource)
+{
+}
+
+TransmissionGate::TransmissionGate(const std::string &gateLabel, std::pmr::memory_resource *resource)
+    : BusGate(GateType::TransmissionGate, gateLabel, resource)
+{
+}
+
+WiredAndNet::WiredAndNet(const std::string &gateLabel, std::pmr::memory_resource *resource)
+    : BusGate(GateType::WiredAnd, gateLabel, resource)
+{
+}
+
+WiredOrNet::WiredOrNet(const std::string &gateLabel, std::pmr::memory_resource *resource)
+    : BusGate(GateType::WiredOr, gateLabel, resource)
+{
+}
+
+ResolvedBus::ResolvedBus(const std::string &gateLabel, std::pmr::memory_resource *resource)
+    : BusGate(GateType::Bus, gateLabel, resource)
+{
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "Gate.h"
+#include <stdexcept>
+
+// Drivers that can let go of their output, and the nets several of them share. A tri-state
+// buffer or transmission gate drives Z while it is off; a resolved net has one pin per
+// driver and combines them, ignoring the ones that are Z. Z only exists in four-valued
+// logic, so evaluateLogicWord() is the real function of these gates; evaluate() and
+// evaluateWord() give the two-valued reading where a released driver is 0 (see GateKernels.h).
+class BusGate : public Gate
+{
+public:
+    void evaluate() override;
+    uint64_t evaluateWord(const std::vector<uint64_t> &inputWords) const override;
+    LogicWord evaluateLogicWord(const std::vector<LogicWord> &inputWords) const override;
+
+protected:
+    BusGate(GateType type, const std::string &gateLabel, std::pmr::memory_resource *resource);
+
+private:
+    void checkInputCount(size_t count) const;
+};
+
+class TriStateBuffer : public BusGate
+{
+public:
+    TriStateBuffer(const std::string &gateLabel = "", std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+};
+
+class TransmissionGate : public BusGate
+{
+public:
+    TransmissionGate(const std::string &gateLabel = "", std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+};
+
+class WiredAndNet : public BusGate
+{
+public:
+    WiredAndNet(const std::string &gateLabel = "", std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+};
+
+class WiredOrNet : public BusGate
+{
+public:
+    WiredOrNet(const std::string &gateLabel = "", std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+};
+
+class ResolvedBus : public BusGate
+{
+public:
+    ResolvedBus(const std::string &gateLabel = "", std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+};
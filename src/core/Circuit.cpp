@@ -0,0 +1,426 @@
+#include "Circuit.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "GateFactory.h"
+
+namespace
+{
+    // FNV-1a, only used to place names in the lookup table
+    uint64_t hashName(const char *name, size_t length)
+    {
+        uint64_t hash = 1469598103934665603ULL;
+        for (size_t i = 0; i < length; i++)
+        {
+            hash ^= static_cast<unsigned char>(name[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
+
+Circuit::Circuit(const Circuit &other)
+    : typeCodes(other.typeCodes), faninOffsets(other.faninOffsets), faninIds(other.faninIds),
+      fanoutOffsets(other.fanoutOffsets), fanoutIds(other.fanoutIds), inputs(other.inputs), outputs(other.outputs),
+      delays(other.delays), nameTable(other.nameTable), nameOffsets(other.nameOffsets), nameSlots(other.nameSlots),
+      view(other.view), owner(other.owner), valueBits(other.valueBits), frozen(other.frozen)
+{
+    // an attached copy shares the image, an owned one reads its own vectors
+    if (!owner)
+    {
+        bindOwned();
+    }
+}
+
+Circuit &Circuit::operator=(const Circuit &other)
+{
+    if (this != &other)
+    {
+        Circuit copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+Circuit::Circuit(Circuit &&other) noexcept
+    : typeCodes(std::move(other.typeCodes)), faninOffsets(std::move(other.faninOffsets)), faninIds(std::move(other.faninIds)),
+      fanoutOffsets(std::move(other.fanoutOffsets)), fanoutIds(std::move(other.fanoutIds)), inputs(std::move(other.inputs)),
+      outputs(std::move(other.outputs)), delays(std::move(other.delays)), nameTable(std::move(other.nameTable)),
+      nameOffsets(std::move(other.nameOffsets)), nameSlots(std::move(other.nameSlots)), view(other.view),
+      owner(std::move(other.owner)), valueBits(std::move(other.valueBits)), frozen(other.frozen)
+{
+    if (!owner)
+    {
+        bindOwned();
+    }
+    other.resetMovedFrom();
+}
+
+Circuit &Circuit::operator=(Circuit &&other) noexcept
+{
+    if (this != &other)
+    {
+        typeCodes = std::move(other.typeCodes);
+        faninOffsets = std::move(other.faninOffsets);
+        faninIds = std::move(other.faninIds);
+        fanoutOffsets = std::move(other.fanoutOffsets);
+        fanoutIds = std::move(other.fanoutIds);
+        inputs = std::move(other.inputs);
+        outputs = std::move(other.outputs);
+        delays = std::move(other.delays);
+        nameTable = std::move(other.nameTable);
+        nameOffsets = std::move(other.nameOffsets);
+        nameSlots = std::move(other.nameSlots);
+        view = other.view;
+        owner = std::move(other.owner);
+        valueBits = std::move(other.valueBits);
+        frozen = other.frozen;
+        if (!owner)
+        {
+            bindOwned();
+        }
+        other.resetMovedFrom();
+    }
+    return *this;
+}
+
+Circuit Circuit::attach(const Image &image, std::shared_ptr<const void> owner)
+{
+    if (!owner)
+    {
+        throw std::invalid_argument("Circuit: an attached image needs an owner");
+    }
+    Circuit circuit;
+    circuit.view = image;
+    circuit.owner = std::move(owner);
+    circuit.valueBits.assign((image.nodeCount + 63) / 64, 0);
+    if (image.values)
+    {
+        std::copy(image.values, image.values + circuit.valueBits.size(), circuit.valueBits.begin());
+    }
+    circuit.frozen = true;
+    return circuit;
+}
+
+Circuit::Image Circuit::getImage() const
+{
+    if (!frozen)
+    {
+        throw std::logic_error("Circuit: only a frozen netlist has an image");
+    }
+    Image image = view;
+    image.values = valueBits.data();
+    return image;
+}
+
+Circuit::NodeId Circuit::addInput(std::string_view name)
+{
+    NodeId node = addNode(InputCode, name, 0);
+    inputs.push_back(node);
+    return node;
+}
+
+Circuit::NodeId Circuit::addGate(GateType type, std::string_view name, uint32_t numInputs)
+{
+    if (!GateFactory::isValidGateType(type))
+    {
+        throw std::invalid_argument("Circuit: unsupported gate type " + GateFactory::getGateTypeName(type));
+    }
+    return addNode(static_cast<uint8_t>(type), name, numInputs);
+}
+
+Circuit::NodeId Circuit::addNode(uint8_t typeCode, std::string_view name, uint32_t numInputs)
+{
+    requireBuilding();
+    if (typeCodes.size() >= InvalidNode)
+    {
+        throw std::length_error("Circuit: too many nodes");
+    }
+    if (faninOffsets.empty())
+    {
+        // a moved-from circuit being built again
+        faninOffsets.push_back(0);
+        nameOffsets.push_back(0);
+    }
+    NodeId node = static_cast<NodeId>(typeCodes.size());
+    // only generated names need storage of their own
+    std::string generated = name.empty() ? "N" + std::to_string(node) : std::string();
+    std::string_view nodeName = name.empty() ? std::string_view(generated) : name;
+
+    if ((typeCodes.size() + 1) * 2 > nameSlots.size())
+    {
+        growNameSlots();
+    }
+    size_t slot = findSlot(nodeName.data(), nodeName.size());
+    if (nameSlots[slot] != InvalidNode)
+    {
+        throw std::invalid_argument("Circuit: duplicate node name " + std::string(nodeName));
+    }
+    nameSlots[slot] = node;
+    nameTable.insert(nameTable.end(), nodeName.begin(), nodeName.end());
+    nameOffsets.push_back(static_cast<uint32_t>(nameTable.size()));
+
+    typeCodes.push_back(typeCode);
+    delays.push_back(typeCode == InputCode ? 0 : 1);
+    faninOffsets.push_back(faninOffsets.back() + numInputs);
+    faninIds.resize(faninOffsets.back(), InvalidNode);
+    valueBits.resize((typeCodes.size() + 63) / 64, 0);
+    bindOwned();
+    return node;
+}
+
+void Circuit::connect(NodeId driver, NodeId gate, uint32_t pin)
+{
+    requireBuilding();
+    requireNode(driver);
+    requireNode(gate);
+    if (isInput(gate))
+    {
+        throw std::invalid_argument("Circuit: cannot drive primary input " + getName(gate));
+    }
+    if (pin >= getFaninCount(gate))
+    {
+        throw std::out_of_range("Circuit: pin " + std::to_string(pin) + " out of range for " + getName(gate));
+    }
+    faninIds[faninOffsets[gate] + pin] = driver;
+}
+
+void Circuit::setDelay(NodeId node, uint32_t ticks)
+{
+    if (owner)
+    {
+        throw std::logic_error("Circuit: an attached netlist is read-only");
+    }
+    requireNode(node);
+    if (isInput(node))
+    {
+        throw std::invalid_argument("Circuit: primary input " + getName(node) + " has no delay");
+    }
+    delays[node] = ticks;
+}
+
+void Circuit::markOutput(NodeId node)
+{
+    requireBuilding();
+    requireNode(node);
+    outputs.push_back(node);
+    bindOwned();
+}
+
+void Circuit::freeze()
+{
+    requireBuilding();
+    const uint32_t numNodes = getNodeCount();
+
+    // validate every gate once here, so the engines never have to
+    for (NodeId node = 0; node < numNodes; node++)
+    {
+        if (isInput(node))
+        {
+            continue;
+        }
+        if (!GateFactory::isValidInputCount(getGateType(node), getFaninCount(node)))
+        {
+            throw std::invalid_argument("Circuit: gate " + getName(node) + " has an invalid number of inputs (" +
+                                        std::to_string(getFaninCount(node)) + ")");
+        }
+        for (uint32_t pin = 0; pin < getFaninCount(node); pin++)
+        {
+            if (getFanin(node)[pin] == InvalidNode)
+            {
+                throw std::runtime_error("Circuit: pin " + std::to_string(pin) + " of gate " + getName(node) + " is not connected");
+            }
+        }
+    }
+
+    // fan-out CSR: count, prefix sum, scatter
+    fanoutOffsets.assign(numNodes + 1, 0);
+    for (NodeId driver : faninIds)
+    {
+        fanoutOffsets[driver + 1]++;
+    }
+    for (uint32_t node = 0; node < numNodes; node++)
+    {
+        fanoutOffsets[node + 1] += fanoutOffsets[node];
+    }
+    fanoutIds.resize(faninIds.size());
+    std::vector<uint32_t> cursor(fanoutOffsets.begin(), fanoutOffsets.end() - 1);
+    for (NodeId node = 0; node < numNodes; node++)
+    {
+        for (uint32_t pin = 0; pin < getFaninCount(node); pin++)
+        {
+            fanoutIds[cursor[getFanin(node)[pin]]++] = node;
+        }
+    }
+    bindOwned();
+
+    // without explicit outputs, every gate nobody reads is a primary output
+    if (outputs.empty())
+    {
+        for (NodeId node = 0; node < numNodes; node++)
+        {
+            if (!isInput(node) && getFanoutCount(node) == 0)
+            {
+                outputs.push_back(node);
+            }
+        }
+    }
+    bindOwned();
+    frozen = true;
+}
+
+GateType Circuit::getGateType(NodeId node) const
+{
+    if (isInput(node))
+    {
+        throw std::invalid_argument("Circuit: " + getName(node) + " is a primary input, not a gate");
+    }
+    return static_cast<GateType>(view.typeCodes[node]);
+}
+
+bool Circuit::hasStateElements() const
+{
+    for (NodeId node = 0; node < view.nodeCount; node++)
+    {
+        if (!isInput(node) && GateFactory::isSequential(static_cast<GateType>(view.typeCodes[node])))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string Circuit::getName(NodeId node) const
+{
+    requireNode(node);
+    return std::string(view.nameTable + view.nameOffsets[node], view.nameOffsets[node + 1] - view.nameOffsets[node]);
+}
+
+Circuit::NodeId Circuit::findNode(std::string_view name) const
+{
+    if (view.nameSlotCount == 0)
+    {
+        return InvalidNode;
+    }
+    return view.nameSlots[findSlot(name.data(), name.size())];
+}
+
+void Circuit::setValue(NodeId node, bool value)
+{
+    if (value)
+    {
+        valueBits[node >> 6] |= 1ULL << (node & 63);
+    }
+    else
+    {
+        valueBits[node >> 6] &= ~(1ULL << (node & 63));
+    }
+}
+
+void Circuit::clearValues()
+{
+    std::fill(valueBits.begin(), valueBits.end(), 0);
+}
+
+size_t Circuit::getMemoryUsage() const
+{
+    if (owner)
+    {
+        // the image arrays, most of which are only paged in when read
+        return view.nodeCount * (sizeof(uint8_t) + 4 * sizeof(uint32_t)) +
+               (view.inputCount + view.outputCount + view.nameSlotCount) * sizeof(NodeId) +
+               (view.faninOffsets[view.nodeCount] * 2) * sizeof(NodeId) + view.nameOffsets[view.nodeCount] +
+               valueBits.capacity() * sizeof(uint64_t);
+    }
+    return typeCodes.capacity() * sizeof(uint8_t) +
+           (faninOffsets.capacity() + fanoutOffsets.capacity() + nameOffsets.capacity() + delays.capacity()) * sizeof(uint32_t) +
+           (faninIds.capacity() + fanoutIds.capacity() + inputs.capacity() + outputs.capacity() + nameSlots.capacity()) * sizeof(NodeId) +
+           nameTable.capacity() + valueBits.capacity() * sizeof(uint64_t);
+}
+
+void Circuit::requireBuilding() const
+{
+    if (frozen)
+    {
+        throw std::logic_error("Circuit: netlist is frozen");
+    }
+}
+
+void Circuit::requireNode(NodeId node) const
+{
+    if (node >= getNodeCount())
+    {
+        throw std::out_of_range("Circuit: node id out of range");
+    }
+}
+
+size_t Circuit::findSlot(const char *name, size_t length) const
+{
+    // linear probing, the table is kept at most half full
+    size_t mask = view.nameSlotCount - 1;
+    size_t slot = hashName(name, length) & mask;
+    while (view.nameSlots[slot] != InvalidNode)
+    {
+        NodeId node = view.nameSlots[slot];
+        uint32_t begin = view.nameOffsets[node];
+        if (view.nameOffsets[node + 1] - begin == length && std::memcmp(view.nameTable + begin, name, length) == 0)
+        {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void Circuit::growNameSlots()
+{
+    nameSlots.assign(nameSlots.empty() ? 16 : nameSlots.size() * 2, InvalidNode);
+    bindOwned();
+    for (NodeId node = 0; node < getNodeCount(); node++)
+    {
+        uint32_t begin = nameOffsets[node];
+        nameSlots[findSlot(nameTable.data() + begin, nameOffsets[node + 1] - begin)] = node;
+    }
+}
+
+void Circuit::resetMovedFrom() noexcept
+{
+    typeCodes.clear();
+    // the offsets stay empty rather than allocating, bindOwned() reads that as zero nodes
+    faninOffsets.clear();
+    faninIds.clear();
+    fanoutOffsets.clear();
+    fanoutIds.clear();
+    inputs.clear();
+    outputs.clear();
+    delays.clear();
+    nameTable.clear();
+    nameOffsets.clear();
+    nameSlots.clear();
+    owner.reset();
+    valueBits.clear();
+    frozen = false;
+    view = Image();
+    bindOwned();
+}
+
+void Circuit::bindOwned()
+{
+    // the leading zero offset of a circuit without nodes, for one whose vectors were moved out
+    static const uint32_t NoOffsets[1] = {0};
+    view.nodeCount = static_cast<uint32_t>(typeCodes.size());
+    view.inputCount = static_cast<uint32_t>(inputs.size());
+    view.outputCount = static_cast<uint32_t>(outputs.size());
+    view.nameSlotCount = static_cast<uint32_t>(nameSlots.size());
+    view.typeCodes = typeCodes.data();
+    view.delays = delays.data();
+    view.faninOffsets = faninOffsets.empty() ? NoOffsets : faninOffsets.data();
+    view.faninIds = faninIds.data();
+    view.fanoutOffsets = fanoutOffsets.data();
+    view.fanoutIds = fanoutIds.data();
+    view.inputs = inputs.data();
+    view.outputs = outputs.data();
+    view.nameOffsets = nameOffsets.empty() ? NoOffsets : nameOffsets.data();
+    view.nameSlots = nameSlots.data();
+    view.nameTable = nameTable.data();
+}
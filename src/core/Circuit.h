@@ -0,0 +1,165 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Gate.h"
+
+// Compiled netlist. Every node (a primary input or a gate) drives exactly one signal,
+// and the whole structure lives in flat arrays indexed by 32-bit node ids:
+//  - one type code byte per node
+//  - CSR fan-in: node n reads faninIds[faninOffsets[n] .. faninOffsets[n + 1])
+//  - CSR fan-out: node n drives fanoutIds[fanoutOffsets[n] .. fanoutOffsets[n + 1])
+//  - one bit per node in the packed signal-value array
+// Names live in one shared string table, so a node costs no heap allocation of its own.
+// A frozen circuit can also read all of these arrays in place from a binary image (see
+// attach()), in which case it owns nothing but the signal values.
+class Circuit
+{
+public:
+    using NodeId = uint32_t;
+    static constexpr NodeId InvalidNode = 0xFFFFFFFF;
+    // type code of primary inputs, gates store static_cast<uint8_t>(GateType)
+    static constexpr uint8_t InputCode = 0xFF;
+
+    // read-only run of node ids, such as the primary inputs
+    class NodeList
+    {
+    public:
+        NodeList(const NodeId *first, size_t count) : first(first), count(count) {}
+        const NodeId *begin() const { return first; }
+        const NodeId *end() const { return first + count; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        NodeId operator[](size_t index) const { return first[index]; }
+
+    private:
+        const NodeId *first;
+        size_t count;
+    };
+
+    // every array of a frozen circuit, with the counts that size them
+    // nameSlots is the open-addressing name table, nameSlotCount entries (a power of two)
+    struct Image
+    {
+        uint32_t nodeCount = 0;
+        uint32_t inputCount = 0;
+        uint32_t outputCount = 0;
+        uint32_t nameSlotCount = 0;
+        const uint8_t *typeCodes = nullptr;
+        const uint32_t *delays = nullptr;
+        const uint32_t *faninOffsets = nullptr; // nodeCount + 1 entries
+        const NodeId *faninIds = nullptr;
+        const uint32_t *fanoutOffsets = nullptr; // nodeCount + 1 entries
+        const NodeId *fanoutIds = nullptr;
+        const NodeId *inputs = nullptr;
+        const NodeId *outputs = nullptr;
+        const uint64_t *values = nullptr; // (nodeCount + 63) / 64 words of signal values
+        const uint32_t *nameOffsets = nullptr; // nodeCount + 1 entries
+        const NodeId *nameSlots = nullptr;
+        const char *nameTable = nullptr;
+    };
+
+    Circuit() { bindOwned(); }
+    Circuit(const Circuit &other);
+    Circuit &operator=(const Circuit &other);
+    // the view is re-bound on both sides, `other` is left an empty circuit
+    Circuit(Circuit &&other) noexcept;
+    Circuit &operator=(Circuit &&other) noexcept;
+
+    // a frozen circuit reading `image` in place; only the signal values are copied, since
+    // they change. `owner` keeps the arrays alive for as long as the circuit or a copy exists
+    static Circuit attach(const Image &image, std::shared_ptr<const void> owner);
+    // the arrays of a frozen circuit, for writing it out as an image
+    Image getImage() const;
+    bool isAttached() const { return owner != nullptr; }
+
+    // building, only allowed before freeze()
+    // names are copied into the shared table, an empty name becomes N<id>
+    NodeId addInput(std::string_view name);
+    NodeId addGate(GateType type, std::string_view name, uint32_t numInputs);
+    void connect(NodeId driver, NodeId gate, uint32_t pin);
+    void markOutput(NodeId node);
+    // propagation delay in ticks for the event-driven engine, gates default to 1
+    void setDelay(NodeId node, uint32_t ticks);
+    // validates pin counts and connections, then builds the fan-out arrays
+    void freeze();
+    bool isFrozen() const { return frozen; }
+
+    // structure
+    uint32_t getNodeCount() const { return view.nodeCount; }
+    uint32_t getGateCount() const { return getNodeCount() - getInputCount(); }
+    uint32_t getInputCount() const { return view.inputCount; }
+    uint32_t getOutputCount() const { return view.outputCount; }
+    NodeList getInputs() const { return NodeList(view.inputs, view.inputCount); }
+    NodeList getOutputs() const { return NodeList(view.outputs, view.outputCount); }
+
+    uint8_t getTypeCode(NodeId node) const { return view.typeCodes[node]; }
+    bool isInput(NodeId node) const { return view.typeCodes[node] == InputCode; }
+    GateType getGateType(NodeId node) const;
+    uint32_t getFaninCount(NodeId node) const { return view.faninOffsets[node + 1] - view.faninOffsets[node]; }
+    const NodeId *getFanin(NodeId node) const { return view.faninIds + view.faninOffsets[node]; }
+    uint32_t getFanoutCount(NodeId node) const { return view.fanoutOffsets[node + 1] - view.fanoutOffsets[node]; }
+    const NodeId *getFanout(NodeId node) const { return view.fanoutIds + view.fanoutOffsets[node]; }
+
+    // raw arrays for the simulation engines
+    const uint8_t *getTypeCodes() const { return view.typeCodes; }
+    const uint32_t *getFaninOffsets() const { return view.faninOffsets; }
+    const NodeId *getFaninIds() const { return view.faninIds; }
+    const uint32_t *getFanoutOffsets() const { return view.fanoutOffsets; }
+    const NodeId *getFanoutIds() const { return view.fanoutIds; }
+    uint32_t getDelay(NodeId node) const { return view.delays[node]; }
+    const uint32_t *getDelays() const { return view.delays; }
+    // true if any gate is a flip-flop or latch, which only SequentialSimulator can run
+    bool hasStateElements() const;
+
+    // names
+    std::string getName(NodeId node) const;
+    // returns InvalidNode if no node has that name
+    NodeId findNode(std::string_view name) const;
+
+    // bit-packed signal values, one bit per node
+    bool getValue(NodeId node) const { return (valueBits[node >> 6] >> (node & 63)) & 1; }
+    void setValue(NodeId node, bool value);
+    const std::vector<uint64_t> &getValueWords() const { return valueBits; }
+    void clearValues();
+
+    // bytes held by the flat arrays, names and value bits, or read from the image
+    size_t getMemoryUsage() const;
+
+private:
+    // storage of a circuit built in memory, all empty for an attached one
+    std::vector<uint8_t> typeCodes;
+    std::vector<uint32_t> faninOffsets{0};
+    std::vector<NodeId> faninIds;
+    std::vector<uint32_t> fanoutOffsets;
+    std::vector<NodeId> fanoutIds;
+    std::vector<NodeId> inputs;
+    std::vector<NodeId> outputs;
+    std::vector<uint32_t> delays;
+
+    // all names back to back, node n owns nameTable[nameOffsets[n] .. nameOffsets[n + 1])
+    std::vector<char> nameTable;
+    std::vector<uint32_t> nameOffsets{0};
+    // open-addressing hash of node ids keyed by name, InvalidNode marks an empty slot
+    std::vector<NodeId> nameSlots;
+
+    // what the accessors read: the vectors above, re-bound whenever they may have moved,
+    // or the arrays of an attached image
+    Image view;
+    std::shared_ptr<const void> owner;
+
+    std::vector<uint64_t> valueBits;
+    bool frozen = false;
+
+    NodeId addNode(uint8_t typeCode, std::string_view name, uint32_t numInputs);
+    void requireBuilding() const;
+    void requireNode(NodeId node) const;
+    size_t findSlot(const char *name, size_t length) const;
+    void growNameSlots();
+    void bindOwned();
+    // back to a new, empty circuit after being moved from
+    void resetMovedFrom() noexcept;
+};
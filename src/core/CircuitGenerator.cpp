@@ -0,0 +1,208 @@
+#include "CircuitGenerator.h"
+#include <stdexcept>
+#include <vector>
+
+Circuit::NodeId CircuitGenerator::addGate2(Circuit &circuit, GateType type, const std::string &name, Circuit::NodeId a, Circuit::NodeId b)
+{
+    Circuit::NodeId gate = circuit.addGate(type, name, 2);
+    circuit.connect(a, gate, 0);
+    circuit.connect(b, gate, 1);
+    return gate;
+}
+
+void CircuitGenerator::addBits(Circuit &circuit, const std::string &name, Circuit::NodeId a, Circuit::NodeId b, Circuit::NodeId c,
+                               Circuit::NodeId &sum, Circuit::NodeId &carry)
+{
+    std::vector<Circuit::NodeId> operands;
+    for (Circuit::NodeId operand : {a, b, c})
+    {
+        if (operand != Circuit::InvalidNode)
+        {
+            operands.push_back(operand);
+        }
+    }
+
+    if (operands.size() == 1)
+    {
+        sum = operands[0];
+        carry = Circuit::InvalidNode;
+    }
+    else if (operands.size() == 2)
+    {
+        // half adder
+        sum = addGate2(circuit, GateType::Xor, name + ".s", operands[0], operands[1]);
+        carry = addGate2(circuit, GateType::And, name + ".c", operands[0], operands[1]);
+    }
+    else if (operands.size() == 3)
+    {
+        // full adder: s = a ^ b ^ c, cout = ab | c(a ^ b)
+        Circuit::NodeId half = addGate2(circuit, GateType::Xor, name + ".x", operands[0], operands[1]);
+        sum = addGate2(circuit, GateType::Xor, name + ".s", half, operands[2]);
+        Circuit::NodeId generate = addGate2(circuit, GateType::And, name + ".g", operands[0], operands[1]);
+        Circuit::NodeId propagate = addGate2(circuit, GateType::And, name + ".p", half, operands[2]);
+        carry = addGate2(circuit, GateType::Or, name + ".c", generate, propagate);
+    }
+    else
+    {
+        throw std::invalid_argument("CircuitGenerator: nothing to add");
+    }
+}
+
+Circuit CircuitGenerator::adderArray(uint32_t instances, uint32_t bits)
+{
+    if (instances == 0 || bits == 0)
+    {
+        throw std::invalid_argument("CircuitGenerator: adder array needs at least one 1-bit adder");
+    }
+
+    Circuit circuit;
+    std::vector<Circuit::NodeId> outputs;
+    for (uint32_t unit = 0; unit < instances; unit++)
+    {
+        std::string prefix = "u" + std::to_string(unit) + ".";
+        std::vector<Circuit::NodeId> a(bits), b(bits);
+        for (uint32_t j = 0; j < bits; j++)
+        {
+            a[j] = circuit.addInput(prefix + "a" + std::to_string(j));
+            b[j] = circuit.addInput(prefix + "b" + std::to_string(j));
+        }
+        Circuit::NodeId carry = circuit.addInput(prefix + "cin");
+        for (uint32_t j = 0; j < bits; j++)
+        {
+            Circuit::NodeId sum;
+            addBits(circuit, prefix + "fa" + std::to_string(j), a[j], b[j], carry, sum, carry);
+            outputs.push_back(sum);
+        }
+        outputs.push_back(carry);
+    }
+    for (Circuit::NodeId output : outputs)
+    {
+        circuit.markOutput(output);
+    }
+    circuit.freeze();
+    return circuit;
+}
+
+Circuit CircuitGenerator::multiplierArray(uint32_t instances, uint32_t bits)
+{
+    if (instances == 0 || bits < 2)
+    {
+        throw std::invalid_argument("CircuitGenerator: multiplier array needs at least one 2-bit multiplier");
+    }
+
+    Circuit circuit;
+    std::vector<Circuit::NodeId> outputs;
+    for (uint32_t unit = 0; unit < instances; unit++)
+    {
+        std::string prefix = "u" + std::to_string(unit) + ".";
+        std::vector<Circuit::NodeId> a(bits), b(bits);
+        for (uint32_t j = 0; j < bits; j++)
+        {
+            a[j] = circuit.addInput(prefix + "a" + std::to_string(j));
+        }
+        for (uint32_t j = 0; j < bits; j++)
+        {
+            b[j] = circuit.addInput(prefix + "b" + std::to_string(j));
+        }
+
+        // row 0 of the partial products is the initial accumulator
+        std::vector<Circuit::NodeId> acc(bits);
+        for (uint32_t j = 0; j < bits; j++)
+        {
+            acc[j] = addGate2(circuit, GateType::And, prefix + "pp0." + std::to_string(j), a[j], b[0]);
+        }
+        Circuit::NodeId top = Circuit::InvalidNode;
+        for (uint32_t row = 1; row < bits; row++)
+        {
+            // the low accumulator bit is final, add the rest to this row's partial products
+            outputs.push_back(acc[0]);
+            std::string rowPrefix = prefix + "r" + std::to_string(row) + ".";
+            std::vector<Circuit::NodeId> next(bits);
+            Circuit::NodeId carry = Circuit::InvalidNode;
+            for (uint32_t j = 0; j < bits; j++)
+            {
+                Circuit::NodeId pp = addGate2(circuit, GateType::And, rowPrefix + "pp" + std::to_string(j), a[j], b[row]);
+                Circuit::NodeId shifted = j + 1 < bits ? acc[j + 1] : top;
+                addBits(circuit, rowPrefix + "fa" + std::to_string(j), shifted, pp, carry, next[j], carry);
+            }
+            acc = next;
+            top = carry;
+        }
+        for (Circuit::NodeId bit : acc)
+        {
+            outputs.push_back(bit);
+        }
+        if (top != Circuit::InvalidNode)
+        {
+            outputs.push_back(top);
+        }
+    }
+    for (Circuit::NodeId output : outputs)
+    {
+        circuit.markOutput(output);
+    }
+    circuit.freeze();
+    return circuit;
+}
+
+Circuit CircuitGenerator::counterArray(uint32_t instances, uint32_t bits)
+{
+    if (instances == 0 || bits == 0)
+    {
+        throw std::invalid_argument("CircuitGenerator: counter array needs at least one 1-bit counter");
+    }
+
+    Circuit circuit;
+    std::vector<Circuit::NodeId> outputs;
+    const std::pair<GateType, const char *> kinds[] = {
+        {GateType::FlipFlop, "d"}, {GateType::TFlipFlop, "t"}, {GateType::JKFlipFlop, "jk"}, {GateType::SRFlipFlop, "sr"}};
+    for (uint32_t unit = 0; unit < instances; unit++)
+    {
+        std::string prefix = "u" + std::to_string(unit) + ".";
+        Circuit::NodeId enable = circuit.addInput(prefix + "en");
+        for (const auto &kind : kinds)
+        {
+            // bit j toggles when every lower bit is 1: carry c0 = en, c(j+1) = cj & qj
+            std::string counterPrefix = prefix + kind.second + ".";
+            Circuit::NodeId carry = enable;
+            for (uint32_t j = 0; j < bits; j++)
+            {
+                std::string bitPrefix = counterPrefix + std::to_string(j) + ".";
+                uint32_t pins = kind.first == GateType::FlipFlop || kind.first == GateType::TFlipFlop ? 1 : 2;
+                Circuit::NodeId q = circuit.addGate(kind.first, counterPrefix + "q" + std::to_string(j), pins);
+                Circuit::NodeId next = j + 1 < bits || kind.first == GateType::SRFlipFlop
+                                           ? addGate2(circuit, GateType::And, bitPrefix + "c", carry, q)
+                                           : Circuit::InvalidNode;
+                if (kind.first == GateType::FlipFlop)
+                {
+                    circuit.connect(addGate2(circuit, GateType::Xor, bitPrefix + "d", q, carry), q, 0);
+                }
+                else if (kind.first == GateType::TFlipFlop)
+                {
+                    circuit.connect(carry, q, 0);
+                }
+                else if (kind.first == GateType::JKFlipFlop)
+                {
+                    circuit.connect(carry, q, 0);
+                    circuit.connect(carry, q, 1);
+                }
+                else
+                {
+                    // set while 0, reset while 1
+                    Circuit::NodeId low = circuit.addGate(GateType::Not, bitPrefix + "n", 1);
+                    circuit.connect(q, low, 0);
+                    circuit.connect(addGate2(circuit, GateType::And, bitPrefix + "s", carry, low), q, 0);
+                    circuit.connect(next, q, 1);
+                }
+                outputs.push_back(q);
+                carry = next;
+            }
+        }
+    }
+    for (Circuit::NodeId output : outputs)
+    {
+        circuit.markOutput(output);
+    }
+    circuit.freeze();
+    return circuit;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "Circuit.h"
+
+// Builds regular datapath netlists for benchmarks and tests of the engines.
+// Every generator returns a frozen Circuit with its sum/product bits marked as outputs.
+class CircuitGenerator
+{
+public:
+    // `instances` independent ripple-carry adders of `bits` bits each, with a carry-in per adder
+    // inputs: u<k>.a<j>, u<k>.b<j>, u<k>.cin   outputs: u<k>.s<j>, u<k>.cout
+    static Circuit adderArray(uint32_t instances, uint32_t bits);
+    // `instances` independent `bits` x `bits` array multipliers (AND partial products
+    // summed row by row with ripple-carry adders)
+    // inputs: u<k>.a<j>, u<k>.b<j>   outputs: 2 * bits product bits per multiplier
+    static Circuit multiplierArray(uint32_t instances, uint32_t bits);
+    // `instances` groups of four `bits`-bit synchronous counters, one built from each
+    // flip-flop kind (D, T, JK, SR), all counting up on every clock edge while en is 1
+    // inputs: u<k>.en   outputs: u<k>.<d|t|jk|sr>.q<j>, the count's bit j
+    static Circuit counterArray(uint32_t instances, uint32_t bits);
+
+private:
+    static Circuit::NodeId addGate2(Circuit &circuit, GateType type, const std::string &name, Circuit::NodeId a, Circuit::NodeId b);
+    // adds up to three bits (InvalidNode operands are skipped) with a buffer, half adder or full adder
+    static void addBits(Circuit &circuit, const std::string &name, Circuit::NodeId a, Circuit::NodeId b, Circuit::NodeId c,
+                        Circuit::NodeId &sum, Circuit::NodeId &carry);
+};
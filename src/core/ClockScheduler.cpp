@@ -0,0 +1,165 @@
+#include "ClockScheduler.h"
+#include <algorithm>
+#include <stdexcept>
+#include "GateFactory.h"
+
+ClockScheduler::ClockScheduler(const Circuit &circuit, const std::vector<ClockDefinition> &clocks)
+    : circuit(circuit), clocks(clocks), simulator(circuit, assignDomains(circuit, clocks), findEnables(circuit, clocks))
+{
+    for (const ClockDefinition &clock : clocks)
+    {
+        nextEdge.push_back(clock.phase);
+    }
+    gateCount = circuit.getNodeCount() - circuit.getInputCount() - simulator.getRegisterCount();
+}
+
+std::vector<uint32_t> ClockScheduler::assignDomains(const Circuit &circuit, const std::vector<ClockDefinition> &clocks)
+{
+    if (clocks.empty() || clocks.size() > SequentialSimulator::MaxDomains)
+    {
+        throw std::invalid_argument("ClockScheduler: between 1 and " + std::to_string(SequentialSimulator::MaxDomains) + " clocks are supported");
+    }
+    for (size_t i = 0; i < clocks.size(); i++)
+    {
+        if (clocks[i].period == 0)
+        {
+            throw std::invalid_argument("ClockScheduler: clock " + clocks[i].name + " has period 0");
+        }
+        for (size_t j = 0; j < i; j++)
+        {
+            if (clocks[j].name == clocks[i].name)
+            {
+                throw std::invalid_argument("ClockScheduler: clock " + clocks[i].name + " is defined twice");
+            }
+        }
+    }
+
+    // the longest matching prefix wins, so "cpu." and "cpu.fpu." can be different clocks
+    std::vector<uint32_t> domainOf(circuit.getNodeCount(), 0);
+    for (Circuit::NodeId node = 0; node < circuit.getNodeCount(); node++)
+    {
+        if (circuit.isInput(node) || !GateFactory::isSequential(circuit.getGateType(node)) || circuit.getGateType(node) == GateType::Latch)
+        {
+            continue;
+        }
+        std::string name = circuit.getName(node);
+        size_t best = clocks.size();
+        for (size_t i = 0; i < clocks.size(); i++)
+        {
+            const std::string &prefix = clocks[i].prefix;
+            if (name.compare(0, prefix.size(), prefix) == 0 && (best == clocks.size() || prefix.size() > clocks[best].prefix.size()))
+            {
+                best = i;
+            }
+        }
+        if (best == clocks.size())
+        {
+            throw std::invalid_argument("ClockScheduler: no clock drives flip-flop " + name);
+        }
+        domainOf[node] = static_cast<uint32_t>(best);
+    }
+    return domainOf;
+}
+
+std::vector<Circuit::NodeId> ClockScheduler::findEnables(const Circuit &circuit, const std::vector<ClockDefinition> &clocks)
+{
+    std::vector<Circuit::NodeId> enables;
+    for (const ClockDefinition &clock : clocks)
+    {
+        if (clock.enable.empty())
+        {
+            enables.push_back(Circuit::InvalidNode);
+            continue;
+        }
+        Circuit::NodeId node = circuit.findNode(clock.enable);
+        if (node == Circuit::InvalidNode)
+        {
+            throw std::invalid_argument("ClockScheduler: enable net " + clock.enable + " of clock " + clock.name + " not found");
+        }
+        enables.push_back(node);
+    }
+    return enables;
+}
+
+uint64_t ClockScheduler::step()
+{
+    uint64_t next = *std::min_element(nextEdge.begin(), nextEdge.end());
+    uint32_t domains = 0;
+    for (size_t i = 0; i < clocks.size(); i++)
+    {
+        if (nextEdge[i] == next)
+        {
+            domains |= 1u << i;
+            nextEdge[i] += clocks[i].period;
+        }
+    }
+    simulator.tick(domains);
+    time = next;
+    instants++;
+    return time;
+}
+
+uint64_t ClockScheduler::runUntil(uint64_t until)
+{
+    uint64_t taken = 0;
+    while (*std::min_element(nextEdge.begin(), nextEdge.end()) <= until)
+    {
+        step();
+        taken++;
+    }
+    time = std::max(time, until);
+    simulator.evaluate();
+    return taken;
+}
+
+void ClockScheduler::runEdges(uint64_t count)
+{
+    for (uint64_t i = 0; i < count; i++)
+    {
+        step();
+    }
+    simulator.evaluate();
+}
+
+void ClockScheduler::reset()
+{
+    simulator.reset();
+    for (size_t i = 0; i < clocks.size(); i++)
+    {
+        nextEdge[i] = clocks[i].phase;
+    }
+    time = 0;
+    instants = 0;
+}
+
+std::vector<std::pair<uint64_t, uint32_t>> ClockScheduler::getTimeline(size_t count) const
+{
+    std::vector<uint64_t> edges(nextEdge);
+    std::vector<std::pair<uint64_t, uint32_t>> timeline;
+    while (timeline.size() < count)
+    {
+        uint64_t next = *std::min_element(edges.begin(), edges.end());
+        uint32_t domains = 0;
+        for (size_t i = 0; i < clocks.size(); i++)
+        {
+            if (edges[i] == next)
+            {
+                domains |= 1u << i;
+                edges[i] += clocks[i].period;
+            }
+        }
+        timeline.emplace_back(next, domains);
+    }
+    return timeline;
+}
+
+std::vector<ClockScheduler::DomainReport> ClockScheduler::getReport() const
+{
+    std::vector<DomainReport> report;
+    for (uint32_t i = 0; i < clocks.size(); i++)
+    {
+        const SequentialSimulator::DomainStats &stats = simulator.getDomainStats(i);
+        report.push_back(DomainReport{clocks[i].name, stats, stats.gatedOff * stats.coneGates});
+    }
+    return report;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Circuit.h"
+#include "SequentialSimulator.h"
+
+// One clock of a multi-clock design: rising edges at phase, phase + period, phase + 2 * period, ...
+struct ClockDefinition
+{
+    std::string name;
+    uint64_t period = 1;
+    uint64_t phase = 0;
+    // net gating the clock, the domain skips its edges while it is 0; empty for a free-running clock
+    std::string enable;
+    // the flip-flops whose names start with this, empty for every flip-flop no other clock claims
+    std::string prefix;
+};
+
+// Runs a circuit with several clocks on one merged edge timeline. Each clock is a domain of
+// the SequentialSimulator, so an instant where only some clocks have an edge evaluates only
+// the logic feeding their flip-flops, and a gated clock whose enable is 0 skips its logic and
+// its commit altogether. Time is in abstract units; several clocks with an edge at the same
+// instant take it together, sampling the same pre-edge values.
+class ClockScheduler
+{
+public:
+    struct DomainReport
+    {
+        std::string name;
+        SequentialSimulator::DomainStats stats;
+        // gate evaluations saved by the gated-off edges, at most; logic shared with a
+        // domain that did take the edge was evaluated anyway
+        uint64_t skippedEvaluations;
+    };
+
+    // the circuit must be frozen and outlive the scheduler; throws std::invalid_argument for a
+    // bad or duplicate clock, an unknown enable net, or a flip-flop no clock claims
+    ClockScheduler(const Circuit &circuit, const std::vector<ClockDefinition> &clocks);
+
+    // advances to the next instant with any edge and takes it, returns that time; the outputs
+    // are settled lazily, by runUntil, runEdges or getSimulator().evaluate()
+    uint64_t step();
+    // every edge up to and including `until`, returns the number of instants taken
+    uint64_t runUntil(uint64_t until);
+    void runEdges(uint64_t instants);
+    // back to time 0 with the initial state, the inputs are kept
+    void reset();
+
+    // the next `count` instants as (time, mask of the clocks with an edge), without advancing
+    std::vector<std::pair<uint64_t, uint32_t>> getTimeline(size_t count) const;
+    uint64_t getTime() const { return time; }
+    uint64_t getInstants() const { return instants; }
+    const std::vector<ClockDefinition> &getClocks() const { return clocks; }
+    SequentialSimulator &getSimulator() { return simulator; }
+    const SequentialSimulator &getSimulator() const { return simulator; }
+
+    std::vector<DomainReport> getReport() const;
+    // what evaluating every gate at every instant would have cost
+    uint64_t getFullSweepEvaluations() const { return instants * gateCount; }
+
+private:
+    const Circuit &circuit;
+    std::vector<ClockDefinition> clocks;
+    SequentialSimulator simulator;
+    std::vector<uint64_t> nextEdge;
+    uint64_t time = 0;
+    uint64_t instants = 0;
+    uint64_t gateCount = 0;
+
+    static std::vector<uint32_t> assignDomains(const Circuit &circuit, const std::vector<ClockDefinition> &clocks);
+    static std::vector<Circuit::NodeId> findEnables(const Circuit &circuit, const std::vector<ClockDefinition> &clocks);
+};
@@ -0,0 +1,755 @@
+#include "Espresso.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include "GateKernels.h"
+
+namespace
+{
+    // low bit of every two-bit field
+    constexpr uint64_t LowBits = 0x5555555555555555ULL;
+
+    // thrown out of the recursion when a check runs past its node budget
+    struct BudgetExceeded
+    {
+    };
+
+    // no field of the intersection is 00
+    bool intersects(const uint64_t *a, const uint64_t *b, size_t words)
+    {
+        for (size_t w = 0; w < words; w++)
+        {
+            uint64_t both = a[w] & b[w];
+            if (((both | (both >> 1)) & LowBits) != LowBits)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool contains(const uint64_t *outer, const uint64_t *inner, size_t words)
+    {
+        for (size_t w = 0; w < words; w++)
+        {
+            if (inner[w] & ~outer[w])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool isUniversal(const uint64_t *cube, size_t words)
+    {
+        for (size_t w = 0; w < words; w++)
+        {
+            if (cube[w] != ~0ULL)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    double secondsSince(const std::chrono::steady_clock::time_point &start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+// cube list
+
+CubeList::CubeList(int numInputs, int numOutputs)
+    : numInputs(numInputs), numOutputs(numOutputs)
+{
+    if (numInputs < 0 || numOutputs < 0)
+    {
+        throw std::invalid_argument("Cube list needs non-negative input and output counts");
+    }
+    inputWords = (2 * static_cast<size_t>(numInputs) + 63) / 64;
+    outputWords = (static_cast<size_t>(numOutputs) + 63) / 64;
+    stride = inputWords + outputWords;
+    universe.assign(inputWords, ~0ULL);
+}
+
+size_t CubeList::addCube()
+{
+    data.resize(data.size() + stride, 0);
+    std::copy(universe.begin(), universe.end(), cube(count));
+    return count++;
+}
+
+size_t CubeList::addCube(const uint64_t *source)
+{
+    data.insert(data.end(), source, source + stride);
+    return count++;
+}
+
+void CubeList::removeLast()
+{
+    data.resize(data.size() - stride);
+    count--;
+}
+
+void CubeList::compact(const std::vector<char> &keep)
+{
+    size_t kept = 0;
+    for (size_t index = 0; index < count; index++)
+    {
+        if (keep[index])
+        {
+            if (kept != index)
+            {
+                std::copy(cube(index), cube(index) + stride, cube(kept));
+            }
+            kept++;
+        }
+    }
+    count = kept;
+    data.resize(count * stride);
+}
+
+void CubeList::clear()
+{
+    data.clear();
+    count = 0;
+}
+
+int CubeList::getInput(size_t index, int variable) const
+{
+    int field = (cube(index)[variable / 32] >> (2 * (variable % 32))) & 3;
+    return field == 3 ? 2 : field == 2 ? 1 : field == 1 ? 0 : -1;
+}
+
+void CubeList::setInput(size_t index, int variable, int value)
+{
+    uint64_t field = value == 0 ? 1 : value == 1 ? 2 : 3;
+    uint64_t &word = cube(index)[variable / 32];
+    int shift = 2 * (variable % 32);
+    word = (word & ~(3ULL << shift)) | (field << shift);
+}
+
+bool CubeList::hasOutput(size_t index, int output) const
+{
+    return (outputs(index)[output / 64] >> (output % 64)) & 1;
+}
+
+void CubeList::setOutput(size_t index, int output, bool value)
+{
+    uint64_t &word = outputs(index)[output / 64];
+    uint64_t bit = 1ULL << (output % 64);
+    word = value ? word | bit : word & ~bit;
+}
+
+int CubeList::literalCount(size_t index) const
+{
+    // 32 fields per word minus the don't-cares, padding fields are don't-cares
+    int literals = 0;
+    for (size_t w = 0; w < inputWords; w++)
+    {
+        uint64_t word = cube(index)[w];
+        literals += 32 - popcount(word & (word >> 1) & LowBits);
+    }
+    return literals;
+}
+
+size_t CubeList::literalCount() const
+{
+    size_t literals = 0;
+    for (size_t index = 0; index < count; index++)
+    {
+        literals += literalCount(index);
+    }
+    return literals;
+}
+
+// minimizer
+
+Espresso::Espresso(const CubeList &onSet, const CubeList &dontCares)
+    : original(onSet), dontCares(dontCares), cover(onSet)
+{
+    if (onSet.getNumInputs() != dontCares.getNumInputs() || onSet.getNumOutputs() != dontCares.getNumOutputs())
+    {
+        throw std::invalid_argument("On-set and don't-care covers have different shapes");
+    }
+    if (onSet.getNumInputs() == 0 || onSet.getNumOutputs() == 0)
+    {
+        throw std::invalid_argument("Cover needs at least one input and one output");
+    }
+}
+
+bool Espresso::isTautology(std::vector<uint64_t> &cubes, size_t count) const
+{
+    if (nodesLeft == 0)
+    {
+        throw BudgetExceeded();
+    }
+    nodesLeft--;
+
+    const size_t words = cover.getInputWords();
+    const int numInputs = cover.getNumInputs();
+    if (count == 0)
+    {
+        return false;
+    }
+
+    // a cube with no literals covers everything, and cubes that add up to less
+    // than the whole space cannot cover it
+    double volume = 0;
+    for (size_t c = 0; c < count; c++)
+    {
+        const uint64_t *cube = cubes.data() + c * words;
+        if (isUniversal(cube, words))
+        {
+            return true;
+        }
+        int literals = 0;
+        for (size_t w = 0; w < words; w++)
+        {
+            literals += 32 - popcount(cube[w] & (cube[w] >> 1) & LowBits);
+        }
+        volume += std::ldexp(1.0, -literals);
+    }
+    if (volume < 1.0)
+    {
+        return false;
+    }
+
+    // polarity counts per variable
+    std::vector<uint32_t> zeros(numInputs, 0);
+    std::vector<uint32_t> ones(numInputs, 0);
+    for (size_t c = 0; c < count; c++)
+    {
+        const uint64_t *cube = cubes.data() + c * words;
+        for (size_t w = 0; w < words; w++)
+        {
+            uint64_t zeroFields = cube[w] & ~(cube[w] >> 1) & LowBits;
+            uint64_t oneFields = (cube[w] >> 1) & ~cube[w] & LowBits;
+            while (zeroFields)
+            {
+                zeros[w * 32 + popcount((zeroFields & (~zeroFields + 1)) - 1) / 2]++;
+                zeroFields &= zeroFields - 1;
+            }
+            while (oneFields)
+            {
+                ones[w * 32 + popcount((oneFields & (~oneFields + 1)) - 1) / 2]++;
+                oneFields &= oneFields - 1;
+            }
+        }
+    }
+
+    // cubes using a unate variable can be dropped: the cofactor on its absent
+    // polarity keeps exactly the cubes that do not mention it
+    std::vector<uint64_t> unateFields(words, 0);
+    int split = -1;
+    uint32_t splitWeight = 0;
+    for (int v = 0; v < numInputs; v++)
+    {
+        if ((zeros[v] == 0) != (ones[v] == 0))
+        {
+            unateFields[v / 32] |= 3ULL << (2 * (v % 32));
+        }
+        else if (zeros[v] + ones[v] > splitWeight)
+        {
+            split = v;
+            splitWeight = zeros[v] + ones[v];
+        }
+    }
+    bool anyUnate = std::any_of(unateFields.begin(), unateFields.end(), [](uint64_t word)
+                                { return word != 0; });
+    if (anyUnate)
+    {
+        std::vector<uint64_t> kept;
+        size_t keptCount = 0;
+        for (size_t c = 0; c < count; c++)
+        {
+            const uint64_t *cube = cubes.data() + c * words;
+            bool mentions = false;
+            for (size_t w = 0; w < words && !mentions; w++)
+            {
+                mentions = (~cube[w] & unateFields[w]) != 0;
+            }
+            if (!mentions)
+            {
+                kept.insert(kept.end(), cube, cube + words);
+                keptCount++;
+            }
+        }
+        return isTautology(kept, keptCount);
+    }
+    if (split < 0)
+    {
+        return false;
+    }
+
+    // Shannon split on the most binate variable
+    size_t word = split / 32;
+    int shift = 2 * (split % 32);
+    for (uint64_t value : {1ULL, 2ULL})
+    {
+        std::vector<uint64_t> half;
+        size_t halfCount = 0;
+        for (size_t c = 0; c < count; c++)
+        {
+            const uint64_t *cube = cubes.data() + c * words;
+            if ((cube[word] >> shift) & value)
+            {
+                half.insert(half.end(), cube, cube + words);
+                half[halfCount * words + word] |= 3ULL << shift;
+                halfCount++;
+            }
+        }
+        if (!isTautology(half, halfCount))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Espresso::isCovered(const uint64_t *region, int output, const CubeList &cubes, size_t skip) const
+{
+    const size_t words = cover.getInputWords();
+    tautologyChecks++;
+
+    // cofactor every cube that can help against the region
+    std::vector<uint64_t> cofactors;
+    size_t count = 0;
+    for (const CubeList *list : {&cubes, &dontCares})
+    {
+        for (size_t c = 0; c < list->size(); c++)
+        {
+            if ((list == &cubes && c == skip) || !list->hasOutput(c, output) || !intersects(list->cube(c), region, words))
+            {
+                continue;
+            }
+            const uint64_t *cube = list->cube(c);
+            if (contains(cube, region, words))
+            {
+                return true;
+            }
+            for (size_t w = 0; w < words; w++)
+            {
+                cofactors.push_back(cube[w] | ~region[w]);
+            }
+            count++;
+        }
+    }
+
+    nodesLeft = tautologyBudget;
+    try
+    {
+        return isTautology(cofactors, count);
+    }
+    catch (const BudgetExceeded &)
+    {
+        inconclusiveChecks++;
+        return false;
+    }
+}
+
+bool Espresso::isCovered(const uint64_t *region, const uint64_t *outputs, const CubeList &cubes, size_t skip) const
+{
+    for (int output = 0; output < cover.getNumOutputs(); output++)
+    {
+        if (((outputs[output / 64] >> (output % 64)) & 1) && !isCovered(region, output, cubes, skip))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Espresso::removeContained()
+{
+    // drop cubes lying inside a single other cube, inputs and outputs alike
+    const size_t stride = cover.getStride();
+    std::vector<size_t> order(cover.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b)
+                     { return cover.literalCount(a) < cover.literalCount(b); });
+    std::vector<char> keep(cover.size(), 1);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        if (!keep[order[i]])
+        {
+            continue;
+        }
+        for (size_t j = i + 1; j < order.size(); j++)
+        {
+            if (keep[order[j]] && contains(cover.cube(order[i]), cover.cube(order[j]), stride))
+            {
+                keep[order[j]] = 0;
+            }
+        }
+    }
+    cover.compact(keep);
+}
+
+void Espresso::expand()
+{
+    const size_t inputWords = cover.getInputWords();
+    // biggest cubes first, they are the likeliest to swallow others
+    std::vector<size_t> order(cover.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b)
+                     { return cover.literalCount(a) < cover.literalCount(b); });
+
+    std::vector<uint64_t> half(inputWords);
+    for (size_t index : order)
+    {
+        uint64_t *cube = cover.cube(index);
+        // raise each literal whose missing half is already covered
+        for (int v = 0; v < cover.getNumInputs(); v++)
+        {
+            int value = cover.getInput(index, v);
+            if (value == 2)
+            {
+                continue;
+            }
+            std::copy(cube, cube + inputWords, half.begin());
+            int shift = 2 * (v % 32);
+            half[v / 32] = (half[v / 32] & ~(3ULL << shift)) | ((value == 0 ? 2ULL : 1ULL) << shift);
+            if (isCovered(half.data(), cover.outputs(index), cover, index))
+            {
+                cover.setInput(index, v, 2);
+            }
+        }
+        // then add every output the expanded input part already implies
+        for (int output = 0; output < cover.getNumOutputs(); output++)
+        {
+            if (!cover.hasOutput(index, output) && isCovered(cube, output, cover, index))
+            {
+                cover.setOutput(index, output, true);
+            }
+        }
+    }
+    removeContained();
+}
+
+void Espresso::irredundant()
+{
+    // smallest cubes first, they are the likeliest to be redundant
+    std::vector<size_t> order(cover.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b)
+                     { return cover.literalCount(a) > cover.literalCount(b); });
+
+    std::vector<char> keep(cover.size(), 1);
+    CubeList rest = cover;
+    for (size_t index : order)
+    {
+        // `rest` mirrors `keep`: removed cubes lose all their outputs
+        if (isCovered(rest.cube(index), rest.outputs(index), rest, index))
+        {
+            keep[index] = 0;
+            std::fill(rest.outputs(index), rest.outputs(index) + rest.getOutputWords(), 0);
+        }
+    }
+    cover.compact(keep);
+}
+
+void Espresso::reduce()
+{
+    const size_t inputWords = cover.getInputWords();
+    std::vector<size_t> order(cover.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b)
+                     { return cover.literalCount(a) < cover.literalCount(b); });
+
+    std::vector<char> keep(cover.size(), 1);
+    std::vector<uint64_t> half(inputWords);
+    for (size_t index : order)
+    {
+        uint64_t *cube = cover.cube(index);
+        // drop outputs the other cubes already provide
+        for (int output = 0; output < cover.getNumOutputs(); output++)
+        {
+            if (cover.hasOutput(index, output) && isCovered(cube, output, cover, index))
+            {
+                cover.setOutput(index, output, false);
+            }
+        }
+        bool anyOutput = false;
+        for (size_t w = 0; w < cover.getOutputWords(); w++)
+        {
+            anyOutput = anyOutput || cover.outputs(index)[w] != 0;
+        }
+        if (!anyOutput)
+        {
+            keep[index] = 0;
+            continue;
+        }
+        // shrink to one half of a don't-care when the other half is covered elsewhere
+        for (int v = 0; v < cover.getNumInputs(); v++)
+        {
+            if (cover.getInput(index, v) != 2)
+            {
+                continue;
+            }
+            for (int dropped : {1, 0})
+            {
+                std::copy(cube, cube + inputWords, half.begin());
+                int shift = 2 * (v % 32);
+                half[v / 32] = (half[v / 32] & ~(3ULL << shift)) | ((dropped == 0 ? 1ULL : 2ULL) << shift);
+                if (isCovered(half.data(), cover.outputs(index), cover, index))
+                {
+                    cover.setInput(index, v, 1 - dropped);
+                    break;
+                }
+            }
+        }
+    }
+    cover.compact(keep);
+}
+
+void Espresso::record(int iteration, const char *phase, double seconds)
+{
+    stats.push_back({iteration, phase, cover.size(), cover.literalCount(), seconds});
+}
+
+const CubeList &Espresso::minimize()
+{
+    cover = original;
+    stats.clear();
+    tautologyChecks = 0;
+    inconclusiveChecks = 0;
+    record(0, "initial", 0);
+
+    auto timed = [this](int iteration, const char *phase, void (Espresso::*step)())
+    {
+        auto start = std::chrono::steady_clock::now();
+        (this->*step)();
+        record(iteration, phase, secondsSince(start));
+    };
+
+    timed(0, "expand", &Espresso::expand);
+    timed(0, "irredundant", &Espresso::irredundant);
+    for (int iteration = 1; iteration <= maxIterations; iteration++)
+    {
+        CubeList previous = cover;
+        timed(iteration, "reduce", &Espresso::reduce);
+        timed(iteration, "expand", &Espresso::expand);
+        timed(iteration, "irredundant", &Espresso::irredundant);
+        // stop once neither the cube count nor the literal count improves
+        if (cover.size() > previous.size() || (cover.size() == previous.size() && cover.literalCount() >= previous.literalCount()))
+        {
+            if (cover.size() > previous.size() || cover.literalCount() > previous.literalCount())
+            {
+                cover = previous;
+            }
+            break;
+        }
+    }
+    return cover;
+}
+
+bool Espresso::verify() const
+{
+    // every new cube lies in on-set plus don't-cares, and every original cube is still covered
+    for (size_t c = 0; c < cover.size(); c++)
+    {
+        if (!isCovered(cover.cube(c), cover.outputs(c), original, original.size()))
+        {
+            return false;
+        }
+    }
+    for (size_t c = 0; c < original.size(); c++)
+    {
+        if (!isCovered(original.cube(c), original.outputs(c), cover, cover.size()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// PLA files
+
+void Espresso::readPla(const std::string &path, CubeList &onSet, CubeList &dontCares)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        throw std::runtime_error("Cannot open PLA file: " + path);
+    }
+
+    int numInputs = -1;
+    int numOutputs = -1;
+    std::vector<std::string> inputNames;
+    std::vector<std::string> outputNames;
+    std::string type = "fd";
+    bool started = false;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream tokens(line);
+        std::string first;
+        if (!(tokens >> first))
+        {
+            continue;
+        }
+        if (first[0] == '.')
+        {
+            if (first == ".i")
+                tokens >> numInputs;
+            else if (first == ".o")
+                tokens >> numOutputs;
+            else if (first == ".ilb")
+                for (std::string name; tokens >> name;)
+                    inputNames.push_back(name);
+            else if (first == ".ob")
+                for (std::string name; tokens >> name;)
+                    outputNames.push_back(name);
+            else if (first == ".type")
+                tokens >> type;
+            else if (first == ".e" || first == ".end")
+                break;
+            // .p and other directives carry nothing we need
+            continue;
+        }
+
+        if (!started)
+        {
+            if (numInputs <= 0 || numOutputs <= 0)
+            {
+                throw std::runtime_error("PLA file needs .i and .o before the first cube");
+            }
+            if (type != "f" && type != "fd")
+            {
+                throw std::runtime_error("Unsupported PLA type: " + type);
+            }
+            onSet = CubeList(numInputs, numOutputs);
+            dontCares = CubeList(numInputs, numOutputs);
+            started = true;
+        }
+
+        // the cube may be split by spaces or '|', so read the characters in order
+        std::string text;
+        for (char symbol : line)
+        {
+            if (!std::isspace(static_cast<unsigned char>(symbol)) && symbol != '|')
+            {
+                text += symbol;
+            }
+        }
+        if (text.size() != static_cast<size_t>(numInputs + numOutputs))
+        {
+            throw std::runtime_error("PLA line " + std::to_string(lineNumber) + ": expected " +
+                                     std::to_string(numInputs + numOutputs) + " symbols");
+        }
+
+        size_t on = onSet.addCube();
+        for (int v = 0; v < numInputs; v++)
+        {
+            char symbol = text[v];
+            if (symbol != '0' && symbol != '1' && symbol != '-' && symbol != '2')
+            {
+                throw std::runtime_error("PLA line " + std::to_string(lineNumber) + ": bad input symbol '" + symbol + "'");
+            }
+            onSet.setInput(on, v, symbol == '0' ? 0 : symbol == '1' ? 1 : 2);
+        }
+        size_t dc = dontCares.addCube(onSet.cube(on));
+        bool anyOn = false;
+        bool anyDc = false;
+        for (int output = 0; output < numOutputs; output++)
+        {
+            char symbol = text[numInputs + output];
+            if (symbol == '1' || symbol == '4')
+            {
+                onSet.setOutput(on, output, true);
+                anyOn = true;
+            }
+            else if (symbol == '-' || symbol == '2')
+            {
+                dontCares.setOutput(dc, output, true);
+                anyDc = true;
+            }
+            else if (symbol != '0' && symbol != '3' && symbol != '~')
+            {
+                throw std::runtime_error("PLA line " + std::to_string(lineNumber) + ": bad output symbol '" + symbol + "'");
+            }
+        }
+        // drop the halves that ended up with no outputs
+        if (!anyOn)
+        {
+            onSet.removeLast();
+        }
+        if (!anyDc)
+        {
+            dontCares.removeLast();
+        }
+    }
+
+    if (!started)
+    {
+        if (numInputs <= 0 || numOutputs <= 0)
+        {
+            throw std::runtime_error("PLA file needs .i and .o");
+        }
+        onSet = CubeList(numInputs, numOutputs);
+        dontCares = CubeList(numInputs, numOutputs);
+    }
+    if (inputNames.size() == static_cast<size_t>(numInputs))
+    {
+        onSet.inputNames = inputNames;
+    }
+    if (outputNames.size() == static_cast<size_t>(numOutputs))
+    {
+        onSet.outputNames = outputNames;
+    }
+}
+
+void Espresso::writePla(const std::string &path, const CubeList &cubes)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        throw std::runtime_error("Cannot write PLA file: " + path);
+    }
+    file << ".i " << cubes.getNumInputs() << "\n";
+    file << ".o " << cubes.getNumOutputs() << "\n";
+    if (!cubes.inputNames.empty())
+    {
+        file << ".ilb";
+        for (const std::string &name : cubes.inputNames)
+        {
+            file << " " << name;
+        }
+        file << "\n";
+    }
+    if (!cubes.outputNames.empty())
+    {
+        file << ".ob";
+        for (const std::string &name : cubes.outputNames)
+        {
+            file << " " << name;
+        }
+        file << "\n";
+    }
+    file << ".p " << cubes.size() << "\n";
+    std::string text(cubes.getNumInputs() + 1 + cubes.getNumOutputs(), ' ');
+    for (size_t c = 0; c < cubes.size(); c++)
+    {
+        for (int v = 0; v < cubes.getNumInputs(); v++)
+        {
+            int value = cubes.getInput(c, v);
+            text[v] = value == 0 ? '0' : value == 1 ? '1' : '-';
+        }
+        for (int output = 0; output < cubes.getNumOutputs(); output++)
+        {
+            text[cubes.getNumInputs() + 1 + output] = cubes.hasOutput(c, output) ? '1' : '0';
+        }
+        file << text << "\n";
+    }
+    file << ".e\n";
+}
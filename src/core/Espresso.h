@@ -0,0 +1,124 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Multiple-output cubes in positional notation, packed back to back in one array.
+// Input variable v takes two bits of the input part: bit 2v allows 0, bit 2v + 1 allows 1,
+// so 01 is the literal v', 10 is v and 11 is a don't-care. The output part holds one bit
+// per output. Unused fields at the end of the input part are kept at 11.
+class CubeList
+{
+public:
+    CubeList(int numInputs = 0, int numOutputs = 0);
+
+    int getNumInputs() const { return numInputs; }
+    int getNumOutputs() const { return numOutputs; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t getInputWords() const { return inputWords; }
+    size_t getOutputWords() const { return outputWords; }
+    size_t getStride() const { return stride; }
+
+    uint64_t *cube(size_t index) { return data.data() + index * stride; }
+    const uint64_t *cube(size_t index) const { return data.data() + index * stride; }
+    uint64_t *outputs(size_t index) { return cube(index) + inputWords; }
+    const uint64_t *outputs(size_t index) const { return cube(index) + inputWords; }
+
+    // appends a cube with every input a don't-care and no outputs, returns its index
+    size_t addCube();
+    size_t addCube(const uint64_t *source);
+    void removeLast();
+    // keeps the cubes whose keep flag is set, in order
+    void compact(const std::vector<char> &keep);
+    void clear();
+
+    // 0, 1 or 2 for a don't-care
+    int getInput(size_t index, int variable) const;
+    void setInput(size_t index, int variable, int value);
+    bool hasOutput(size_t index, int output) const;
+    void setOutput(size_t index, int output, bool value);
+    // specified input literals of one cube and of the whole list
+    int literalCount(size_t index) const;
+    size_t literalCount() const;
+
+    size_t getMemoryUsage() const { return data.capacity() * sizeof(uint64_t); }
+
+    std::vector<std::string> inputNames;
+    std::vector<std::string> outputNames;
+
+private:
+    int numInputs;
+    int numOutputs;
+    size_t inputWords;
+    size_t outputWords;
+    size_t stride;
+    size_t count = 0;
+    std::vector<uint64_t> data;
+    // input part of a fresh cube: all don't-cares
+    std::vector<uint64_t> universe;
+};
+
+// Heuristic two-level minimizer in the style of Espresso: EXPAND, IRREDUNDANT and REDUCE
+// repeat on the packed cube list until the cost (cubes, then literals) stops improving.
+// Every step is checked with cube-containment tests, each of which is a tautology check of
+// a cofactor done by unate recursion. Nothing needs the off-set, so functions with 30 to
+// 60 inputs stay in the size of their covers. A tautology check that runs past its node
+// budget counts as "not contained": the step is skipped, and the cover stays correct.
+class Espresso
+{
+public:
+    struct IterationStats
+    {
+        int iteration;
+        std::string phase;
+        size_t cubes;
+        size_t literals;
+        double seconds;
+    };
+
+    // the on-set and don't-care covers must have the same shape
+    Espresso(const CubeList &onSet, const CubeList &dontCares);
+
+    void setMaxIterations(int iterations) { maxIterations = iterations; }
+    void setTautologyBudget(uint64_t nodes) { tautologyBudget = nodes; }
+
+    const CubeList &minimize();
+    const CubeList &getCover() const { return cover; }
+    const std::vector<IterationStats> &getStats() const { return stats; }
+    uint64_t getTautologyChecks() const { return tautologyChecks; }
+    uint64_t getInconclusiveChecks() const { return inconclusiveChecks; }
+
+    // true if the cover and the original on-set agree outside the don't-cares,
+    // checked by containment in both directions
+    bool verify() const;
+
+    // Berkeley PLA: .i/.o/.ilb/.ob/.p/.type/.e, types f and fd
+    // output '1' puts the cube in the on-set, '-' or '2' in the don't-care set
+    static void readPla(const std::string &path, CubeList &onSet, CubeList &dontCares);
+    static void writePla(const std::string &path, const CubeList &cubes);
+
+private:
+    CubeList original;
+    CubeList dontCares;
+    CubeList cover;
+    std::vector<IterationStats> stats;
+    int maxIterations = 20;
+    uint64_t tautologyBudget = 100000;
+    mutable uint64_t tautologyChecks = 0;
+    mutable uint64_t inconclusiveChecks = 0;
+    mutable uint64_t nodesLeft = 0;
+
+    void expand();
+    void irredundant();
+    void reduce();
+    void removeContained();
+    void record(int iteration, const char *phase, double seconds);
+
+    // input part `region` for output `output` lies inside `cubes` (minus cube `skip`) plus the don't-cares
+    bool isCovered(const uint64_t *region, int output, const CubeList &cubes, size_t skip) const;
+    // same for every output set in `outputs`
+    bool isCovered(const uint64_t *region, const uint64_t *outputs, const CubeList &cubes, size_t skip) const;
+    bool isTautology(std::vector<uint64_t> &cubes, size_t count) const;
+};
@@ -0,0 +1,284 @@
+#include "EventSimulator.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+EventSimulator::EventSimulator(const Circuit &circuit, DelayModel model)
+    : circuit(circuit), model(model), level0(Level0Slots), level1(Level1Slots)
+{
+    if (!circuit.isFrozen())
+    {
+        throw std::logic_error("EventSimulator: circuit must be frozen first");
+    }
+    if (circuit.hasStateElements())
+    {
+        throw std::invalid_argument("EventSimulator: circuit has flip-flops or latches, use SequentialSimulator");
+    }
+    const uint32_t numNodes = circuit.getNodeCount();
+    values.assign((numNodes + 63) / 64, 0);
+    projected.assign(values.size(), 0);
+    generations.assign(numNodes, 0);
+    evaluatedAt.assign(numNodes, 0);
+}
+
+void EventSimulator::setBit(std::vector<uint64_t> &bits, Circuit::NodeId node, bool value)
+{
+    if (value)
+    {
+        bits[node >> 6] |= 1ULL << (node & 63);
+    }
+    else
+    {
+        bits[node >> 6] &= ~(1ULL << (node & 63));
+    }
+}
+
+void EventSimulator::initialize()
+{
+    // start from the circuit's input values with every gate output at 0,
+    // then let one full evaluation settle whatever that leaves inconsistent
+    std::fill(values.begin(), values.end(), 0);
+    for (Circuit::NodeId input : circuit.getInputs())
+    {
+        setBit(values, input, circuit.getValue(input));
+    }
+    projected = values;
+    for (Circuit::NodeId node = 0; node < circuit.getNodeCount(); node++)
+    {
+        if (!circuit.isInput(node))
+        {
+            stats.gateEvaluations++;
+            scheduleOutput(node, evaluateGate(node), now + circuit.getDelay(node));
+        }
+    }
+    runUntilStable();
+}
+
+void EventSimulator::setInput(uint32_t inputIndex, bool value)
+{
+    if (inputIndex >= circuit.getInputCount())
+    {
+        throw std::out_of_range("EventSimulator: input index out of range");
+    }
+    Circuit::NodeId node = circuit.getInputs()[inputIndex];
+    if (getBit(projected, node) == value)
+    {
+        return;
+    }
+    setBit(projected, node, value);
+    schedule(Event{now, node, generations[node], value});
+}
+
+void EventSimulator::schedule(const Event &event)
+{
+    if (event.time / Level0Span == now / Level0Span)
+    {
+        level0[event.time % Level0Slots].push_back(event);
+        level0Pending++;
+    }
+    else if (event.time / Level1Span == now / Level1Span)
+    {
+        level1[(event.time / Level0Span) % Level1Slots].push_back(event);
+        level1Pending++;
+    }
+    else
+    {
+        overflow.push_back(event);
+    }
+}
+
+void EventSimulator::scheduleOutput(Circuit::NodeId gate, bool value, uint64_t time)
+{
+    if (getBit(projected, gate) == value)
+    {
+        // already heading there
+        return;
+    }
+    if (model == DelayModel::Inertial)
+    {
+        // the new change supersedes whatever is still pending for this gate
+        generations[gate]++;
+        if (getBit(values, gate) == value)
+        {
+            // the pending pulse was shorter than the delay and is swallowed
+            setBit(projected, gate, value);
+            return;
+        }
+    }
+    setBit(projected, gate, value);
+    schedule(Event{time, gate, generations[gate], value});
+}
+
+bool EventSimulator::evaluateGate(Circuit::NodeId gate) const
+{
+    const Circuit::NodeId *fanin = circuit.getFanin(gate);
+    const uint32_t count = circuit.getFaninCount(gate);
+    bool acc = getBit(values, fanin[0]);
+    // tri-states and resolved nets in their two-valued reading, see GateKernels.h
+    switch (circuit.getGateType(gate))
+    {
+    case GateType::And:
+    case GateType::Nand:
+    case GateType::TriState:
+    case GateType::TransmissionGate:
+    case GateType::WiredAnd:
+        for (uint32_t i = 1; i < count && acc; i++)
+            acc = getBit(values, fanin[i]);
+        return circuit.getGateType(gate) == GateType::Nand ? !acc : acc;
+    case GateType::Or:
+    case GateType::Nor:
+    case GateType::WiredOr:
+    case GateType::Bus:
+        for (uint32_t i = 1; i < count && !acc; i++)
+            acc = getBit(values, fanin[i]);
+        return circuit.getGateType(gate) == GateType::Nor ? !acc : acc;
+    case GateType::Xor:
+    case GateType::Xnor:
+        for (uint32_t i = 1; i < count; i++)
+            acc ^= getBit(values, fanin[i]);
+        return circuit.getGateType(gate) == GateType::Xor ? acc : !acc;
+    case GateType::Not:
+        return !acc;
+    default:
+        return acc;
+    }
+}
+
+void EventSimulator::processTick()
+{
+    std::vector<Event> &slot = level0[now % Level0Slots];
+    uint32_t deltaCycles = 0;
+    // zero-delay gates schedule into this same slot, so loop until it stays empty
+    while (!slot.empty())
+    {
+        if (++deltaCycles > MaxDeltaCycles)
+        {
+            throw std::runtime_error("EventSimulator: zero-delay loop does not settle");
+        }
+        current.swap(slot);
+        level0Pending -= current.size();
+        dirtyGates.clear();
+
+        // apply every change of this delta cycle first, so a gate sees all of its new inputs together
+        for (const Event &event : current)
+        {
+            if (event.generation != generations[event.node])
+            {
+                stats.eventsCancelled++;
+                continue;
+            }
+            stats.eventsProcessed++;
+            if (getBit(values, event.node) == event.value)
+            {
+                continue;
+            }
+            setBit(values, event.node, event.value);
+            const Circuit::NodeId *fanout = circuit.getFanout(event.node);
+            for (uint32_t i = 0; i < circuit.getFanoutCount(event.node); i++)
+            {
+                Circuit::NodeId sink = fanout[i];
+                uint64_t stamp = (now << 20 | deltaCycles) + 1;
+                if (evaluatedAt[sink] != stamp)
+                {
+                    evaluatedAt[sink] = stamp;
+                    dirtyGates.push_back(sink);
+                }
+            }
+        }
+        current.clear();
+
+        for (Circuit::NodeId gate : dirtyGates)
+        {
+            stats.gateEvaluations++;
+            scheduleOutput(gate, evaluateGate(gate), now + circuit.getDelay(gate));
+        }
+    }
+}
+
+void EventSimulator::cascade()
+{
+    // now sits on the first tick of a new level-0 block, pull that block's events down
+    std::vector<Event> block;
+    block.swap(level1[(now / Level0Span) % Level1Slots]);
+    level1Pending -= block.size();
+    for (const Event &event : block)
+    {
+        schedule(event);
+    }
+}
+
+void EventSimulator::advanceTo(uint64_t time)
+{
+    // jumps to the first tick of the overflow block holding `time` and pulls in everything in that level-1 block
+    now = time / Level0Span * Level0Span;
+    std::vector<Event> later;
+    std::vector<Event> pending;
+    pending.swap(overflow);
+    for (const Event &event : pending)
+    {
+        if (event.time / Level1Span == now / Level1Span)
+        {
+            schedule(event);
+        }
+        else
+        {
+            later.push_back(event);
+        }
+    }
+    overflow.swap(later);
+}
+
+uint64_t EventSimulator::runUntilStable()
+{
+    const uint64_t start = now;
+    while (level0Pending + level1Pending + overflow.size() > 0)
+    {
+        processTick();
+        if (level0Pending > 0)
+        {
+            // level 0 only holds ticks of the current block, so this never crosses a block boundary
+            now++;
+        }
+        else if (level1Pending > 0)
+        {
+            // level 1 only holds blocks of the current level-1 span, so this stays inside it
+            now = (now / Level0Span + 1) * Level0Span;
+            cascade();
+        }
+        else if (!overflow.empty())
+        {
+            auto earliest = std::min_element(overflow.begin(), overflow.end(), [](const Event &a, const Event &b)
+                                             { return a.time < b.time; });
+            advanceTo(earliest->time);
+        }
+    }
+    return now - start;
+}
+
+EventSimulator::Stats EventSimulator::run(uint64_t vectors, uint32_t togglesPerVector, uint64_t seed)
+{
+    if (circuit.getInputCount() == 0)
+    {
+        throw std::runtime_error("EventSimulator: circuit has no primary inputs");
+    }
+    initialize();
+    resetStats();
+
+    uint64_t state = seed ? seed : 1;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t v = 0; v < vectors; v++)
+    {
+        for (uint32_t t = 0; t < togglesPerVector; t++)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            uint32_t input = static_cast<uint32_t>(state % circuit.getInputCount());
+            setInput(input, !getBit(projected, circuit.getInputs()[input]));
+        }
+        runUntilStable();
+        stats.vectors++;
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Circuit.h"
+
+// Event-driven simulation over a frozen Circuit. Only the fan-out of signals that actually
+// changed is re-evaluated, and each gate's output change is scheduled its Circuit::getDelay()
+// ticks later on a two-level hierarchical timing wheel:
+//  - level 0: 256 one-tick slots for the current 256-tick block
+//  - level 1: 64 slots of 256 ticks for the current 16384-tick block
+//  - overflow list for anything further out, cascaded in when its block comes up
+// Unlike the levelized engine this one also accepts feedback loops, as long as they have delay.
+class EventSimulator
+{
+public:
+    enum class DelayModel
+    {
+        Transport, // every output change propagates, however short the pulse
+        Inertial   // a new output change cancels pending ones, pulses shorter than the delay are swallowed
+    };
+
+    struct Stats
+    {
+        uint64_t vectors = 0;         // input vectors applied
+        uint64_t eventsProcessed = 0; // scheduled changes that reached their time slot
+        uint64_t eventsCancelled = 0; // dropped by inertial pulse rejection
+        uint64_t gateEvaluations = 0;
+        double seconds = 0;
+        double eventsPerSecond() const { return seconds > 0 ? eventsProcessed / seconds : 0; }
+        // fraction of the gates a full sweep would evaluate that were actually evaluated
+        double activityFactor(uint32_t gateCount) const
+        {
+            return vectors && gateCount ? static_cast<double>(gateEvaluations) / (static_cast<double>(vectors) * gateCount) : 0;
+        }
+    };
+
+    // the circuit must be frozen and must outlive the simulator
+    EventSimulator(const Circuit &circuit, DelayModel model = DelayModel::Inertial);
+
+    // evaluates every gate once from the current input values and runs until stable
+    void initialize();
+    // schedules an input change at the current time
+    void setInput(uint32_t inputIndex, bool value);
+    // processes events until none are pending, returns the number of ticks advanced
+    uint64_t runUntilStable();
+
+    bool getValue(Circuit::NodeId node) const { return (values[node >> 6] >> (node & 63)) & 1; }
+    uint64_t getTime() const { return now; }
+    const Stats &getStats() const { return stats; }
+    void resetStats() { stats = Stats(); }
+
+    // applies `vectors` random input vectors, flipping `togglesPerVector` inputs each time,
+    // and lets the circuit settle after each one
+    Stats run(uint64_t vectors, uint32_t togglesPerVector, uint64_t seed = 1);
+
+private:
+    struct Event
+    {
+        uint64_t time;
+        Circuit::NodeId node;
+        uint32_t generation; // must match the node's generation, otherwise it was cancelled
+        bool value;
+    };
+
+    static constexpr uint64_t Level0Slots = 256;
+    static constexpr uint64_t Level1Slots = 64;
+    static constexpr uint64_t Level0Span = Level0Slots;
+    static constexpr uint64_t Level1Span = Level0Span * Level1Slots;
+    // zero-delay feedback would otherwise spin forever inside one tick
+    static constexpr uint32_t MaxDeltaCycles = 100000;
+
+    const Circuit &circuit;
+    DelayModel model;
+    uint64_t now = 0;
+
+    std::vector<uint64_t> values;    // one bit per node, current value
+    std::vector<uint64_t> projected; // one bit per node, value after all pending events
+    std::vector<uint32_t> generations;
+    std::vector<uint64_t> evaluatedAt; // tick + 1 of the last evaluation, dedupes gates within a tick
+
+    std::vector<std::vector<Event>> level0;
+    std::vector<std::vector<Event>> level1;
+    std::vector<Event> overflow;
+    uint64_t level0Pending = 0;
+    uint64_t level1Pending = 0;
+    std::vector<Event> current;
+    std::vector<Circuit::NodeId> dirtyGates;
+
+    Stats stats;
+
+    void schedule(const Event &event);
+    void scheduleOutput(Circuit::NodeId gate, bool value, uint64_t time);
+    void processTick();
+    void advanceTo(uint64_t time);
+    void cascade();
+    bool evaluateGate(Circuit::NodeId gate) const;
+    static bool getBit(const std::vector<uint64_t> &bits, Circuit::NodeId node) { return (bits[node >> 6] >> (node & 63)) & 1; }
+    static void setBit(std::vector<uint64_t> &bits, Circuit::NodeId node, bool value);
+};
@@ -3,9 +3,11 @@
 
 int Gate::nextId = 0;
 
-Gate::Gate(GateType type, const std::string &gateLabel)
-    : type(type), label(gateLabel.empty() ? "Gate" + std::to_string(nextId) : gateLabel), outputSignal(false)
+Gate::Gate(GateType type, const std::string &gateLabel, std::pmr::memory_resource *resource)
+    : inputSignals(resource), outputSignal(false), label(resource), type(type), delay(1)
 {
+    std::string text = gateLabel.empty() ? "Gate" + std::to_string(nextId) : gateLabel;
+    label.assign(text.data(), text.size());
     // inputSignals.resize(2, false);
     id = nextId++;
 }
@@ -47,7 +49,7 @@ int Gate::getId() const
 
 std::string Gate::getLabel() const
 {
-    return label;
+    return std::string(label);
 }
 
 GateType Gate::getType() const
@@ -55,6 +57,20 @@ GateType Gate::getType() const
     return type;
 }
 
+int Gate::getDelay() const
+{
+    return delay;
+}
+
+void Gate::setDelay(int ticks)
+{
+    if (ticks < 0)
+    {
+        throw std::invalid_argument("Delay cannot be negative");
+    }
+    delay = ticks;
+}
+
 void Gate::reset()
 {
     // reset output value
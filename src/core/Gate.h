@@ -1,6 +1,8 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <memory_resource>
 // gatetype enum
 enum class GateType
 {
@@ -12,31 +14,75 @@ enum class GateType
     Xor,
     Xnor,
     Buffer,
-    FlipFlop,
-    Latch
+    // state elements, clocked by SequentialSimulator
+    FlipFlop,   // D flip-flop, pins: d
+    Latch,      // level-sensitive D latch, pins: d, enable
+    JKFlipFlop, // pins: j, k
+    TFlipFlop,  // pins: t
+    SRFlipFlop, // pins: s, r, both high sets
+    // drivers that can release their output (Z), and the resolved nets they share
+    TriState,         // pins: data, enable; drives data while enable is 1
+    TransmissionGate, // pins: data, control; passes data, Z included, while control is 1
+    WiredAnd,         // one pin per driver, a 0 wins
+    WiredOr,          // one pin per driver, a 1 wins
+    Bus               // one pin per driver, disagreeing drivers give X
+};
+
+// four-valued signal: known 0 and 1, unknown (X) and undriven (Z)
+enum class Logic : uint8_t
+{
+    Zero,
+    One,
+    X,
+    Z
+};
+
+// 64 lanes of four-valued logic in two bit-planes. A lane whose unknown bit is clear is the
+// 0 or 1 in `value`; one whose unknown bit is set is X if its value bit is 0 and Z if it is 1
+struct LogicWord
+{
+    uint64_t value;
+    uint64_t unknown;
+};
+
+// the compiled engines run two-valued unless switched, and then pay nothing for X and Z
+enum class LogicMode
+{
+    TwoValued,
+    FourValued
 };
 
 class Gate
 {
     // define protected members
 protected:
-    // input signals
-    std::vector<bool> inputSignals;
+    // input signals, allocated from the owner's memory resource
+    std::pmr::vector<bool> inputSignals;
     // output signal
     bool outputSignal;
     // add label and id management
     static int nextId;
-    std::string label;
+    std::pmr::string label;
     int id;
     GateType type;
+    // propagation delay in simulation ticks, used by the event-driven engine
+    int delay;
 
 public:
     // constructor with proper initialization
-    Gate(GateType type, const std::string &gateLabel = "");
+    // pin storage and label come from `resource`, by default plain new/delete
+    Gate(GateType type, const std::string &gateLabel = "", std::pmr::memory_resource *resource = std::pmr::get_default_resource());
     // destructor
     virtual ~Gate() = default;
     // pure virtual evaluate method
     virtual void evaluate() = 0;
+    // packed evaluate method: one word per input, bit i of every word is stimulus pattern i
+    // returns the 64 output lanes without touching the stored input/output signals
+    virtual uint64_t evaluateWord(const std::vector<uint64_t> &inputWords) const = 0;
+    // same for four-valued lanes: Z inputs read as X, and an output lane is X only where
+    // the unknown inputs could change it. Tri-state drivers and resolved nets (see BusGates.h)
+    // are the exception, they drive and combine Z
+    virtual LogicWord evaluateLogicWord(const std::vector<LogicWord> &inputWords) const = 0;
     // input access maanagement methods
     // setinput
     void setInput(int index, bool value);
@@ -50,6 +96,8 @@ public:
     int getId() const;
     std::string getLabel() const;
     GateType getType() const;
+    int getDelay() const;
+    void setDelay(int ticks);
 
     // utility methods
     // reset
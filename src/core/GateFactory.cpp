@@ -39,15 +39,101 @@ std::shared_ptr<Gate> GateFactory::createGate(GateType type, const std::string &
     {
         return std::make_shared<BufferGate>(gateLabel);
     }
+    else if (type == GateType::FlipFlop)
+    {
+        return std::make_shared<DFlipFlop>(gateLabel);
+    }
+    else if (type == GateType::JKFlipFlop)
+    {
+        return std::make_shared<JKFlipFlop>(gateLabel);
+    }
+    else if (type == GateType::TFlipFlop)
+    {
+        return std::make_shared<TFlipFlop>(gateLabel);
+    }
+    else if (type == GateType::SRFlipFlop)
+    {
+        return std::make_shared<SRFlipFlop>(gateLabel);
+    }
+    else if (type == GateType::Latch)
+    {
+        return std::make_shared<DLatch>(gateLabel);
+    }
+    else if (type == GateType::TriState)
+    {
+        return std::make_shared<TriStateBuffer>(gateLabel);
+    }
+    else if (type == GateType::TransmissionGate)
+    {
+        return std::make_shared<TransmissionGate>(gateLabel);
+    }
+    else if (type == GateType::WiredAnd)
+    {
+        return std::make_shared<WiredAndNet>(gateLabel);
+    }
+    else if (type == GateType::WiredOr)
+    {
+        return std::make_shared<WiredOrNet>(gateLabel);
+    }
+    else if (type == GateType::Bus)
+    {
+        return std::make_shared<ResolvedBus>(gateLabel);
+    }
     else
     {
         throw std::invalid_argument("Invalid gate type");
     }
 }
 
+GateHandle GateFactory::createGate(GatePool &pool, GateType type, const std::string &gateLabel)
+{
+    switch (type)
+    {
+    case GateType::And:
+        return pool.emplace<ANDGate>(gateLabel);
+    case GateType::Or:
+        return pool.emplace<ORGate>(gateLabel);
+    case GateType::Not:
+        return pool.emplace<NOTGate>(gateLabel);
+    case GateType::Nor:
+        return pool.emplace<NORGate>(gateLabel);
+    case GateType::Nand:
+        return pool.emplace<NANDGate>(gateLabel);
+    case GateType::Xor:
+        return pool.emplace<XORGate>(gateLabel);
+    case GateType::Xnor:
+        return pool.emplace<XNORGate>(gateLabel);
+    case GateType::Buffer:
+        return pool.emplace<BufferGate>(gateLabel);
+    case GateType::FlipFlop:
+        return pool.emplace<DFlipFlop>(gateLabel);
+    case GateType::JKFlipFlop:
+        return pool.emplace<JKFlipFlop>(gateLabel);
+    case GateType::TFlipFlop:
+        return pool.emplace<TFlipFlop>(gateLabel);
+    case GateType::SRFlipFlop:
+        return pool.emplace<SRFlipFlop>(gateLabel);
+    case GateType::Latch:
+        return pool.emplace<DLatch>(gateLabel);
+    case GateType::TriState:
+        return pool.emplace<TriStateBuffer>(gateLabel);
+    case GateType::TransmissionGate:
+        return pool.emplace<TransmissionGate>(gateLabel);
+    case GateType::WiredAnd:
+        return pool.emplace<WiredAndNet>(gateLabel);
+    case GateType::WiredOr:
+        return pool.emplace<WiredOrNet>(gateLabel);
+    case GateType::Bus:
+        return pool.emplace<ResolvedBus>(gateLabel);
+    default:
+        throw std::invalid_argument("Invalid gate type");
+    }
+}
+
 bool GateFactory::isValidGateType(GateType type)
 {
-    if (type == GateType::And || type == GateType::Or || type == GateType::Not || type == GateType::Nor || type == GateType::Nand || type == GateType::Xor || type == GateType::Xnor || type == GateType::Buffer)
+    if (type == GateType::And || type == GateType::Or || type == GateType::Not || type == GateType::Nor || type == GateType::Nand || type == GateType::Xor || type == GateType::Xnor || type == GateType::Buffer ||
+        isSequential(type) || isTriState(type) || isResolvedNet(type))
     {
         return true;
     }
@@ -57,6 +143,52 @@ bool GateFactory::isValidGateType(GateType type)
     }
 }
 
+bool GateFactory::isValidInputCount(GateType type, int count)
+{
+    switch (type)
+    {
+    case GateType::Not:
+    case GateType::Buffer:
+    case GateType::FlipFlop:
+    case GateType::TFlipFlop:
+        return count == 1;
+    case GateType::And:
+    case GateType::Or:
+    case GateType::Nor:
+    case GateType::Nand:
+    case GateType::Xor:
+    case GateType::Xnor:
+    case GateType::WiredAnd:
+    case GateType::WiredOr:
+    case GateType::Bus:
+        return count >= 2;
+    case GateType::JKFlipFlop:
+    case GateType::SRFlipFlop:
+    case GateType::Latch:
+    case GateType::TriState:
+    case GateType::TransmissionGate:
+        return count == 2;
+    default:
+        return false;
+    }
+}
+
+bool GateFactory::isSequential(GateType type)
+{
+    return type == GateType::FlipFlop || type == GateType::Latch || type == GateType::JKFlipFlop ||
+           type == GateType::TFlipFlop || type == GateType::SRFlipFlop;
+}
+
+bool GateFactory::isTriState(GateType type)
+{
+    return type == GateType::TriState || type == GateType::TransmissionGate;
+}
+
+bool GateFactory::isResolvedNet(GateType type)
+{
+    return type == GateType::WiredAnd || type == GateType::WiredOr || type == GateType::Bus;
+}
+
 std::vector<GateType> GateFactory::getSupportedTypes()
 {
     return {
@@ -64,6 +196,16 @@ std::vector<GateType> GateFactory::getSupportedTypes()
         GateType::Nand, GateType::Xor, GateType::Xnor, GateType::Buffer};
 }
 
+std::vector<GateType> GateFactory::getSequentialTypes()
+{
+    return {GateType::FlipFlop, GateType::JKFlipFlop, GateType::TFlipFlop, GateType::SRFlipFlop, GateType::Latch};
+}
+
+std::vector<GateType> GateFactory::getBusTypes()
+{
+    return {GateType::TriState, GateType::TransmissionGate, GateType::WiredAnd, GateType::WiredOr, GateType::Bus};
+}
+
 std::string GateFactory::getGateTypeName(GateType type)
 {
     switch (type)
@@ -84,6 +226,26 @@ std::string GateFactory::getGateTypeName(GateType type)
         return "XNOR";
     case GateType::Buffer:
         return "BUFFER";
+    case GateType::FlipFlop:
+        return "DFF";
+    case GateType::JKFlipFlop:
+        return "JKFF";
+    case GateType::TFlipFlop:
+        return "TFF";
+    case GateType::SRFlipFlop:
+        return "SRFF";
+    case GateType::Latch:
+        return "LATCH";
+    case GateType::TriState:
+        return "TRIBUF";
+    case GateType::TransmissionGate:
+        return "TGATE";
+    case GateType::WiredAnd:
+        return "WAND";
+    case GateType::WiredOr:
+        return "WOR";
+    case GateType::Bus:
+        return "BUS";
     default:
         return "UNKNOWN";
     }
@@ -2,6 +2,9 @@
 #include <memory>
 #include "Gate.h"
 #include "BasicGates.h"
+#include "SequentialGates.h"
+#include "BusGates.h"
+#include "GatePool.h"
 
 class GateFactory
 {
@@ -9,8 +12,21 @@ class GateFactory
 public:
     //  Static method to create gates by type
     static std::shared_ptr<Gate> createGate(GateType type, const std::string &gateLabel = "");
+    //  Same, but the gate and its pins live in the pool's arena
+    static GateHandle createGate(GatePool &pool, GateType type, const std::string &gateLabel = "");
     //  Handle invalid gate type request
     static bool isValidGateType(GateType type);
+    // same input count rules the gates enforce in evaluate()
+    static bool isValidInputCount(GateType type, int count);
+    // flip-flops and latches, which hold state between clock edges
+    static bool isSequential(GateType type);
+    // tri-state buffers and transmission gates, which drive Z while they are off
+    static bool isTriState(GateType type);
+    // nets that combine several drivers
+    static bool isResolvedNet(GateType type);
+    // the combinational types
     static std::vector<GateType> getSupportedTypes();
+    static std::vector<GateType> getSequentialTypes();
+    static std::vector<GateType> getBusTypes();
     static std::string getGateTypeName(GateType type);
 };
\ No newline at end of file
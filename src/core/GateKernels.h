@@ -0,0 +1,307 @@
+#pragma once
+#include <bitset>
+#include <cstdint>
+#include "Gate.h"
+
+// Word-parallel gate logic for the compiled engines. Same truth functions as the
+// gate classes in BasicGates.cpp, but reading the fan-in straight out of a value
+// array so the hot loops need neither a vtable nor a temporary input vector.
+// Pin counts are validated when the Circuit is frozen, not here.
+// Two-valued lanes cannot hold Z, so there a released driver reads as 0: a tri-state
+// buffer is data AND enable, a bus or wired-OR the OR of its drivers and a wired-AND their
+// AND. That is exact for buses with one active driver; contention and wired-AND over
+// tri-states need four-valued mode.
+
+// set bits of a word, shared by the truth-table and minimizer code
+inline int popcount(uint64_t word)
+{
+    return static_cast<int>(std::bitset<64>(word).count());
+}
+
+// one gate of a type known at compile time, so a loop over same-typed gates has no dispatch at all
+template <GateType Type>
+inline uint64_t evaluateTypedWord(const uint64_t *values, const uint32_t *fanin, uint32_t count)
+{
+    uint64_t acc = values[fanin[0]];
+    if constexpr (Type == GateType::And || Type == GateType::Nand || Type == GateType::TriState ||
+                  Type == GateType::TransmissionGate || Type == GateType::WiredAnd)
+    {
+        for (uint32_t i = 1; i < count; i++)
+            acc &= values[fanin[i]];
+    }
+    else if constexpr (Type == GateType::Or || Type == GateType::Nor || Type == GateType::WiredOr || Type == GateType::Bus)
+    {
+        for (uint32_t i = 1; i < count; i++)
+            acc |= values[fanin[i]];
+    }
+    else if constexpr (Type == GateType::Xor || Type == GateType::Xnor)
+    {
+        for (uint32_t i = 1; i < count; i++)
+            acc ^= values[fanin[i]];
+    }
+    if constexpr (Type == GateType::Nand || Type == GateType::Nor || Type == GateType::Xnor || Type == GateType::Not)
+    {
+        return ~acc;
+    }
+    else
+    {
+        return acc;
+    }
+}
+
+// one gate whose type is only known at run time
+inline uint64_t evaluateGateWord(GateType type, const uint64_t *values, const uint32_t *fanin, uint32_t count)
+{
+    switch (type)
+    {
+    case GateType::And:
+        return evaluateTypedWord<GateType::And>(values, fanin, count);
+    case GateType::Nand:
+        return evaluateTypedWord<GateType::Nand>(values, fanin, count);
+    case GateType::Or:
+        return evaluateTypedWord<GateType::Or>(values, fanin, count);
+    case GateType::Nor:
+        return evaluateTypedWord<GateType::Nor>(values, fanin, count);
+    case GateType::Xor:
+        return evaluateTypedWord<GateType::Xor>(values, fanin, count);
+    case GateType::Xnor:
+        return evaluateTypedWord<GateType::Xnor>(values, fanin, count);
+    case GateType::Not:
+        return evaluateTypedWord<GateType::Not>(values, fanin, count);
+    case GateType::TriState:
+    case GateType::TransmissionGate:
+    case GateType::WiredAnd:
+        return evaluateTypedWord<GateType::And>(values, fanin, count);
+    case GateType::WiredOr:
+    case GateType::Bus:
+        return evaluateTypedWord<GateType::Or>(values, fanin, count);
+    case GateType::Buffer:
+    default:
+        return evaluateTypedWord<GateType::Buffer>(values, fanin, count);
+    }
+}
+
+// a lone gate whose input words sit next to each other, as in a truth-table chunk
+inline uint64_t evaluateGateWord(GateType type, const uint64_t *inputs, uint32_t count)
+{
+    // identity fan-in, wide enough for any gate a truth table can enumerate
+    static const uint32_t identity[64] = {
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+        16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+        32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47,
+        48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63};
+    return evaluateGateWord(type, inputs, identity, count);
+}
+
+// next state of a state element, 64 lanes at once: `a` and `b` are its first and second
+// data pins (b unused by D and T), `state` its current output
+inline uint64_t nextStateWord(GateType type, uint64_t a, uint64_t b, uint64_t state)
+{
+    switch (type)
+    {
+    case GateType::FlipFlop:
+        return a;
+    case GateType::TFlipFlop:
+        return a ^ state;
+    case GateType::JKFlipFlop:
+        // j sets, k resets, both toggle
+        return (a & ~state) | (~b & state);
+    case GateType::SRFlipFlop:
+        // s sets, r resets, s wins when both are high
+        return a | (~b & state);
+    case GateType::Latch:
+        // transparent while enabled, holding otherwise
+        return (b & a) | (~b & state);
+    default:
+        return state;
+    }
+}
+
+// Four-valued versions over two planes, see LogicWord. Gates read Z as X and never drive Z,
+// and an output lane is X only where the unknown inputs could change it: a known 0 into an
+// AND (or a known 1 into an OR) decides the lane whatever the other inputs are.
+// A tri-state buffer drives Z while disabled and X while its enable is X; a transmission
+// gate does the same but passes a Z on its data pin through. A resolved net ignores its
+// Z drivers and is Z only if all of them are. The drivers are classified into four masks
+// once per pin, so a net with many drivers costs a few word operations per driver for
+// all 64 lanes.
+template <GateType Type>
+inline LogicWord evaluateTypedLogicWord(const uint64_t *values, const uint64_t *unknowns, const uint32_t *fanin, uint32_t count)
+{
+    if constexpr (Type == GateType::TriState || Type == GateType::TransmissionGate)
+    {
+        uint64_t value = values[fanin[0]];
+        uint64_t unknown = unknowns[fanin[0]];
+        uint64_t enableValue = values[fanin[1]];
+        uint64_t enableUnknown = unknowns[fanin[1]];
+        uint64_t on = enableValue & ~enableUnknown;
+        uint64_t off = ~enableValue & ~enableUnknown;
+        // a buffer regenerates its data, so only the transmission gate lets Z through
+        if constexpr (Type == GateType::TriState)
+            value &= ~unknown;
+        // released lanes are Z, X enables leave value 0 and unknown 1
+        return LogicWord{(on & value) | off, (on & unknown) | off | enableUnknown};
+    }
+    else if constexpr (Type == GateType::WiredAnd || Type == GateType::WiredOr || Type == GateType::Bus)
+    {
+        uint64_t anyOne = 0;
+        uint64_t anyZero = 0;
+        uint64_t anyX = 0;
+        uint64_t allZ = ~0ULL;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint64_t value = values[fanin[i]];
+            uint64_t unknown = unknowns[fanin[i]];
+            anyOne |= value & ~unknown;
+            anyZero |= ~value & ~unknown;
+            anyX |= ~value & unknown;
+            allZ &= value & unknown;
+        }
+        if constexpr (Type == GateType::WiredAnd)
+        {
+            // a driven 0 decides the lane, then an X spoils it
+            uint64_t unknown = ~anyZero & (anyX | allZ);
+            return LogicWord{~anyZero & ~anyX & (anyOne | allZ), unknown};
+        }
+        else if constexpr (Type == GateType::WiredOr)
+        {
+            uint64_t unknown = ~anyOne & (anyX | allZ);
+            return LogicWord{anyOne | (~anyX & allZ), unknown};
+        }
+        else
+        {
+            // contention between a driven 0 and a driven 1 is as unknown as an X driver
+            uint64_t conflict = anyX | (anyOne & anyZero);
+            return LogicWord{(anyOne & ~conflict) | allZ, conflict | allZ};
+        }
+    }
+    else if constexpr (Type == GateType::And || Type == GateType::Nand || Type == GateType::Or || Type == GateType::Nor)
+    {
+        constexpr bool isAnd = Type == GateType::And || Type == GateType::Nand;
+        uint64_t ones = isAnd ? ~0ULL : 0;
+        uint64_t zeros = isAnd ? 0 : ~0ULL;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint64_t value = values[fanin[i]];
+            uint64_t unknown = unknowns[fanin[i]];
+            if constexpr (isAnd)
+            {
+                ones &= value & ~unknown;
+                zeros |= ~value & ~unknown;
+            }
+            else
+            {
+                ones |= value & ~unknown;
+                zeros &= ~value & ~unknown;
+            }
+        }
+        // inverting swaps the known ones and zeros
+        if constexpr (Type == GateType::Nand || Type == GateType::Nor)
+            return LogicWord{zeros, ~(ones | zeros)};
+        else
+            return LogicWord{ones, ~(ones | zeros)};
+    }
+    else if constexpr (Type == GateType::Xor || Type == GateType::Xnor)
+    {
+        uint64_t parity = 0;
+        uint64_t unknown = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            parity ^= values[fanin[i]];
+            unknown |= unknowns[fanin[i]];
+        }
+        if constexpr (Type == GateType::Xnor)
+            parity = ~parity;
+        return LogicWord{parity & ~unknown, unknown};
+    }
+    else
+    {
+        uint64_t value = values[fanin[0]];
+        uint64_t unknown = unknowns[fanin[0]];
+        if constexpr (Type == GateType::Not)
+            value = ~value;
+        return LogicWord{value & ~unknown, unknown};
+    }
+}
+
+inline LogicWord evaluateGateLogicWord(GateType type, const uint64_t *values, const uint64_t *unknowns, const uint32_t *fanin, uint32_t count)
+{
+    switch (type)
+    {
+    case GateType::And:
+        return evaluateTypedLogicWord<GateType::And>(values, unknowns, fanin, count);
+    case GateType::Nand:
+        return evaluateTypedLogicWord<GateType::Nand>(values, unknowns, fanin, count);
+    case GateType::Or:
+        return evaluateTypedLogicWord<GateType::Or>(values, unknowns, fanin, count);
+    case GateType::Nor:
+        return evaluateTypedLogicWord<GateType::Nor>(values, unknowns, fanin, count);
+    case GateType::Xor:
+        return evaluateTypedLogicWord<GateType::Xor>(values, unknowns, fanin, count);
+    case GateType::Xnor:
+        return evaluateTypedLogicWord<GateType::Xnor>(values, unknowns, fanin, count);
+    case GateType::Not:
+        return evaluateTypedLogicWord<GateType::Not>(values, unknowns, fanin, count);
+    case GateType::TriState:
+        return evaluateTypedLogicWord<GateType::TriState>(values, unknowns, fanin, count);
+    case GateType::TransmissionGate:
+        return evaluateTypedLogicWord<GateType::TransmissionGate>(values, unknowns, fanin, count);
+    case GateType::WiredAnd:
+        return evaluateTypedLogicWord<GateType::WiredAnd>(values, unknowns, fanin, count);
+    case GateType::WiredOr:
+        return evaluateTypedLogicWord<GateType::WiredOr>(values, unknowns, fanin, count);
+    case GateType::Bus:
+        return evaluateTypedLogicWord<GateType::Bus>(values, unknowns, fanin, count);
+    case GateType::Buffer:
+    default:
+        return evaluateTypedLogicWord<GateType::Buffer>(values, unknowns, fanin, count);
+    }
+}
+
+// next state with unknown pins or state: a lane is known only if every 0/1 completion of
+// its unknown operands gives the same next state, found by trying all eight
+inline LogicWord nextStateLogicWord(GateType type, LogicWord a, LogicWord b, LogicWord state)
+{
+    uint64_t first = 0;
+    uint64_t differ = 0;
+    for (int completion = 0; completion < 8; completion++)
+    {
+        uint64_t fillA = completion & 1 ? a.unknown : 0;
+        uint64_t fillB = completion & 2 ? b.unknown : 0;
+        uint64_t fillState = completion & 4 ? state.unknown : 0;
+        uint64_t next = nextStateWord(type, (a.value & ~a.unknown) | fillA, (b.value & ~b.unknown) | fillB,
+                                      (state.value & ~state.unknown) | fillState);
+        if (completion == 0)
+            first = next;
+        else
+            differ |= next ^ first;
+    }
+    return LogicWord{first & ~differ, differ};
+}
+
+// all 64 lanes holding `value`
+inline LogicWord logicWord(Logic value)
+{
+    switch (value)
+    {
+    case Logic::One:
+        return LogicWord{~0ULL, 0};
+    case Logic::X:
+        return LogicWord{0, ~0ULL};
+    case Logic::Z:
+        return LogicWord{~0ULL, ~0ULL};
+    case Logic::Zero:
+    default:
+        return LogicWord{0, 0};
+    }
+}
+
+inline Logic logicAt(LogicWord word, int lane)
+{
+    return static_cast<Logic>(((word.unknown >> lane) & 1) << 1 | ((word.value >> lane) & 1));
+}
+
+inline char logicChar(Logic value)
+{
+    return "01XZ"[static_cast<int>(value)];
+}
@@ -0,0 +1,45 @@
+#include "GatePool.h"
+#include <stdexcept>
+
+namespace
+{
+    // a gate object plus its two-pin storage, rounded up
+    constexpr size_t BytesPerGate = 128;
+}
+
+GatePool::GatePool(size_t expectedGates)
+    : arena(expectedGates ? expectedGates * BytesPerGate : 4096)
+{
+    slots.reserve(expectedGates);
+}
+
+GatePool::~GatePool()
+{
+    clear();
+}
+
+void GatePool::destroy(GateHandle handle)
+{
+    Gate *gate = get(handle);
+    if (gate == nullptr)
+    {
+        throw std::out_of_range("GatePool: invalid gate handle");
+    }
+    gate->~Gate();
+    slots[handle] = nullptr;
+    liveGates--;
+}
+
+void GatePool::clear()
+{
+    for (Gate *gate : slots)
+    {
+        if (gate != nullptr)
+        {
+            gate->~Gate();
+        }
+    }
+    slots.clear();
+    liveGates = 0;
+    arena.release();
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <vector>
+#include "Gate.h"
+
+// stable index of a gate inside a GatePool
+using GateHandle = uint32_t;
+
+// Owns gates together with their pin storage and labels in one monotonic arena.
+// Creating a gate is a bump allocation instead of a make_shared control block plus
+// separate vector and string allocations, and teardown releases the arena in a few
+// large frees. Callers keep GateHandle indices rather than shared_ptr, so passing
+// gates around costs no reference counting.
+// Destroying a single gate runs its destructor but its bytes are only reclaimed by clear().
+class GatePool
+{
+public:
+    static constexpr GateHandle InvalidHandle = 0xFFFFFFFF;
+
+    // expectedGates sizes the handle table and the first arena block up front
+    explicit GatePool(size_t expectedGates = 0);
+    ~GatePool();
+    GatePool(const GatePool &) = delete;
+    GatePool &operator=(const GatePool &) = delete;
+
+    template <typename T>
+    GateHandle emplace(const std::string &gateLabel)
+    {
+        // the slot first, so a gate is never constructed without a place to record it
+        slots.push_back(nullptr);
+        try
+        {
+            void *memory = arena.allocate(sizeof(T), alignof(T));
+            slots.back() = new (memory) T(gateLabel, &arena);
+        }
+        catch (...)
+        {
+            slots.pop_back();
+            throw;
+        }
+        liveGates++;
+        return static_cast<GateHandle>(slots.size() - 1);
+    }
+
+    // nullptr for destroyed or unknown handles
+    Gate *get(GateHandle handle) const { return handle < slots.size() ? slots[handle] : nullptr; }
+    void destroy(GateHandle handle);
+    // destroys every gate and gives the arena memory back
+    void clear();
+
+    size_t size() const { return liveGates; }
+    std::pmr::memory_resource *getResource() { return &arena; }
+
+private:
+    std::pmr::monotonic_buffer_resource arena;
+    std::vector<Gate *> slots;
+    size_t liveGates = 0;
+};
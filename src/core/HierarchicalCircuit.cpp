@@ -0,0 +1,301 @@
+#include "HierarchicalCircuit.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    // FNV-1a, only used to place names in the lookup table
+    uint64_t hashName(std::string_view name)
+    {
+        uint64_t hash = 1469598103934665603ULL;
+        for (char c : name)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
+
+HierarchicalCircuit::DefinitionId HierarchicalCircuit::define(const std::string &name, Circuit body)
+{
+    if (!body.isFrozen())
+    {
+        throw std::invalid_argument("HierarchicalCircuit: the body of module " + name + " is not frozen");
+    }
+    if (body.getOutputCount() == 0)
+    {
+        throw std::invalid_argument("HierarchicalCircuit: module " + name + " has no outputs");
+    }
+    if (findDefinition(name) != InvalidId)
+    {
+        throw std::invalid_argument("HierarchicalCircuit: module " + name + " is already defined");
+    }
+    definitions.push_back(Definition{name, std::move(body), 0});
+    return static_cast<DefinitionId>(definitions.size() - 1);
+}
+
+HierarchicalCircuit::DefinitionId HierarchicalCircuit::findDefinition(std::string_view name) const
+{
+    for (DefinitionId id = 0; id < definitions.size(); id++)
+    {
+        if (definitions[id].name == name)
+        {
+            return id;
+        }
+    }
+    return InvalidId;
+}
+
+HierarchicalCircuit::NetId HierarchicalCircuit::addInput(const std::string &name)
+{
+    inputNames.push_back(addName(name, netCount));
+    inputNets.push_back(netCount);
+    flattened.reset();
+    return netCount++;
+}
+
+HierarchicalCircuit::InstanceId HierarchicalCircuit::instantiate(DefinitionId definition, const std::string &name, const std::vector<NetId> &inputs)
+{
+    if (definition >= definitions.size())
+    {
+        throw std::invalid_argument("HierarchicalCircuit: no such module");
+    }
+    Definition &module = definitions[definition];
+    if (inputs.size() != module.body.getInputCount())
+    {
+        throw std::invalid_argument("HierarchicalCircuit: module " + module.name + " has " + std::to_string(module.body.getInputCount()) +
+                                    " inputs, " + std::to_string(inputs.size()) + " nets given");
+    }
+    for (NetId net : inputs)
+    {
+        if (net >= netCount)
+        {
+            throw std::invalid_argument("HierarchicalCircuit: net " + std::to_string(net) + " does not exist");
+        }
+    }
+    if (netCount + module.body.getOutputCount() >= InstanceBit)
+    {
+        throw std::length_error("HierarchicalCircuit: too many nets");
+    }
+    InstanceId instance = static_cast<InstanceId>(instances.size());
+    uint32_t nameIndex = addName(name, InstanceBit | instance);
+    instances.push_back(Instance{definition, static_cast<uint32_t>(portNets.size()), netCount, nameIndex});
+    portNets.insert(portNets.end(), inputs.begin(), inputs.end());
+    netCount += module.body.getOutputCount();
+    module.instances++;
+    flattened.reset();
+    return instance;
+}
+
+void HierarchicalCircuit::markOutput(NetId net)
+{
+    if (net >= netCount)
+    {
+        throw std::out_of_range("HierarchicalCircuit: net id out of range");
+    }
+    if (std::find(outputs.begin(), outputs.end(), net) == outputs.end())
+    {
+        outputs.push_back(net);
+        flattened.reset();
+    }
+}
+
+std::string HierarchicalCircuit::getInstanceName(InstanceId instance) const
+{
+    return std::string(nameAt(instances.at(instance).name));
+}
+
+HierarchicalCircuit::InstanceId HierarchicalCircuit::findInstance(std::string_view name) const
+{
+    uint32_t index = nameSlots[findSlot(name)];
+    if (index == InvalidId || !(nameOwners[index] & InstanceBit))
+    {
+        return InvalidId;
+    }
+    return nameOwners[index] & ~InstanceBit;
+}
+
+HierarchicalCircuit::InstanceId HierarchicalCircuit::getDriver(NetId net) const
+{
+    // instances own consecutive runs of nets in the order they were added
+    auto after = std::upper_bound(instances.begin(), instances.end(), net, [](NetId value, const Instance &instance)
+                                  { return value < instance.firstOutput; });
+    if (after == instances.begin())
+    {
+        return InvalidId;
+    }
+    const Instance &instance = *(after - 1);
+    if (net - instance.firstOutput < definitions[instance.definition].body.getOutputCount())
+    {
+        return static_cast<InstanceId>(after - 1 - instances.begin());
+    }
+    return InvalidId;
+}
+
+std::string HierarchicalCircuit::getNetName(NetId net) const
+{
+    if (net >= netCount)
+    {
+        throw std::out_of_range("HierarchicalCircuit: net id out of range");
+    }
+    InstanceId instance = getDriver(net);
+    if (instance == InvalidId)
+    {
+        size_t input = std::lower_bound(inputNets.begin(), inputNets.end(), net) - inputNets.begin();
+        return std::string(nameAt(inputNames[input]));
+    }
+    const Circuit &body = definitions[instances[instance].definition].body;
+    return getInstanceName(instance) + "." + body.getName(body.getOutputs()[net - instances[instance].firstOutput]);
+}
+
+HierarchicalCircuit::NetId HierarchicalCircuit::findNet(std::string_view name) const
+{
+    uint32_t index = nameSlots[findSlot(name)];
+    if (index != InvalidId && !(nameOwners[index] & InstanceBit))
+    {
+        return nameOwners[index];
+    }
+    // <instance>.<port>, where either side may hold dots of its own
+    for (size_t dot = name.find('.'); dot != std::string_view::npos; dot = name.find('.', dot + 1))
+    {
+        InstanceId instance = findInstance(name.substr(0, dot));
+        if (instance == InvalidId)
+        {
+            continue;
+        }
+        const Circuit &body = definitions[instances[instance].definition].body;
+        Circuit::NodeId port = body.findNode(name.substr(dot + 1));
+        for (uint32_t p = 0; p < body.getOutputCount(); p++)
+        {
+            if (body.getOutputs()[p] == port)
+            {
+                return instances[instance].firstOutput + p;
+            }
+        }
+    }
+    return InvalidId;
+}
+
+const Circuit &HierarchicalCircuit::flatten() const
+{
+    if (flattened)
+    {
+        return *flattened;
+    }
+    auto circuit = std::make_unique<Circuit>();
+    std::vector<Circuit::NodeId> nodeOfNet(netCount, Circuit::InvalidNode);
+    for (uint32_t i = 0; i < inputNets.size(); i++)
+    {
+        nodeOfNet[inputNets[i]] = circuit->addInput(nameAt(inputNames[i]));
+    }
+    std::vector<Circuit::NodeId> nodeOf;
+    std::string name;
+    for (const Instance &instance : instances)
+    {
+        const Circuit &body = definitions[instance.definition].body;
+        nodeOf.assign(body.getNodeCount(), Circuit::InvalidNode);
+        // input ports are not nodes of their own, they are the nets driving them
+        for (uint32_t p = 0; p < body.getInputCount(); p++)
+        {
+            nodeOf[body.getInputs()[p]] = nodeOfNet[portNets[instance.firstPort + p]];
+        }
+        std::string_view prefix = nameAt(instance.name);
+        for (Circuit::NodeId node = 0; node < body.getNodeCount(); node++)
+        {
+            if (body.isInput(node))
+            {
+                continue;
+            }
+            name.assign(prefix);
+            name += '.';
+            name += body.getName(node);
+            nodeOf[node] = circuit->addGate(body.getGateType(node), name, body.getFaninCount(node));
+            circuit->setDelay(nodeOf[node], body.getDelay(node));
+            // power-up state of flip-flops and latches
+            circuit->setValue(nodeOf[node], body.getValue(node));
+        }
+        for (Circuit::NodeId node = 0; node < body.getNodeCount(); node++)
+        {
+            for (uint32_t pin = 0; !body.isInput(node) && pin < body.getFaninCount(node); pin++)
+            {
+                circuit->connect(nodeOf[body.getFanin(node)[pin]], nodeOf[node], pin);
+            }
+        }
+        for (uint32_t p = 0; p < body.getOutputCount(); p++)
+        {
+            nodeOfNet[instance.firstOutput + p] = nodeOf[body.getOutputs()[p]];
+        }
+    }
+    for (NetId net : outputs)
+    {
+        circuit->markOutput(nodeOfNet[net]);
+    }
+    circuit->freeze();
+    flattened = std::move(circuit);
+    return *flattened;
+}
+
+size_t HierarchicalCircuit::getDefinitionMemoryUsage() const
+{
+    size_t bytes = definitions.capacity() * sizeof(Definition);
+    for (const Definition &definition : definitions)
+    {
+        bytes += definition.name.capacity() + definition.body.getMemoryUsage();
+    }
+    return bytes;
+}
+
+size_t HierarchicalCircuit::getInstanceMemoryUsage() const
+{
+    return instances.capacity() * sizeof(Instance) +
+           (portNets.capacity() + inputNets.capacity() + outputs.capacity() + inputNames.capacity()) * sizeof(NetId) +
+           nameTable.capacity() + (nameOffsets.capacity() + nameOwners.capacity() + nameSlots.capacity()) * sizeof(uint32_t);
+}
+
+std::string_view HierarchicalCircuit::nameAt(uint32_t name) const
+{
+    return std::string_view(nameTable.data() + nameOffsets[name], nameOffsets[name + 1] - nameOffsets[name]);
+}
+
+size_t HierarchicalCircuit::findSlot(std::string_view name) const
+{
+    // linear probing, the table is kept at most half full
+    size_t mask = nameSlots.size() - 1;
+    size_t slot = hashName(name) & mask;
+    while (nameSlots[slot] != InvalidId && nameAt(nameSlots[slot]) != name)
+    {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+uint32_t HierarchicalCircuit::addName(std::string_view name, uint32_t owner)
+{
+    if (name.empty() || nameSlots[findSlot(name)] != InvalidId)
+    {
+        throw std::invalid_argument("HierarchicalCircuit: name '" + std::string(name) + "' is empty or taken");
+    }
+    uint32_t index = static_cast<uint32_t>(nameOwners.size());
+    nameTable.insert(nameTable.end(), name.begin(), name.end());
+    nameOffsets.push_back(static_cast<uint32_t>(nameTable.size()));
+    nameOwners.push_back(owner);
+    if ((nameOwners.size()) * 2 > nameSlots.size())
+    {
+        growNameSlots();
+    }
+    else
+    {
+        nameSlots[findSlot(name)] = index;
+    }
+    return index;
+}
+
+void HierarchicalCircuit::growNameSlots()
+{
+    nameSlots.assign(nameSlots.size() * 2, InvalidId);
+    for (uint32_t index = 0; index < nameOwners.size(); index++)
+    {
+        nameSlots[findSlot(nameAt(index))] = index;
+    }
+}
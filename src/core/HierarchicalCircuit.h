@@ -0,0 +1,123 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Circuit.h"
+
+// A design built from instances of module definitions. A definition is a frozen Circuit
+// whose primary inputs and outputs are its ports, and it is stored once however often it
+// is instantiated: an instance is only its definition, the nets on its input ports and its
+// name, a few words whatever the size of the block. Signal values live in the simulator
+// (see HierarchicalSimulator), which allocates them per instance and compiles each
+// definition once.
+//
+// Nets are the design's primary inputs and the output ports of its instances. An instance
+// can only read nets that already exist, so instances are added in evaluation order and the
+// design cannot loop; feedback, through flip-flops or not, stays inside a definition.
+//
+// flatten() expands the design into one flat Circuit, instance nodes named
+// <instance>.<node>, for everything that needs a netlist: export, the compiled and
+// event-driven engines, BDDs. It is built on first use and kept until the design changes.
+class HierarchicalCircuit
+{
+public:
+    using NetId = uint32_t;
+    using InstanceId = uint32_t;
+    using DefinitionId = uint32_t;
+    static constexpr uint32_t InvalidId = 0xFFFFFFFF;
+
+    struct Definition
+    {
+        std::string name;
+        Circuit body;
+        uint32_t instances = 0;
+    };
+
+    HierarchicalCircuit() = default;
+    HierarchicalCircuit(const HierarchicalCircuit &) = delete;
+    HierarchicalCircuit &operator=(const HierarchicalCircuit &) = delete;
+
+    // throws std::invalid_argument for a duplicate name, or a body that is not frozen or has
+    // no outputs; the ports are the body's inputs and outputs in order
+    DefinitionId define(const std::string &name, Circuit body);
+    // returns InvalidId if no definition has that name
+    DefinitionId findDefinition(std::string_view name) const;
+    const Definition &getDefinition(DefinitionId definition) const { return definitions.at(definition); }
+    uint32_t getDefinitionCount() const { return static_cast<uint32_t>(definitions.size()); }
+
+    // names are shared by inputs and instances, throws std::invalid_argument for a taken one
+    NetId addInput(const std::string &name);
+    // `inputs` drive the definition's input ports in order; throws std::invalid_argument for
+    // a bad definition, a taken name, the wrong number of nets or a net that does not exist
+    InstanceId instantiate(DefinitionId definition, const std::string &name, const std::vector<NetId> &inputs);
+    void markOutput(NetId net);
+
+    uint32_t getNetCount() const { return netCount; }
+    uint32_t getInputCount() const { return static_cast<uint32_t>(inputNets.size()); }
+    NetId getInputNet(uint32_t inputIndex) const { return inputNets.at(inputIndex); }
+    uint32_t getInstanceCount() const { return static_cast<uint32_t>(instances.size()); }
+    const std::vector<NetId> &getOutputs() const { return outputs; }
+
+    DefinitionId getInstanceDefinition(InstanceId instance) const { return instances[instance].definition; }
+    // the nets on the instance's input ports, one per port
+    const NetId *getInstanceInputs(InstanceId instance) const { return portNets.data() + instances[instance].firstPort; }
+    // output port p of an instance drives net getFirstOutputNet(instance) + p
+    NetId getFirstOutputNet(InstanceId instance) const { return instances[instance].firstOutput; }
+    std::string getInstanceName(InstanceId instance) const;
+    // returns InvalidId if no instance has that name
+    InstanceId findInstance(std::string_view name) const;
+
+    // the instance driving the net, InvalidId for a design input
+    InstanceId getDriver(NetId net) const;
+    // an input's name, or <instance>.<port> for an instance output
+    std::string getNetName(NetId net) const;
+    // returns InvalidId if there is no such net
+    NetId findNet(std::string_view name) const;
+
+    // the whole design as one flat, frozen netlist, built on first use
+    const Circuit &flatten() const;
+    bool isFlattened() const { return flattened != nullptr; }
+
+    // bytes held by the definitions, and by everything the instances and nets add to them
+    size_t getDefinitionMemoryUsage() const;
+    size_t getInstanceMemoryUsage() const;
+
+private:
+    struct Instance
+    {
+        DefinitionId definition;
+        uint32_t firstPort; // into portNets
+        NetId firstOutput;
+        uint32_t name; // into the name table
+    };
+
+    std::vector<Definition> definitions;
+    std::vector<Instance> instances;
+    std::vector<NetId> portNets;
+    std::vector<NetId> inputNets;
+    std::vector<NetId> outputs;
+    uint32_t netCount = 0;
+
+    static constexpr uint32_t InstanceBit = 0x80000000;
+
+    // names of inputs and instances back to back, name n is nameTable[nameOffsets[n] .. nameOffsets[n + 1]);
+    // nameOwners[n] is the net of an input, or InstanceBit | instance
+    std::vector<char> nameTable;
+    std::vector<uint32_t> nameOffsets{0};
+    std::vector<uint32_t> nameOwners;
+    // name of every input, by input index
+    std::vector<uint32_t> inputNames;
+    // open-addressing hash of name indices, InvalidId marks an empty slot
+    std::vector<uint32_t> nameSlots = std::vector<uint32_t>(64, InvalidId);
+
+    mutable std::unique_ptr<Circuit> flattened;
+
+    std::string_view nameAt(uint32_t name) const;
+    size_t findSlot(std::string_view name) const;
+    // records the name, throws std::invalid_argument if it is taken
+    uint32_t addName(std::string_view name, uint32_t owner);
+    void growNameSlots();
+};
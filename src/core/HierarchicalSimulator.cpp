@@ -0,0 +1,289 @@
+#include "HierarchicalSimulator.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include "GateFactory.h"
+#include "GateKernels.h"
+
+namespace
+{
+    bool isStateElement(const Circuit &circuit, Circuit::NodeId node)
+    {
+        return !circuit.isInput(node) && GateFactory::isSequential(circuit.getGateType(node));
+    }
+}
+
+HierarchicalSimulator::HierarchicalSimulator(const HierarchicalCircuit &design)
+    : design(design), programs(design.getDefinitionCount()), netWords(design.getNetCount(), 0)
+{
+    // the state layout is needed up front, the programs themselves wait for their first instance
+    for (HierarchicalCircuit::DefinitionId d = 0; d < design.getDefinitionCount(); d++)
+    {
+        const Circuit &body = design.getDefinition(d).body;
+        Program &program = programs[d];
+        program.stateIndex.assign(body.getNodeCount(), 0);
+        for (Circuit::NodeId node = 0; node < body.getNodeCount(); node++)
+        {
+            if (isStateElement(body, node))
+            {
+                program.stateIndex[node] = static_cast<uint32_t>(program.stateNodes.size());
+                program.stateNodes.push_back(node);
+                program.initialState.push_back(body.getValue(node) ? ~0ULL : 0);
+            }
+        }
+    }
+    firstState.reserve(design.getInstanceCount() + 1);
+    firstState.push_back(0);
+    size_t words = 0;
+    for (HierarchicalCircuit::InstanceId i = 0; i < design.getInstanceCount(); i++)
+    {
+        words += programs[design.getInstanceDefinition(i)].stateNodes.size();
+        if (words > 0xFFFFFFFF)
+        {
+            throw std::length_error("HierarchicalSimulator: too many state elements");
+        }
+        firstState.push_back(static_cast<uint32_t>(words));
+    }
+    stateWords.resize(words);
+    reset();
+}
+
+void HierarchicalSimulator::setInput(uint32_t inputIndex, uint64_t lanes)
+{
+    netWords[design.getInputNet(inputIndex)] = lanes;
+}
+
+void HierarchicalSimulator::setInputNet(HierarchicalCircuit::NetId net, uint64_t lanes)
+{
+    if (net >= netWords.size())
+    {
+        throw std::out_of_range("HierarchicalSimulator: net id out of range");
+    }
+    if (design.getDriver(net) != HierarchicalCircuit::InvalidId)
+    {
+        throw std::invalid_argument("HierarchicalSimulator: " + design.getNetName(net) + " is driven by an instance, not a design input");
+    }
+    netWords[net] = lanes;
+}
+
+void HierarchicalSimulator::evaluate()
+{
+    for (HierarchicalCircuit::InstanceId i = 0; i < design.getInstanceCount(); i++)
+    {
+        runInstance(i, false);
+    }
+}
+
+void HierarchicalSimulator::clock(uint64_t cycles)
+{
+    for (uint64_t c = 0; c < cycles; c++)
+    {
+        for (HierarchicalCircuit::InstanceId i = 0; i < design.getInstanceCount(); i++)
+        {
+            runInstance(i, true);
+        }
+        cycle++;
+    }
+    evaluate();
+}
+
+void HierarchicalSimulator::reset()
+{
+    for (HierarchicalCircuit::InstanceId i = 0; i < design.getInstanceCount(); i++)
+    {
+        const Program &program = programs[design.getInstanceDefinition(i)];
+        std::copy(program.initialState.begin(), program.initialState.end(), stateWords.begin() + firstState[i]);
+    }
+    cycle = 0;
+}
+
+uint64_t HierarchicalSimulator::getInstanceWord(HierarchicalCircuit::InstanceId instance, Circuit::NodeId node)
+{
+    if (instance >= design.getInstanceCount())
+    {
+        throw std::out_of_range("HierarchicalSimulator: instance id out of range");
+    }
+    if (node >= design.getDefinition(design.getInstanceDefinition(instance)).body.getNodeCount())
+    {
+        throw std::out_of_range("HierarchicalSimulator: node id out of range");
+    }
+    runInstance(instance, false);
+    return scratch[node];
+}
+
+size_t HierarchicalSimulator::getStateMemoryUsage() const
+{
+    return (netWords.capacity() + stateWords.capacity()) * sizeof(uint64_t) + firstState.capacity() * sizeof(uint32_t);
+}
+
+size_t HierarchicalSimulator::getProgramMemoryUsage() const
+{
+    size_t bytes = programs.capacity() * sizeof(Program) + scratch.capacity() * sizeof(uint64_t);
+    for (const Program &program : programs)
+    {
+        bytes += (program.code.capacity() + program.stateNodes.capacity() + program.stateIndex.capacity()) * sizeof(uint32_t) +
+                 program.initialState.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+uint32_t HierarchicalSimulator::getCompiledCount() const
+{
+    return static_cast<uint32_t>(std::count_if(programs.begin(), programs.end(), [](const Program &program)
+                                               { return program.compiled; }));
+}
+
+const HierarchicalSimulator::Program &HierarchicalSimulator::getProgram(HierarchicalCircuit::DefinitionId definition)
+{
+    if (!programs[definition].compiled)
+    {
+        compile(definition);
+    }
+    return programs[definition];
+}
+
+void HierarchicalSimulator::compile(HierarchicalCircuit::DefinitionId definition)
+{
+    const Circuit &body = design.getDefinition(definition).body;
+    Program &program = programs[definition];
+    const uint32_t numNodes = body.getNodeCount();
+
+    // Kahn's algorithm from the ports and flip-flop outputs; edges into flip-flops are cut,
+    // since a flip-flop only reads its data pins at the edge
+    auto isRegister = [&](Circuit::NodeId node)
+    { return isStateElement(body, node) && body.getGateType(node) != GateType::Latch; };
+    std::vector<uint32_t> pending(numNodes, 0);
+    std::vector<Circuit::NodeId> ready;
+    for (Circuit::NodeId node = 0; node < numNodes; node++)
+    {
+        if (body.isInput(node) || isRegister(node))
+        {
+            ready.push_back(node);
+        }
+        else
+        {
+            pending[node] = body.getFaninCount(node);
+        }
+    }
+    size_t sources = ready.size();
+    for (size_t next = 0; next < ready.size(); next++)
+    {
+        Circuit::NodeId node = ready[next];
+        const Circuit::NodeId *fanout = body.getFanout(node);
+        for (uint32_t i = 0; i < body.getFanoutCount(node); i++)
+        {
+            if (!isRegister(fanout[i]) && --pending[fanout[i]] == 0)
+            {
+                ready.push_back(fanout[i]);
+            }
+        }
+    }
+    if (ready.size() != numNodes)
+    {
+        throw std::runtime_error("HierarchicalSimulator: module " + design.getDefinition(definition).name + " has a combinational loop");
+    }
+
+    program.code.clear();
+    for (size_t next = sources; next < ready.size(); next++)
+    {
+        Circuit::NodeId node = ready[next];
+        program.code.push_back(static_cast<uint32_t>(body.getGateType(node)));
+        program.code.push_back(node);
+        program.code.push_back(body.getFaninCount(node));
+        program.code.insert(program.code.end(), body.getFanin(node), body.getFanin(node) + body.getFaninCount(node));
+    }
+    if (scratch.size() < numNodes)
+    {
+        scratch.resize(numNodes, 0);
+    }
+    program.compiled = true;
+}
+
+void HierarchicalSimulator::runInstance(HierarchicalCircuit::InstanceId instance, bool commit)
+{
+    const Circuit &body = design.getDefinition(design.getInstanceDefinition(instance)).body;
+    const Program &program = getProgram(design.getInstanceDefinition(instance));
+    const HierarchicalCircuit::NetId *ports = design.getInstanceInputs(instance);
+    uint64_t *state = stateWords.data() + firstState[instance];
+    uint64_t *values = scratch.data();
+
+    Circuit::NodeList inputs = body.getInputs();
+    for (uint32_t p = 0; p < inputs.size(); p++)
+    {
+        values[inputs[p]] = netWords[ports[p]];
+    }
+    for (uint32_t s = 0; s < program.stateNodes.size(); s++)
+    {
+        values[program.stateNodes[s]] = state[s];
+    }
+
+    const uint32_t *code = program.code.data();
+    const uint32_t *end = code + program.code.size();
+    while (code < end)
+    {
+        GateType type = static_cast<GateType>(code[0]);
+        uint32_t node = code[1];
+        uint32_t count = code[2];
+        if (type == GateType::Latch)
+        {
+            // transparent while enabled, and the state follows
+            values[node] = nextStateWord(type, values[code[3]], values[code[4]], values[node]);
+            state[program.stateIndex[node]] = values[node];
+        }
+        else
+        {
+            values[node] = evaluateGateWord(type, values, code + 3, count);
+        }
+        code += 3 + count;
+    }
+
+    Circuit::NodeList outputs = body.getOutputs();
+    HierarchicalCircuit::NetId firstOutput = design.getFirstOutputNet(instance);
+    for (uint32_t p = 0; p < outputs.size(); p++)
+    {
+        netWords[firstOutput + p] = values[outputs[p]];
+    }
+
+    if (commit)
+    {
+        // the outputs above are the pre-edge values every later instance samples
+        for (uint32_t s = 0; s < program.stateNodes.size(); s++)
+        {
+            Circuit::NodeId node = program.stateNodes[s];
+            GateType type = body.getGateType(node);
+            if (type == GateType::Latch)
+            {
+                continue;
+            }
+            const Circuit::NodeId *fanin = body.getFanin(node);
+            uint64_t b = body.getFaninCount(node) > 1 ? values[fanin[1]] : 0;
+            state[s] = nextStateWord(type, values[fanin[0]], b, state[s]);
+        }
+    }
+}
+
+HierarchicalSimulator::RunStats HierarchicalSimulator::run(uint64_t cycles, uint64_t seed)
+{
+    uint64_t state = seed ? seed : 1;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < cycles; i++)
+    {
+        for (uint32_t input = 0; input < design.getInputCount(); input++)
+        {
+            // xorshift64, a fresh word of 64 lanes per input
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            netWords[design.getInputNet(input)] = state;
+        }
+        for (HierarchicalCircuit::InstanceId instance = 0; instance < design.getInstanceCount(); instance++)
+        {
+            runInstance(instance, true);
+        }
+        cycle++;
+    }
+    evaluate();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return RunStats{cycles, seconds};
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Circuit.h"
+#include "HierarchicalCircuit.h"
+
+// Simulates a HierarchicalCircuit without flattening it. Every definition is compiled once,
+// the first time an instance of it is evaluated, into a program over its own node ids; the
+// instances then run that program one after another against one shared scratch array sized
+// for the largest definition. What is allocated per instance is only its signal state: a
+// word for each output net and for each flip-flop and latch of its definition, so 10k
+// instances of a block cost 10k times its state, not 10k times its netlist.
+//
+// Values are 64 lanes per word, as in LevelizedSimulator, so one pass runs 64 independent
+// input patterns. A clock edge runs each instance and commits its flip-flops in place right
+// away: the instances reading it have already seen its pre-edge outputs in their nets and
+// nothing else reads its state. Latches are evaluated with the logic as in
+// SequentialSimulator. Two-valued only; for X and Z, flatten() the design and use the flat engines.
+class HierarchicalSimulator
+{
+public:
+    struct RunStats
+    {
+        uint64_t cycles;
+        double seconds;
+        double cyclesPerSecond() const { return seconds > 0 ? cycles / seconds : 0; }
+    };
+
+    // the design must outlive the simulator and must not change while it is used; flip-flops
+    // and latches start, in every lane, from the values they have in their definition
+    explicit HierarchicalSimulator(const HierarchicalCircuit &design);
+
+    // inputs are addressed by their position among the design's inputs, one bit per lane
+    void setInput(uint32_t inputIndex, uint64_t lanes);
+    void setInputNet(HierarchicalCircuit::NetId net, uint64_t lanes);
+    // settles every instance for the current inputs and state; throws std::runtime_error if
+    // a definition being compiled has a combinational loop
+    void evaluate();
+    // `cycles` edges, the logic is settled again afterwards
+    void clock(uint64_t cycles = 1);
+    // flip-flops and latches back to their initial values, the inputs are kept
+    void reset();
+
+    uint64_t getWord(HierarchicalCircuit::NetId net) const { return netWords.at(net); }
+    bool getValue(HierarchicalCircuit::NetId net, uint32_t lane = 0) const { return (getWord(net) >> lane) & 1; }
+    // any node inside an instance, recomputed from the nets and state as of the last evaluate()
+    uint64_t getInstanceWord(HierarchicalCircuit::InstanceId instance, Circuit::NodeId node);
+
+    // bytes of per-instance state (nets, flip-flops, latches), and of the compiled definitions
+    size_t getStateMemoryUsage() const;
+    size_t getProgramMemoryUsage() const;
+    uint32_t getCompiledCount() const;
+    uint64_t getCycle() const { return cycle; }
+
+    // random inputs on every edge, timed
+    RunStats run(uint64_t cycles, uint64_t seed = 1);
+
+private:
+    struct Program
+    {
+        bool compiled = false;
+        // per gate in evaluation order: type, node, fan-in count, fan-in nodes
+        std::vector<uint32_t> code;
+        // flip-flops and latches, in the order of their state words
+        std::vector<Circuit::NodeId> stateNodes;
+        // state word of every node, unused for the others
+        std::vector<uint32_t> stateIndex;
+        std::vector<uint64_t> initialState;
+    };
+
+    const HierarchicalCircuit &design;
+    std::vector<Program> programs;
+    std::vector<uint64_t> netWords;
+    // per instance, its state is stateWords[firstState[i] .. firstState[i + 1])
+    std::vector<uint32_t> firstState;
+    std::vector<uint64_t> stateWords;
+    std::vector<uint64_t> scratch;
+    uint64_t cycle = 0;
+
+    const Program &getProgram(HierarchicalCircuit::DefinitionId definition);
+    void compile(HierarchicalCircuit::DefinitionId definition);
+    // loads the instance's ports and state into the scratch, runs it and writes its outputs;
+    // with `commit` its flip-flops then take an edge
+    void runInstance(HierarchicalCircuit::InstanceId instance, bool commit);
+};
@@ -0,0 +1,603 @@
+#include "K-Map.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include "GateKernels.h"
+#include "ThreadPool.h"
+#include "utils/TruthTable.h"
+#include "utils/PackedTruthTable.h"
+
+namespace
+{
+    // positions inside a word whose minterm has bit b clear, for b < 6
+    constexpr uint64_t BitClearPatterns[6] = {
+        0x5555555555555555ULL,
+        0x3333333333333333ULL,
+        0x0F0F0F0F0F0F0F0FULL,
+        0x00FF00FF00FF00FFULL,
+        0x0000FFFF0000FFFFULL,
+        0x00000000FFFFFFFFULL};
+
+    // all cubes sharing one don't-care mask, one bit per canonical value
+    struct CubeTable
+    {
+        uint32_t mask;
+        std::vector<uint64_t> bits;
+    };
+
+    // calls visit(position) for every set bit, lowest first
+    template <typename Visit>
+    void forEachSetBit(const std::vector<uint64_t> &bits, Visit visit)
+    {
+        for (size_t word = 0; word < bits.size(); word++)
+        {
+            uint64_t remaining = bits[word];
+            while (remaining != 0)
+            {
+                uint64_t lowest = remaining & (~remaining + 1);
+                visit(static_cast<uint32_t>(word * 64 + popcount(lowest - 1)));
+                remaining ^= lowest;
+            }
+        }
+    }
+
+    // calls visit(minterm) for every minterm inside the cube
+    template <typename Visit>
+    void forEachMinterm(const KMapSolver::Implicant &cube, Visit visit)
+    {
+        uint32_t sub = cube.mask;
+        while (true)
+        {
+            visit(cube.value | sub);
+            if (sub == 0)
+            {
+                break;
+            }
+            sub = (sub - 1) & cube.mask;
+        }
+    }
+
+    double secondsSince(const std::chrono::steady_clock::time_point &start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int KMapSolver::Implicant::literalCount(int numVariables) const
+{
+    return numVariables - popcount(mask);
+}
+
+int KMapSolver::Solution::literalCount(int numVariables) const
+{
+    int literals = 0;
+    for (const Implicant &term : cover)
+    {
+        literals += term.literalCount(numVariables);
+    }
+    return literals;
+}
+
+KMapSolver::KMapSolver(int numVariables, const std::vector<uint32_t> &minterms, const std::vector<uint32_t> &dontCares)
+{
+    if (numVariables < 1 || numVariables > MaxVariables)
+    {
+        throw std::invalid_argument("K-map needs 1 to " + std::to_string(MaxVariables) + " variables");
+    }
+    this->numVariables = numVariables;
+    uint64_t rows = 1ULL << numVariables;
+    onSet.assign((rows + 63) / 64, 0);
+    dontCareSet.assign(onSet.size(), 0);
+    for (uint32_t minterm : minterms)
+    {
+        if (minterm >= rows)
+        {
+            throw std::invalid_argument("Minterm " + std::to_string(minterm) + " out of range");
+        }
+        onSet[minterm / 64] |= 1ULL << (minterm % 64);
+    }
+    for (uint32_t dontCare : dontCares)
+    {
+        if (dontCare >= rows)
+        {
+            throw std::invalid_argument("Don't-care " + std::to_string(dontCare) + " out of range");
+        }
+        if ((onSet[dontCare / 64] >> (dontCare % 64)) & 1)
+        {
+            throw std::invalid_argument("Minterm " + std::to_string(dontCare) + " is also listed as a don't-care");
+        }
+        dontCareSet[dontCare / 64] |= 1ULL << (dontCare % 64);
+    }
+
+    // A is the most significant variable
+    std::vector<std::string> defaultNames(numVariables);
+    for (int bit = 0; bit < numVariables; bit++)
+    {
+        defaultNames[bit] = std::string(1, static_cast<char>('A' + (numVariables - 1 - bit) % 26));
+        if (numVariables > 26)
+        {
+            defaultNames[bit] = "x" + std::to_string(bit);
+        }
+    }
+    setVariableNames(defaultNames);
+}
+
+KMapSolver KMapSolver::fromOutputs(const std::vector<bool> &outputs)
+{
+    int numVariables = 0;
+    while ((1ULL << numVariables) < outputs.size())
+    {
+        numVariables++;
+    }
+    if (outputs.size() < 2 || (1ULL << numVariables) != outputs.size())
+    {
+        throw std::invalid_argument("Output count must be a power of two");
+    }
+    std::vector<uint32_t> minterms;
+    for (uint32_t row = 0; row < outputs.size(); row++)
+    {
+        if (outputs[row])
+        {
+            minterms.push_back(row);
+        }
+    }
+    return KMapSolver(numVariables, minterms);
+}
+
+KMapSolver KMapSolver::fromTruthTable(const TruthTable &table)
+{
+    std::vector<bool> outputs;
+    for (const auto &row : table.getRows())
+    {
+        outputs.push_back(row.expectedOutput);
+    }
+    KMapSolver solver = fromOutputs(outputs);
+    std::vector<std::string> columnNames(table.getNumInputs());
+    for (int i = 0; i < table.getNumInputs(); i++)
+    {
+        columnNames[i] = "I" + std::to_string(i);
+    }
+    solver.setVariableNames(columnNames);
+    return solver;
+}
+
+KMapSolver KMapSolver::fromTruthTable(const PackedTruthTable &table)
+{
+    if (table.getNumInputs() > MaxVariables)
+    {
+        throw std::invalid_argument("K-map needs 1 to " + std::to_string(MaxVariables) + " variables");
+    }
+    std::vector<uint32_t> minterms;
+    forEachSetBit(table.getExpectedWords(), [&minterms](uint32_t row)
+                  { minterms.push_back(row); });
+    KMapSolver solver(table.getNumInputs(), minterms);
+    std::vector<std::string> columnNames(table.getNumInputs());
+    for (int i = 0; i < table.getNumInputs(); i++)
+    {
+        columnNames[i] = "I" + std::to_string(i);
+    }
+    solver.setVariableNames(columnNames);
+    return solver;
+}
+
+void KMapSolver::setVariableNames(const std::vector<std::string> &variableNames)
+{
+    if (variableNames.size() != static_cast<size_t>(numVariables))
+    {
+        throw std::invalid_argument("Need one name per variable");
+    }
+    names = variableNames;
+}
+
+// prime implicants
+
+std::vector<KMapSolver::Implicant> KMapSolver::findPrimes(const std::vector<uint64_t> &ones, ThreadPool *pool) const
+{
+    const size_t words = ones.size();
+    std::vector<CubeTable> bucket;
+    bucket.push_back({0, ones});
+    for (size_t word = 0; word < words; word++)
+    {
+        bucket[0].bits[word] |= dontCareSet[word];
+    }
+
+    std::vector<Implicant> primes;
+    // bucket d holds the masks with d don't-care positions
+    while (!bucket.empty())
+    {
+        std::vector<std::vector<CubeTable>> produced(bucket.size());
+        std::vector<std::vector<Implicant>> found(bucket.size());
+        std::function<void(size_t, size_t)> body = [&](size_t begin, size_t end)
+        {
+            std::vector<uint64_t> combined(words);
+            for (size_t index = begin; index < end; index++)
+            {
+                const CubeTable &table = bucket[index];
+                const std::vector<uint64_t> &bits = table.bits;
+                std::fill(combined.begin(), combined.end(), 0);
+                // only merge past the highest eliminated variable, so every mask is built by one table
+                int top = -1;
+                for (int bit = 0; bit < numVariables; bit++)
+                {
+                    if (table.mask & (1u << bit))
+                    {
+                        top = bit;
+                    }
+                }
+
+                for (int bit = 0; bit < numVariables; bit++)
+                {
+                    if (table.mask & (1u << bit))
+                    {
+                        continue;
+                    }
+                    bool emit = bit > top;
+                    std::vector<uint64_t> merged(emit ? words : 0);
+                    uint64_t any = 0;
+                    if (bit < 6)
+                    {
+                        // partners sit in the same word, `shift` positions apart
+                        int shift = 1 << bit;
+                        for (size_t word = 0; word < words; word++)
+                        {
+                            uint64_t pair = bits[word] & (bits[word] >> shift) & BitClearPatterns[bit];
+                            combined[word] |= pair | (pair << shift);
+                            if (emit)
+                            {
+                                merged[word] = pair;
+                                any |= pair;
+                            }
+                        }
+                    }
+                    else
+                    {
+                        // partners sit `stride` words apart
+                        size_t stride = size_t(1) << (bit - 6);
+                        for (size_t word = 0; word < words; word++)
+                        {
+                            if (word & stride)
+                            {
+                                continue;
+                            }
+                            uint64_t pair = bits[word] & bits[word + stride];
+                            combined[word] |= pair;
+                            combined[word + stride] |= pair;
+                            if (emit)
+                            {
+                                merged[word] = pair;
+                                any |= pair;
+                            }
+                        }
+                    }
+                    if (any != 0)
+                    {
+                        produced[index].push_back({table.mask | (1u << bit), std::move(merged)});
+                    }
+                }
+
+                // cubes that merged with nothing are prime
+                for (size_t word = 0; word < words; word++)
+                {
+                    combined[word] = bits[word] & ~combined[word];
+                }
+                uint32_t mask = table.mask;
+                forEachSetBit(combined, [&](uint32_t value)
+                              { found[index].push_back({value, mask}); });
+            }
+        };
+        if (pool != nullptr && bucket.size() > 1)
+        {
+            pool->parallelFor(bucket.size(), 1, body);
+        }
+        else
+        {
+            body(0, bucket.size());
+        }
+
+        std::vector<CubeTable> next;
+        for (size_t index = 0; index < bucket.size(); index++)
+        {
+            primes.insert(primes.end(), found[index].begin(), found[index].end());
+            for (CubeTable &table : produced[index])
+            {
+                next.push_back(std::move(table));
+            }
+        }
+        bucket = std::move(next);
+    }
+    return primes;
+}
+
+// covering
+
+std::vector<KMapSolver::Implicant> KMapSolver::selectCover(const std::vector<uint64_t> &ones, const std::vector<Implicant> &primes, size_t &essentialCount) const
+{
+    // number the minterms to cover
+    std::vector<int32_t> mintermIndex(ones.size() * 64, -1);
+    uint32_t mintermCount = 0;
+    forEachSetBit(ones, [&](uint32_t minterm)
+                  { mintermIndex[minterm] = static_cast<int32_t>(mintermCount++); });
+
+    // CSR both ways: prime -> minterms it covers, minterm -> primes covering it
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> primeOffsets{0};
+    std::vector<uint32_t> primeMinterms;
+    std::vector<uint32_t> coverCount(mintermCount, 0);
+    for (uint32_t p = 0; p < primes.size(); p++)
+    {
+        size_t before = primeMinterms.size();
+        forEachMinterm(primes[p], [&](uint32_t minterm)
+                       {
+            if (mintermIndex[minterm] >= 0)
+            {
+                primeMinterms.push_back(mintermIndex[minterm]);
+                coverCount[mintermIndex[minterm]]++;
+            } });
+        // primes made only of don't-cares never help
+        if (primeMinterms.size() == before)
+        {
+            continue;
+        }
+        candidates.push_back(p);
+        primeOffsets.push_back(static_cast<uint32_t>(primeMinterms.size()));
+    }
+    std::vector<uint32_t> mintermOffsets(mintermCount + 1, 0);
+    for (uint32_t m = 0; m < mintermCount; m++)
+    {
+        mintermOffsets[m + 1] = mintermOffsets[m] + coverCount[m];
+    }
+    std::vector<uint32_t> mintermPrimes(mintermOffsets.back());
+    std::vector<uint32_t> fill(mintermOffsets.begin(), mintermOffsets.end() - 1);
+    for (uint32_t c = 0; c < candidates.size(); c++)
+    {
+        for (uint32_t i = primeOffsets[c]; i < primeOffsets[c + 1]; i++)
+        {
+            mintermPrimes[fill[primeMinterms[i]]++] = c;
+        }
+    }
+
+    // gain[c] = minterms candidate c would newly cover
+    std::vector<uint32_t> gain(candidates.size());
+    for (uint32_t c = 0; c < candidates.size(); c++)
+    {
+        gain[c] = primeOffsets[c + 1] - primeOffsets[c];
+    }
+    std::vector<char> covered(mintermCount, 0);
+    std::vector<char> chosen(candidates.size(), 0);
+    std::vector<uint32_t> picks;
+    uint32_t uncovered = mintermCount;
+    auto choose = [&](uint32_t c)
+    {
+        chosen[c] = 1;
+        picks.push_back(c);
+        for (uint32_t i = primeOffsets[c]; i < primeOffsets[c + 1]; i++)
+        {
+            uint32_t m = primeMinterms[i];
+            if (covered[m])
+            {
+                continue;
+            }
+            covered[m] = 1;
+            uncovered--;
+            for (uint32_t j = mintermOffsets[m]; j < mintermOffsets[m + 1]; j++)
+            {
+                gain[mintermPrimes[j]]--;
+            }
+        }
+    };
+
+    // essential primes: the only cover of some minterm
+    for (uint32_t m = 0; m < mintermCount; m++)
+    {
+        if (mintermOffsets[m + 1] - mintermOffsets[m] == 1 && !chosen[mintermPrimes[mintermOffsets[m]]])
+        {
+            choose(mintermPrimes[mintermOffsets[m]]);
+        }
+    }
+    essentialCount = picks.size();
+
+    // greedy on the rest: most new minterms first, fewer literals on a tie
+    // gains only ever drop, so a heap entry whose gain is still current is the true best
+    using Entry = std::tuple<uint32_t, int, uint32_t>; // gain, -literals, candidate
+    std::priority_queue<Entry> heap;
+    for (uint32_t c = 0; c < candidates.size(); c++)
+    {
+        if (gain[c] > 0)
+        {
+            heap.emplace(gain[c], -primes[candidates[c]].literalCount(numVariables), c);
+        }
+    }
+    while (uncovered > 0)
+    {
+        auto [stored, negLiterals, c] = heap.top();
+        heap.pop();
+        if (stored != gain[c])
+        {
+            if (gain[c] > 0)
+            {
+                heap.emplace(gain[c], negLiterals, c);
+            }
+            continue;
+        }
+        choose(c);
+    }
+
+    // a greedy pick can become redundant once later picks cover its minterms
+    std::vector<uint32_t> timesCovered(mintermCount, 0);
+    for (uint32_t c : picks)
+    {
+        for (uint32_t i = primeOffsets[c]; i < primeOffsets[c + 1]; i++)
+        {
+            timesCovered[primeMinterms[i]]++;
+        }
+    }
+    for (size_t k = picks.size(); k-- > essentialCount;)
+    {
+        uint32_t c = picks[k];
+        bool redundant = true;
+        for (uint32_t i = primeOffsets[c]; i < primeOffsets[c + 1] && redundant; i++)
+        {
+            redundant = timesCovered[primeMinterms[i]] > 1;
+        }
+        if (redundant)
+        {
+            chosen[c] = 0;
+            for (uint32_t i = primeOffsets[c]; i < primeOffsets[c + 1]; i++)
+            {
+                timesCovered[primeMinterms[i]]--;
+            }
+        }
+    }
+
+    std::vector<Implicant> cover;
+    for (uint32_t c : picks)
+    {
+        if (chosen[c])
+        {
+            cover.push_back(primes[candidates[c]]);
+        }
+    }
+    return cover;
+}
+
+// minimization
+
+KMapSolver::Solution KMapSolver::minimize(const std::vector<uint64_t> &ones, ThreadPool *pool) const
+{
+    Solution solution;
+    auto start = std::chrono::steady_clock::now();
+    solution.primes = findPrimes(ones, pool);
+    solution.primeSeconds = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    solution.cover = selectCover(ones, solution.primes, solution.essentialCount);
+    solution.coverSeconds = secondsSince(start);
+    return solution;
+}
+
+std::vector<uint64_t> KMapSolver::offSet() const
+{
+    std::vector<uint64_t> zeros(onSet.size());
+    uint64_t rows = 1ULL << numVariables;
+    for (size_t word = 0; word < zeros.size(); word++)
+    {
+        zeros[word] = ~(onSet[word] | dontCareSet[word]);
+    }
+    if (rows < 64)
+    {
+        zeros[0] &= (1ULL << rows) - 1;
+    }
+    return zeros;
+}
+
+KMapSolver::Solution KMapSolver::minimizeSop(ThreadPool *pool) const
+{
+    return minimize(onSet, pool);
+}
+
+KMapSolver::Solution KMapSolver::minimizePos(ThreadPool *pool) const
+{
+    // the sums of a POS are the complemented products of the zeros
+    Solution solution = minimize(offSet(), pool);
+    solution.productOfSums = true;
+    return solution;
+}
+
+bool KMapSolver::verify(const Solution &solution) const
+{
+    std::vector<uint64_t> covered(onSet.size(), 0);
+    for (const Implicant &term : solution.cover)
+    {
+        forEachMinterm(term, [&covered](uint32_t minterm)
+                       { covered[minterm / 64] |= 1ULL << (minterm % 64); });
+    }
+    std::vector<uint64_t> target = solution.productOfSums ? offSet() : onSet;
+    for (size_t word = 0; word < covered.size(); word++)
+    {
+        if ((covered[word] ^ target[word]) & ~dontCareSet[word])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// formatting
+
+std::string KMapSolver::toString(const Solution &solution) const
+{
+    if (solution.cover.empty())
+    {
+        // no ones means 0 as a sum, no zeros means 1 as a product
+        return solution.productOfSums ? "1" : "0";
+    }
+
+    // literals in name order, single-letter names run together like AB'C
+    std::vector<int> order(numVariables);
+    for (int bit = 0; bit < numVariables; bit++)
+    {
+        order[bit] = bit;
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b)
+              { return names[a].size() != names[b].size() ? names[a].size() < names[b].size() : names[a] < names[b]; });
+    bool singleLetters = std::all_of(names.begin(), names.end(), [](const std::string &name)
+                                     { return name.size() == 1; });
+
+    // terms in literal order too, so SOP and POS list the variables the same way
+    struct Term
+    {
+        std::vector<std::pair<int, bool>> key; // (position in order, complemented) per literal
+        std::string text;
+        size_t literals;
+    };
+    std::vector<Term> terms;
+    for (const Implicant &implicant : solution.cover)
+    {
+        Term term;
+        std::vector<std::string> literals;
+        for (size_t position = 0; position < order.size(); position++)
+        {
+            int bit = order[position];
+            if (implicant.mask & (1u << bit))
+            {
+                continue;
+            }
+            bool set = (implicant.value >> bit) & 1;
+            // a zero cube contributes its complement to the sum
+            bool complemented = solution.productOfSums ? set : !set;
+            literals.push_back(names[bit] + (complemented ? "'" : ""));
+            term.key.emplace_back(static_cast<int>(position), complemented);
+        }
+        for (size_t i = 0; i < literals.size(); i++)
+        {
+            if (i > 0)
+            {
+                term.text += solution.productOfSums ? " + " : (singleLetters ? "" : " ");
+            }
+            term.text += literals[i];
+        }
+        term.literals = literals.size();
+        terms.push_back(std::move(term));
+    }
+    std::stable_sort(terms.begin(), terms.end(), [](const Term &a, const Term &b)
+                     { return a.key < b.key; });
+
+    std::string text;
+    for (size_t t = 0; t < terms.size(); t++)
+    {
+        const Term &term = terms[t];
+        if (solution.productOfSums)
+        {
+            // factors run together like A'(B + C) only when every name is one letter
+            text += t > 0 && !singleLetters ? " " : "";
+            text += term.literals == 0 ? "0" : (term.literals == 1 ? term.text : "(" + term.text + ")");
+        }
+        else
+        {
+            text += (t > 0 ? " + " : "") + (term.literals == 0 ? std::string("1") : term.text);
+        }
+    }
+    return text;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+class TruthTable;
+class PackedTruthTable;
+
+// Two-level minimizer (Quine-McCluskey) for K-map style problems.
+// Minterm m sets variable i when bit i of m is set. Default names are A, B, C, ...
+// with A the most significant bit, so m5 over ABC is A B' C as in the textbooks.
+//
+// Prime implicants come from bitset implicant tables: every set of cubes sharing the
+// same don't-care mask is one bitset over the 2^n minterm positions, and merging along
+// a variable is a shift-and-AND of that bitset. The masks are bucketed by their number
+// of don't-care positions; all masks in a bucket merge independently, so a bucket is
+// spread over the thread pool when one is given.
+class KMapSolver
+{
+public:
+    // bitset tables take 2^n bits each
+    static constexpr int MaxVariables = 20;
+
+    // a product term: bits set in `mask` are eliminated variables, `value` holds the rest
+    struct Implicant
+    {
+        uint32_t value;
+        uint32_t mask;
+
+        bool covers(uint32_t minterm) const { return (minterm & ~mask) == value; }
+        int literalCount(int numVariables) const;
+        bool operator==(const Implicant &other) const { return value == other.value && mask == other.mask; }
+    };
+
+    struct Solution
+    {
+        // true for a POS solution, whose implicants describe the zeros of the function
+        bool productOfSums = false;
+        std::vector<Implicant> primes;
+        std::vector<Implicant> cover;
+        size_t essentialCount = 0;
+        double primeSeconds = 0;
+        double coverSeconds = 0;
+
+        int literalCount(int numVariables) const;
+    };
+
+    KMapSolver(int numVariables, const std::vector<uint32_t> &minterms, const std::vector<uint32_t> &dontCares = {});
+    // outputs[row] is the function value of minterm `row`
+    static KMapSolver fromOutputs(const std::vector<bool> &outputs);
+    // minimizes the expected outputs, variables named I0, I1, ... like the table columns
+    static KMapSolver fromTruthTable(const TruthTable &table);
+    static KMapSolver fromTruthTable(const PackedTruthTable &table);
+
+    // names[i] is the name of variable i (bit i of a minterm)
+    void setVariableNames(const std::vector<std::string> &variableNames);
+    const std::vector<std::string> &getVariableNames() const { return names; }
+    int getNumVariables() const { return numVariables; }
+
+    Solution minimizeSop(ThreadPool *pool = nullptr) const;
+    Solution minimizePos(ThreadPool *pool = nullptr) const;
+
+    std::string toString(const Solution &solution) const;
+    // true if the cover matches the function on every row that is not a don't-care
+    bool verify(const Solution &solution) const;
+
+private:
+    int numVariables;
+    // one bit per minterm
+    std::vector<uint64_t> onSet;
+    std::vector<uint64_t> dontCareSet;
+    std::vector<std::string> names;
+
+    Solution minimize(const std::vector<uint64_t> &ones, ThreadPool *pool) const;
+    std::vector<Implicant> findPrimes(const std::vector<uint64_t> &ones, ThreadPool *pool) const;
+    // essential primes, then greedy covering, then redundant terms removed
+    std::vector<Implicant> selectCover(const std::vector<uint64_t> &ones, const std::vector<Implicant> &primes, size_t &essentialCount) const;
+    std::vector<uint64_t> offSet() const;
+};
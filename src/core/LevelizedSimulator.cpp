@@ -0,0 +1,731 @@
+#include "LevelizedSimulator.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include "GateKernels.h"
+
+namespace
+{
+    // node values a wide run may spread over before it falls back to narrower lanes
+    const size_t WideCacheBytes = 2 << 20;
+}
+
+LevelizedSimulator::LevelizedSimulator(const Circuit &circuit) : circuit(circuit)
+{
+    if (!circuit.isFrozen())
+    {
+        throw std::logic_error("LevelizedSimulator: circuit must be frozen first");
+    }
+    if (circuit.hasStateElements())
+    {
+        throw std::invalid_argument("LevelizedSimulator: circuit has flip-flops or latches, use SequentialSimulator");
+    }
+    values.assign(circuit.getNodeCount(), 0);
+    dirty.assign(circuit.getNodeCount(), 0);
+    levelize();
+    compileProgram();
+    dirtyLevels.resize(getLevelCount());
+}
+
+LevelizedSimulator::LevelizedSimulator(const Circuit &circuit, Compiled compiled)
+    : circuit(circuit), levels(std::move(compiled.levels)), order(std::move(compiled.order)),
+      levelOffsets(std::move(compiled.levelOffsets)), program(std::move(compiled.program)),
+      segments(std::move(compiled.segments))
+{
+    if (!circuit.isFrozen())
+    {
+        throw std::logic_error("LevelizedSimulator: circuit must be frozen first");
+    }
+    if (circuit.hasStateElements())
+    {
+        throw std::invalid_argument("LevelizedSimulator: circuit has flip-flops or latches, use SequentialSimulator");
+    }
+    validateCompiled();
+    values.assign(circuit.getNodeCount(), 0);
+    dirty.assign(circuit.getNodeCount(), 0);
+    dirtyLevels.resize(getLevelCount());
+}
+
+void LevelizedSimulator::levelize()
+{
+    // Kahn's algorithm from the primary inputs, a gate's depth is one more than its deepest fan-in
+    const uint32_t numNodes = circuit.getNodeCount();
+    levels.assign(numNodes, 0);
+    std::vector<uint32_t> pending(numNodes);
+    std::vector<Circuit::NodeId> ready(circuit.getInputs().begin(), circuit.getInputs().end());
+    for (Circuit::NodeId node = 0; node < numNodes; node++)
+    {
+        pending[node] = circuit.getFaninCount(node);
+    }
+
+    uint32_t maxLevel = 0;
+    size_t visitedGates = 0;
+    for (size_t next = 0; next < ready.size(); next++)
+    {
+        Circuit::NodeId node = ready[next];
+        const Circuit::NodeId *fanout = circuit.getFanout(node);
+        for (uint32_t i = 0; i < circuit.getFanoutCount(node); i++)
+        {
+            Circuit::NodeId sink = fanout[i];
+            if (levels[sink] < levels[node] + 1)
+            {
+                levels[sink] = levels[node] + 1;
+            }
+            if (--pending[sink] == 0)
+            {
+                ready.push_back(sink);
+                visitedGates++;
+                if (levels[sink] > maxLevel)
+                {
+                    maxLevel = levels[sink];
+                }
+            }
+        }
+    }
+    if (visitedGates != circuit.getGateCount())
+    {
+        throw std::runtime_error("LevelizedSimulator: circuit has a combinational loop");
+    }
+
+    // counting sort by depth, level l holds the gates at depth l + 1
+    levelOffsets.assign(maxLevel + 1, 0);
+    for (Circuit::NodeId node = 0; node < numNodes; node++)
+    {
+        if (!circuit.isInput(node))
+        {
+            levelOffsets[levels[node]]++;
+        }
+    }
+    for (uint32_t level = 1; level <= maxLevel; level++)
+    {
+        levelOffsets[level] += levelOffsets[level - 1];
+    }
+    order.resize(circuit.getGateCount());
+    std::vector<uint32_t> cursor(levelOffsets.begin(), levelOffsets.end() - 1);
+    for (Circuit::NodeId node = 0; node < numNodes; node++)
+    {
+        if (!circuit.isInput(node))
+        {
+            order[cursor[levels[node] - 1]++] = node;
+        }
+    }
+    // group the gates of each level by type, evaluation order inside a level does not matter
+    for (uint32_t level = 0; level < getLevelCount(); level++)
+    {
+        std::stable_sort(order.begin() + levelOffsets[level], order.begin() + levelOffsets[level + 1],
+                         [this](Circuit::NodeId a, Circuit::NodeId b)
+                         { return circuit.getTypeCode(a) < circuit.getTypeCode(b); });
+    }
+}
+
+void LevelizedSimulator::compileProgram()
+{
+    program.clear();
+    segments.clear();
+    program.reserve(order.size() * 2 + circuit.getFaninOffsets()[circuit.getNodeCount()]);
+    for (uint32_t level = 0; level < getLevelCount(); level++)
+    {
+        for (uint32_t i = levelOffsets[level]; i < levelOffsets[level + 1]; i++)
+        {
+            Circuit::NodeId node = order[i];
+            GateType type = circuit.getGateType(node);
+            // a new segment starts at every level boundary and every type change
+            if (i == levelOffsets[level] || segments.back().type != type)
+            {
+                segments.push_back(Segment{type, 0, program.size()});
+            }
+            segments.back().gates++;
+            program.push_back(node);
+            program.push_back(circuit.getFaninCount(node));
+            program.insert(program.end(), circuit.getFanin(node), circuit.getFanin(node) + circuit.getFaninCount(node));
+        }
+    }
+}
+
+void LevelizedSimulator::validateCompiled() const
+{
+    const uint32_t numNodes = circuit.getNodeCount();
+    if (levels.size() != numNodes || order.size() != circuit.getGateCount() || levelOffsets.empty() || levelOffsets.front() != 0 ||
+        levelOffsets.back() != order.size() || program.size() != order.size() * 2 + circuit.getFaninOffsets()[numNodes])
+    {
+        throw std::invalid_argument("LevelizedSimulator: compiled form does not match the circuit");
+    }
+    for (size_t level = 1; level < levelOffsets.size(); level++)
+    {
+        if (levelOffsets[level] < levelOffsets[level - 1])
+        {
+            throw std::invalid_argument("LevelizedSimulator: compiled levels out of order");
+        }
+    }
+    for (Circuit::NodeId input : circuit.getInputs())
+    {
+        if (levels[input] != 0)
+        {
+            throw std::invalid_argument("LevelizedSimulator: compiled level of an input is not 0");
+        }
+    }
+
+    // the segments must cover the program back to back, each inside one level, and every
+    // entry must be the gate of that slot of the order with its exact fan-in
+    std::vector<uint8_t> seen(numNodes, 0);
+    size_t pc = 0;
+    size_t gate = 0;
+    uint32_t level = 0;
+    auto reject = [](const char *what)
+    { throw std::invalid_argument(std::string("LevelizedSimulator: compiled ") + what + " does not match the circuit"); };
+    for (const Segment &segment : segments)
+    {
+        while (level + 1 < levelOffsets.size() && levelOffsets[level + 1] <= gate)
+        {
+            level++;
+        }
+        if (segment.programOffset != pc || segment.gates == 0 || level + 1 >= levelOffsets.size() ||
+            segment.gates > levelOffsets[level + 1] - gate)
+        {
+            reject("segment");
+        }
+        for (uint32_t g = 0; g < segment.gates; g++, gate++)
+        {
+            Circuit::NodeId node = program[pc];
+            if (node != order[gate] || node >= numNodes || circuit.isInput(node) || seen[node] ||
+                circuit.getGateType(node) != segment.type || levels[node] != level + 1)
+            {
+                reject("gate order");
+            }
+            seen[node] = 1;
+            uint32_t count = program[pc + 1];
+            if (count != circuit.getFaninCount(node) || program.size() - pc - 2 < count ||
+                !std::equal(program.begin() + pc + 2, program.begin() + pc + 2 + count, circuit.getFanin(node)))
+            {
+                reject("fan-in");
+            }
+            for (uint32_t pin = 0; pin < count; pin++)
+            {
+                // fan-ins are checked once their own slot comes up, so this holds for all of them at the end
+                if (levels[circuit.getFanin(node)[pin]] >= levels[node])
+                {
+                    reject("level");
+                }
+            }
+            pc += 2 + count;
+        }
+    }
+    if (gate != order.size() || pc != program.size())
+    {
+        reject("program");
+    }
+}
+
+template <GateType Type>
+const uint32_t *LevelizedSimulator::runSegment(const uint32_t *pc, uint32_t gates, uint64_t *values)
+{
+    for (uint32_t g = 0; g < gates; g++)
+    {
+        uint32_t count = pc[1];
+        values[pc[0]] = evaluateTypedWord<Type>(values, pc + 2, count);
+        pc += 2 + count;
+    }
+    return pc;
+}
+
+template <GateType Type>
+const uint32_t *LevelizedSimulator::runLogicSegment(const uint32_t *pc, uint32_t gates, uint64_t *values, uint64_t *unknowns)
+{
+    for (uint32_t g = 0; g < gates; g++)
+    {
+        uint32_t count = pc[1];
+        LogicWord word = evaluateTypedLogicWord<Type>(values, unknowns, pc + 2, count);
+        values[pc[0]] = word.value;
+        unknowns[pc[0]] = word.unknown;
+        pc += 2 + count;
+    }
+    return pc;
+}
+
+void LevelizedSimulator::setInputWord(uint32_t inputIndex, uint64_t lanes)
+{
+    if (inputIndex >= circuit.getInputCount())
+    {
+        throw std::out_of_range("LevelizedSimulator: input index out of range");
+    }
+    setInputNode(circuit.getInputs()[inputIndex], lanes);
+}
+
+void LevelizedSimulator::setInputNode(Circuit::NodeId input, uint64_t lanes)
+{
+    if (input >= circuit.getNodeCount() || !circuit.isInput(input))
+    {
+        throw std::invalid_argument("LevelizedSimulator: node is not a primary input");
+    }
+    if (!unknowns.empty())
+    {
+        setInputNodeLogic(input, LogicWord{lanes, 0});
+        return;
+    }
+    if (values[input] != lanes)
+    {
+        values[input] = lanes;
+        markFanoutDirty(input);
+    }
+}
+
+void LevelizedSimulator::setInputLogic(uint32_t inputIndex, LogicWord lanes)
+{
+    if (inputIndex >= circuit.getInputCount())
+    {
+        throw std::out_of_range("LevelizedSimulator: input index out of range");
+    }
+    setInputNodeLogic(circuit.getInputs()[inputIndex], lanes);
+}
+
+void LevelizedSimulator::setInputNodeLogic(Circuit::NodeId input, LogicWord lanes)
+{
+    if (logicMode != LogicMode::FourValued)
+    {
+        throw std::logic_error("LevelizedSimulator: X and Z inputs need four-valued mode");
+    }
+    if (input >= circuit.getNodeCount() || !circuit.isInput(input))
+    {
+        throw std::invalid_argument("LevelizedSimulator: node is not a primary input");
+    }
+    if (values[input] != lanes.value || unknowns[input] != lanes.unknown)
+    {
+        values[input] = lanes.value;
+        unknowns[input] = lanes.unknown;
+        markFanoutDirty(input);
+    }
+}
+
+void LevelizedSimulator::setLogicMode(LogicMode mode)
+{
+    if (mode == logicMode)
+    {
+        return;
+    }
+    logicMode = mode;
+    if (mode == LogicMode::FourValued)
+    {
+        // nothing has been driven yet in four-valued terms
+        std::fill(values.begin(), values.end(), 0);
+        unknowns.assign(circuit.getNodeCount(), ~0ULL);
+    }
+    else
+    {
+        std::vector<uint64_t>().swap(unknowns);
+    }
+    clearDirty();
+    settled = false;
+}
+
+Logic LevelizedSimulator::getLogic(Circuit::NodeId node, int lane) const
+{
+    return logicAt(getLogicWord(node), lane);
+}
+
+void LevelizedSimulator::markFanoutDirty(Circuit::NodeId node)
+{
+    const Circuit::NodeId *fanout = circuit.getFanout(node);
+    for (uint32_t i = 0; i < circuit.getFanoutCount(node); i++)
+    {
+        Circuit::NodeId sink = fanout[i];
+        if (!dirty[sink])
+        {
+            dirty[sink] = 1;
+            dirtyLevels[levels[sink] - 1].push_back(sink);
+        }
+    }
+}
+
+void LevelizedSimulator::clearDirty()
+{
+    for (auto &bucket : dirtyLevels)
+    {
+        for (Circuit::NodeId node : bucket)
+        {
+            dirty[node] = 0;
+        }
+        bucket.clear();
+    }
+}
+
+void LevelizedSimulator::update()
+{
+    updateStats.updates++;
+    updateStats.gatesChanged = 0;
+    if (!settled)
+    {
+        evaluate();
+        updateStats.gatesEvaluated = order.size();
+        updateStats.totalEvaluated += order.size();
+        return;
+    }
+
+    uint64_t evaluated = logicMode == LogicMode::FourValued ? propagateDirty<true>() : propagateDirty<false>();
+    updateStats.gatesEvaluated = evaluated;
+    updateStats.totalEvaluated += evaluated;
+}
+
+template <bool FourValued>
+uint64_t LevelizedSimulator::propagateDirty()
+{
+    const uint8_t *types = circuit.getTypeCodes();
+    const uint32_t *faninOffsets = circuit.getFaninOffsets();
+    const Circuit::NodeId *faninIds = circuit.getFaninIds();
+    uint64_t evaluated = 0;
+    // a gate only ever dirties gates on deeper levels, so one pass from the bottom is enough
+    for (auto &bucket : dirtyLevels)
+    {
+        for (size_t i = 0; i < bucket.size(); i++)
+        {
+            Circuit::NodeId node = bucket[i];
+            dirty[node] = 0;
+            uint32_t first = faninOffsets[node];
+            GateType type = static_cast<GateType>(types[node]);
+            bool changed;
+            if constexpr (FourValued)
+            {
+                LogicWord word = evaluateGateLogicWord(type, values.data(), unknowns.data(), faninIds + first, faninOffsets[node + 1] - first);
+                changed = word.value != values[node] || word.unknown != unknowns[node];
+                values[node] = word.value;
+                unknowns[node] = word.unknown;
+            }
+            else
+            {
+                uint64_t word = evaluateGateWord(type, values.data(), faninIds + first, faninOffsets[node + 1] - first);
+                changed = word != values[node];
+                values[node] = word;
+            }
+            evaluated++;
+            if (changed)
+            {
+                updateStats.gatesChanged++;
+                markFanoutDirty(node);
+            }
+        }
+        bucket.clear();
+    }
+    return evaluated;
+}
+
+void LevelizedSimulator::loadInputs(const Circuit &source)
+{
+    for (Circuit::NodeId node : circuit.getInputs())
+    {
+        setInputNode(node, source.getValue(node) ? ~0ULL : 0);
+    }
+}
+
+void LevelizedSimulator::evaluate()
+{
+    if (logicMode == LogicMode::FourValued)
+    {
+        evaluateLogic();
+        return;
+    }
+    // one type switch per segment, the loop inside runs without any dispatch
+    uint64_t *data = values.data();
+    for (const Segment &segment : segments)
+    {
+        runTyped(segment.type, program.data() + segment.programOffset, segment.gates, data);
+    }
+    // a full sweep leaves nothing dirty
+    clearDirty();
+    settled = true;
+}
+
+void LevelizedSimulator::evaluateLogic()
+{
+    uint64_t *data = values.data();
+    uint64_t *unknownData = unknowns.data();
+    for (const Segment &segment : segments)
+    {
+        runTypedLogic(segment.type, program.data() + segment.programOffset, segment.gates, data, unknownData);
+    }
+    clearDirty();
+    settled = true;
+}
+
+const uint32_t *LevelizedSimulator::runTyped(GateType type, const uint32_t *pc, uint32_t gates, uint64_t *data)
+{
+    switch (type)
+    {
+    case GateType::And:
+        return runSegment<GateType::And>(pc, gates, data);
+    case GateType::Nand:
+        return runSegment<GateType::Nand>(pc, gates, data);
+    case GateType::Or:
+        return runSegment<GateType::Or>(pc, gates, data);
+    case GateType::Nor:
+        return runSegment<GateType::Nor>(pc, gates, data);
+    case GateType::Xor:
+        return runSegment<GateType::Xor>(pc, gates, data);
+    case GateType::Xnor:
+        return runSegment<GateType::Xnor>(pc, gates, data);
+    case GateType::Not:
+        return runSegment<GateType::Not>(pc, gates, data);
+    // two-valued, a released driver is 0 (see GateKernels.h)
+    case GateType::TriState:
+    case GateType::TransmissionGate:
+    case GateType::WiredAnd:
+        return runSegment<GateType::And>(pc, gates, data);
+    case GateType::WiredOr:
+    case GateType::Bus:
+        return runSegment<GateType::Or>(pc, gates, data);
+    default:
+        return runSegment<GateType::Buffer>(pc, gates, data);
+    }
+}
+
+const uint32_t *LevelizedSimulator::runTypedLogic(GateType type, const uint32_t *pc, uint32_t gates, uint64_t *data, uint64_t *unknownData)
+{
+    switch (type)
+    {
+    case GateType::And:
+        return runLogicSegment<GateType::And>(pc, gates, data, unknownData);
+    case GateType::Nand:
+        return runLogicSegment<GateType::Nand>(pc, gates, data, unknownData);
+    case GateType::Or:
+        return runLogicSegment<GateType::Or>(pc, gates, data, unknownData);
+    case GateType::Nor:
+        return runLogicSegment<GateType::Nor>(pc, gates, data, unknownData);
+    case GateType::Xor:
+        return runLogicSegment<GateType::Xor>(pc, gates, data, unknownData);
+    case GateType::Xnor:
+        return runLogicSegment<GateType::Xnor>(pc, gates, data, unknownData);
+    case GateType::Not:
+        return runLogicSegment<GateType::Not>(pc, gates, data, unknownData);
+    case GateType::TriState:
+        return runLogicSegment<GateType::TriState>(pc, gates, data, unknownData);
+    case GateType::TransmissionGate:
+        return runLogicSegment<GateType::TransmissionGate>(pc, gates, data, unknownData);
+    case GateType::WiredAnd:
+        return runLogicSegment<GateType::WiredAnd>(pc, gates, data, unknownData);
+    case GateType::WiredOr:
+        return runLogicSegment<GateType::WiredOr>(pc, gates, data, unknownData);
+    case GateType::Bus:
+        return runLogicSegment<GateType::Bus>(pc, gates, data, unknownData);
+    default:
+        return runLogicSegment<GateType::Buffer>(pc, gates, data, unknownData);
+    }
+}
+
+void LevelizedSimulator::evaluate(ThreadPool &pool, size_t grain)
+{
+    if (grain == 0)
+    {
+        grain = 1;
+    }
+    if (grain != chunkGrain)
+    {
+        splitLevels(grain);
+    }
+    std::function<void(size_t, size_t)> body;
+    for (uint32_t level = 0; level < getLevelCount(); level++)
+    {
+        size_t first = chunkOffsets[level];
+        size_t count = chunkOffsets[level + 1] - first;
+        if (count == 1)
+        {
+            // narrow levels are cheaper to run inline than to hand out
+            runChunk(chunks[first]);
+            continue;
+        }
+        body = [this, first](size_t begin, size_t end)
+        {
+            for (size_t c = first + begin; c < first + end; c++)
+            {
+                runChunk(chunks[c]);
+            }
+        };
+        pool.parallelFor(count, 1, body);
+    }
+    clearDirty();
+    settled = true;
+}
+
+void LevelizedSimulator::splitLevels(size_t grain)
+{
+    // walks the opcode stream once; a chunk ends after `grain` gates or at the end of its level,
+    // and may cover the tail of one segment, whole segments and the head of another
+    chunks.clear();
+    chunkOffsets.assign(1, 0);
+    uint32_t segment = 0;
+    uint32_t skip = 0;
+    size_t pc = 0;
+    for (uint32_t level = 0; level < getLevelCount(); level++)
+    {
+        uint32_t left = levelOffsets[level + 1] - levelOffsets[level];
+        while (left > 0)
+        {
+            Chunk chunk{segment, skip, static_cast<uint32_t>(std::min<size_t>(grain, left)), pc};
+            // step over the chunk's gates to find where the next one starts
+            for (uint32_t g = 0; g < chunk.gates; g++)
+            {
+                pc += 2 + program[pc + 1];
+                if (++skip == segments[segment].gates)
+                {
+                    segment++;
+                    skip = 0;
+                }
+            }
+            left -= chunk.gates;
+            chunks.push_back(chunk);
+        }
+        chunkOffsets.push_back(static_cast<uint32_t>(chunks.size()));
+    }
+    chunkGrain = grain;
+}
+
+void LevelizedSimulator::runChunk(const Chunk &chunk)
+{
+    uint64_t *data = values.data();
+    uint64_t *unknownData = unknowns.empty() ? nullptr : unknowns.data();
+    const uint32_t *pc = program.data() + chunk.programOffset;
+    uint32_t segment = chunk.segment;
+    uint32_t skip = chunk.skip;
+    for (uint32_t left = chunk.gates; left > 0; segment++, skip = 0)
+    {
+        const Segment &run = segments[segment];
+        uint32_t gates = std::min(left, run.gates - skip);
+        if (skip == 0)
+        {
+            pc = program.data() + run.programOffset;
+        }
+        pc = unknownData ? runTypedLogic(run.type, pc, gates, data, unknownData) : runTyped(run.type, pc, gates, data);
+        left -= gates;
+    }
+}
+
+void LevelizedSimulator::randomizeInputs(uint64_t &state)
+{
+    for (Circuit::NodeId input : circuit.getInputs())
+    {
+        // xorshift64, cheap enough not to show up next to the sweep
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        values[input] = state;
+    }
+    // random inputs are known ones and zeros in either mode
+    if (!unknowns.empty())
+    {
+        for (Circuit::NodeId input : circuit.getInputs())
+        {
+            unknowns[input] = 0;
+        }
+    }
+}
+
+LevelizedSimulator::RunStats LevelizedSimulator::run(uint64_t cycles, uint64_t seed)
+{
+    return runSweeps(cycles, seed, nullptr);
+}
+
+LevelizedSimulator::RunStats LevelizedSimulator::run(uint64_t cycles, ThreadPool &pool, uint64_t seed)
+{
+    return runSweeps(cycles, seed, &pool);
+}
+
+LevelizedSimulator::RunStats LevelizedSimulator::runSweeps(uint64_t cycles, uint64_t seed, ThreadPool *pool)
+{
+    RunStats stats{0, 0, 0};
+    uint64_t state = seed ? seed : 1;
+    auto start = std::chrono::steady_clock::now();
+    // a visit is only cheaper than its sweeps while the wider node array stays in cache,
+    // past that the run is memory-bound and narrower visits win
+    const LaneKernels *widest = &WideLanes::best();
+    while (widest->wordsPerVisit > 1 && circuit.getNodeCount() * widest->wordsPerVisit * sizeof(uint64_t) > WideCacheBytes)
+    {
+        bool avx2 = widest->backend == LaneBackend::Avx512 && WideLanes::isSupported(LaneBackend::Avx2);
+        widest = &WideLanes::get(avx2 ? LaneBackend::Avx2 : LaneBackend::Word64);
+    }
+    const LaneKernels &kernels = *widest;
+    uint64_t sweeps = (cycles + 63) / 64;
+    if (!pool && unknowns.empty() && kernels.wordsPerVisit > 1 && sweeps >= kernels.wordsPerVisit)
+    {
+        // whole visits on the wide backend, the remainder sweep by sweep below
+        uint64_t visits = sweeps / kernels.wordsPerVisit;
+        runWideSweeps(visits, kernels, state);
+        stats.sweeps = visits * kernels.wordsPerVisit;
+        stats.cycles = stats.sweeps * 64;
+        stats.lanesPerVisit = static_cast<uint32_t>(kernels.wordsPerVisit * 64);
+    }
+    while (stats.cycles < cycles)
+    {
+        randomizeInputs(state);
+        if (pool)
+        {
+            evaluate(*pool);
+        }
+        else
+        {
+            evaluate();
+        }
+        stats.sweeps++;
+        stats.cycles += 64;
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+void LevelizedSimulator::runWideSweeps(uint64_t visits, const LaneKernels &kernels, uint64_t &state)
+{
+    const size_t words = kernels.wordsPerVisit;
+    std::vector<uint64_t> wide(circuit.getNodeCount() * words, 0);
+    std::vector<const uint64_t *> pins(1);
+    // the lane kernels only reduce, released drivers read 0 as in the two-valued sweep
+    auto laneType = [](GateType type)
+    {
+        switch (type)
+        {
+        case GateType::TriState:
+        case GateType::TransmissionGate:
+        case GateType::WiredAnd:
+            return GateType::And;
+        case GateType::WiredOr:
+        case GateType::Bus:
+            return GateType::Or;
+        default:
+            return type;
+        }
+    };
+    for (uint64_t visit = 0; visit < visits; visit++)
+    {
+        // word w of every input is what sweep w of the visit would have drawn
+        for (size_t w = 0; w < words; w++)
+        {
+            for (Circuit::NodeId input : circuit.getInputs())
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                wide[input * words + w] = state;
+            }
+        }
+        for (const Segment &segment : segments)
+        {
+            GateType type = laneType(segment.type);
+            const uint32_t *pc = program.data() + segment.programOffset;
+            for (uint32_t g = 0; g < segment.gates; g++)
+            {
+                uint32_t count = pc[1];
+                if (pins.size() < count)
+                {
+                    pins.resize(count);
+                }
+                for (uint32_t pin = 0; pin < count; pin++)
+                {
+                    pins[pin] = wide.data() + size_t(pc[2 + pin]) * words;
+                }
+                kernels.evaluate(type, pins.data(), count, wide.data() + size_t(pc[0]) * words, words);
+                pc += 2 + count;
+            }
+        }
+    }
+    for (Circuit::NodeId node = 0; node < circuit.getNodeCount(); node++)
+    {
+        values[node] = wide[node * words + words - 1];
+    }
+    clearDirty();
+    settled = true;
+}
@@ -0,0 +1,175 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Circuit.h"
+#include "ThreadPool.h"
+#include "WideLanes.h"
+
+// Compiled-code simulation for combinational circuits. The netlist is levelized once
+// and every cycle is a straight-line walk over the gates in level order, with no event
+// queue and no virtual dispatch. Each node holds one uint64_t, so a single sweep
+// simulates 64 independent input vectors (lanes) at once.
+// Within a level the gates are grouped by type and compiled into a packed opcode
+// stream, so a sweep runs one tight loop per (level, type) segment instead of
+// switching on the type of every gate.
+// In four-valued mode every node also has an unknown plane (see LogicWord) and the sweep
+// runs the four-valued kernels instead. The plane only exists in that mode, and the
+// two-valued sweep is untouched, so two-valued simulation costs exactly what it did.
+// Tri-state drivers and resolved buses only show Z and contention in four-valued mode;
+// a two-valued sweep reads a released driver as 0.
+class LevelizedSimulator
+{
+public:
+    struct RunStats
+    {
+        uint64_t cycles; // input vectors simulated, 64 per sweep
+        uint64_t sweeps;
+        double seconds;
+        // lanes per gate visit, 64 unless the sweeps ran on a wide lane backend
+        uint32_t lanesPerVisit = 64;
+        double cyclesPerSecond() const { return seconds > 0 ? cycles / seconds : 0; }
+    };
+
+    // work done by incremental updates
+    struct UpdateStats
+    {
+        uint64_t updates = 0;
+        uint64_t gatesEvaluated = 0; // gates re-evaluated in the last update
+        uint64_t gatesChanged = 0;   // of those, gates whose output word changed
+        uint64_t totalEvaluated = 0; // over all updates
+    };
+
+    // a run of same-typed gates in the opcode stream
+    struct Segment
+    {
+        GateType type;
+        uint32_t gates;
+        size_t programOffset;
+    };
+
+    // everything the constructor derives from the netlist: levelization and the opcode
+    // stream. It depends on the structure alone, so it can be kept (see CompiledCache) and
+    // handed to a later simulator of the same netlist, which then skips all preprocessing.
+    struct Compiled
+    {
+        std::vector<uint32_t> levels;
+        std::vector<Circuit::NodeId> order;
+        std::vector<uint32_t> levelOffsets;
+        // per gate in order: node id, fan-in count, fan-in ids
+        std::vector<uint32_t> program;
+        std::vector<Segment> segments;
+    };
+
+    // the circuit must be frozen and must outlive the simulator
+    // throws std::runtime_error if the netlist has a combinational loop
+    explicit LevelizedSimulator(const Circuit &circuit);
+    // takes the compiled form of an identical netlist; every level, segment and program entry
+    // is checked against the circuit, throws std::invalid_argument if anything does not fit
+    LevelizedSimulator(const Circuit &circuit, Compiled compiled);
+    Compiled getCompiled() const { return Compiled{levels, order, levelOffsets, program, segments}; }
+
+    // inputs are addressed by their position in circuit.getInputs()
+    // a changed input marks its fan-out dirty for the next update()
+    void setInputWord(uint32_t inputIndex, uint64_t lanes);
+    void setInputNode(Circuit::NodeId input, uint64_t lanes);
+    // copies the circuit's packed input values into every lane
+    void loadInputs(const Circuit &circuit);
+
+    // switching to four-valued makes every node X until inputs are set and the logic swept,
+    // switching back drops the unknown plane
+    void setLogicMode(LogicMode mode);
+    LogicMode getLogicMode() const { return logicMode; }
+    // four-valued inputs, throws std::logic_error in two-valued mode; setInputWord and
+    // setInputNode set known lanes in either mode
+    void setInputLogic(uint32_t inputIndex, LogicWord lanes);
+    void setInputNodeLogic(Circuit::NodeId input, LogicWord lanes);
+    // one straight-line sweep over the levelized gate order
+    void evaluate();
+    // same sweep with every level split into chunks of about `grain` gates and run on the pool,
+    // each chunk as typed runs of the opcode stream; the end of each level is a barrier,
+    // results are bit-identical to evaluate()
+    void evaluate(ThreadPool &pool, size_t grain = 1024);
+    // re-evaluates only the transitive fan-out of the inputs changed since the last sweep or update,
+    // level by level, and stops propagating wherever a gate's output word did not change
+    // the first call after construction does a full sweep
+    void update();
+    const UpdateStats &getUpdateStats() const { return updateStats; }
+
+    uint64_t getWord(Circuit::NodeId node) const { return values[node]; }
+    bool getValue(Circuit::NodeId node, int lane = 0) const { return (values[node] >> lane) & 1; }
+    // all lanes known in two-valued mode
+    LogicWord getLogicWord(Circuit::NodeId node) const { return LogicWord{values[node], unknowns.empty() ? 0 : unknowns[node]}; }
+    Logic getLogic(Circuit::NodeId node, int lane = 0) const;
+
+    // simulates `cycles` random input vectors and times it. Two-valued runs go through the
+    // widest lane backend the CPU has (see WideLanes), several sweeps per gate visit; the
+    // vectors and the final values are the same as sweep by sweep
+    RunStats run(uint64_t cycles, uint64_t seed = 1);
+    RunStats run(uint64_t cycles, ThreadPool &pool, uint64_t seed = 1);
+
+    // levelization results
+    uint32_t getLevelCount() const { return static_cast<uint32_t>(levelOffsets.size() - 1); }
+    uint32_t getLevel(Circuit::NodeId node) const { return levels[node]; }
+    // gates in evaluation order, level l is order[levelOffsets[l] .. levelOffsets[l + 1]),
+    // same-typed gates are adjacent inside a level
+    const std::vector<Circuit::NodeId> &getOrder() const { return order; }
+    const std::vector<uint32_t> &getLevelOffsets() const { return levelOffsets; }
+
+private:
+    const Circuit &circuit;
+    std::vector<uint32_t> levels;
+    std::vector<Circuit::NodeId> order;
+    std::vector<uint32_t> levelOffsets;
+    std::vector<uint64_t> values;
+    // the unknown plane, empty in two-valued mode
+    std::vector<uint64_t> unknowns;
+    LogicMode logicMode = LogicMode::TwoValued;
+    // per gate in order: node id, fan-in count, fan-in ids
+    std::vector<uint32_t> program;
+    std::vector<Segment> segments;
+
+    // dirty gates waiting for update(), bucketed by level
+    std::vector<std::vector<Circuit::NodeId>> dirtyLevels;
+    std::vector<uint8_t> dirty;
+    bool settled = false;
+    UpdateStats updateStats;
+
+    void levelize();
+    void compileProgram();
+    // what levelize() and compileProgram() guarantee, for a compiled form from elsewhere
+    void validateCompiled() const;
+    // a chunk of one level for the parallel sweep: `gates` gates from gate `skip` of
+    // segments[segment], whose opcodes start at programOffset, running on into the next segments
+    struct Chunk
+    {
+        uint32_t segment;
+        uint32_t skip;
+        uint32_t gates;
+        size_t programOffset;
+    };
+    // chunks of every level for chunkGrain, level l is chunks[chunkOffsets[l] .. chunkOffsets[l + 1])
+    std::vector<Chunk> chunks;
+    std::vector<uint32_t> chunkOffsets;
+    size_t chunkGrain = 0;
+
+    template <GateType Type>
+    static const uint32_t *runSegment(const uint32_t *pc, uint32_t gates, uint64_t *values);
+    template <GateType Type>
+    static const uint32_t *runLogicSegment(const uint32_t *pc, uint32_t gates, uint64_t *values, uint64_t *unknowns);
+    // one type switch, then the typed loop over `gates` gates
+    static const uint32_t *runTyped(GateType type, const uint32_t *pc, uint32_t gates, uint64_t *values);
+    static const uint32_t *runTypedLogic(GateType type, const uint32_t *pc, uint32_t gates, uint64_t *values, uint64_t *unknowns);
+    void splitLevels(size_t grain);
+    void runChunk(const Chunk &chunk);
+    void evaluateLogic();
+    // the dirty gates of update(), level by level
+    template <bool FourValued>
+    uint64_t propagateDirty();
+    void markFanoutDirty(Circuit::NodeId node);
+    void clearDirty();
+    void randomizeInputs(uint64_t &state);
+    RunStats runSweeps(uint64_t cycles, uint64_t seed, ThreadPool *pool);
+    // `visits` gate visits of `words` sweeps each on the lane kernel, node n holding
+    // wide[n * words .. n * words + words); values is left with the last sweep
+    void runWideSweeps(uint64_t visits, const LaneKernels &kernels, uint64_t &state);
+};
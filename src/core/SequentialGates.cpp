@@ -0,0 +1,74 @@
+#include "SequentialGates.h"
+#include "GateFactory.h"
+#include "GateKernels.h"
+
+SequentialGate::SequentialGate(GateType type, int numPins, const std::string &gateLabel, std::pmr::memory_resource *resource)
+    : Gate(type, gateLabel, resource)
+{
+    inputSignals.resize(numPins, false);
+}
+
+void SequentialGate::evaluate()
+{
+    if (!GateFactory::isValidInputCount(type, getInputCount()))
+    {
+        throw std::invalid_argument(GateFactory::getGateTypeName(type) + ": wrong number of data pins.");
+    }
+    uint64_t a = inputSignals[0] ? ~0ULL : 0;
+    uint64_t b = inputSignals.size() > 1 && inputSignals[1] ? ~0ULL : 0;
+    nextState = nextStateWord(type, a, b, outputSignal ? ~0ULL : 0) & 1;
+    if (type == GateType::Latch)
+    {
+        outputSignal = nextState;
+    }
+}
+
+uint64_t SequentialGate::evaluateWord(const std::vector<uint64_t> &inputWords) const
+{
+    if (inputWords.size() != static_cast<size_t>(getInputCount()) + 1)
+    {
+        throw std::invalid_argument(GateFactory::getGateTypeName(type) + ": expects the data pins and the current state.");
+    }
+    uint64_t b = inputWords.size() > 2 ? inputWords[1] : 0;
+    return nextStateWord(type, inputWords[0], b, inputWords.back());
+}
+
+LogicWord SequentialGate::evaluateLogicWord(const std::vector<LogicWord> &inputWords) const
+{
+    if (inputWords.size() != static_cast<size_t>(getInputCount()) + 1)
+    {
+        throw std::invalid_argument(GateFactory::getGateTypeName(type) + ": expects the data pins and the current state.");
+    }
+    LogicWord b = inputWords.size() > 2 ? inputWords[1] : LogicWord{0, 0};
+    return nextStateLogicWord(type, inputWords[0], b, inputWords.back());
+}
+
+void SequentialGate::clock()
+{
+    outputSignal = nextState;
+}
+
+DFlipFlop::DFlipFlop(const std::string &gateLabel, std::pmr::memory_resource *resource)
+    : SequentialGate(GateType::FlipFlop, 1, gateLabel, resource)
+{
+}
+
+JKFlipFlop::JKFlipFlop(const std::string &gateLabel, std::pmr::memory_resource *resource)
+    : SequentialGate(GateType::JKFlipFlop, 2, gateLabel, resource)
+{
+}
+
+TFlipFlop::TFlipFlop(const std::string &gateLabel, std::pmr::memory_resource *resource)
+    : SequentialGate(GateType::TFlipFlop, 1, gateLabel, resource)
+{
+}
+
+SRFlipFlop::SRFlipFlop(const std::string &gateLabel, std::pmr::memory_resource *resource)
+    : SequentialGate(GateType::SRFlipFlop, 2, gateLabel, resource)
+{
+}
+
+DLatch::DLatch(const std::string &gateLabel, std::pmr::memory_resource *resource)
+    : SequentialGate(GateType::Latch, 2, gateLabel, resource)
+{
+}
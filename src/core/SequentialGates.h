@@ -0,0 +1,55 @@
+#pragma once
+#include "Gate.h"
+#include <stdexcept>
+
+// Flip-flops and latches as standalone gates. The output is the stored state:
+// evaluate() computes the next state from the data pins, and clock() makes it the output,
+// so a set of flip-flops can all be evaluated before any of them changes. A latch is
+// level-sensitive, its evaluate() updates the output right away while it is enabled.
+class SequentialGate : public Gate
+{
+public:
+    void evaluate() override;
+    // the data pin words followed by the current state word, returns the next state word
+    uint64_t evaluateWord(const std::vector<uint64_t> &inputWords) const override;
+    LogicWord evaluateLogicWord(const std::vector<LogicWord> &inputWords) const override;
+    // rising clock edge
+    void clock();
+    bool getNextState() const { return nextState; }
+
+protected:
+    SequentialGate(GateType type, int numPins, const std::string &gateLabel, std::pmr::memory_resource *resource);
+
+private:
+    bool nextState = false;
+};
+
+class DFlipFlop : public SequentialGate
+{
+public:
+    DFlipFlop(const std::string &gateLabel = "", std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+};
+
+class JKFlipFlop : public SequentialGate
+{
+public:
+    JKFlipFlop(const std::string &gateLabel = "", std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+};
+
+class TFlipFlop : public SequentialGate
+{
+public:
+    TFlipFlop(const std::string &gateLabel = "", std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+};
+
+class SRFlipFlop : public SequentialGate
+{
+public:
+    SRFlipFlop(const std::string &gateLabel = "", std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+};
+
+class DLatch : public SequentialGate
+{
+public:
+    DLatch(const std::string &gateLabel = "", std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+};
@@ -0,0 +1,658 @@
+#include "SequentialSimulator.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include "GateFactory.h"
+#include "GateKernels.h"
+
+namespace
+{
+    bool isRegister(const Circuit &circuit, Circuit::NodeId node)
+    {
+        if (circuit.isInput(node))
+        {
+            return false;
+        }
+        GateType type = circuit.getGateType(node);
+        return GateFactory::isSequential(type) && type != GateType::Latch;
+    }
+}
+
+SequentialSimulator::SequentialSimulator(const Circuit &circuit)
+    : SequentialSimulator(circuit, {}, {Circuit::InvalidNode})
+{
+}
+
+SequentialSimulator::SequentialSimulator(const Circuit &circuit, const std::vector<uint32_t> &domainOf, const std::vector<Circuit::NodeId> &enables)
+    : circuit(circuit), enables(enables)
+{
+    if (!circuit.isFrozen())
+    {
+        throw std::logic_error("SequentialSimulator: circuit must be frozen first");
+    }
+    if (enables.empty() || enables.size() > MaxDomains)
+    {
+        throw std::invalid_argument("SequentialSimulator: between 1 and " + std::to_string(MaxDomains) + " clock domains are supported");
+    }
+    if (!domainOf.empty() && domainOf.size() != circuit.getNodeCount())
+    {
+        throw std::invalid_argument("SequentialSimulator: need a domain for every node");
+    }
+    for (Circuit::NodeId enable : enables)
+    {
+        if (enable != Circuit::InvalidNode && enable >= circuit.getNodeCount())
+        {
+            throw std::invalid_argument("SequentialSimulator: clock enable is not a node");
+        }
+    }
+    for (Circuit::NodeId node = 0; node < circuit.getNodeCount() && !domainOf.empty(); node++)
+    {
+        if (isRegister(circuit, node) && domainOf[node] >= enables.size())
+        {
+            throw std::invalid_argument("SequentialSimulator: " + circuit.getName(node) + " is in an undefined clock domain");
+        }
+    }
+    domainStats.resize(enables.size());
+    compile(domainOf);
+    initialBits = bits;
+}
+
+void SequentialSimulator::compile(const std::vector<uint32_t> &domainOf)
+{
+    const uint32_t numNodes = circuit.getNodeCount();
+    const uint32_t unassigned = 0xFFFFFFFF;
+    slotOf.assign(numNodes, unassigned);
+    auto domainOfNode = [&](Circuit::NodeId node) { return domainOf.empty() ? 0 : domainOf[node]; };
+
+    // flip-flops first, each kind of each domain starting on a word of its own
+    uint32_t word = 0;
+    for (uint32_t domain = 0; domain < enables.size(); domain++)
+    {
+        for (GateType type : {GateType::FlipFlop, GateType::TFlipFlop, GateType::JKFlipFlop, GateType::SRFlipFlop})
+        {
+            RegisterGroup group{type, domain, word, 0};
+            for (Circuit::NodeId node = 0; node < numNodes; node++)
+            {
+                if (!circuit.isInput(node) && circuit.getGateType(node) == type && domainOfNode(node) == domain)
+                {
+                    slotOf[node] = word * 64 + group.count++;
+                }
+            }
+            if (group.count > 0)
+            {
+                groups.push_back(group);
+                word += (group.count + 63) / 64;
+                registerCount += group.count;
+                domainStats[domain].flipFlops += group.count;
+            }
+        }
+    }
+    stateWords = word;
+    zeroSlot = word * 64;
+    uint32_t nextSlot = zeroSlot + 1;
+    for (Circuit::NodeId input : circuit.getInputs())
+    {
+        slotOf[input] = nextSlot++;
+    }
+
+    // Kahn's algorithm from the inputs and flip-flop outputs; edges into flip-flops are cut,
+    // since a flip-flop only reads its data pins at the edge
+    std::vector<uint32_t> pending(numNodes, 0);
+    std::vector<uint32_t> depth(numNodes, 0);
+    std::vector<Circuit::NodeId> ready;
+    for (Circuit::NodeId node = 0; node < numNodes; node++)
+    {
+        bool isSource = circuit.isInput(node) || slotOf[node] < zeroSlot;
+        if (isSource)
+        {
+            ready.push_back(node);
+        }
+        else
+        {
+            pending[node] = circuit.getFaninCount(node);
+        }
+    }
+    size_t sources = ready.size();
+    for (size_t next = 0; next < ready.size(); next++)
+    {
+        Circuit::NodeId node = ready[next];
+        const Circuit::NodeId *fanout = circuit.getFanout(node);
+        for (uint32_t i = 0; i < circuit.getFanoutCount(node); i++)
+        {
+            Circuit::NodeId sink = fanout[i];
+            if (slotOf[sink] < zeroSlot)
+            {
+                continue;
+            }
+            if (depth[sink] < depth[node] + 1)
+            {
+                depth[sink] = depth[node] + 1;
+            }
+            if (--pending[sink] == 0)
+            {
+                ready.push_back(sink);
+            }
+        }
+    }
+    if (ready.size() != numNodes)
+    {
+        for (Circuit::NodeId node = 0; node < numNodes; node++)
+        {
+            if (pending[node] != 0)
+            {
+                throw std::runtime_error("SequentialSimulator: combinational loop in the fan-in of " + circuit.getName(node));
+            }
+        }
+    }
+
+    // domain masks, sinks before sources: a gate feeds every domain its sinks feed
+    std::vector<uint64_t> mask(numNodes, 0);
+    for (uint32_t domain = 0; domain < enables.size(); domain++)
+    {
+        if (enables[domain] != Circuit::InvalidNode)
+        {
+            mask[enables[domain]] |= 1ULL << (MaxDomains + domain);
+        }
+    }
+    // latches hold state too, so they follow every edge rather than wait for evaluate()
+    const uint64_t allDomains = (1ULL << enables.size()) - 1;
+    for (size_t i = ready.size(); i-- > sources;)
+    {
+        Circuit::NodeId node = ready[i];
+        if (circuit.getGateType(node) == GateType::Latch)
+        {
+            mask[node] |= allDomains;
+        }
+        const Circuit::NodeId *fanout = circuit.getFanout(node);
+        for (uint32_t j = 0; j < circuit.getFanoutCount(node); j++)
+        {
+            Circuit::NodeId sink = fanout[j];
+            mask[node] |= slotOf[sink] < zeroSlot ? 1ULL << domainOfNode(sink) : mask[sink];
+        }
+    }
+
+    // a gate's mask contains the mask of every gate it feeds, so ordering by falling mask
+    // size, then mask, then depth is still topological and makes every mask one segment
+    std::vector<Circuit::NodeId> order(ready.begin() + sources, ready.end());
+    std::sort(order.begin(), order.end(), [&](Circuit::NodeId a, Circuit::NodeId b) {
+        int sizeA = popcount(mask[a]);
+        int sizeB = popcount(mask[b]);
+        if (sizeA != sizeB)
+            return sizeA > sizeB;
+        if (mask[a] != mask[b])
+            return mask[a] < mask[b];
+        return depth[a] != depth[b] ? depth[a] < depth[b] : a < b;
+    });
+    for (Circuit::NodeId node : order)
+    {
+        slotOf[node] = nextSlot++;
+        levelCount = std::max(levelCount, depth[node]);
+        latchCount += circuit.getGateType(node) == GateType::Latch;
+        for (uint32_t domain = 0; domain < enables.size(); domain++)
+        {
+            domainStats[domain].coneGates += mask[node] >> domain & 1;
+        }
+    }
+    for (Circuit::NodeId node : order)
+    {
+        if (segments.empty() || segments.back().mask != mask[node])
+        {
+            segments.push_back(Segment{mask[node], 0, program.size(), program.size()});
+        }
+        program.push_back(static_cast<uint32_t>(circuit.getGateType(node)));
+        program.push_back(slotOf[node]);
+        program.push_back(circuit.getFaninCount(node));
+        for (uint32_t pin = 0; pin < circuit.getFaninCount(node); pin++)
+        {
+            program.push_back(slotOf[circuit.getFanin(node)[pin]]);
+        }
+        segments.back().gates++;
+        segments.back().end = program.size();
+    }
+
+    pinA.assign(stateWords * 64, zeroSlot);
+    pinB.assign(stateWords * 64, zeroSlot);
+    gatheredA.assign(stateWords, 0);
+    gatheredB.assign(stateWords, 0);
+    bits.assign((nextSlot + 63) / 64, 0);
+    for (Circuit::NodeId node = 0; node < numNodes; node++)
+    {
+        uint32_t slot = slotOf[node];
+        if (slot < zeroSlot)
+        {
+            pinA[slot] = slotOf[circuit.getFanin(node)[0]];
+            if (circuit.getFaninCount(node) > 1)
+            {
+                pinB[slot] = slotOf[circuit.getFanin(node)[1]];
+            }
+        }
+        writeBit(slot, circuit.getValue(node));
+    }
+}
+
+void SequentialSimulator::setInput(uint32_t inputIndex, bool value)
+{
+    if (inputIndex >= circuit.getInputCount())
+    {
+        throw std::out_of_range("SequentialSimulator: input index out of range");
+    }
+    setInputNode(circuit.getInputs()[inputIndex], value);
+}
+
+void SequentialSimulator::setInputNode(Circuit::NodeId input, bool value)
+{
+    if (input >= circuit.getNodeCount() || !circuit.isInput(input))
+    {
+        throw std::invalid_argument("SequentialSimulator: node is not a primary input");
+    }
+    if (logicMode == LogicMode::FourValued)
+    {
+        writeLogic(slotOf[input], value ? Logic::One : Logic::Zero);
+        return;
+    }
+    writeBit(slotOf[input], value);
+}
+
+void SequentialSimulator::setState(Circuit::NodeId node, bool value)
+{
+    if (node >= circuit.getNodeCount() || circuit.isInput(node) || !GateFactory::isSequential(circuit.getGateType(node)))
+    {
+        throw std::invalid_argument("SequentialSimulator: node is not a flip-flop or latch");
+    }
+    if (logicMode == LogicMode::FourValued)
+    {
+        writeLogic(slotOf[node], value ? Logic::One : Logic::Zero);
+        return;
+    }
+    writeBit(slotOf[node], value);
+}
+
+void SequentialSimulator::setInputLogic(uint32_t inputIndex, Logic value)
+{
+    if (inputIndex >= circuit.getInputCount())
+    {
+        throw std::out_of_range("SequentialSimulator: input index out of range");
+    }
+    setInputNodeLogic(circuit.getInputs()[inputIndex], value);
+}
+
+void SequentialSimulator::setInputNodeLogic(Circuit::NodeId input, Logic value)
+{
+    if (logicMode != LogicMode::FourValued)
+    {
+        throw std::logic_error("SequentialSimulator: X and Z inputs need four-valued mode");
+    }
+    if (input >= circuit.getNodeCount() || !circuit.isInput(input))
+    {
+        throw std::invalid_argument("SequentialSimulator: node is not a primary input");
+    }
+    writeLogic(slotOf[input], value);
+}
+
+Logic SequentialSimulator::getLogic(Circuit::NodeId node) const
+{
+    uint32_t slot = slotOf[node];
+    bool unknown = logicMode == LogicMode::FourValued && readUnknown(slot);
+    return static_cast<Logic>(unknown << 1 | readBit(slot));
+}
+
+void SequentialSimulator::setLogicMode(LogicMode mode)
+{
+    if (mode == logicMode)
+    {
+        return;
+    }
+    logicMode = mode;
+    if (mode == LogicMode::TwoValued)
+    {
+        for (auto *plane : {&unknownBits, &initialUnknownBits, &gatheredUnknownA, &gatheredUnknownB, &pinValues, &pinUnknowns})
+        {
+            std::vector<uint64_t>().swap(*plane);
+        }
+        std::vector<uint32_t>().swap(pinIndex);
+        return;
+    }
+    // every node X, only the constant 0 and the padding of the state words stay known
+    unknownBits.assign(bits.size(), 0);
+    for (Circuit::NodeId node = 0; node < circuit.getNodeCount(); node++)
+    {
+        writeLogic(slotOf[node], Logic::X);
+    }
+    initialUnknownBits = unknownBits;
+    gatheredUnknownA.assign(stateWords, 0);
+    gatheredUnknownB.assign(stateWords, 0);
+    uint32_t widest = 1;
+    for (Circuit::NodeId node = 0; node < circuit.getNodeCount(); node++)
+    {
+        widest = std::max(widest, circuit.getFaninCount(node));
+    }
+    pinValues.assign(widest, 0);
+    pinUnknowns.assign(widest, 0);
+    pinIndex.resize(widest);
+    for (uint32_t i = 0; i < widest; i++)
+    {
+        pinIndex[i] = i;
+    }
+}
+
+void SequentialSimulator::runSegment(const Segment &segment)
+{
+    if (logicMode == LogicMode::FourValued)
+    {
+        runLogicSegment(segment);
+        return;
+    }
+    const uint32_t *pc = program.data() + segment.begin;
+    const uint32_t *end = program.data() + segment.end;
+    while (pc < end)
+    {
+        GateType type = static_cast<GateType>(pc[0]);
+        uint32_t slot = pc[1];
+        uint32_t count = pc[2];
+        const uint32_t *fanin = pc + 3;
+        uint64_t acc = readBit(fanin[0]);
+        switch (type)
+        {
+        case GateType::And:
+        case GateType::Nand:
+        case GateType::TriState:
+        case GateType::TransmissionGate:
+        case GateType::WiredAnd:
+            for (uint32_t i = 1; i < count; i++)
+                acc &= readBit(fanin[i]);
+            break;
+        case GateType::Or:
+        case GateType::Nor:
+        case GateType::WiredOr:
+        case GateType::Bus:
+            for (uint32_t i = 1; i < count; i++)
+                acc |= readBit(fanin[i]);
+            break;
+        case GateType::Xor:
+        case GateType::Xnor:
+            for (uint32_t i = 1; i < count; i++)
+                acc ^= readBit(fanin[i]);
+            break;
+        case GateType::Latch:
+            acc = nextStateWord(type, acc, readBit(fanin[1]), readBit(slot));
+            break;
+        default:
+            break;
+        }
+        if (type == GateType::Nand || type == GateType::Nor || type == GateType::Xnor || type == GateType::Not)
+        {
+            acc = ~acc;
+        }
+        writeBit(slot, acc & 1);
+        pc += 3 + count;
+    }
+}
+
+void SequentialSimulator::runLogicSegment(const Segment &segment)
+{
+    const uint32_t *pc = program.data() + segment.begin;
+    const uint32_t *end = program.data() + segment.end;
+    while (pc < end)
+    {
+        GateType type = static_cast<GateType>(pc[0]);
+        uint32_t slot = pc[1];
+        uint32_t count = pc[2];
+        const uint32_t *fanin = pc + 3;
+        // lane 0 of one-lane words, so the shared kernels do the four-valued logic
+        for (uint32_t i = 0; i < count; i++)
+        {
+            pinValues[i] = readBit(fanin[i]);
+            pinUnknowns[i] = readUnknown(fanin[i]);
+        }
+        LogicWord word;
+        if (type == GateType::Latch)
+        {
+            LogicWord state{readBit(slot), readUnknown(slot)};
+            word = nextStateLogicWord(type, LogicWord{pinValues[0], pinUnknowns[0]}, LogicWord{pinValues[1], pinUnknowns[1]}, state);
+        }
+        else
+        {
+            word = evaluateGateLogicWord(type, pinValues.data(), pinUnknowns.data(), pinIndex.data(), count);
+        }
+        writeLogic(slot, logicAt(word, 0));
+        pc += 3 + count;
+    }
+}
+
+void SequentialSimulator::evaluate()
+{
+    for (const Segment &segment : segments)
+    {
+        runSegment(segment);
+    }
+}
+
+void SequentialSimulator::commit(uint32_t domains, uint32_t uncertain)
+{
+    if (logicMode == LogicMode::FourValued)
+    {
+        commitLogic(domains, uncertain);
+        return;
+    }
+    // sample everything first: a data pin may be the output of another flip-flop
+    for (const RegisterGroup &group : groups)
+    {
+        if (!(domains >> group.domain & 1))
+        {
+            continue;
+        }
+        for (uint32_t word = group.firstWord; word < group.firstWord + (group.count + 63) / 64; word++)
+        {
+            const uint32_t *a = pinA.data() + word * 64;
+            const uint32_t *b = pinB.data() + word * 64;
+            uint64_t wordA = 0;
+            uint64_t wordB = 0;
+            for (uint32_t bit = 0; bit < 64; bit++)
+            {
+                wordA |= static_cast<uint64_t>(readBit(a[bit])) << bit;
+                wordB |= static_cast<uint64_t>(readBit(b[bit])) << bit;
+            }
+            gatheredA[word] = wordA;
+            gatheredB[word] = wordB;
+        }
+    }
+    // padding bits read the constant 0 and stay 0 under every kind's next-state function
+    for (const RegisterGroup &group : groups)
+    {
+        if (!(domains >> group.domain & 1))
+        {
+            continue;
+        }
+        for (uint32_t word = group.firstWord; word < group.firstWord + (group.count + 63) / 64; word++)
+        {
+            bits[word] = nextStateWord(group.type, gatheredA[word], gatheredB[word], bits[word]);
+        }
+    }
+}
+
+void SequentialSimulator::commitLogic(uint32_t domains, uint32_t uncertain)
+{
+    for (const RegisterGroup &group : groups)
+    {
+        if (!(domains >> group.domain & 1))
+        {
+            continue;
+        }
+        for (uint32_t word = group.firstWord; word < group.firstWord + (group.count + 63) / 64; word++)
+        {
+            const uint32_t *a = pinA.data() + word * 64;
+            const uint32_t *b = pinB.data() + word * 64;
+            uint64_t words[4] = {0, 0, 0, 0};
+            for (uint32_t bit = 0; bit < 64; bit++)
+            {
+                words[0] |= static_cast<uint64_t>(readBit(a[bit])) << bit;
+                words[1] |= static_cast<uint64_t>(readUnknown(a[bit])) << bit;
+                words[2] |= static_cast<uint64_t>(readBit(b[bit])) << bit;
+                words[3] |= static_cast<uint64_t>(readUnknown(b[bit])) << bit;
+            }
+            gatheredA[word] = words[0];
+            gatheredUnknownA[word] = words[1];
+            gatheredB[word] = words[2];
+            gatheredUnknownB[word] = words[3];
+        }
+    }
+    for (const RegisterGroup &group : groups)
+    {
+        if (!(domains >> group.domain & 1))
+        {
+            continue;
+        }
+        bool merge = uncertain >> group.domain & 1;
+        for (uint32_t word = group.firstWord; word < group.firstWord + (group.count + 63) / 64; word++)
+        {
+            LogicWord state{bits[word], unknownBits[word]};
+            LogicWord next = nextStateLogicWord(group.type, LogicWord{gatheredA[word], gatheredUnknownA[word]},
+                                                LogicWord{gatheredB[word], gatheredUnknownB[word]}, state);
+            if (merge)
+            {
+                // the edge may or may not have happened, so only lanes both outcomes agree on stay known
+                next.unknown |= state.unknown | (next.value ^ state.value);
+                next.value &= ~next.unknown;
+            }
+            bits[word] = next.value;
+            unknownBits[word] = next.unknown;
+        }
+    }
+}
+
+uint32_t SequentialSimulator::tick(uint32_t domains)
+{
+    domains &= static_cast<uint32_t>((1ULL << enables.size()) - 1);
+    uint64_t enableCones = 0;
+    for (uint32_t domain = 0; domain < enables.size(); domain++)
+    {
+        if ((domains >> domain & 1) && enables[domain] != Circuit::InvalidNode)
+        {
+            enableCones |= 1ULL << (MaxDomains + domain);
+        }
+    }
+    // settle the enables first, a domain whose enable is 0 needs none of its logic
+    if (enableCones != 0)
+    {
+        for (const Segment &segment : segments)
+        {
+            if (segment.mask & enableCones)
+            {
+                runSegment(segment);
+                gateEvaluations += segment.gates;
+            }
+        }
+    }
+    uint32_t active = domains;
+    uint32_t uncertain = 0;
+    for (uint32_t domain = 0; domain < enables.size(); domain++)
+    {
+        if (!(domains >> domain & 1))
+        {
+            continue;
+        }
+        domainStats[domain].edges++;
+        if (enables[domain] == Circuit::InvalidNode)
+        {
+            continue;
+        }
+        if (logicMode == LogicMode::FourValued && readUnknown(slotOf[enables[domain]]))
+        {
+            domainStats[domain].uncertain++;
+            uncertain |= 1u << domain;
+        }
+        else if (!readBit(slotOf[enables[domain]]))
+        {
+            domainStats[domain].gatedOff++;
+            active &= ~(1u << domain);
+        }
+    }
+    if (active != 0)
+    {
+        for (const Segment &segment : segments)
+        {
+            if ((segment.mask & active) && !(segment.mask & enableCones))
+            {
+                runSegment(segment);
+                gateEvaluations += segment.gates;
+            }
+        }
+        commit(active, uncertain);
+    }
+    cycle++;
+    return active;
+}
+
+void SequentialSimulator::clock(uint64_t cycles)
+{
+    const uint32_t all = static_cast<uint32_t>((1ULL << enables.size()) - 1);
+    for (uint64_t i = 0; i < cycles; i++)
+    {
+        tick(all);
+    }
+    evaluate();
+}
+
+void SequentialSimulator::reset()
+{
+    // inputs keep their current values, everything else goes back to the start
+    std::vector<uint64_t> inputs(bits);
+    std::vector<uint64_t> unknownInputs(unknownBits);
+    bits = initialBits;
+    if (logicMode == LogicMode::FourValued)
+    {
+        unknownBits = initialUnknownBits;
+        for (size_t word = 0; word < bits.size(); word++)
+        {
+            bits[word] &= ~unknownBits[word];
+        }
+    }
+    for (uint32_t i = 0; i < circuit.getInputCount(); i++)
+    {
+        uint32_t slot = zeroSlot + 1 + i;
+        writeBit(slot, (inputs[slot >> 6] >> (slot & 63)) & 1);
+        if (logicMode == LogicMode::FourValued)
+        {
+            uint64_t mask = 1ULL << (slot & 63);
+            unknownBits[slot >> 6] = (unknownBits[slot >> 6] & ~mask) | (unknownInputs[slot >> 6] & mask);
+        }
+    }
+    cycle = 0;
+    gateEvaluations = 0;
+    for (DomainStats &stats : domainStats)
+    {
+        stats.edges = 0;
+        stats.gatedOff = 0;
+        stats.uncertain = 0;
+    }
+}
+
+SequentialSimulator::RunStats SequentialSimulator::run(uint64_t cycles, uint64_t seed)
+{
+    const uint32_t all = static_cast<uint32_t>((1ULL << enables.size()) - 1);
+    uint64_t state = seed ? seed : 1;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < cycles; i++)
+    {
+        for (uint32_t input = 0; input < circuit.getInputCount(); input++)
+        {
+            // xorshift64
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            if (logicMode == LogicMode::FourValued)
+            {
+                writeLogic(zeroSlot + 1 + input, state & 1 ? Logic::One : Logic::Zero);
+            }
+            else
+            {
+                writeBit(zeroSlot + 1 + input, state & 1);
+            }
+        }
+        tick(all);
+    }
+    evaluate();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return RunStats{cycles, seconds};
+}
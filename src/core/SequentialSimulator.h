@@ -0,0 +1,179 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Circuit.h"
+
+// Cycle-based simulation of synchronous circuits. A clock edge evaluates the combinational
+// logic once, in topological order, with the primary inputs and flip-flop outputs as its
+// sources, and then commits every flip-flop in a separate phase, so no register ever sees
+// another register's new value in the same edge.
+//
+// Flip-flops can be split into clock domains (see ClockScheduler), each optionally gated by
+// an enable signal. Every gate carries the mask of the domains whose flip-flops it feeds,
+// and the gates are ordered so that each distinct mask is one contiguous segment. An edge
+// of some domains first evaluates their enable cones, then only the segments feeding the
+// enabled ones, and commits only their flip-flops; a gated-off domain costs nothing.
+//
+// Signals are one bit per node. The flip-flops are renumbered into one packed state vector
+// in which each kind (D, T, JK, SR) of each domain is a word-aligned run of bits. The commit
+// gathers the data pins into packed words and then updates 64 flip-flops of a kind with a
+// couple of word operations. Latches are level-sensitive and evaluated with the
+// combinational logic on every edge: an enabled latch passes its input and a disabled one
+// keeps its value, so a loop through latches alone is rejected like any other loop.
+//
+// In four-valued mode an unknown plane (see LogicWord) runs alongside the bits, so
+// flip-flops that were never set read X instead of a silent 0. Only the segment and
+// commit loops check the mode, once each, so two-valued runs keep their cost.
+class SequentialSimulator
+{
+public:
+    static constexpr uint32_t MaxDomains = 32;
+
+    struct RunStats
+    {
+        uint64_t cycles;
+        double seconds;
+        double cyclesPerSecond() const { return seconds > 0 ? cycles / seconds : 0; }
+    };
+
+    // per clock domain, counted by tick()
+    struct DomainStats
+    {
+        uint32_t flipFlops = 0;
+        uint32_t coneGates = 0; // gates feeding its flip-flops, shared ones included
+        uint64_t edges = 0;     // edges it was asked to take
+        uint64_t gatedOff = 0;  // of those, skipped because its enable was 0
+        uint64_t uncertain = 0; // of those, taken with an X enable: state stays known only where both outcomes agree
+    };
+
+    // the circuit must be frozen and must outlive the simulator. Flip-flops, latches and
+    // inputs start from the circuit's values, so they can be set before the circuit is handed over
+    // throws std::runtime_error if the netlist has a combinational loop
+    explicit SequentialSimulator(const Circuit &circuit);
+    // several clock domains: flip-flop f belongs to domain domainOf[f] (entries of other nodes
+    // are ignored), and domain d only takes an edge while enables[d] is 1, or always if it is
+    // InvalidNode. Throws std::invalid_argument past MaxDomains or for a bad domain or enable
+    SequentialSimulator(const Circuit &circuit, const std::vector<uint32_t> &domainOf, const std::vector<Circuit::NodeId> &enables);
+
+    // inputs are addressed by their position in circuit.getInputs()
+    void setInput(uint32_t inputIndex, bool value);
+    void setInputNode(Circuit::NodeId input, bool value);
+    // settles the combinational logic and latches for the current inputs and state
+    void evaluate();
+    // one edge of the domains in the bit mask `domains`: evaluates their enables, then the
+    // logic feeding the enabled ones, and commits their flip-flops. Logic feeding nothing but
+    // outputs waits for evaluate(). Returns the mask of the domains that were clocked
+    uint32_t tick(uint32_t domains);
+    // `cycles` edges of every domain, the logic is settled again afterwards
+    void clock(uint64_t cycles = 1);
+    // flip-flops and latches back to their initial values and the counters to 0, the inputs are kept
+    void reset();
+
+    // four-valued mode starts every node X: flip-flops, latches and inputs stay X until they
+    // are set, and reset() returns the state elements to X. Back to two-valued drops the plane
+    void setLogicMode(LogicMode mode);
+    LogicMode getLogicMode() const { return logicMode; }
+    // throws std::logic_error in two-valued mode; setInput, setInputNode and setState set
+    // known values in either mode
+    void setInputLogic(uint32_t inputIndex, Logic value);
+    void setInputNodeLogic(Circuit::NodeId input, Logic value);
+    Logic getLogic(Circuit::NodeId node) const;
+
+    bool getValue(Circuit::NodeId node) const { return readBit(slotOf[node]); }
+    // forces the stored value of a flip-flop or latch, throws std::invalid_argument for other nodes
+    void setState(Circuit::NodeId node, bool value);
+
+    uint32_t getRegisterCount() const { return registerCount; }
+    uint32_t getLatchCount() const { return latchCount; }
+    uint32_t getLevelCount() const { return levelCount; }
+    uint64_t getCycle() const { return cycle; }
+    uint32_t getDomainCount() const { return static_cast<uint32_t>(domainStats.size()); }
+    const DomainStats &getDomainStats(uint32_t domain) const { return domainStats.at(domain); }
+    // gates evaluated so far by tick(), settling the outputs with evaluate() not included
+    uint64_t getGateEvaluations() const { return gateEvaluations; }
+    // distinct domain masks, each one run of the program
+    size_t getSegmentCount() const { return segments.size(); }
+    // the packed flip-flop state, per domain words of D, then T, JK and SR flip-flops,
+    // unused bits stay 0
+    const uint64_t *getStateWords() const { return bits.data(); }
+    size_t getStateWordCount() const { return stateWords; }
+
+    // random inputs on every edge, timed
+    RunStats run(uint64_t cycles, uint64_t seed = 1);
+
+private:
+    // flip-flops of one kind and domain, bits firstWord * 64 .. firstWord * 64 + count of the state
+    struct RegisterGroup
+    {
+        GateType type;
+        uint32_t domain;
+        uint32_t firstWord;
+        uint32_t count;
+    };
+
+    // gates feeding the same domains: bit d of the mask for the logic of domain d,
+    // bit MaxDomains + d for the cone of domain d's enable
+    struct Segment
+    {
+        uint64_t mask;
+        uint32_t gates;
+        size_t begin; // program offsets
+        size_t end;
+    };
+
+    const Circuit &circuit;
+    // bit position of every node: flip-flops in the state words, then a constant 0,
+    // the primary inputs and the combinational gates and latches in evaluation order
+    std::vector<uint32_t> slotOf;
+    std::vector<uint64_t> bits;
+    std::vector<uint64_t> initialBits;
+    size_t stateWords = 0;
+    uint32_t zeroSlot = 0;
+    uint32_t registerCount = 0;
+    uint32_t latchCount = 0;
+    uint32_t levelCount = 0;
+    std::vector<RegisterGroup> groups;
+    std::vector<Segment> segments;
+    std::vector<Circuit::NodeId> enables;
+    std::vector<DomainStats> domainStats;
+    uint64_t gateEvaluations = 0;
+    // data pin slots of every state bit, the constant 0 for unused pins and padding
+    std::vector<uint32_t> pinA;
+    std::vector<uint32_t> pinB;
+    std::vector<uint64_t> gatheredA;
+    std::vector<uint64_t> gatheredB;
+    // per gate in evaluation order: type, slot, fan-in count, fan-in slots
+    std::vector<uint32_t> program;
+    uint64_t cycle = 0;
+    LogicMode logicMode = LogicMode::TwoValued;
+    // four-valued mode only: unknown bit of every slot, of the initial state, and of the
+    // gathered pins; the fan-in of one gate, and 0, 1, 2, ... to index it
+    std::vector<uint64_t> unknownBits;
+    std::vector<uint64_t> initialUnknownBits;
+    std::vector<uint64_t> gatheredUnknownA;
+    std::vector<uint64_t> gatheredUnknownB;
+    std::vector<uint64_t> pinValues;
+    std::vector<uint64_t> pinUnknowns;
+    std::vector<uint32_t> pinIndex;
+
+    bool readBit(uint32_t slot) const { return (bits[slot >> 6] >> (slot & 63)) & 1; }
+    void writeBit(uint32_t slot, bool value)
+    {
+        bits[slot >> 6] = (bits[slot >> 6] & ~(1ULL << (slot & 63))) | (static_cast<uint64_t>(value) << (slot & 63));
+    }
+    bool readUnknown(uint32_t slot) const { return (unknownBits[slot >> 6] >> (slot & 63)) & 1; }
+    void writeLogic(uint32_t slot, Logic value)
+    {
+        writeBit(slot, value == Logic::One || value == Logic::Z);
+        uint64_t mask = 1ULL << (slot & 63);
+        unknownBits[slot >> 6] = (value == Logic::X || value == Logic::Z) ? unknownBits[slot >> 6] | mask : unknownBits[slot >> 6] & ~mask;
+    }
+    void compile(const std::vector<uint32_t> &domainOf);
+    void runSegment(const Segment &segment);
+    void runLogicSegment(const Segment &segment);
+    // samples the data pins of the flip-flops in the given domains, then updates all of them;
+    // `uncertain` domains had an X enable
+    void commit(uint32_t domains, uint32_t uncertain);
+    void commitLogic(uint32_t domains, uint32_t uncertain);
+};
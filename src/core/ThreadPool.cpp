@@ -0,0 +1,140 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threads)
+{
+    if (threads == 0)
+    {
+        threads = 1;
+    }
+    for (unsigned i = 0; i < threads; i++)
+    {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 1; i < threads; i++)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &job)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    if (grain == 0)
+    {
+        grain = 1;
+    }
+    if (workers.empty() || count <= grain)
+    {
+        job(0, count);
+        return;
+    }
+
+    size_t chunks = (count + grain - 1) / grain;
+    body = &job;
+    remaining.store(chunks, std::memory_order_relaxed);
+    // deal the chunks out round-robin, stealing evens out whatever imbalance is left
+    for (size_t chunk = 0; chunk < chunks; chunk++)
+    {
+        Queue &queue = *queues[chunk % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        size_t begin = chunk * grain;
+        queue.ranges.push_back(Range{begin, std::min(count, begin + grain)});
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        jobGeneration.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_all();
+
+    while (remaining.load(std::memory_order_acquire) > 0)
+    {
+        if (!runOne(0))
+        {
+            std::this_thread::yield();
+        }
+    }
+    body = nullptr;
+}
+
+bool ThreadPool::runOne(unsigned self)
+{
+    Range range;
+    bool found = false;
+    {
+        Queue &own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.ranges.empty())
+        {
+            range = own.ranges.back();
+            own.ranges.pop_back();
+            found = true;
+        }
+    }
+    for (size_t offset = 1; !found && offset < queues.size(); offset++)
+    {
+        Queue &victim = *queues[(self + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.ranges.empty())
+        {
+            range = victim.ranges.front();
+            victim.ranges.pop_front();
+            found = true;
+        }
+    }
+    if (!found)
+    {
+        return false;
+    }
+    (*body)(range.begin, range.end);
+    remaining.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+void ThreadPool::workerLoop(unsigned self)
+{
+    uint64_t seen = 0;
+    while (true)
+    {
+        // levels come in quick succession, so spin a little before paying for a sleep/wake
+        int spins = 0;
+        while (jobGeneration.load(std::memory_order_acquire) == seen && spins < SpinsBeforeSleep)
+        {
+            spins++;
+            std::this_thread::yield();
+        }
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait(lock, [&]
+                      { return stopping || jobGeneration.load(std::memory_order_acquire) != seen; });
+            if (stopping)
+            {
+                return;
+            }
+            seen = jobGeneration.load(std::memory_order_acquire);
+        }
+        while (remaining.load(std::memory_order_acquire) > 0)
+        {
+            if (!runOne(self))
+            {
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size work-stealing pool for data-parallel loops. Every participant (the calling
+// thread plus the workers) owns a deque of index ranges: it pops from the back of its own
+// deque and, once that is empty, steals from the front of the others. parallelFor returns
+// only after every range has run, so consecutive calls are separated by a full barrier.
+class ThreadPool
+{
+public:
+    // threads counts the calling thread, so ThreadPool(1) spawns no workers
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(queues.size()); }
+
+    // runs body(begin, end) over [0, count) in chunks of at most `grain` indices
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &body);
+
+private:
+    struct Range
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+    };
+
+    // how long an idle worker spins on the job counter before it blocks
+    static constexpr int SpinsBeforeSleep = 4096;
+
+    std::vector<std::unique_ptr<Queue>> queues; // queues[0] belongs to the calling thread
+    std::vector<std::thread> workers;
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::atomic<uint64_t> jobGeneration{0};
+    bool stopping = false;
+
+    const std::function<void(size_t, size_t)> *body = nullptr;
+    std::atomic<size_t> remaining{0};
+
+    bool runOne(unsigned self);
+    void workerLoop(unsigned self);
+};
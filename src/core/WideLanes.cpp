@@ -0,0 +1,269 @@
+#include "WideLanes.h"
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DLS_X86_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC accepts AVX intrinsics in any function, the CPUID check below guards the call
+#define DLS_TARGET_AVX2
+#define DLS_TARGET_AVX512
+#else
+#define DLS_TARGET_AVX2 __attribute__((target("avx2")))
+#define DLS_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+#endif
+
+namespace
+{
+    // every combinational gate is a reduction (and/or/xor/pass) followed by an optional inversion
+    enum class LaneOp
+    {
+        And,
+        Or,
+        Xor,
+        Pass
+    };
+
+    void classify(GateType type, LaneOp &op, bool &invert)
+    {
+        switch (type)
+        {
+        case GateType::And:
+            op = LaneOp::And;
+            invert = false;
+            return;
+        case GateType::Nand:
+            op = LaneOp::And;
+            invert = true;
+            return;
+        case GateType::Or:
+            op = LaneOp::Or;
+            invert = false;
+            return;
+        case GateType::Nor:
+            op = LaneOp::Or;
+            invert = true;
+            return;
+        case GateType::Xor:
+            op = LaneOp::Xor;
+            invert = false;
+            return;
+        case GateType::Xnor:
+            op = LaneOp::Xor;
+            invert = true;
+            return;
+        case GateType::Not:
+            op = LaneOp::Pass;
+            invert = true;
+            return;
+        case GateType::Buffer:
+            op = LaneOp::Pass;
+            invert = false;
+            return;
+        default:
+            throw std::invalid_argument("WideLanes: gate type has no lane kernel");
+        }
+    }
+
+    // 64-bit lanes, also used for the tail of the SIMD kernels
+    void evaluateWord64Range(LaneOp op, bool invert, const uint64_t *const *inputs, size_t count,
+                             uint64_t *output, size_t begin, size_t end)
+    {
+        const uint64_t mask = invert ? ~0ULL : 0;
+        for (size_t w = begin; w < end; w++)
+        {
+            uint64_t acc = inputs[0][w];
+            switch (op)
+            {
+            case LaneOp::And:
+                for (size_t i = 1; i < count; i++)
+                    acc &= inputs[i][w];
+                break;
+            case LaneOp::Or:
+                for (size_t i = 1; i < count; i++)
+                    acc |= inputs[i][w];
+                break;
+            case LaneOp::Xor:
+                for (size_t i = 1; i < count; i++)
+                    acc ^= inputs[i][w];
+                break;
+            case LaneOp::Pass:
+                break;
+            }
+            output[w] = acc ^ mask;
+        }
+    }
+
+    void evaluateWord64(GateType type, const uint64_t *const *inputs, size_t count, uint64_t *output, size_t words)
+    {
+        LaneOp op;
+        bool invert;
+        classify(type, op, invert);
+        evaluateWord64Range(op, invert, inputs, count, output, 0, words);
+    }
+
+#ifdef DLS_X86_SIMD
+    DLS_TARGET_AVX2 void evaluateAvx2(GateType type, const uint64_t *const *inputs, size_t count, uint64_t *output, size_t words)
+    {
+        LaneOp op;
+        bool invert;
+        classify(type, op, invert);
+        const __m256i mask = invert ? _mm256_set1_epi64x(-1) : _mm256_setzero_si256();
+        size_t w = 0;
+        for (; w + 4 <= words; w += 4)
+        {
+            __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(inputs[0] + w));
+            switch (op)
+            {
+            case LaneOp::And:
+                for (size_t i = 1; i < count; i++)
+                    acc = _mm256_and_si256(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(inputs[i] + w)));
+                break;
+            case LaneOp::Or:
+                for (size_t i = 1; i < count; i++)
+                    acc = _mm256_or_si256(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(inputs[i] + w)));
+                break;
+            case LaneOp::Xor:
+                for (size_t i = 1; i < count; i++)
+                    acc = _mm256_xor_si256(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(inputs[i] + w)));
+                break;
+            case LaneOp::Pass:
+                break;
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + w), _mm256_xor_si256(acc, mask));
+        }
+        evaluateWord64Range(op, invert, inputs, count, output, w, words);
+    }
+
+    DLS_TARGET_AVX512 void evaluateAvx512(GateType type, const uint64_t *const *inputs, size_t count, uint64_t *output, size_t words)
+    {
+        LaneOp op;
+        bool invert;
+        classify(type, op, invert);
+        const __m512i mask = invert ? _mm512_set1_epi64(-1) : _mm512_setzero_si512();
+        size_t w = 0;
+        for (; w + 8 <= words; w += 8)
+        {
+            __m512i acc = _mm512_loadu_si512(inputs[0] + w);
+            switch (op)
+            {
+            case LaneOp::And:
+                for (size_t i = 1; i < count; i++)
+                    acc = _mm512_and_si512(acc, _mm512_loadu_si512(inputs[i] + w));
+                break;
+            case LaneOp::Or:
+                for (size_t i = 1; i < count; i++)
+                    acc = _mm512_or_si512(acc, _mm512_loadu_si512(inputs[i] + w));
+                break;
+            case LaneOp::Xor:
+                for (size_t i = 1; i < count; i++)
+                    acc = _mm512_xor_si512(acc, _mm512_loadu_si512(inputs[i] + w));
+                break;
+            case LaneOp::Pass:
+                break;
+            }
+            _mm512_storeu_si512(output + w, _mm512_xor_si512(acc, mask));
+        }
+        evaluateWord64Range(op, invert, inputs, count, output, w, words);
+    }
+
+    bool cpuHasAvx2()
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        bool osSavesYmm = (info[2] & (1 << 27)) && ((_xgetbv(0) & 0x6) == 0x6);
+        __cpuidex(info, 7, 0);
+        return osSavesYmm && (info[1] & (1 << 5));
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    bool cpuHasAvx512()
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        bool osSavesZmm = (info[2] & (1 << 27)) && ((_xgetbv(0) & 0xE6) == 0xE6);
+        __cpuidex(info, 7, 0);
+        return osSavesZmm && (info[1] & (1 << 16));
+#else
+        return __builtin_cpu_supports("avx512f");
+#endif
+    }
+#endif
+
+    const LaneKernels word64Kernels{LaneBackend::Word64, evaluateWord64, 1, "64-bit"};
+#ifdef DLS_X86_SIMD
+    const LaneKernels avx2Kernels{LaneBackend::Avx2, evaluateAvx2, 4, "AVX2"};
+    const LaneKernels avx512Kernels{LaneBackend::Avx512, evaluateAvx512, 8, "AVX-512"};
+#endif
+}
+
+bool WideLanes::isSupported(LaneBackend backend)
+{
+    switch (backend)
+    {
+    case LaneBackend::Word64:
+        return true;
+#ifdef DLS_X86_SIMD
+    case LaneBackend::Avx2:
+    {
+        static const bool supported = cpuHasAvx2();
+        return supported;
+    }
+    case LaneBackend::Avx512:
+    {
+        static const bool supported = cpuHasAvx512();
+        return supported;
+    }
+#endif
+    default:
+        return false;
+    }
+}
+
+const LaneKernels &WideLanes::get(LaneBackend backend)
+{
+    if (!isSupported(backend))
+    {
+        throw std::runtime_error("Lane backend not supported on this CPU: " + getBackendName(backend));
+    }
+    switch (backend)
+    {
+#ifdef DLS_X86_SIMD
+    case LaneBackend::Avx2:
+        return avx2Kernels;
+    case LaneBackend::Avx512:
+        return avx512Kernels;
+#endif
+    default:
+        return word64Kernels;
+    }
+}
+
+const LaneKernels &WideLanes::best()
+{
+    static const LaneKernels &selected = isSupported(LaneBackend::Avx512) ? get(LaneBackend::Avx512)
+                                         : isSupported(LaneBackend::Avx2) ? get(LaneBackend::Avx2)
+                                                                          : get(LaneBackend::Word64);
+    return selected;
+}
+
+std::string WideLanes::getBackendName(LaneBackend backend)
+{
+    switch (backend)
+    {
+    case LaneBackend::Word64:
+        return "64-bit";
+    case LaneBackend::Avx2:
+        return "AVX2";
+    case LaneBackend::Avx512:
+        return "AVX-512";
+    default:
+        return "UNKNOWN";
+    }
+}
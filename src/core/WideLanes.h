@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "Gate.h"
+
+// lane backends, ordered from narrowest to widest
+enum class LaneBackend
+{
+    Word64, // one uint64_t per gate visit (64 patterns)
+    Avx2,   // one 256-bit register per gate visit (256 patterns)
+    Avx512  // one 512-bit register per gate visit (512 patterns)
+};
+
+// evaluates one gate over a block of simulation lanes
+// inputs holds `count` pointers, each to `words` consecutive uint64_t of one input signal
+// words must be a multiple of the backend's wordsPerVisit
+using LaneKernel = void (*)(GateType type, const uint64_t *const *inputs, size_t count, uint64_t *output, size_t words);
+
+struct LaneKernels
+{
+    LaneBackend backend;
+    LaneKernel evaluate;
+    size_t wordsPerVisit; // 1, 4 or 8
+    const char *name;
+};
+
+class WideLanes
+{
+public:
+    // widest backend the running CPU supports, detected once on first use
+    static const LaneKernels &best();
+    // a specific backend, throws std::runtime_error if the CPU (or build) cannot run it
+    static const LaneKernels &get(LaneBackend backend);
+    static bool isSupported(LaneBackend backend);
+    static std::string getBackendName(LaneBackend backend);
+};
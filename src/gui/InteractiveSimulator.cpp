@@ -2,14 +2,27 @@
 #include <sstream>   // For std::stringstream
 #include <algorithm> // For std::transform
 #include <cctype>    // For ::tolower
+#include <filesystem>
+#include <iomanip>
 #include <iostream>
 #include <utils/TruthTable.h>
+#include <utils/PackedTruthTable.h>
+#include <utils/TruthTableStream.h>
+#include <utils/CircuitTruthTable.h>
+#include <utils/Benchmark.h>
+#include <utils/parser.h>
+#include <utils/BinaryNetlist.h>
+#include "core/EventSimulator.h"
+#include "core/K-Map.h"
+#include "core/Espresso.h"
+#include "core/Bdd.h"
+#include "core/GateKernels.h"
 
 void InteractiveSimulator::displayWelcomeMessage()
 {
     std::cout << "=== Digital Logic Simulator ===" << std::endl;
     std::cout << "Type 'help' for available commands" << std::endl;
-    std::cout << "Available gate types: and, or, not, nand, nor, xor, xnor, buffer" << std::endl;
+    std::cout << "Available gate types: and, or, not, nand, nor, xor, xnor, buffer, dff, jkff, tff, srff, latch, tribuf, tgate, wand, wor, bus" << std::endl;
     std::cout << std::endl;
 }
 
@@ -27,7 +40,9 @@ std::string InteractiveSimulator::getUserInput()
 
 void InteractiveSimulator::cleanUp()
 {
+    invalidateCircuit();
     gates.clear();
+    gatePool.clear();
     std::cout << "Goodbye!" << std::endl;
 }
 
@@ -66,6 +81,26 @@ GateType InteractiveSimulator::parseGateType(const std::string &typeStr)
         return GateType::Xnor;
     if (lowerType == "buffer")
         return GateType::Buffer;
+    if (lowerType == "dff" || lowerType == "flipflop")
+        return GateType::FlipFlop;
+    if (lowerType == "jkff")
+        return GateType::JKFlipFlop;
+    if (lowerType == "tff")
+        return GateType::TFlipFlop;
+    if (lowerType == "srff")
+        return GateType::SRFlipFlop;
+    if (lowerType == "latch")
+        return GateType::Latch;
+    if (lowerType == "tribuf")
+        return GateType::TriState;
+    if (lowerType == "tgate")
+        return GateType::TransmissionGate;
+    if (lowerType == "wand")
+        return GateType::WiredAnd;
+    if (lowerType == "wor")
+        return GateType::WiredOr;
+    if (lowerType == "bus")
+        return GateType::Bus;
 
     throw std::invalid_argument("Unknown gate type: " + typeStr);
 }
@@ -79,7 +114,11 @@ bool InteractiveSimulator::validateCommand(const std::vector<std::string> &token
     return (command == "create" || command == "help" || command == "exit" ||
             command == "clear" || command == "list" || command == "set" ||
             command == "eval" || command == "table" || command == "info" ||
-            command == "delete" || command == "test");
+            command == "delete" || command == "test" || command == "bench" ||
+            command == "connect" || command == "circuit" || command == "simulate" ||
+            command == "run" || command == "delay" || command == "minimize" || command == "espresso" || command == "expr" ||
+            command == "import" || command == "export" || command == "save" || command == "load" ||
+            command == "cache" || command == "clock" || command == "logic" || command == "module");
 }
 
 // Missing executeCommand method implementation
@@ -113,6 +152,40 @@ void InteractiveSimulator::executeCommand(const std::string &input)
             handleDelete(tokens);
         else if (command == "test")
             handleTest(tokens);
+        else if (command == "bench")
+            handleBench(tokens);
+        else if (command == "connect")
+            handleConnect(tokens);
+        else if (command == "circuit")
+            handleCircuit(tokens);
+        else if (command == "simulate")
+            handleSimulate(tokens);
+        else if (command == "run")
+            handleRun(tokens);
+        else if (command == "delay")
+            handleDelay(tokens);
+        else if (command == "minimize")
+            handleMinimize(tokens);
+        else if (command == "espresso")
+            handleEspresso(tokens);
+        else if (command == "expr")
+            handleExpression(input.substr(input.find(tokens[0]) + tokens[0].size()));
+        else if (command == "import")
+            handleImport(tokens);
+        else if (command == "export")
+            handleExport(tokens);
+        else if (command == "save")
+            handleSave(tokens);
+        else if (command == "load")
+            handleLoad(tokens);
+        else if (command == "cache")
+            handleCache(tokens);
+        else if (command == "clock")
+            handleClock(tokens);
+        else if (command == "logic")
+            handleLogic(tokens);
+        else if (command == "module")
+            handleModule(tokens);
         else if (command == "help")
             handleHelp(tokens);
         else if (command == "exit")
@@ -133,9 +206,9 @@ void InteractiveSimulator::handleCreate(const std::vector<std::string> &tokens)
 {
     try
     {
-        if (tokens.size() != 3)
+        if (tokens.size() != 3 && tokens.size() != 4)
         {
-            std::cout << "Usage: create <gate_type> <name>" << std::endl;
+            std::cout << "Usage: create <gate_type> <name> [inputs]" << std::endl;
             std::cout << "Example: create and MyAndGate" << std::endl;
             return;
         }
@@ -151,8 +224,20 @@ void InteractiveSimulator::handleCreate(const std::vector<std::string> &tokens)
 
         // Create gate
         GateType gateType = parseGateType(tokens[1]);
-        auto gate = GateFactory::createGate(gateType, gateName);
-        gates[gateName] = gate;
+        int numInputs = tokens.size() == 4 ? std::stoi(tokens[3]) : (GateFactory::isValidInputCount(gateType, 1) ? 1 : 2);
+        if (!GateFactory::isValidInputCount(gateType, numInputs) || numInputs > TruthTableStream::MaxInputs)
+        {
+            std::cout << "✗ A " << tokens[1] << " gate cannot have " << numInputs << " inputs" << std::endl;
+            return;
+        }
+        GateHandle handle = GateFactory::createGate(gatePool, gateType, gateName);
+        gates[gateName] = handle;
+        Gate *gate = gatePool.get(handle);
+        while (gate->getInputCount() < numInputs)
+        {
+            gate->addInput(false);
+        }
+        invalidateCircuit();
 
         std::cout << "✓ Created " << tokens[1] << " gate '" << gateName << "' with "
                   << gate->getInputCount() << " inputs" << std::endl;
@@ -175,7 +260,7 @@ void InteractiveSimulator::handleList(const std::vector<std::string> &tokens)
     std::cout << "Active Gates:" << std::endl;
     for (const auto &pair : gates)
     {
-        auto &gate = pair.second;
+        Gate *gate = gatePool.get(pair.second);
         std::cout << "- " << pair.first << " (" << getGateTypeName(gate->getType())
                   << ", " << gate->getInputCount() << " inputs)" << std::endl;
     }
@@ -198,8 +283,9 @@ void InteractiveSimulator::handleSet(const std::vector<std::string> &tokens)
         return;
     }
 
-    auto &gate = it->second;
+    Gate *gate = gatePool.get(it->second);
     std::vector<bool> inputs;
+    std::vector<Logic> logicInputs;
 
     // Parse input values
     for (size_t i = 2; i < tokens.size(); ++i)
@@ -207,14 +293,23 @@ void InteractiveSimulator::handleSet(const std::vector<std::string> &tokens)
         if (tokens[i] == "1" || tokens[i] == "true")
         {
             inputs.push_back(true);
+            logicInputs.push_back(Logic::One);
         }
         else if (tokens[i] == "0" || tokens[i] == "false")
         {
             inputs.push_back(false);
+            logicInputs.push_back(Logic::Zero);
+        }
+        else if ((tokens[i] == "x" || tokens[i] == "X" || tokens[i] == "z" || tokens[i] == "Z") && logicMode == LogicMode::FourValued)
+        {
+            // the gate object itself is two-valued and just sees 0
+            inputs.push_back(false);
+            logicInputs.push_back(tokens[i] == "x" || tokens[i] == "X" ? Logic::X : Logic::Z);
         }
         else
         {
-            std::cout << "Invalid input value: " << tokens[i] << ". Use 0, 1, true, or false." << std::endl;
+            std::cout << "Invalid input value: " << tokens[i] << ". Use 0, 1, true, or false"
+                      << (logicMode == LogicMode::FourValued ? ", x or z." : " ('logic 4' adds x and z).") << std::endl;
             return;
         }
     }
@@ -230,12 +325,45 @@ void InteractiveSimulator::handleSet(const std::vector<std::string> &tokens)
     for (size_t i = 0; i < inputs.size(); ++i)
     {
         gate->setInput(i, inputs[i]);
+        pinLogic[gateName + "." + std::to_string(i)] = logicInputs[i];
+    }
+    // unconnected pins are primary inputs of the compiled circuit, mark their cones dirty
+    SequentialSimulator *sequential = clockScheduler ? &clockScheduler->getSimulator() : sequentialSimulator.get();
+    if (sequential)
+    {
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            Circuit::NodeId input = compiledCircuit->findNode(gateName + "." + std::to_string(i));
+            if (input != Circuit::InvalidNode && logicMode == LogicMode::FourValued)
+            {
+                sequential->setInputNodeLogic(input, logicInputs[i]);
+            }
+            else if (input != Circuit::InvalidNode)
+            {
+                sequential->setInputNode(input, inputs[i]);
+            }
+        }
+    }
+    if (compiledSimulator)
+    {
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            Circuit::NodeId input = compiledCircuit->findNode(gateName + "." + std::to_string(i));
+            if (input != Circuit::InvalidNode && logicMode == LogicMode::FourValued)
+            {
+                compiledSimulator->setInputNodeLogic(input, logicWord(logicInputs[i]));
+            }
+            else if (input != Circuit::InvalidNode)
+            {
+                compiledSimulator->setInputNode(input, inputs[i] ? ~0ULL : 0);
+            }
+        }
     }
 
     std::cout << "✓ Set inputs for '" << gateName << "': ";
-    for (bool input : inputs)
+    for (Logic input : logicInputs)
     {
-        std::cout << (input ? "1" : "0") << " ";
+        std::cout << logicChar(input) << " ";
     }
     std::cout << std::endl;
 }
@@ -256,11 +384,51 @@ void InteractiveSimulator::handleEval(const std::vector<std::string> &tokens)
         return;
     }
 
-    auto &gate = it->second;
-    gate->evaluate();
-    bool output = gate->getOutput();
+    Gate *gate = gatePool.get(it->second);
+    bool compiled = isWired(gateName) || GateFactory::isSequential(gate->getType());
+    // the compiled circuit is the imported netlist while one is loaded, the created gates are not in it
+    Circuit::NodeId node = compiled ? getCompiledCircuit().findNode(gateName) : Circuit::InvalidNode;
+    if (compiled && node == Circuit::InvalidNode)
+    {
+        std::cout << "Gate '" << gateName << "' is not in the circuit: an imported netlist is active, use 'import off'" << std::endl;
+        return;
+    }
+    Logic output;
+    if (compiled && compiledCircuit->hasStateElements())
+    {
+        // flip-flops only change on 'clock', this shows the logic settled for their current state
+        SequentialSimulator &simulator = getSequentialSimulator();
+        simulator.evaluate();
+        output = simulator.getLogic(node);
+    }
+    else if (isWired(gateName))
+    {
+        // connected gates are evaluated through the compiled circuit so their fan-in cones are included,
+        // only the cones of inputs changed since the last evaluation are recomputed
+        LevelizedSimulator &simulator = getCompiledSimulator();
+        simulator.update();
+        output = simulator.getLogic(node);
+        const LevelizedSimulator::UpdateStats &stats = simulator.getUpdateStats();
+        std::cout << "Re-evaluated " << stats.gatesEvaluated << " of " << compiledCircuit->getGateCount()
+                  << " gates (" << stats.gatesChanged << " changed)" << std::endl;
+    }
+    else if (logicMode == LogicMode::FourValued)
+    {
+        std::vector<LogicWord> pins;
+        for (int pin = 0; pin < gate->getInputCount(); pin++)
+        {
+            pins.push_back(logicWord(getPinLogic(gateName, pin)));
+        }
+        output = logicAt(gate->evaluateLogicWord(pins), 0);
+    }
+    else
+    {
+        gate->evaluate();
+        output = gate->getOutput() ? Logic::One : Logic::Zero;
+    }
 
-    std::cout << "Output: " << (output ? "1" : "0") << " (" << (output ? "true" : "false") << ")" << std::endl;
+    static const char *const meanings[] = {"false", "true", "unknown", "undriven"};
+    std::cout << "Output: " << logicChar(output) << " (" << meanings[static_cast<int>(output)] << ")" << std::endl;
 }
 
 void InteractiveSimulator::handleInfo(const std::vector<std::string> &tokens)
@@ -279,7 +447,7 @@ void InteractiveSimulator::handleInfo(const std::vector<std::string> &tokens)
         return;
     }
 
-    auto &gate = it->second;
+    Gate *gate = gatePool.get(it->second);
     std::cout << "Gate: " << gateName << std::endl;
     std::cout << "Type: " << getGateTypeName(gate->getType()) << std::endl;
     std::cout << "Inputs: " << gate->getInputCount() << std::endl;
@@ -295,19 +463,76 @@ void InteractiveSimulator::handleInfo(const std::vector<std::string> &tokens)
 void InteractiveSimulator::handleHelp(const std::vector<std::string> &tokens)
 {
     std::cout << "Available Commands:" << std::endl;
-    std::cout << "  create <type> <name>  - Create a new gate" << std::endl;
+    std::cout << "  create <type> <name> [inputs] - Create a new gate, optionally with more inputs" << std::endl;
     std::cout << "  list                  - Show all created gates" << std::endl;
     std::cout << "  set <name> <inputs>   - Set gate inputs (e.g., set MyGate 1 0)" << std::endl;
     std::cout << "  eval <name>           - Evaluate gate and show output" << std::endl;
     std::cout << "  info <name>           - Show gate information" << std::endl;
     std::cout << "  table <name>          - Generate truth table for gate" << std::endl;
-    std::cout << "  test <name>           - Interactive testing mode" << std::endl;
+    std::cout << "  test <name> [all] [threads] - Check every input combination in chunks, across threads" << std::endl;
     std::cout << "  delete <name>         - Delete a gate" << std::endl;
+    std::cout << "  minimize <name>       - Minimal SOP and POS of a gate's function" << std::endl;
+    std::cout << "  minimize <vars> <minterms...> [dc <dont_cares...>] - Minimize a function given by minterms" << std::endl;
+    std::cout << "  espresso <in.pla> [out.pla] - Heuristic minimization of a wide multiple-output PLA" << std::endl;
+    std::cout << "  expr <expression>     - Parse and compile an expression like (A & B) | ~C ^ D, then minimize it" << std::endl;
+    std::cout << "  connect <from> <to> <pin> - Drive input pin of gate 'to' with the output of 'from'" << std::endl;
+    std::cout << "  import <file.v|file.blif> - Load a structural Verilog or BLIF netlist as the circuit" << std::endl;
+    std::cout << "  import off            - Drop the imported netlist and go back to the created gates" << std::endl;
+    std::cout << "  export <file.v|file.blif> - Write the circuit as structural Verilog or BLIF" << std::endl;
+    std::cout << "  save <file.dlsn>      - Write the circuit as a binary netlist image" << std::endl;
+    std::cout << "  load <file.dlsn>      - Map a binary netlist image in place as the circuit ('import off' drops it)" << std::endl;
+    std::cout << "  cache on [dir] [max_mb] - Keep compiled netlists in an on-disk cache for later runs" << std::endl;
+    std::cout << "  cache [stats|clear|off] - Hit and miss counts, empty the cache, or stop using it" << std::endl;
+    std::cout << "  circuit               - Build the netlist and show its size" << std::endl;
+    std::cout << "  circuit table [rows]  - Truth table of all circuit outputs over every input combination" << std::endl;
+    std::cout << "  circuit bdd           - BDD size and satisfying row count of every circuit output" << std::endl;
+    std::cout << "  circuit equiv <a> <b> - Exact equivalence of two circuit outputs, with a counterexample" << std::endl;
+    std::cout << "  simulate              - Evaluate the connected circuit and show its outputs" << std::endl;
+    std::cout << "  clock [cycles]        - Clock the flip-flops, evaluating the logic once per edge, and show the state" << std::endl;
+    std::cout << "  clock reset           - Put flip-flops and latches back to their initial values" << std::endl;
+    std::cout << "  clock domain <name> <period> [phase] [enable=<net>] [prefix=<p>]" << std::endl;
+    std::cout << "                        - Clock the flip-flops named <p>... separately, gated by <net>" << std::endl;
+    std::cout << "  clock domains         - Clock domains, their next edges and the evaluations gating saved" << std::endl;
+    std::cout << "  clock domain clear    - Back to one global clock" << std::endl;
+    std::cout << "  clock until <time>    - Take every clock domain edge up to <time>" << std::endl;
+    std::cout << "  module define <name> [outputs...] - Turn the created gates (or the imported netlist, with its own" << std::endl;
+    std::cout << "                        outputs) into a module; the created gates and the import are then cleared" << std::endl;
+    std::cout << "  module inst <module> <name> <nets...> - Instantiate a module, unknown nets become design inputs" << std::endl;
+    std::cout << "  module set <net> <0|1> / module eval <net> / module clock [cycles] - Simulate the design unflattened" << std::endl;
+    std::cout << "  module output <nets...> / module list / module stats - Design outputs, contents and memory" << std::endl;
+    std::cout << "  module flatten / module clear - Load the flattened design as the circuit, or drop the design" << std::endl;
+    std::cout << "  logic [2|4]           - Two-valued or four-valued (0/1/X/Z) simulation, unset pins read X" << std::endl;
+    std::cout << "  run [cycles]          - Simulate random input vectors and report cycles per second" << std::endl;
+    std::cout << "  run parallel [cycles] [threads] - Level-parallel run on a work-stealing thread pool" << std::endl;
+    std::cout << "  run event [vectors] [toggles] [inertial|transport]" << std::endl;
+    std::cout << "                        - Event-driven run, reports events per second and activity factor" << std::endl;
+    std::cout << "  delay <name> <ticks>  - Set a gate's propagation delay for event-driven runs" << std::endl;
+    std::cout << "  bench lanes [g] [p]   - Compare scalar, 64-bit and SIMD lanes on a random netlist" << std::endl;
+    std::cout << "  bench parallel [n] [bits] [threads] - Level-parallel scaling on adder and multiplier arrays" << std::endl;
+    std::cout << "  bench alloc [gates]   - Gate build/teardown time and RSS, GatePool vs shared_ptr" << std::endl;
+    std::cout << "  bench dispatch [n] [bits] - Virtual vs switch vs type-grouped gate evaluation" << std::endl;
+    std::cout << "  bench table [inputs]  - Row-based vs bit-packed truth table time and memory" << std::endl;
+    std::cout << "  bench verify [inputs] [threads] - Exhaustive gate check scaling from 1 to N threads" << std::endl;
+    std::cout << "  bench ctable [bits]   - Ripple adder truth table, one pass per output vs all outputs per pass" << std::endl;
+    std::cout << "  bench kmap [vars] [n] [threads] - Quine-McCluskey on random functions, serial and threaded" << std::endl;
+    std::cout << "  bench espresso [i] [o] [terms] - Espresso on a wide split cover, stats per iteration" << std::endl;
+    std::cout << "  bench bdd [a] [m]     - Adder equivalence against its spec and multiplier BDD growth" << std::endl;
+    std::cout << "  bench expr [v] [t] [n] - Compiled expression bytecode vs the same gate netlist" << std::endl;
+    std::cout << "  bench import [gates]  - Verilog and BLIF import rate on a random netlist, checked by simulation" << std::endl;
+    std::cout << "  bench image [gates]   - Startup from a mapped binary netlist vs parsing Verilog" << std::endl;
+    std::cout << "  bench cache [gates]   - Simulator setup from the compiled cache vs compiling, and LRU eviction" << std::endl;
+    std::cout << "  bench seq [n] [bits]  - Clocked counters on the packed cycle-based engine vs gate objects" << std::endl;
+    std::cout << "  bench logic [gates]   - Two-valued vs four-valued (0/1/X/Z) sweeps, X propagation checked" << std::endl;
+    std::cout << "  bench clocks [bits]   - Counters on four clocks, one gated, scheduled per domain vs a full sweep" << std::endl;
+    std::cout << "  bench bus [drivers]   - Tri-state buses resolved 64 lanes at a time vs one lane and driver at a time" << std::endl;
+    std::cout << "  bench modules [n]     - n instances of one counter module: memory and speed unflattened vs flattened" << std::endl;
     std::cout << "  clear                 - Clear screen" << std::endl;
     std::cout << "  help                  - Show this help message" << std::endl;
     std::cout << "  exit                  - Exit the simulator" << std::endl;
     std::cout << std::endl;
     std::cout << "Gate types: and, or, not, nand, nor, xor, xnor, buffer" << std::endl;
+    std::cout << "State elements (pins): dff (d), tff (t), jkff (j k), srff (s r), latch (d enable)" << std::endl;
+    std::cout << "Bus drivers (pins): tribuf (d enable), tgate (d control); resolved nets: wand, wor, bus (one pin per driver)" << std::endl;
 }
 
 void InteractiveSimulator::handleExit(const std::vector<std::string> &tokens)
@@ -342,6 +567,26 @@ std::string InteractiveSimulator::getGateTypeName(GateType type)
         return "XNOR";
     case GateType::Buffer:
         return "BUFFER";
+    case GateType::FlipFlop:
+        return "DFF";
+    case GateType::JKFlipFlop:
+        return "JKFF";
+    case GateType::TFlipFlop:
+        return "TFF";
+    case GateType::SRFlipFlop:
+        return "SRFF";
+    case GateType::Latch:
+        return "LATCH";
+    case GateType::TriState:
+        return "TRIBUF";
+    case GateType::TransmissionGate:
+        return "TGATE";
+    case GateType::WiredAnd:
+        return "WAND";
+    case GateType::WiredOr:
+        return "WOR";
+    case GateType::Bus:
+        return "BUS";
     default:
         return "UNKNOWN";
     }
@@ -366,150 +611,1618 @@ void InteractiveSimulator::handleTable(const std::vector<std::string> &tokens)
             return;
         }
 
-        auto &gate = it->second;
+        Gate *gate = gatePool.get(it->second);
+        if (GateFactory::isSequential(gate->getType()))
+        {
+            std::cout << "'" << gateName << "' holds state, so it has no truth table. Use 'clock' to step it." << std::endl;
+            return;
+        }
         int numInputs = gate->getInputCount();
-        int numCombinations = 1 << numInputs; // 2^numInputs
+        if (numInputs > PackedTruthTable::MaxInputs)
+        {
+            std::cout << "'" << gateName << "' has " << numInputs << " inputs, too many to store its truth table." << std::endl;
+            std::cout << "Use 'test " << gateName << "' to verify it without storing the table." << std::endl;
+            return;
+        }
 
         std::cout << "Generating Truth Table for '" << gateName
                   << "' (" << getGateTypeName(gate->getType()) << " gate)..." << std::endl;
         std::cout << std::endl;
 
-        // Create a vector to store actual outputs (we'll use these as "expected" for display)
-        std::vector<bool> actualOutputs(numCombinations);
+        // Inputs are implicit in the row number and outputs are bitmaps, so the
+        // gate is evaluated 64 combinations per kernel call without building rows
+        std::vector<bool> expectedResults = generateExpectedResults(gate->getType(), numInputs);
+        PackedTruthTable truthTable(gate, expectedResults);
+        truthTable.evaluateGate();
+
+        // Display the truth table
+        truthTable.printToConsole();
 
-        // Generate all input combinations and evaluate the gate
-        for (int i = 0; i < numCombinations; i++)
+        // Since we used actual outputs as expected, verification should show 100% accuracy
+        std::cout << std::endl;
+        std::cout << "Truth table generated successfully!" << std::endl;
+        std::cout << "Total combinations: " << truthTable.getNumRows() << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "Error: " << e.what() << std::endl;
+    }
+}
+void InteractiveSimulator::handleTest(const std::vector<std::string> &tokens)
+{
+    try
+    {
+        bool checkAll = false;
+        unsigned threads = std::thread::hardware_concurrency();
+        bool validArgs = tokens.size() >= 2 && tokens.size() <= 4;
+        for (size_t i = 2; i < tokens.size() && validArgs; i++)
         {
-            // Convert i to binary representation for inputs
-            std::vector<bool> inputs(numInputs);
-            for (int bit = 0; bit < numInputs; bit++)
+            if (tokens[i] == "all")
             {
-                inputs[bit] = (i >> bit) & 1;
+                checkAll = true;
             }
-
-            // Set gate inputs and evaluate
-            for (int j = 0; j < numInputs; j++)
+            else if (std::all_of(tokens[i].begin(), tokens[i].end(), ::isdigit) && std::stoul(tokens[i]) > 0)
+            {
+                threads = std::stoul(tokens[i]);
+            }
+            else
             {
-                gate->setInput(j, inputs[j]);
+                validArgs = false;
             }
-            gate->evaluate();
-            actualOutputs[i] = gate->getOutput();
+        }
+        if (!validArgs)
+        {
+            std::cout << "Usage: test <gate_name> [all] [threads]" << std::endl;
+            std::cout << "Checks every input combination, stopping at the first mismatch unless 'all' is given" << std::endl;
+            return;
         }
 
-        // Create truth table with actual outputs as expected (for clean display)
-        std::vector<bool> expectedResults = generateExpectedResults(gate->getType(), numInputs);
-        TruthTable truthTable(gate.get(), expectedResults);
+        std::string gateName = tokens[1];
+        auto it = gates.find(gateName);
+        if (it == gates.end())
+        {
+            std::cout << "Gate not found: " << gateName << std::endl;
+            showAvailableGates();
+            return;
+        }
 
-        // Generate combinations and evaluate (this will match our pre-calculated outputs)
-        truthTable.generateInputCombinations(numInputs);
-        truthTable.evaluateGate();
+        // Walk the input space chunk by chunk against the reference, memory stays flat
+        Gate *gate = gatePool.get(it->second);
+        GateType type = gate->getType();
+        if (GateFactory::isSequential(type))
+        {
+            std::cout << "'" << gateName << "' holds state, so it has no truth table to test. Use 'clock' to step it." << std::endl;
+            return;
+        }
+        TruthTableStream stream(gate, [this, type](const uint64_t *inputWords, int numInputs)
+                                { return calculateExpectedWord(type, inputWords, numInputs); });
+        stream.setStopOnMismatch(!checkAll);
+        stream.setProgressCallback([](const TruthTableStream::Result &partial)
+                                   {
+                                       std::ostringstream line;
+                                       line << std::fixed << std::setprecision(1) << 100.0 * partial.rowsChecked / partial.totalRows
+                                            << "% of " << partial.totalRows << " combinations, " << std::setprecision(0)
+                                            << partial.rowsPerSecond() << " rows/s";
+                                       std::cout << "\r  " << line.str() << std::flush; });
 
-        // Display the truth table
-        truthTable.printToConsole();
+        std::cout << "Testing '" << gateName << "' (" << getGateTypeName(type) << " gate) over "
+                  << stream.getNumRows() << " combinations on " << std::max(1u, threads) << " thread(s)..." << std::endl;
+        TruthTableStream::Result result;
+        if (threads > 1)
+        {
+            // each thread checks its own ranges of the input space, results are merged at the end
+            ThreadPool pool(threads);
+            result = stream.run(pool);
+        }
+        else
+        {
+            result = stream.run();
+        }
+        std::cout << "\r" << std::string(60, ' ') << "\r";
+        TruthTableStream::printValidationReport(result);
+        std::cout << "Time: " << result.seconds * 1000 << " ms (" << result.rowsPerSecond() << " rows/s)" << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "Error: " << e.what() << std::endl;
+    }
+}
 
-        // Since we used actual outputs as expected, verification should show 100% accuracy
-        std::cout << std::endl;
-        std::cout << "Truth table generated successfully!" << std::endl;
-        std::cout << "Total combinations: " << numCombinations << std::endl;
+void InteractiveSimulator::handleMinimize(const std::vector<std::string> &tokens)
+{
+    try
+    {
+        if (tokens.size() < 2)
+        {
+            std::cout << "Usage: minimize <gate_name>" << std::endl;
+            std::cout << "       minimize <vars> <minterms...> [dc <dont_cares...>]" << std::endl;
+            std::cout << "Example: minimize 4 0 1 2 5 6 7 8 9 10 14" << std::endl;
+            return;
+        }
+
+        std::unique_ptr<KMapSolver> solver;
+        auto it = gates.find(tokens[1]);
+        if (it != gates.end())
+        {
+            // the gate's reference function, variables named after the truth table columns
+            Gate *gate = gatePool.get(it->second);
+            if (GateFactory::isSequential(gate->getType()))
+            {
+                std::cout << "'" << tokens[1] << "' holds state, so it has no function to minimize" << std::endl;
+                return;
+            }
+            if (gate->getInputCount() > KMapSolver::MaxVariables)
+            {
+                std::cout << "'" << tokens[1] << "' has too many inputs to minimize" << std::endl;
+                return;
+            }
+            PackedTruthTable table(gate, generateExpectedResults(gate->getType(), gate->getInputCount()));
+            solver = std::make_unique<KMapSolver>(KMapSolver::fromTruthTable(table));
+            std::cout << "Minimizing '" << tokens[1] << "' (" << getGateTypeName(gate->getType()) << " gate)..." << std::endl;
+        }
+        else
+        {
+            int numVariables = std::stoi(tokens[1]);
+            std::vector<uint32_t> minterms;
+            std::vector<uint32_t> dontCares;
+            bool inDontCares = false;
+            for (size_t i = 2; i < tokens.size(); i++)
+            {
+                if (tokens[i] == "dc")
+                {
+                    inDontCares = true;
+                    continue;
+                }
+                (inDontCares ? dontCares : minterms).push_back(std::stoul(tokens[i]));
+            }
+            solver = std::make_unique<KMapSolver>(numVariables, minterms, dontCares);
+        }
+
+        KMapSolver::Solution sop = solver->minimizeSop();
+        KMapSolver::Solution pos = solver->minimizePos();
+        int numVariables = solver->getNumVariables();
+        std::cout << "SOP: " << solver->toString(sop) << std::endl;
+        std::cout << "     " << sop.cover.size() << " terms, " << sop.literalCount(numVariables) << " literals, "
+                  << sop.primes.size() << " prime implicants, " << sop.essentialCount << " essential" << std::endl;
+        std::cout << "POS: " << solver->toString(pos) << std::endl;
+        std::cout << "     " << pos.cover.size() << " terms, " << pos.literalCount(numVariables) << " literals, "
+                  << pos.primes.size() << " prime implicants, " << pos.essentialCount << " essential" << std::endl;
+        if (!solver->verify(sop) || !solver->verify(pos))
+        {
+            std::cout << "✗ Minimized form does not match the function" << std::endl;
+        }
     }
     catch (const std::exception &e)
     {
         std::cout << "Error: " << e.what() << std::endl;
     }
 }
-void InteractiveSimulator::handleTest(const std::vector<std::string> &tokens)
+
+void InteractiveSimulator::handleEspresso(const std::vector<std::string> &tokens)
 {
-    // TODO: Implement interactive testing mode
-    std::cout << "Interactive testing mode not yet implemented." << std::endl;
+    try
+    {
+        if (tokens.size() != 2 && tokens.size() != 3)
+        {
+            std::cout << "Usage: espresso <input.pla> [output.pla]" << std::endl;
+            return;
+        }
+
+        CubeList onSet;
+        CubeList dontCares;
+        Espresso::readPla(tokens[1], onSet, dontCares);
+        std::cout << "Read " << onSet.getNumInputs() << " inputs, " << onSet.getNumOutputs() << " outputs, "
+                  << onSet.size() << " on-set and " << dontCares.size() << " don't-care cubes" << std::endl;
+
+        Espresso espresso(onSet, dontCares);
+        const CubeList &cover = espresso.minimize();
+        std::cout << std::left << std::setw(11) << "Iteration" << std::setw(14) << "Phase" << std::setw(10) << "Cubes"
+                  << std::setw(10) << "Literals" << "Time (ms)" << std::endl;
+        for (const Espresso::IterationStats &step : espresso.getStats())
+        {
+            std::cout << std::left << std::setw(11) << step.iteration << std::setw(14) << step.phase << std::setw(10) << step.cubes
+                      << std::setw(10) << step.literals << step.seconds * 1000 << std::endl;
+        }
+        std::cout << "Result: " << cover.size() << " cubes, " << cover.literalCount() << " literals, "
+                  << espresso.getTautologyChecks() << " tautology checks (" << espresso.getInconclusiveChecks()
+                  << " over budget)" << std::endl;
+        if (!espresso.verify())
+        {
+            std::cout << "✗ Minimized cover does not match the input" << std::endl;
+            return;
+        }
+
+        if (tokens.size() == 3)
+        {
+            Espresso::writePla(tokens[2], cover);
+            std::cout << "✓ Wrote " << tokens[2] << std::endl;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "Error: " << e.what() << std::endl;
+    }
 }
 
-void InteractiveSimulator::handleDelete(const std::vector<std::string> &tokens)
+void InteractiveSimulator::handleImport(const std::vector<std::string> &tokens)
 {
     if (tokens.size() != 2)
     {
-        std::cout << "Usage: delete <gate_name>" << std::endl;
+        std::cout << "Usage: import <netlist.v|netlist.blif>" << std::endl;
+        std::cout << "       import off" << std::endl;
+        return;
+    }
+    if (tokens[1] == "off")
+    {
+        importedCircuit.reset();
+        invalidateCircuit();
+        std::cout << "✓ Back to the " << gates.size() << " created gates" << std::endl;
         return;
     }
 
-    std::string gateName = tokens[1];
-    auto it = gates.find(gateName);
-    if (it == gates.end())
+    NetlistImporter::Stats stats;
+    Circuit circuit = NetlistImporter::load(tokens[1], &stats);
+    importedCircuit = std::make_unique<Circuit>(std::move(circuit));
+    invalidateCircuit();
+    std::cout << "✓ Imported " << tokens[1] << ": " << stats.gates << " gates, " << stats.inputs << " inputs, "
+              << stats.outputs << " outputs" << std::endl;
+    std::cout << "Read " << stats.bytes / 1024 << " KiB in " << stats.seconds * 1000 << " ms ("
+              << stats.bytes / stats.seconds / 1e6 << " MB/s, " << stats.gates / stats.seconds / 1e6 << " M gates/s)" << std::endl;
+    std::cout << "circuit, simulate and run now use this netlist, 'import off' returns to the created gates" << std::endl;
+}
+
+void InteractiveSimulator::handleExport(const std::vector<std::string> &tokens)
+{
+    if (tokens.size() != 2)
     {
-        std::cout << "Gate '" << gateName << "' not found." << std::endl;
+        std::cout << "Usage: export <netlist.v|netlist.blif>" << std::endl;
         return;
     }
+    Circuit circuit = buildCircuit();
+    const std::string &path = tokens[1];
+    if (path.size() >= 5 && path.compare(path.size() - 5, 5, ".blif") == 0)
+        NetlistImporter::writeBlif(circuit, path);
+    else
+        NetlistImporter::writeVerilog(circuit, path);
+    std::cout << "✓ Wrote " << circuit.getGateCount() << " gates to " << path << std::endl;
+}
 
-    gates.erase(it);
-    std::cout << "✓ Deleted gate '" << gateName << "'" << std::endl;
+void InteractiveSimulator::handleSave(const std::vector<std::string> &tokens)
+{
+    if (tokens.size() != 2)
+    {
+        std::cout << "Usage: save <netlist.dlsn>" << std::endl;
+        return;
+    }
+    Circuit circuit = buildCircuit();
+    BinaryNetlist::save(circuit, tokens[1]);
+    std::cout << "✓ Saved " << circuit.getGateCount() << " gates to " << tokens[1] << std::endl;
 }
 
-// Add this helper method to show available gates
-void InteractiveSimulator::showAvailableGates()
+void InteractiveSimulator::handleLoad(const std::vector<std::string> &tokens)
 {
-    if (gates.empty())
+    if (tokens.size() != 2)
     {
-        std::cout << "No gates have been created yet." << std::endl;
+        std::cout << "Usage: load <netlist.dlsn>" << std::endl;
         return;
     }
+    auto start = std::chrono::steady_clock::now();
+    Circuit circuit = BinaryNetlist::load(tokens[1]);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    importedCircuit = std::make_unique<Circuit>(std::move(circuit));
+    invalidateCircuit();
+    std::cout << "✓ Mapped " << tokens[1] << ": " << importedCircuit->getGateCount() << " gates, "
+              << importedCircuit->getInputCount() << " inputs, " << importedCircuit->getOutputCount() << " outputs in "
+              << seconds * 1e6 << " us" << std::endl;
+    std::cout << "circuit, simulate and run now use this netlist, 'import off' returns to the created gates" << std::endl;
+}
 
-    std::cout << "Available gates:" << std::endl;
-    for (const auto &pair : gates)
+void InteractiveSimulator::handleCache(const std::vector<std::string> &tokens)
+{
+    std::string action = tokens.size() > 1 ? tokens[1] : "stats";
+    if (action == "on")
+    {
+        std::string directory = tokens.size() > 2 ? tokens[2] : (std::filesystem::temp_directory_path() / "dls-cache").string();
+        uint64_t maxMegabytes = tokens.size() > 3 ? std::stoull(tokens[3]) : 256;
+        compiledCache = std::make_unique<CompiledCache>(directory, maxMegabytes << 20);
+        std::cout << "✓ Compiled netlists are cached in " << directory << " (up to " << maxMegabytes << " MB, "
+                  << compiledCache->getEntryCount() << " entries there now)" << std::endl;
+        return;
+    }
+    if (action == "off")
+    {
+        compiledCache.reset();
+        std::cout << "✓ Compiled cache off, entries stay on disk" << std::endl;
+        return;
+    }
+    if (!compiledCache)
     {
-        std::cout << "- " << pair.first << " (" << getGateTypeName(pair.second->getType()) << ")" << std::endl;
+        std::cout << "The compiled cache is off. Usage: cache on [dir] [max_mb]" << std::endl;
+        return;
+    }
+    if (action == "clear")
+    {
+        compiledCache->clear();
+        std::cout << "✓ Cleared " << compiledCache->getDirectory() << std::endl;
+        return;
     }
+    if (action != "stats")
+    {
+        std::cout << "Usage: cache on [dir] [max_mb] | cache stats | cache clear | cache off" << std::endl;
+        return;
+    }
+    const CompiledCache::Stats &stats = compiledCache->getStats();
+    std::cout << "Cache: " << compiledCache->getDirectory() << ", " << compiledCache->getEntryCount() << " entries, "
+              << compiledCache->getSizeBytes() / 1024 << " of " << (compiledCache->getMaxBytes() >> 10) << " KiB" << std::endl;
+    std::cout << "Hits: " << stats.hits << ", misses: " << stats.misses << " (hit rate " << stats.hitRate() * 100 << "%)" << std::endl;
+    std::cout << "Stored: " << stats.stores << ", evicted: " << stats.evictions << ", rejected: " << stats.rejected << std::endl;
 }
 
-std::vector<bool> InteractiveSimulator::generateExpectedResults(GateType type, int numInputs)
+void InteractiveSimulator::handleClock(const std::vector<std::string> &tokens)
 {
-    int numCombinations = 1 << numInputs;
-    std::vector<bool> expected;
+    if (tokens.size() >= 2 && tokens[1] == "domain")
+    {
+        handleClockDomain(tokens);
+        return;
+    }
+    if (tokens.size() == 2 && tokens[1] == "domains")
+    {
+        showClockDomains();
+        return;
+    }
+    if (tokens.size() > 3 || (tokens.size() == 3 && tokens[1] != "until"))
+    {
+        std::cout << "Usage: clock [cycles]" << std::endl;
+        std::cout << "       clock reset" << std::endl;
+        std::cout << "       clock until <time>" << std::endl;
+        std::cout << "       clock domain <name> <period> [phase] [enable=<net>] [prefix=<p>]" << std::endl;
+        std::cout << "       clock domain clear" << std::endl;
+        std::cout << "       clock domains" << std::endl;
+        return;
+    }
+    if (!getCompiledCircuit().hasStateElements())
+    {
+        std::cout << "The circuit has no flip-flops or latches to clock, use 'simulate'" << std::endl;
+        return;
+    }
+    SequentialSimulator &simulator = getSequentialSimulator();
+    if (tokens.size() == 2 && tokens[1] == "reset")
+    {
+        if (clockScheduler)
+        {
+            clockScheduler->reset();
+        }
+        else
+        {
+            simulator.reset();
+        }
+        simulator.evaluate();
+        std::cout << "✓ Flip-flops and latches back to their initial values" << std::endl;
+        return;
+    }
 
-    for (int i = 0; i < numCombinations; i++)
+    auto start = std::chrono::steady_clock::now();
+    if (clockScheduler)
     {
-        std::vector<bool> inputs(numInputs);
-        for (int bit = 0; bit < numInputs; bit++)
+        // with clock domains a step is one instant of the merged timeline, where any clock has an edge
+        uint64_t instants = 0;
+        if (tokens.size() == 3)
         {
-            inputs[bit] = (i >> bit) & 1;
+            instants = clockScheduler->runUntil(std::stoull(tokens[2]));
         }
+        else
+        {
+            instants = tokens.size() == 2 ? std::stoull(tokens[1]) : 1;
+            clockScheduler->runEdges(instants);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "✓ Took " << instants << " edge instant(s), now at time " << clockScheduler->getTime() << " ("
+                  << seconds * 1000 << " ms)" << std::endl;
+    }
+    else
+    {
+        if (tokens.size() == 3)
+        {
+            std::cout << "'clock until' needs clock domains, see 'clock domain'" << std::endl;
+            return;
+        }
+        uint64_t cycles = tokens.size() == 2 ? std::stoull(tokens[1]) : 1;
+        simulator.clock(cycles);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "✓ Clocked " << cycles << " edge(s), now at cycle " << simulator.getCycle() << " (" << seconds * 1000 << " ms)" << std::endl;
+    }
 
-        // Calculate expected output based on gate type and inputs
-        bool expectedOutput = calculateExpectedOutput(type, inputs);
-        expected.push_back(expectedOutput);
+    // state elements, then the outputs, as long as the lists stay readable
+    const Circuit &circuit = *compiledCircuit;
+    const size_t maxListed = 32;
+    size_t listed = 0;
+    std::cout << "State:";
+    for (Circuit::NodeId node = 0; node < circuit.getNodeCount() && listed <= maxListed; node++)
+    {
+        if (!circuit.isInput(node) && GateFactory::isSequential(circuit.getGateType(node)))
+        {
+            if (listed++ == maxListed)
+            {
+                std::cout << " ...";
+                break;
+            }
+            std::cout << " " << circuit.getName(node) << "=" << logicChar(simulator.getLogic(node));
+        }
     }
-    return expected;
+    std::cout << std::endl;
+    std::cout << "Outputs:";
+    for (size_t i = 0; i < circuit.getOutputCount() && i < maxListed; i++)
+    {
+        std::cout << " " << circuit.getName(circuit.getOutputs()[i]) << "=" << logicChar(simulator.getLogic(circuit.getOutputs()[i]));
+    }
+    std::cout << (circuit.getOutputCount() > maxListed ? " ..." : "") << std::endl;
 }
 
-bool InteractiveSimulator::calculateExpectedOutput(GateType type, const std::vector<bool> &inputs)
+void InteractiveSimulator::handleClockDomain(const std::vector<std::string> &tokens)
 {
-    switch (type)
-    {
-    case GateType::And:
-        return std::all_of(inputs.begin(), inputs.end(), [](bool val)
-                           { return val; });
-    case GateType::Or:
-        return std::any_of(inputs.begin(), inputs.end(), [](bool val)
-                           { return val; });
-    case GateType::Not:
-        return !inputs[0];
-    case GateType::Nand:
-        return !std::all_of(inputs.begin(), inputs.end(), [](bool val)
-                            { return val; });
-    case GateType::Nor:
-        return !std::any_of(inputs.begin(), inputs.end(), [](bool val)
-                            { return val; });
-    case GateType::Xor:
+    if (tokens.size() == 3 && tokens[2] == "clear")
     {
-        int trueCount = std::count(inputs.begin(), inputs.end(), true);
-        return (trueCount % 2 == 1);
+        clockDomains.clear();
+        clockScheduler.reset();
+        std::cout << "✓ Clock domains cleared, all flip-flops are on one clock again" << std::endl;
+        return;
     }
-    case GateType::Xnor:
+    if (tokens.size() < 4 || tokens.size() > 7)
     {
-        int trueCount = std::count(inputs.begin(), inputs.end(), true);
-        return (trueCount % 2 == 0);
+        std::cout << "Usage: clock domain <name> <period> [phase] [enable=<net>] [prefix=<p>]" << std::endl;
+        std::cout << "       clock domain clear" << std::endl;
+        std::cout << "Example: clock domain slow 4 1 enable=u2.en prefix=u2." << std::endl;
+        return;
     }
-    case GateType::Buffer:
-        return inputs[0];
+
+    ClockDefinition clock;
+    clock.name = tokens[2];
+    clock.period = std::stoull(tokens[3]);
+    for (size_t i = 4; i < tokens.size(); i++)
+    {
+        if (tokens[i].rfind("enable=", 0) == 0)
+        {
+            clock.enable = tokens[i].substr(7);
+        }
+        else if (tokens[i].rfind("prefix=", 0) == 0)
+        {
+            clock.prefix = tokens[i].substr(7);
+        }
+        else
+        {
+            clock.phase = std::stoull(tokens[i]);
+        }
+    }
+    if (clock.period == 0)
+    {
+        std::cout << "The period must be at least 1" << std::endl;
+        return;
+    }
+
+    // a clock of the same name is redefined in place
+    auto existing = std::find_if(clockDomains.begin(), clockDomains.end(),
+                                 [&](const ClockDefinition &other) { return other.name == clock.name; });
+    if (existing != clockDomains.end())
+    {
+        *existing = clock;
+    }
+    else if (clockDomains.size() == SequentialSimulator::MaxDomains)
+    {
+        std::cout << "At most " << SequentialSimulator::MaxDomains << " clock domains are supported" << std::endl;
+        return;
+    }
+    else
+    {
+        clockDomains.push_back(clock);
+    }
+    // the flip-flops are regrouped, so the state starts over
+    clockScheduler.reset();
+    std::cout << "✓ Clock '" << clock.name << "': period " << clock.period << ", first edge at " << clock.phase
+              << (clock.enable.empty() ? "" : ", gated by " + clock.enable)
+              << ", flip-flops " << (clock.prefix.empty() ? "not claimed by another clock" : clock.prefix + "*") << std::endl;
+}
+
+void InteractiveSimulator::showClockDomains()
+{
+    if (clockDomains.empty())
+    {
+        std::cout << "No clock domains, every flip-flop is on one global clock. See 'clock domain'." << std::endl;
+        return;
+    }
+    if (!getCompiledCircuit().hasStateElements())
+    {
+        std::cout << "The circuit has no flip-flops or latches to clock" << std::endl;
+        return;
+    }
+    ClockScheduler &scheduler = getClockScheduler();
+    const SequentialSimulator &simulator = scheduler.getSimulator();
+    std::cout << "Time " << scheduler.getTime() << ", " << scheduler.getInstants() << " edge instants, "
+              << simulator.getSegmentCount() << " logic segments" << std::endl;
+    std::cout << std::left << std::setw(12) << "Clock" << std::right << std::setw(7) << "Period" << std::setw(7) << "Phase"
+              << std::setw(7) << "FFs" << std::setw(8) << "Cone" << std::setw(10) << "Edges" << std::setw(10) << "Gated"
+              << std::setw(12) << "Skipped" << "  Enable" << std::endl;
+    std::vector<ClockScheduler::DomainReport> reports = scheduler.getReport();
+    for (size_t i = 0; i < reports.size(); i++)
+    {
+        const ClockScheduler::DomainReport &report = reports[i];
+        const ClockDefinition &clock = scheduler.getClocks()[i];
+        std::cout << std::left << std::setw(12) << report.name << std::right << std::setw(7) << clock.period << std::setw(7) << clock.phase
+                  << std::setw(7) << report.stats.flipFlops << std::setw(8) << report.stats.coneGates << std::setw(10) << report.stats.edges
+                  << std::setw(10) << report.stats.gatedOff << std::setw(12) << report.skippedEvaluations << "  "
+                  << (clock.enable.empty() ? "-" : clock.enable) << std::endl;
+    }
+    uint64_t evaluated = simulator.getGateEvaluations();
+    uint64_t fullSweep = scheduler.getFullSweepEvaluations();
+    std::cout << "Gate evaluations: " << evaluated << ", a full sweep at every instant: " << fullSweep;
+    if (fullSweep > 0)
+    {
+        std::cout << " (" << std::fixed << std::setprecision(1) << 100.0 * evaluated / fullSweep << "%)" << std::defaultfloat;
+    }
+    std::cout << std::endl;
+    std::cout << "Next edges:";
+    for (const auto &instant : scheduler.getTimeline(8))
+    {
+        std::cout << " " << instant.first << "[";
+        bool first = true;
+        for (uint32_t i = 0; i < scheduler.getClocks().size(); i++)
+        {
+            if (instant.second >> i & 1)
+            {
+                std::cout << (first ? "" : ",") << scheduler.getClocks()[i].name;
+                first = false;
+            }
+        }
+        std::cout << "]";
+    }
+    std::cout << std::endl;
+}
+
+void InteractiveSimulator::handleModule(const std::vector<std::string> &tokens)
+{
+    const std::string sub = tokens.size() > 1 ? tokens[1] : "";
+    if (sub == "define" && tokens.size() >= 3)
+    {
+        // the body is the imported netlist as it is, or the created gates with the listed outputs,
+        // by default every gate no other gate reads
+        std::vector<std::string> outputs(tokens.begin() + 3, tokens.end());
+        if (importedCircuit && !outputs.empty())
+        {
+            std::cout << "The imported netlist keeps its own outputs, use 'import off' to pick outputs among the created gates" << std::endl;
+            return;
+        }
+        if (!importedCircuit && outputs.empty())
+        {
+            for (const auto &pair : gates)
+            {
+                if (!std::any_of(wiring.begin(), wiring.end(), [&](const auto &entry)
+                                 { return std::find(entry.second.begin(), entry.second.end(), pair.first) != entry.second.end(); }))
+                {
+                    outputs.push_back(pair.first);
+                }
+            }
+        }
+        if (!moduleDesign)
+        {
+            moduleDesign = std::make_unique<HierarchicalCircuit>();
+        }
+        HierarchicalCircuit::DefinitionId definition = moduleDesign->define(tokens[2], buildCircuit(outputs));
+        moduleSimulator.reset();
+        const Circuit &body = moduleDesign->getDefinition(definition).body;
+        std::cout << "✓ Module '" << tokens[2] << "': " << body.getGateCount() << " gates" << std::endl;
+        std::cout << "Ports in:";
+        for (Circuit::NodeId node : body.getInputs())
+        {
+            std::cout << " " << body.getName(node);
+        }
+        std::cout << std::endl;
+        std::cout << "Ports out:";
+        for (Circuit::NodeId node : body.getOutputs())
+        {
+            std::cout << " " << body.getName(node);
+        }
+        std::cout << std::endl;
+
+        // the workspace is free for the next module
+        std::cout << "Workspace cleared for the next module: " << gates.size() << " created gates removed"
+                  << (importedCircuit ? ", imported netlist dropped" : "") << std::endl;
+        for (const auto &pair : gates)
+        {
+            gatePool.destroy(pair.second);
+        }
+        gates.clear();
+        wiring.clear();
+        pinLogic.clear();
+        importedCircuit.reset();
+        invalidateCircuit();
+        return;
+    }
+    if (sub == "inst" && tokens.size() >= 4)
+    {
+        HierarchicalCircuit::DefinitionId definition = moduleDesign ? moduleDesign->findDefinition(tokens[2]) : HierarchicalCircuit::InvalidId;
+        if (definition == HierarchicalCircuit::InvalidId)
+        {
+            std::cout << "Module '" << tokens[2] << "' not found" << std::endl;
+            return;
+        }
+        const Circuit &body = moduleDesign->getDefinition(definition).body;
+        if (tokens.size() - 4 != body.getInputCount())
+        {
+            std::cout << "Module '" << tokens[2] << "' has " << body.getInputCount() << " input ports, " << tokens.size() - 4 << " nets given" << std::endl;
+            return;
+        }
+        std::vector<HierarchicalCircuit::NetId> inputs;
+        for (size_t t = 4; t < tokens.size(); t++)
+        {
+            HierarchicalCircuit::NetId net = moduleDesign->findNet(tokens[t]);
+            inputs.push_back(net != HierarchicalCircuit::InvalidId ? net : moduleDesign->addInput(tokens[t]));
+        }
+        HierarchicalCircuit::InstanceId instance = moduleDesign->instantiate(definition, tokens[3], inputs);
+        moduleSimulator.reset();
+        std::cout << "✓ Instance '" << tokens[3] << "' of '" << tokens[2] << "', drives";
+        for (uint32_t p = 0; p < body.getOutputCount(); p++)
+        {
+            std::cout << " " << moduleDesign->getNetName(moduleDesign->getFirstOutputNet(instance) + p);
+        }
+        std::cout << std::endl;
+        return;
+    }
+    if (sub == "clear" && tokens.size() == 2)
+    {
+        moduleSimulator.reset();
+        moduleDesign.reset();
+        std::cout << "✓ Module design dropped" << std::endl;
+        return;
+    }
+    if (sub != "set" && sub != "eval" && sub != "clock" && sub != "output" && sub != "list" && sub != "stats" && sub != "flatten")
+    {
+        std::cout << "Usage: module define <name> [outputs...]" << std::endl;
+        std::cout << "       module inst <module> <name> <nets...>" << std::endl;
+        std::cout << "       module set <net> <0|1>" << std::endl;
+        std::cout << "       module eval <net|instance.node>" << std::endl;
+        std::cout << "       module clock [cycles]" << std::endl;
+        std::cout << "       module output <nets...>" << std::endl;
+        std::cout << "       module list|stats|flatten|clear" << std::endl;
+        return;
+    }
+    if (!moduleDesign)
+    {
+        std::cout << "No modules defined yet, see 'module define'" << std::endl;
+        return;
+    }
+    HierarchicalCircuit &design = *moduleDesign;
+
+    if (sub == "list")
+    {
+        std::cout << std::left << std::setw(16) << "Module" << std::setw(10) << "Gates" << std::setw(8) << "In" << std::setw(8) << "Out"
+                  << "Instances" << std::endl;
+        for (HierarchicalCircuit::DefinitionId d = 0; d < design.getDefinitionCount(); d++)
+        {
+            const HierarchicalCircuit::Definition &definition = design.getDefinition(d);
+            std::cout << std::left << std::setw(16) << definition.name << std::setw(10) << definition.body.getGateCount()
+                      << std::setw(8) << definition.body.getInputCount() << std::setw(8) << definition.body.getOutputCount()
+                      << definition.instances << std::endl;
+        }
+        std::cout << "Design: " << design.getInputCount() << " inputs, " << design.getInstanceCount() << " instances, "
+                  << design.getNetCount() << " nets" << std::endl;
+        const uint32_t maxListed = 32;
+        std::cout << "Instances:";
+        for (HierarchicalCircuit::InstanceId i = 0; i < design.getInstanceCount() && i < maxListed; i++)
+        {
+            std::cout << " " << design.getInstanceName(i) << "(" << design.getDefinition(design.getInstanceDefinition(i)).name << ")";
+        }
+        std::cout << (design.getInstanceCount() > maxListed ? " ..." : "") << std::endl;
+        return;
+    }
+    if (sub == "stats")
+    {
+        HierarchicalSimulator &simulator = getModuleSimulator();
+        size_t hierarchical = design.getDefinitionMemoryUsage() + design.getInstanceMemoryUsage() +
+                              simulator.getStateMemoryUsage() + simulator.getProgramMemoryUsage();
+        std::cout << "Definitions:    " << design.getDefinitionMemoryUsage() << " bytes" << std::endl;
+        std::cout << "Instances:      " << design.getInstanceMemoryUsage() << " bytes" << std::endl;
+        std::cout << "Signal state:   " << simulator.getStateMemoryUsage() << " bytes (64 lanes per net, flip-flop and latch)" << std::endl;
+        std::cout << "Programs:       " << simulator.getProgramMemoryUsage() << " bytes, " << simulator.getCompiledCount()
+                  << " of " << design.getDefinitionCount() << " modules compiled" << std::endl;
+        std::cout << "Total:          " << hierarchical << " bytes" << std::endl;
+        std::cout << "Flattened:      " << design.flatten().getMemoryUsage() << " bytes of netlist, "
+                  << design.flatten().getNodeCount() << " nodes" << std::endl;
+        return;
+    }
+    if (sub == "flatten")
+    {
+        auto start = std::chrono::steady_clock::now();
+        importedCircuit = std::make_unique<Circuit>(design.flatten());
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        invalidateCircuit();
+        std::cout << "✓ Flattened " << design.getInstanceCount() << " instances into " << importedCircuit->getGateCount()
+                  << " gates in " << seconds * 1000 << " ms" << std::endl;
+        std::cout << "circuit, simulate and run now use this netlist, 'import off' returns to the created gates" << std::endl;
+        return;
+    }
+    if (sub == "output")
+    {
+        for (size_t t = 2; t < tokens.size(); t++)
+        {
+            HierarchicalCircuit::NetId net = design.findNet(tokens[t]);
+            if (net == HierarchicalCircuit::InvalidId)
+            {
+                std::cout << "Net '" << tokens[t] << "' not found" << std::endl;
+                return;
+            }
+            design.markOutput(net);
+        }
+        std::cout << "✓ " << design.getOutputs().size() << " design output(s)" << std::endl;
+        return;
+    }
+    if (sub == "set")
+    {
+        if (tokens.size() != 4 || (tokens[3] != "0" && tokens[3] != "1"))
+        {
+            std::cout << "Usage: module set <net> <0|1>" << std::endl;
+            return;
+        }
+        HierarchicalCircuit::NetId net = design.findNet(tokens[2]);
+        if (net == HierarchicalCircuit::InvalidId)
+        {
+            std::cout << "Net '" << tokens[2] << "' not found" << std::endl;
+            return;
+        }
+        HierarchicalSimulator &simulator = getModuleSimulator();
+        simulator.setInputNet(net, tokens[3] == "1" ? ~0ULL : 0);
+        simulator.evaluate();
+        std::cout << "✓ " << tokens[2] << " = " << tokens[3] << std::endl;
+        return;
+    }
+    if (sub == "eval")
+    {
+        if (tokens.size() != 3)
+        {
+            std::cout << "Usage: module eval <net|instance.node>" << std::endl;
+            return;
+        }
+        HierarchicalSimulator &simulator = getModuleSimulator();
+        HierarchicalCircuit::NetId net = design.findNet(tokens[2]);
+        if (net != HierarchicalCircuit::InvalidId)
+        {
+            std::cout << tokens[2] << " = " << simulator.getValue(net) << std::endl;
+            return;
+        }
+        // a node inside an instance, recomputed from the instance's ports and state
+        const std::string &name = tokens[2];
+        for (size_t dot = name.find('.'); dot != std::string::npos; dot = name.find('.', dot + 1))
+        {
+            HierarchicalCircuit::InstanceId instance = design.findInstance(name.substr(0, dot));
+            if (instance == HierarchicalCircuit::InvalidId)
+            {
+                continue;
+            }
+            Circuit::NodeId node = design.getDefinition(design.getInstanceDefinition(instance)).body.findNode(name.substr(dot + 1));
+            if (node != Circuit::InvalidNode)
+            {
+                std::cout << name << " = " << (simulator.getInstanceWord(instance, node) & 1) << std::endl;
+                return;
+            }
+        }
+        std::cout << "Net '" << name << "' not found" << std::endl;
+        return;
+    }
+
+    // clock
+    uint64_t cycles = tokens.size() > 2 ? std::stoull(tokens[2]) : 1;
+    HierarchicalSimulator &simulator = getModuleSimulator();
+    auto start = std::chrono::steady_clock::now();
+    simulator.clock(cycles);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "✓ Clocked " << cycles << " edge(s), now at cycle " << simulator.getCycle() << " (" << seconds * 1000 << " ms)" << std::endl;
+    const size_t maxListed = 32;
+    std::cout << "Outputs:";
+    for (size_t i = 0; i < design.getOutputs().size() && i < maxListed; i++)
+    {
+        std::cout << " " << design.getNetName(design.getOutputs()[i]) << "=" << simulator.getValue(design.getOutputs()[i]);
+    }
+    std::cout << (design.getOutputs().size() > maxListed ? " ..." : "") << std::endl;
+}
+
+HierarchicalSimulator &InteractiveSimulator::getModuleSimulator()
+{
+    if (!moduleSimulator)
+    {
+        moduleSimulator = std::make_unique<HierarchicalSimulator>(*moduleDesign);
+        moduleSimulator->evaluate();
+    }
+    return *moduleSimulator;
+}
+
+void InteractiveSimulator::handleLogic(const std::vector<std::string> &tokens)
+{
+    if (tokens.size() == 1)
+    {
+        std::cout << (logicMode == LogicMode::FourValued ? "Four-valued (0/1/X/Z) simulation" : "Two-valued simulation") << std::endl;
+        return;
+    }
+    if (tokens.size() != 2 || (tokens[1] != "2" && tokens[1] != "4"))
+    {
+        std::cout << "Usage: logic [2|4]" << std::endl;
+        return;
+    }
+    logicMode = tokens[1] == "4" ? LogicMode::FourValued : LogicMode::TwoValued;
+    // the engines pick the mode up when they are built again
+    invalidateCircuit();
+    if (logicMode == LogicMode::FourValued)
+    {
+        std::cout << "✓ Four-valued simulation: pins never set read X, flip-flops and latches start X, 'set' takes x and z" << std::endl;
+    }
+    else
+    {
+        std::cout << "✓ Two-valued simulation" << std::endl;
+    }
+}
+
+void InteractiveSimulator::handleExpression(const std::string &input)
+{
+    try
+    {
+        if (input.find_first_not_of(" \t") == std::string::npos)
+        {
+            std::cout << "Usage: expr <expression>" << std::endl;
+            std::cout << "Example: expr (A & B) | ~C ^ D" << std::endl;
+            return;
+        }
+
+        ExpressionDag dag;
+        ExpressionDag::NodeId root = ExpressionParser::parse(input, dag);
+        CompiledExpression compiled(dag, {root});
+        int numVariables = static_cast<int>(dag.getVariableCount());
+        std::cout << "Parsed: " << dag.toString(root) << std::endl;
+        std::cout << dag.countNodes({root}) << " shared nodes, " << compiled.getInstructions().size() << " instructions, "
+                  << compiled.getRegisterCount() << " registers" << std::endl;
+        std::cout << compiled.disassemble();
+        if (numVariables > KMapSolver::MaxVariables)
+        {
+            return;
+        }
+
+        // every row through the bytecode, row r sets variable i when bit i of r is set
+        uint64_t numRows = 1ULL << numVariables;
+        size_t words = (numRows + 63) / 64;
+        std::vector<std::vector<uint64_t>> inputs(numVariables, std::vector<uint64_t>(words));
+        std::vector<const uint64_t *> columns;
+        for (int i = 0; i < numVariables; i++)
+        {
+            for (size_t w = 0; w < words; w++)
+            {
+                inputs[i][w] = PackedTruthTable::getInputWord(i, w);
+            }
+            columns.push_back(inputs[i].data());
+        }
+        std::vector<uint64_t> result(words);
+        uint64_t *output = result.data();
+        compiled.evaluate(columns.data(), &output, words);
+
+        std::vector<uint32_t> minterms;
+        for (uint64_t row = 0; row < numRows; row++)
+        {
+            if ((result[row / 64] >> (row % 64)) & 1)
+            {
+                minterms.push_back(static_cast<uint32_t>(row));
+            }
+        }
+        std::cout << minterms.size() << " of " << numRows << " rows are true" << std::endl;
+        if (numVariables == 0)
+        {
+            return;
+        }
+        KMapSolver solver(numVariables, minterms);
+        solver.setVariableNames(dag.getVariableNames());
+        KMapSolver::Solution sop = solver.minimizeSop();
+        std::cout << "Minimal SOP: " << solver.toString(sop) << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cout << "Error: " << e.what() << std::endl;
+    }
+}
+
+void InteractiveSimulator::handleDelete(const std::vector<std::string> &tokens)
+{
+    if (tokens.size() != 2)
+    {
+        std::cout << "Usage: delete <gate_name>" << std::endl;
+        return;
+    }
+
+    std::string gateName = tokens[1];
+    auto it = gates.find(gateName);
+    if (it == gates.end())
+    {
+        std::cout << "Gate '" << gateName << "' not found." << std::endl;
+        return;
+    }
+
+    invalidateCircuit();
+    gatePool.destroy(it->second);
+    gates.erase(it);
+    wiring.erase(gateName);
+    for (auto pin = pinLogic.lower_bound(gateName + "."); pin != pinLogic.end() && pin->first.rfind(gateName + ".", 0) == 0;)
+    {
+        pin = pinLogic.erase(pin);
+    }
+    for (auto &entry : wiring)
+    {
+        std::replace(entry.second.begin(), entry.second.end(), gateName, std::string());
+    }
+    std::cout << "✓ Deleted gate '" << gateName << "'" << std::endl;
+}
+
+void InteractiveSimulator::handleBench(const std::vector<std::string> &tokens)
+{
+    if (tokens.size() < 2)
+    {
+        std::cout << "Usage: bench lanes [gates] [patterns]" << std::endl;
+        std::cout << "       bench parallel [instances] [bits] [threads]" << std::endl;
+        std::cout << "       bench alloc [gates]" << std::endl;
+        std::cout << "       bench dispatch [instances] [bits]" << std::endl;
+        std::cout << "       bench table [max_inputs]" << std::endl;
+        std::cout << "       bench verify [inputs] [threads]" << std::endl;
+        std::cout << "       bench ctable [bits]" << std::endl;
+        std::cout << "       bench kmap [vars] [functions] [threads]" << std::endl;
+        std::cout << "       bench espresso [inputs] [outputs] [terms]" << std::endl;
+        std::cout << "       bench bdd [adder_bits] [multiplier_bits]" << std::endl;
+        std::cout << "       bench expr [vars] [terms] [vectors]" << std::endl;
+        std::cout << "       bench import [gates]" << std::endl;
+        std::cout << "       bench image [gates]" << std::endl;
+        std::cout << "       bench cache [gates]" << std::endl;
+        std::cout << "       bench seq [instances] [bits]" << std::endl;
+        std::cout << "       bench clocks [bits]" << std::endl;
+        std::cout << "       bench logic [gates]" << std::endl;
+        std::cout << "       bench bus [drivers]" << std::endl;
+        std::cout << "       bench modules [instances]" << std::endl;
+        return;
+    }
+
+    std::string suite = tokens[1];
+    if (suite == "lanes")
+    {
+        int numGates = tokens.size() > 2 ? std::stoi(tokens[2]) : 10000;
+        int numPatterns = tokens.size() > 3 ? std::stoi(tokens[3]) : 1 << 16;
+        Benchmark::runLaneBenchmark(numGates, numPatterns);
+    }
+    else if (suite == "parallel")
+    {
+        uint32_t instances = tokens.size() > 2 ? std::stoul(tokens[2]) : 1024;
+        uint32_t bits = tokens.size() > 3 ? std::stoul(tokens[3]) : 32;
+        unsigned threads = tokens.size() > 4 ? std::stoul(tokens[4]) : std::thread::hardware_concurrency();
+        Benchmark::runParallelBenchmark(instances, bits, threads);
+    }
+    else if (suite == "alloc")
+    {
+        size_t numGates = tokens.size() > 2 ? std::stoull(tokens[2]) : 1000000;
+        Benchmark::runAllocationBenchmark(numGates);
+    }
+    else if (suite == "dispatch")
+    {
+        uint32_t instances = tokens.size() > 2 ? std::stoul(tokens[2]) : 64;
+        uint32_t bits = tokens.size() > 3 ? std::stoul(tokens[3]) : 16;
+        Benchmark::runDispatchBenchmark(instances, bits);
+    }
+    else if (suite == "table")
+    {
+        int maxInputs = tokens.size() > 2 ? std::stoi(tokens[2]) : 24;
+        Benchmark::runTruthTableBenchmark(maxInputs);
+    }
+    else if (suite == "verify")
+    {
+        int inputs = tokens.size() > 2 ? std::stoi(tokens[2]) : 30;
+        unsigned threads = tokens.size() > 3 ? std::stoul(tokens[3]) : std::thread::hardware_concurrency();
+        Benchmark::runVerifyBenchmark(inputs, threads);
+    }
+    else if (suite == "ctable")
+    {
+        uint32_t bits = tokens.size() > 2 ? std::stoul(tokens[2]) : 8;
+        Benchmark::runCircuitTableBenchmark(bits);
+    }
+    else if (suite == "kmap")
+    {
+        int vars = tokens.size() > 2 ? std::stoi(tokens[2]) : 14;
+        int functions = tokens.size() > 3 ? std::stoi(tokens[3]) : 5;
+        unsigned threads = tokens.size() > 4 ? std::stoul(tokens[4]) : std::thread::hardware_concurrency();
+        Benchmark::runKMapBenchmark(vars, functions, threads);
+    }
+    else if (suite == "espresso")
+    {
+        int inputs = tokens.size() > 2 ? std::stoi(tokens[2]) : 48;
+        int outputs = tokens.size() > 3 ? std::stoi(tokens[3]) : 200;
+        int terms = tokens.size() > 4 ? std::stoi(tokens[4]) : 100;
+        Benchmark::runEspressoBenchmark(inputs, outputs, terms);
+    }
+    else if (suite == "bdd")
+    {
+        uint32_t adderBits = tokens.size() > 2 ? std::stoul(tokens[2]) : 64;
+        uint32_t multiplierBits = tokens.size() > 3 ? std::stoul(tokens[3]) : 10;
+        Benchmark::runBddBenchmark(adderBits, multiplierBits);
+    }
+    else if (suite == "expr")
+    {
+        int vars = tokens.size() > 2 ? std::stoi(tokens[2]) : 24;
+        int terms = tokens.size() > 3 ? std::stoi(tokens[3]) : 2000;
+        uint64_t vectors = tokens.size() > 4 ? std::stoull(tokens[4]) : 1 << 22;
+        Benchmark::runExpressionBenchmark(vars, terms, vectors);
+    }
+    else if (suite == "import")
+    {
+        uint32_t numGates = tokens.size() > 2 ? std::stoul(tokens[2]) : 1000000;
+        Benchmark::runImportBenchmark(numGates);
+    }
+    else if (suite == "image")
+    {
+        uint32_t numGates = tokens.size() > 2 ? std::stoul(tokens[2]) : 1000000;
+        Benchmark::runImageBenchmark(numGates);
+    }
+    else if (suite == "seq")
+    {
+        uint32_t instances = tokens.size() > 2 ? std::stoul(tokens[2]) : 1000;
+        uint32_t bits = tokens.size() > 3 ? std::stoul(tokens[3]) : 16;
+        Benchmark::runSequentialBenchmark(instances, bits);
+    }
+    else if (suite == "logic")
+    {
+        uint32_t numGates = tokens.size() > 2 ? std::stoul(tokens[2]) : 100000;
+        Benchmark::runLogicBenchmark(numGates);
+    }
+    else if (suite == "clocks")
+    {
+        uint32_t bits = tokens.size() > 2 ? std::stoul(tokens[2]) : 256;
+        Benchmark::runClockDomainBenchmark(bits);
+    }
+    else if (suite == "bus")
+    {
+        uint32_t drivers = tokens.size() > 2 ? std::stoul(tokens[2]) : 32;
+        Benchmark::runBusBenchmark(drivers);
+    }
+    else if (suite == "modules")
+    {
+        uint32_t instances = tokens.size() > 2 ? std::stoul(tokens[2]) : 10000;
+        Benchmark::runModuleBenchmark(instances);
+    }
+    else if (suite == "cache")
+    {
+        uint32_t numGates = tokens.size() > 2 ? std::stoul(tokens[2]) : 1000000;
+        Benchmark::runCacheBenchmark(numGates);
+    }
+    else
+    {
+        std::cout << "Unknown benchmark: " << suite << std::endl;
+    }
+}
+
+void InteractiveSimulator::handleConnect(const std::vector<std::string> &tokens)
+{
+    if (tokens.size() != 4)
+    {
+        std::cout << "Usage: connect <from_gate> <to_gate> <pin>" << std::endl;
+        std::cout << "Example: connect MyAndGate MyOrGate 0" << std::endl;
+        return;
+    }
+
+    const std::string &from = tokens[1];
+    const std::string &to = tokens[2];
+    if (gates.find(from) == gates.end())
+    {
+        std::cout << "Gate '" << from << "' not found." << std::endl;
+        return;
+    }
+    auto it = gates.find(to);
+    if (it == gates.end())
+    {
+        std::cout << "Gate '" << to << "' not found." << std::endl;
+        return;
+    }
+
+    int pin = std::stoi(tokens[3]);
+    if (pin < 0 || pin >= gatePool.get(it->second)->getInputCount())
+    {
+        std::cout << "Gate '" << to << "' has " << gatePool.get(it->second)->getInputCount() << " inputs, pin "
+                  << pin << " is out of range." << std::endl;
+        return;
+    }
+
+    auto &pins = wiring[to];
+    pins.resize(gatePool.get(it->second)->getInputCount());
+    pins[pin] = from;
+    invalidateCircuit();
+    std::cout << "✓ Connected '" << from << "' -> '" << to << "' pin " << pin << std::endl;
+}
+
+void InteractiveSimulator::handleCircuit(const std::vector<std::string> &tokens)
+{
+    Circuit circuit = buildCircuit();
+    if (tokens.size() >= 2 && tokens[1] == "table")
+    {
+        // every output of the wired circuit for every input combination, 64 rows per pass
+        uint64_t maxRows = tokens.size() > 2 ? std::stoull(tokens[2]) : 64;
+        CircuitTruthTable table(circuit);
+        table.evaluate();
+        for (uint32_t output = 0; output < table.getNumOutputs(); output++)
+        {
+            const uint64_t *plane = table.getActualPlane(output);
+            table.setExpectedWords(output, std::vector<uint64_t>(plane, plane + table.getWordCount()));
+        }
+        table.printToConsole(maxRows);
+        return;
+    }
+    if (tokens.size() >= 2 && (tokens[1] == "bdd" || tokens[1] == "equiv"))
+    {
+        // exact functions of the outputs, circuit input i is BDD variable i
+        BddManager manager;
+        std::vector<Bdd> outputs = manager.fromCircuit(circuit);
+        Circuit::NodeList outputNodes = circuit.getOutputs();
+        if (tokens[1] == "bdd")
+        {
+            std::cout << std::left << std::setw(20) << "Output" << std::setw(10) << "Nodes" << "Satisfying rows" << std::endl;
+            for (size_t i = 0; i < outputs.size(); i++)
+            {
+                std::cout << std::left << std::setw(20) << circuit.getName(outputNodes[i]) << std::setw(10) << manager.nodeCount(outputs[i])
+                          << manager.satCount(outputs[i], circuit.getInputCount()) << " of 2^" << circuit.getInputCount() << std::endl;
+            }
+            std::cout << "Shared nodes: " << manager.nodeCount(outputs) << ", BDD memory: " << manager.getMemoryUsage() / 1024 << " KiB" << std::endl;
+            return;
+        }
+
+        if (tokens.size() != 4)
+        {
+            std::cout << "Usage: circuit equiv <output1> <output2>" << std::endl;
+            return;
+        }
+        std::vector<Bdd> compared;
+        for (size_t t = 2; t < 4; t++)
+        {
+            auto it = std::find(outputNodes.begin(), outputNodes.end(), circuit.findNode(tokens[t]));
+            if (it == outputNodes.end())
+            {
+                std::cout << "'" << tokens[t] << "' is not a circuit output" << std::endl;
+                return;
+            }
+            compared.push_back(outputs[it - outputNodes.begin()]);
+        }
+        if (compared[0] == compared[1])
+        {
+            std::cout << "✓ " << tokens[2] << " and " << tokens[3] << " are equivalent" << std::endl;
+            return;
+        }
+        std::vector<int> witness = manager.satOne(compared[0] ^ compared[1]);
+        std::cout << "✗ " << tokens[2] << " and " << tokens[3] << " differ, e.g. at";
+        for (uint32_t i = 0; i < circuit.getInputCount(); i++)
+        {
+            std::cout << " " << circuit.getName(circuit.getInputs()[i]) << "=" << (witness[i] == 1 ? 1 : 0);
+        }
+        std::cout << std::endl;
+        return;
+    }
+    std::cout << "Circuit: " << circuit.getGateCount() << " gates, " << circuit.getInputCount()
+              << " primary inputs, " << circuit.getOutputCount() << " primary outputs" << std::endl;
+    std::cout << "Netlist memory: " << circuit.getMemoryUsage() << " bytes" << std::endl;
+    std::cout << "Inputs:";
+    for (Circuit::NodeId node : circuit.getInputs())
+    {
+        std::cout << " " << circuit.getName(node);
+    }
+    std::cout << std::endl;
+    std::cout << "Outputs:";
+    for (Circuit::NodeId node : circuit.getOutputs())
+    {
+        std::cout << " " << circuit.getName(node);
+    }
+    std::cout << std::endl;
+}
+
+void InteractiveSimulator::handleSimulate(const std::vector<std::string> &tokens)
+{
+    if (getCompiledCircuit().hasStateElements())
+    {
+        SequentialSimulator &simulator = getSequentialSimulator();
+        simulator.evaluate();
+        const Circuit &circuit = *compiledCircuit;
+        std::cout << "Outputs at cycle " << simulator.getCycle() << " (" << simulator.getRegisterCount() << " flip-flops, "
+                  << simulator.getLatchCount() << " latches):" << std::endl;
+        for (Circuit::NodeId node : circuit.getOutputs())
+        {
+            std::cout << "  " << circuit.getName(node) << " = " << logicChar(simulator.getLogic(node)) << std::endl;
+        }
+        return;
+    }
+    LevelizedSimulator &simulator = getCompiledSimulator();
+    simulator.update();
+    const Circuit &circuit = *compiledCircuit;
+
+    std::cout << "Outputs (" << simulator.getLevelCount() << " levels, re-evaluated "
+              << simulator.getUpdateStats().gatesEvaluated << " of " << circuit.getGateCount() << " gates):" << std::endl;
+    for (Circuit::NodeId node : circuit.getOutputs())
+    {
+        std::cout << "  " << circuit.getName(node) << " = " << logicChar(simulator.getLogic(node)) << std::endl;
+    }
+}
+
+void InteractiveSimulator::handleRun(const std::vector<std::string> &tokens)
+{
+    if (tokens.size() > 1 && tokens[1] == "event")
+    {
+        uint64_t vectors = tokens.size() > 2 ? std::stoull(tokens[2]) : 100000;
+        uint32_t toggles = tokens.size() > 3 ? std::stoul(tokens[3]) : 1;
+        EventSimulator::DelayModel model = EventSimulator::DelayModel::Inertial;
+        if (tokens.size() > 4 && tokens[4] == "transport")
+        {
+            model = EventSimulator::DelayModel::Transport;
+        }
+        else if (tokens.size() > 4 && tokens[4] != "inertial")
+        {
+            std::cout << "Unknown delay model: " << tokens[4] << ". Use inertial or transport." << std::endl;
+            return;
+        }
+
+        Circuit circuit = buildCircuit();
+        EventSimulator simulator(circuit, model);
+        EventSimulator::Stats stats = simulator.run(vectors, toggles);
+        double activity = stats.activityFactor(circuit.getGateCount());
+
+        std::cout << "Event-driven run (" << (model == EventSimulator::DelayModel::Inertial ? "inertial" : "transport")
+                  << " delays): " << stats.vectors << " vectors, " << toggles << " input toggles each, "
+                  << stats.seconds << " s" << std::endl;
+        std::cout << "Events processed: " << stats.eventsProcessed << " (" << stats.eventsCancelled << " cancelled)" << std::endl;
+        std::cout << "Events per second: " << stats.eventsPerSecond() << std::endl;
+        std::cout << "Gate evaluations: " << stats.gateEvaluations << ", activity factor: " << activity << std::endl;
+        std::cout << "A full sweep evaluates all " << circuit.getGateCount() << " gates per vector, "
+                  << (activity < 1 ? "event-driven does less work here" : "full-sweep evaluation does less work here") << std::endl;
+        return;
+    }
+
+    if (tokens.size() > 1 && tokens[1] == "parallel")
+    {
+        uint64_t cycles = tokens.size() > 2 ? std::stoull(tokens[2]) : 1000000;
+        unsigned threads = tokens.size() > 3 ? std::stoul(tokens[3]) : std::thread::hardware_concurrency();
+        Circuit circuit = buildCircuit();
+        std::unique_ptr<LevelizedSimulator> owned = createSimulator(circuit);
+        LevelizedSimulator &simulator = *owned;
+        ThreadPool pool(threads);
+        LevelizedSimulator::RunStats stats = simulator.run(cycles, pool);
+
+        std::cout << "Level-parallel run on " << pool.getThreadCount() << " threads: " << circuit.getGateCount()
+                  << " gates in " << simulator.getLevelCount() << " levels" << std::endl;
+        std::cout << "Simulated " << stats.cycles << " random input vectors in " << stats.seconds << " s" << std::endl;
+        std::cout << "Cycles per second: " << stats.cyclesPerSecond() << std::endl;
+        return;
+    }
+
+    uint64_t cycles = tokens.size() > 1 ? std::stoull(tokens[1]) : 1000000;
+    Circuit circuit = buildCircuit();
+    if (circuit.hasStateElements())
+    {
+        // one clock edge per random input vector
+        SequentialSimulator simulator(circuit);
+        simulator.setLogicMode(logicMode);
+        SequentialSimulator::RunStats stats = simulator.run(cycles);
+        std::cout << (logicMode == LogicMode::FourValued ? "Four-valued cycle-based run: " : "Cycle-based run: ") << circuit.getGateCount() << " gates, " << simulator.getRegisterCount() << " flip-flops in "
+                  << simulator.getStateWordCount() << " state words, " << simulator.getLevelCount() << " levels" << std::endl;
+        std::cout << "Clocked " << stats.cycles << " cycles in " << stats.seconds << " s" << std::endl;
+        std::cout << "Cycles per second: " << stats.cyclesPerSecond() << std::endl;
+        std::cout << "Gate evaluations per second: " << stats.cyclesPerSecond() * circuit.getGateCount() << std::endl;
+        return;
+    }
+    std::unique_ptr<LevelizedSimulator> owned = createSimulator(circuit);
+    LevelizedSimulator &simulator = *owned;
+    simulator.setLogicMode(logicMode);
+    LevelizedSimulator::RunStats stats = simulator.run(cycles);
+
+    std::cout << (logicMode == LogicMode::FourValued ? "Four-valued levelized run: " : "Levelized run: ") << circuit.getGateCount() << " gates in " << simulator.getLevelCount() << " levels" << std::endl;
+    std::cout << "Simulated " << stats.cycles << " random input vectors in " << stats.seconds << " s ("
+              << stats.sweeps << " sweeps of 64 lanes, " << stats.lanesPerVisit << " lanes per gate visit)" << std::endl;
+    std::cout << "Cycles per second: " << stats.cyclesPerSecond() << std::endl;
+    std::cout << "Gate evaluations per second: " << stats.cyclesPerSecond() * circuit.getGateCount() << std::endl;
+}
+
+void InteractiveSimulator::handleDelay(const std::vector<std::string> &tokens)
+{
+    if (tokens.size() != 3)
+    {
+        std::cout << "Usage: delay <gate_name> <ticks>" << std::endl;
+        return;
+    }
+
+    auto it = gates.find(tokens[1]);
+    if (it == gates.end())
+    {
+        std::cout << "Gate '" << tokens[1] << "' not found." << std::endl;
+        return;
+    }
+    gatePool.get(it->second)->setDelay(std::stoi(tokens[2]));
+    std::cout << "✓ Delay of '" << tokens[1] << "' set to " << gatePool.get(it->second)->getDelay() << " ticks" << std::endl;
+}
+
+const Circuit &InteractiveSimulator::getCompiledCircuit()
+{
+    if (!compiledCircuit)
+    {
+        compiledCircuit = std::make_unique<Circuit>(buildCircuit());
+    }
+    return *compiledCircuit;
+}
+
+LevelizedSimulator &InteractiveSimulator::getCompiledSimulator()
+{
+    if (!compiledSimulator)
+    {
+        getCompiledCircuit();
+        compiledSimulator = createSimulator(*compiledCircuit);
+        compiledSimulator->loadInputs(*compiledCircuit);
+        applyLogicMode(*compiledSimulator);
+    }
+    return *compiledSimulator;
+}
+
+std::unique_ptr<LevelizedSimulator> InteractiveSimulator::createSimulator(const Circuit &circuit)
+{
+    if (compiledCache)
+    {
+        return compiledCache->getSimulator(circuit);
+    }
+    return std::make_unique<LevelizedSimulator>(circuit);
+}
+
+SequentialSimulator &InteractiveSimulator::getSequentialSimulator()
+{
+    if (!clockDomains.empty())
+    {
+        return getClockScheduler().getSimulator();
+    }
+    if (!sequentialSimulator)
+    {
+        sequentialSimulator = std::make_unique<SequentialSimulator>(getCompiledCircuit());
+        applyLogicMode(*sequentialSimulator);
+        sequentialSimulator->evaluate();
+    }
+    return *sequentialSimulator;
+}
+
+ClockScheduler &InteractiveSimulator::getClockScheduler()
+{
+    if (!clockScheduler)
+    {
+        clockScheduler = std::make_unique<ClockScheduler>(getCompiledCircuit(), clockDomains);
+        applyLogicMode(clockScheduler->getSimulator());
+        clockScheduler->getSimulator().evaluate();
+    }
+    return *clockScheduler;
+}
+
+void InteractiveSimulator::applyLogicMode(LevelizedSimulator &simulator)
+{
+    if (logicMode != LogicMode::FourValued)
+    {
+        return;
+    }
+    simulator.setLogicMode(LogicMode::FourValued);
+    for (Circuit::NodeId input : compiledCircuit->getInputs())
+    {
+        auto it = pinLogic.find(compiledCircuit->getName(input));
+        if (it != pinLogic.end())
+        {
+            simulator.setInputNodeLogic(input, logicWord(it->second));
+        }
+    }
+}
+
+void InteractiveSimulator::applyLogicMode(SequentialSimulator &simulator)
+{
+    if (logicMode != LogicMode::FourValued)
+    {
+        return;
+    }
+    simulator.setLogicMode(LogicMode::FourValued);
+    for (Circuit::NodeId input : compiledCircuit->getInputs())
+    {
+        auto it = pinLogic.find(compiledCircuit->getName(input));
+        if (it != pinLogic.end())
+        {
+            simulator.setInputNodeLogic(input, it->second);
+        }
+    }
+}
+
+Logic InteractiveSimulator::getPinLogic(const std::string &gateName, size_t pin) const
+{
+    auto it = pinLogic.find(gateName + "." + std::to_string(pin));
+    return it == pinLogic.end() ? Logic::X : it->second;
+}
+
+void InteractiveSimulator::invalidateCircuit()
+{
+    clockScheduler.reset();
+    sequentialSimulator.reset();
+    compiledSimulator.reset();
+    compiledCircuit.reset();
+}
+
+bool InteractiveSimulator::isWired(const std::string &gateName) const
+{
+    for (const auto &entry : wiring)
+    {
+        for (const auto &driver : entry.second)
+        {
+            if (!driver.empty() && (entry.first == gateName || driver == gateName))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+Circuit InteractiveSimulator::buildCircuit(const std::vector<std::string> &outputs)
+{
+    if (importedCircuit)
+    {
+        return *importedCircuit;
+    }
+    if (gates.empty())
+    {
+        throw std::runtime_error("No gates created yet");
+    }
+
+    Circuit circuit;
+    for (const auto &pair : gates)
+    {
+        Circuit::NodeId node = circuit.addGate(gatePool.get(pair.second)->getType(), pair.first, gatePool.get(pair.second)->getInputCount());
+        circuit.setDelay(node, gatePool.get(pair.second)->getDelay());
+    }
+    for (const auto &pair : gates)
+    {
+        Circuit::NodeId node = circuit.findNode(pair.first);
+        auto wired = wiring.find(pair.first);
+        for (int pin = 0; pin < gatePool.get(pair.second)->getInputCount(); pin++)
+        {
+            if (wired != wiring.end() && pin < static_cast<int>(wired->second.size()) && !wired->second[pin].empty())
+            {
+                circuit.connect(circuit.findNode(wired->second[pin]), node, pin);
+            }
+            else
+            {
+                Circuit::NodeId input = circuit.addInput(pair.first + "." + std::to_string(pin));
+                circuit.setValue(input, gatePool.get(pair.second)->getInput(pin));
+                circuit.connect(input, node, pin);
+            }
+        }
+    }
+    for (const std::string &output : outputs)
+    {
+        Circuit::NodeId node = circuit.findNode(output);
+        if (node == Circuit::InvalidNode || circuit.isInput(node))
+        {
+            throw std::invalid_argument("Gate '" + output + "' not found");
+        }
+        circuit.markOutput(node);
+    }
+    circuit.freeze();
+    return circuit;
+}
+
+// Add this helper method to show available gates
+void InteractiveSimulator::showAvailableGates()
+{
+    if (gates.empty())
+    {
+        std::cout << "No gates have been created yet." << std::endl;
+        return;
+    }
+
+    std::cout << "Available gates:" << std::endl;
+    for (const auto &pair : gates)
+    {
+        std::cout << "- " << pair.first << " (" << getGateTypeName(gatePool.get(pair.second)->getType()) << ")" << std::endl;
+    }
+}
+
+std::vector<bool> InteractiveSimulator::generateExpectedResults(GateType type, int numInputs)
+{
+    uint64_t numCombinations = 1ULL << numInputs;
+    std::vector<bool> expected;
+
+    for (uint64_t i = 0; i < numCombinations; i++)
+    {
+        std::vector<bool> inputs(numInputs);
+        for (int bit = 0; bit < numInputs; bit++)
+        {
+            inputs[bit] = (i >> bit) & 1;
+        }
+
+        // Calculate expected output based on gate type and inputs
+        bool expectedOutput = calculateExpectedOutput(type, inputs);
+        expected.push_back(expectedOutput);
+    }
+    return expected;
+}
+
+bool InteractiveSimulator::calculateExpectedOutput(GateType type, const std::vector<bool> &inputs)
+{
+    switch (type)
+    {
+    case GateType::And:
+        return std::all_of(inputs.begin(), inputs.end(), [](bool val)
+                           { return val; });
+    case GateType::Or:
+        return std::any_of(inputs.begin(), inputs.end(), [](bool val)
+                           { return val; });
+    case GateType::Not:
+        return !inputs[0];
+    case GateType::Nand:
+        return !std::all_of(inputs.begin(), inputs.end(), [](bool val)
+                            { return val; });
+    case GateType::Nor:
+        return !std::any_of(inputs.begin(), inputs.end(), [](bool val)
+                            { return val; });
+    case GateType::Xor:
+    {
+        int trueCount = std::count(inputs.begin(), inputs.end(), true);
+        return (trueCount % 2 == 1);
+    }
+    case GateType::Xnor:
+    {
+        int trueCount = std::count(inputs.begin(), inputs.end(), true);
+        return (trueCount % 2 == 0);
+    }
+    case GateType::Buffer:
+        return inputs[0];
+    // a released driver reads as 0 in two-valued terms
+    case GateType::TriState:
+    case GateType::TransmissionGate:
+    case GateType::WiredAnd:
+        return std::all_of(inputs.begin(), inputs.end(), [](bool val)
+                           { return val; });
+    case GateType::WiredOr:
+    case GateType::Bus:
+        return std::any_of(inputs.begin(), inputs.end(), [](bool val)
+                           { return val; });
     default:
         return false;
     }
 }
+
+uint64_t InteractiveSimulator::calculateExpectedWord(GateType type, const uint64_t *inputs, int numInputs)
+{
+    // 64 combinations at once, bit i of each word belongs to the same combination
+    uint64_t all = ~0ULL;
+    uint64_t any = 0;
+    uint64_t parity = 0;
+    for (int i = 0; i < numInputs; i++)
+    {
+        all &= inputs[i];
+        any |= inputs[i];
+        parity ^= inputs[i];
+    }
+    switch (type)
+    {
+    case GateType::And:
+        return all;
+    case GateType::Or:
+        return any;
+    case GateType::Not:
+        return ~inputs[0];
+    case GateType::Nand:
+        return ~all;
+    case GateType::Nor:
+        return ~any;
+    case GateType::Xor:
+        return parity;
+    case GateType::Xnor:
+        return ~parity;
+    case GateType::Buffer:
+        return inputs[0];
+    case GateType::TriState:
+    case GateType::TransmissionGate:
+    case GateType::WiredAnd:
+        return all;
+    case GateType::WiredOr:
+    case GateType::Bus:
+        return any;
+    default:
+        return 0;
+    }
+}
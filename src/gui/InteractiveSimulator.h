@@ -7,11 +7,45 @@
 #include <chrono>
 #include "core/BasicGates.h"
 #include "core/GateFactory.h"
+#include "core/Circuit.h"
+#include "core/ClockScheduler.h"
+#include "core/HierarchicalCircuit.h"
+#include "core/HierarchicalSimulator.h"
+#include "core/LevelizedSimulator.h"
+#include "core/SequentialSimulator.h"
+#include "utils/CompiledCache.h"
 
 class InteractiveSimulator
 {
 private:
-    std::map<std::string, std::shared_ptr<Gate>> gates;
+    // gates live in the pool's arena, the map only holds their handles
+    GatePool gatePool;
+    std::map<std::string, GateHandle> gates;
+    // wiring[gate][pin] is the name of the gate driving that pin, empty when the pin is a primary input
+    std::map<std::string, std::vector<std::string>> wiring;
+    // compiled form of the wired gates, kept between commands so 'set' + 'eval' only
+    // re-evaluate the cone of the changed inputs; dropped whenever the structure changes
+    std::unique_ptr<Circuit> compiledCircuit;
+    std::unique_ptr<LevelizedSimulator> compiledSimulator;
+    // cycle-based engine over the same compiled circuit when it has flip-flops or latches,
+    // it keeps their state from one 'clock' to the next
+    std::unique_ptr<SequentialSimulator> sequentialSimulator;
+    // clocks defined with 'clock domain'; while there are any, flip-flops run under a
+    // ClockScheduler instead, which owns the sequential engine
+    std::vector<ClockDefinition> clockDomains;
+    std::unique_ptr<ClockScheduler> clockScheduler;
+    // 'logic 4' runs the compiled engines four-valued; pins keep what 'set' gave them here,
+    // by input node name (<gate>.<pin>), and a pin that was never set reads X
+    LogicMode logicMode = LogicMode::TwoValued;
+    std::map<std::string, Logic> pinLogic;
+    // netlist read by 'import' or 'load', which stands in for the created gates while it is loaded
+    std::unique_ptr<Circuit> importedCircuit;
+    // design of module instances built with 'module', and its simulator, which starts over
+    // whenever the design changes
+    std::unique_ptr<HierarchicalCircuit> moduleDesign;
+    std::unique_ptr<HierarchicalSimulator> moduleSimulator;
+    // on-disk cache of compiled netlists, enabled with 'cache on'
+    std::unique_ptr<CompiledCache> compiledCache;
     bool running;
 
 public:
@@ -54,9 +88,49 @@ private:
     void handleTable(const std::vector<std::string> &tokens);
     void handleTest(const std::vector<std::string> &tokens);
     void handleDelete(const std::vector<std::string> &tokens);
+    void handleBench(const std::vector<std::string> &tokens);
+    void handleCircuit(const std::vector<std::string> &tokens);
+    void handleDelay(const std::vector<std::string> &tokens);
+    void handleMinimize(const std::vector<std::string> &tokens);
+    void handleEspresso(const std::vector<std::string> &tokens);
+    void handleExpression(const std::string &input);
+    void handleImport(const std::vector<std::string> &tokens);
+    void handleExport(const std::vector<std::string> &tokens);
+    void handleCache(const std::vector<std::string> &tokens);
+    void handleClock(const std::vector<std::string> &tokens);
+    void handleLogic(const std::vector<std::string> &tokens);
+    void handleClockDomain(const std::vector<std::string> &tokens);
+    void showClockDomains();
+    void handleModule(const std::vector<std::string> &tokens);
+    HierarchicalSimulator &getModuleSimulator();
     std::string getGateTypeName(GateType type);
     std::vector<bool> generateExpectedResults(GateType type, int numInputs);
     bool calculateExpectedOutput(GateType type, const std::vector<bool>& inputs);
+    // reference output for 64 combinations, one word per input
+    uint64_t calculateExpectedWord(GateType type, const uint64_t *inputs, int numInputs);
     // Helper methods
     void showAvailableGates();
+    // freezes the created gates and their connections into a flat netlist
+    // unconnected pins become primary inputs named <gate>.<pin> holding the values from 'set'
+    // the named gates are marked as outputs; returns a copy of the imported netlist instead
+    // while one is loaded
+    Circuit buildCircuit(const std::vector<std::string> &outputs = {});
+    // the frozen netlist behind the compiled engines, built on first use
+    const Circuit &getCompiledCircuit();
+    // builds the compiled circuit on first use and settles it from the gates' input values
+    LevelizedSimulator &getCompiledSimulator();
+    // same for circuits with flip-flops or latches, settled for the current state
+    // the clock scheduler's engine when clock domains are defined
+    SequentialSimulator &getSequentialSimulator();
+    ClockScheduler &getClockScheduler();
+    // in four-valued mode, switches a new engine over and loads the pins from pinLogic
+    void applyLogicMode(LevelizedSimulator &simulator);
+    void applyLogicMode(SequentialSimulator &simulator);
+    // the four-valued value of a gate pin, X if it was never set
+    Logic getPinLogic(const std::string &gateName, size_t pin) const;
+    // a levelized simulator for the circuit, through the compiled cache when it is on
+    std::unique_ptr<LevelizedSimulator> createSimulator(const Circuit &circuit);
+    void invalidateCircuit();
+    // true if the gate drives or is driven by another gate
+    bool isWired(const std::string &gateName) const;
 };
@@ -0,0 +1,1625 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <bitset>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include "core/WideLanes.h"
+#include "core/CircuitGenerator.h"
+#include "core/ClockScheduler.h"
+#include "core/HierarchicalCircuit.h"
+#include "core/HierarchicalSimulator.h"
+#include "core/LevelizedSimulator.h"
+#include "core/SequentialSimulator.h"
+#include "core/ThreadPool.h"
+#include "core/GateFactory.h"
+#include "core/GateKernels.h"
+#include "core/K-Map.h"
+#include "core/Espresso.h"
+#include "core/Bdd.h"
+#include "utils/TruthTable.h"
+#include "utils/PackedTruthTable.h"
+#include "utils/TruthTableStream.h"
+#include "utils/CircuitTruthTable.h"
+#include "utils/parser.h"
+#include "utils/BinaryNetlist.h"
+#include "utils/CompiledCache.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+double Benchmark::secondsSince(const std::chrono::steady_clock::time_point &start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+long long Benchmark::currentRssBytes()
+{
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    long long totalPages = 0;
+    long long residentPages = 0;
+    if (statm >> totalPages >> residentPages)
+    {
+        return residentPages * sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return -1;
+}
+
+Benchmark::RandomNetlist Benchmark::generateRandomNetlist(int numInputs, int numGates, uint32_t seed)
+{
+    static const GateType combinationalTypes[] = {
+        GateType::And, GateType::Or, GateType::Not, GateType::Nor,
+        GateType::Nand, GateType::Xor, GateType::Xnor, GateType::Buffer};
+
+    std::mt19937 rng(seed);
+    RandomNetlist netlist;
+    netlist.numInputs = numInputs;
+    netlist.faninStart.push_back(0);
+    for (int g = 0; g < numGates; g++)
+    {
+        GateType type = combinationalTypes[rng() % 8];
+        int arity = (type == GateType::Not || type == GateType::Buffer) ? 1 : 2 + rng() % 3;
+        // read only signals that already exist, so the netlist is acyclic and already in topological order
+        uint32_t available = numInputs + g;
+        // bias towards recent signals to get deep logic cones instead of a flat layer
+        uint32_t window = std::min<uint32_t>(available, 256);
+        for (int pin = 0; pin < arity; pin++)
+        {
+            netlist.fanin.push_back(available - 1 - rng() % window);
+        }
+        netlist.types.push_back(type);
+        netlist.faninStart.push_back(static_cast<uint32_t>(netlist.fanin.size()));
+    }
+    return netlist;
+}
+
+void Benchmark::runLaneBenchmark(int numGates, int numPatterns)
+{
+    const int numInputs = 64;
+    const int numOutputs = std::min(64, numGates);
+    RandomNetlist netlist = generateRandomNetlist(numInputs, numGates);
+    const size_t numSignals = numInputs + numGates;
+    const size_t stimulusWords = (numPatterns + 511) / 512 * 8; // whole AVX-512 visits
+    const size_t totalPatterns = stimulusWords * 64;
+
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> stimulus(numInputs * stimulusWords); // stimulus[input * stimulusWords + word]
+    for (auto &word : stimulus)
+    {
+        word = rng();
+    }
+
+    std::cout << "Lane benchmark: " << numGates << " gates, " << numInputs << " inputs, "
+              << totalPatterns << " patterns" << std::endl;
+    std::cout << "Runtime dispatch selected: " << WideLanes::best().name << std::endl;
+    std::cout << std::left << std::setw(10) << "Backend" << std::setw(18) << "Patterns/s"
+              << std::setw(18) << "Gate evals/s" << std::setw(10) << "Speedup" << "Check" << std::endl;
+
+    // scalar baseline: one pattern per gate visit, one byte per signal
+    // it runs on a prefix of the patterns to keep the benchmark short
+    const size_t scalarPatterns = std::min<size_t>(totalPatterns, 4096);
+    std::vector<uint8_t> scalarValues(numSignals);
+    std::vector<uint8_t> scalarOutputs(scalarPatterns * numOutputs);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t p = 0; p < scalarPatterns; p++)
+    {
+        for (int i = 0; i < numInputs; i++)
+        {
+            scalarValues[i] = (stimulus[i * stimulusWords + p / 64] >> (p % 64)) & 1;
+        }
+        for (int g = 0; g < numGates; g++)
+        {
+            const uint32_t *pins = &netlist.fanin[netlist.faninStart[g]];
+            uint32_t count = netlist.faninStart[g + 1] - netlist.faninStart[g];
+            uint8_t acc = scalarValues[pins[0]];
+            switch (netlist.types[g])
+            {
+            case GateType::And:
+            case GateType::Nand:
+                for (uint32_t i = 1; i < count; i++)
+                    acc &= scalarValues[pins[i]];
+                break;
+            case GateType::Or:
+            case GateType::Nor:
+                for (uint32_t i = 1; i < count; i++)
+                    acc |= scalarValues[pins[i]];
+                break;
+            case GateType::Xor:
+            case GateType::Xnor:
+                for (uint32_t i = 1; i < count; i++)
+                    acc ^= scalarValues[pins[i]];
+                break;
+            default:
+                break;
+            }
+            GateType type = netlist.types[g];
+            bool invert = type == GateType::Nand || type == GateType::Nor || type == GateType::Xnor || type == GateType::Not;
+            scalarValues[numInputs + g] = invert ? acc ^ 1 : acc;
+        }
+        for (int o = 0; o < numOutputs; o++)
+        {
+            scalarOutputs[p * numOutputs + o] = scalarValues[numSignals - numOutputs + o];
+        }
+    }
+    double scalarRate = scalarPatterns / secondsSince(start);
+    std::cout << std::left << std::setw(10) << "scalar" << std::setw(18) << scalarRate
+              << std::setw(18) << scalarRate * numGates << std::setw(10) << 1.0 << "-" << std::endl;
+
+    for (LaneBackend backend : {LaneBackend::Word64, LaneBackend::Avx2, LaneBackend::Avx512})
+    {
+        if (!WideLanes::isSupported(backend))
+        {
+            std::cout << std::left << std::setw(10) << WideLanes::getBackendName(backend) << "not supported on this CPU" << std::endl;
+            continue;
+        }
+        const LaneKernels &kernels = WideLanes::get(backend);
+        const size_t blockWords = kernels.wordsPerVisit;
+
+        // values[signal * blockWords + w] holds one visit worth of lanes for every signal
+        std::vector<uint64_t> values(numSignals * blockWords);
+        std::vector<const uint64_t *> faninPtrs(netlist.fanin.size());
+        for (size_t i = 0; i < netlist.fanin.size(); i++)
+        {
+            faninPtrs[i] = &values[netlist.fanin[i] * blockWords];
+        }
+        std::vector<uint64_t> outputs(numOutputs * stimulusWords);
+
+        start = std::chrono::steady_clock::now();
+        for (size_t block = 0; block < stimulusWords; block += blockWords)
+        {
+            for (int i = 0; i < numInputs; i++)
+            {
+                std::copy_n(&stimulus[i * stimulusWords + block], blockWords, &values[i * blockWords]);
+            }
+            for (int g = 0; g < numGates; g++)
+            {
+                uint32_t begin = netlist.faninStart[g];
+                kernels.evaluate(netlist.types[g], &faninPtrs[begin], netlist.faninStart[g + 1] - begin,
+                                 &values[(numInputs + g) * blockWords], blockWords);
+            }
+            for (int o = 0; o < numOutputs; o++)
+            {
+                std::copy_n(&values[(numSignals - numOutputs + o) * blockWords], blockWords, &outputs[o * stimulusWords + block]);
+            }
+        }
+        double rate = totalPatterns / secondsSince(start);
+
+        // every lane backend must agree with the scalar reference bit for bit
+        bool matches = true;
+        for (size_t p = 0; p < scalarPatterns && matches; p++)
+        {
+            for (int o = 0; o < numOutputs; o++)
+            {
+                if (((outputs[o * stimulusWords + p / 64] >> (p % 64)) & 1) != scalarOutputs[p * numOutputs + o])
+                {
+                    matches = false;
+                    break;
+                }
+            }
+        }
+        std::cout << std::left << std::setw(10) << kernels.name << std::setw(18) << rate
+                  << std::setw(18) << rate * numGates << std::setw(10) << rate / scalarRate
+                  << (matches ? "ok" : "MISMATCH") << std::endl;
+    }
+}
+
+void Benchmark::runParallelBenchmark(uint32_t instances, uint32_t bits, unsigned maxThreads)
+{
+    if (maxThreads == 0)
+    {
+        maxThreads = 1;
+    }
+    std::vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < maxThreads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    struct Design
+    {
+        std::string name;
+        Circuit circuit;
+    };
+    std::vector<Design> designs;
+    designs.push_back({std::to_string(instances) + " x " + std::to_string(bits) + "-bit adders",
+                       CircuitGenerator::adderArray(instances, bits)});
+    uint32_t multiplierBits = std::max<uint32_t>(2, bits / 2);
+    designs.push_back({std::to_string(instances) + " x " + std::to_string(multiplierBits) + "-bit multipliers",
+                       CircuitGenerator::multiplierArray(instances, multiplierBits)});
+
+    for (const Design &design : designs)
+    {
+        const Circuit &circuit = design.circuit;
+        LevelizedSimulator reference(circuit);
+        const uint64_t cycles = std::max<uint64_t>(64, 64ULL * 20000000 / circuit.getGateCount());
+        LevelizedSimulator::RunStats serial = reference.run(cycles);
+
+        std::cout << design.name << ": " << circuit.getGateCount() << " gates, " << reference.getLevelCount()
+                  << " levels, " << circuit.getGateCount() / reference.getLevelCount() << " gates per level on average" << std::endl;
+        std::cout << std::left << std::setw(10) << "Threads" << std::setw(18) << "Cycles/s"
+                  << std::setw(10) << "Speedup" << "Check" << std::endl;
+        std::cout << std::left << std::setw(10) << "serial" << std::setw(18) << serial.cyclesPerSecond()
+                  << std::setw(10) << 1.0 << "-" << std::endl;
+
+        for (unsigned threads : threadCounts)
+        {
+            ThreadPool pool(threads);
+            LevelizedSimulator parallel(circuit);
+            LevelizedSimulator::RunStats stats = parallel.run(cycles, pool);
+
+            // same seed, same sweeps: every node must hold exactly the serial value
+            bool identical = true;
+            for (Circuit::NodeId node = 0; node < circuit.getNodeCount() && identical; node++)
+            {
+                identical = parallel.getWord(node) == reference.getWord(node);
+            }
+            std::cout << std::left << std::setw(10) << threads << std::setw(18) << stats.cyclesPerSecond()
+                      << std::setw(10) << stats.cyclesPerSecond() / serial.cyclesPerSecond()
+                      << (identical ? "identical" : "MISMATCH") << std::endl;
+        }
+        std::cout << std::endl;
+    }
+}
+
+void Benchmark::runAllocationBenchmark(size_t numGates)
+{
+    const std::vector<GateType> types = GateFactory::getSupportedTypes();
+    auto printRow = [](const char *name, double build, double teardown, long long rssBefore, long long rssAfter)
+    {
+        std::cout << std::left << std::setw(12) << name << std::setw(14) << build * 1000 << std::setw(16) << teardown * 1000;
+        if (rssBefore >= 0 && rssAfter >= 0)
+        {
+            std::cout << (rssAfter - rssBefore) / 1024 << " KiB";
+        }
+        else
+        {
+            std::cout << "n/a";
+        }
+        std::cout << std::endl;
+    };
+
+    std::cout << "Allocation benchmark: " << numGates << " gates" << std::endl;
+    std::cout << std::left << std::setw(12) << "Storage" << std::setw(14) << "Build (ms)" << std::setw(16)
+              << "Teardown (ms)" << "RSS growth" << std::endl;
+
+    // the pool goes first: its large arena blocks go straight back to the OS on release,
+    // while the small make_shared blocks would stay cached in the heap and hide the pool's growth
+    {
+        long long rssBefore = currentRssBytes();
+        auto start = std::chrono::steady_clock::now();
+        GatePool pool(numGates);
+        for (size_t i = 0; i < numGates; i++)
+        {
+            GateFactory::createGate(pool, types[i % types.size()], "g" + std::to_string(i));
+        }
+        double build = secondsSince(start);
+        long long rssAfter = currentRssBytes();
+        start = std::chrono::steady_clock::now();
+        pool.clear();
+        printRow("GatePool", build, secondsSince(start), rssBefore, rssAfter);
+    }
+    {
+        long long rssBefore = currentRssBytes();
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::shared_ptr<Gate>> gates;
+        gates.reserve(numGates);
+        for (size_t i = 0; i < numGates; i++)
+        {
+            gates.push_back(GateFactory::createGate(types[i % types.size()], "g" + std::to_string(i)));
+        }
+        double build = secondsSince(start);
+        long long rssAfter = currentRssBytes();
+        start = std::chrono::steady_clock::now();
+        gates.clear();
+        gates.shrink_to_fit();
+        printRow("shared_ptr", build, secondsSince(start), rssBefore, rssAfter);
+    }
+}
+
+void Benchmark::runDispatchBenchmark(uint32_t instances, uint32_t bits)
+{
+    Circuit circuit = CircuitGenerator::multiplierArray(instances, bits);
+    LevelizedSimulator simulator(circuit);
+    const std::vector<Circuit::NodeId> &order = simulator.getOrder();
+    const uint64_t sweeps = std::max<uint64_t>(1, 20000000 / circuit.getGateCount());
+
+    std::mt19937_64 rng(11);
+    std::vector<uint64_t> inputWords(circuit.getInputCount());
+    for (auto &word : inputWords)
+    {
+        word = rng();
+    }
+
+    std::cout << "Dispatch benchmark: " << circuit.getGateCount() << " gates, " << sweeps << " sweeps" << std::endl;
+    std::cout << std::left << std::setw(22) << "Dispatch" << std::setw(18) << "Gate evals/s" << std::setw(10) << "Speedup" << "Check" << std::endl;
+
+    // virtual: one Gate object per node, fan-in gathered into a vector and checked on every call
+    GatePool pool(circuit.getGateCount());
+    std::vector<Gate *> objects(circuit.getNodeCount(), nullptr);
+    for (Circuit::NodeId node : order)
+    {
+        objects[node] = pool.get(GateFactory::createGate(pool, circuit.getGateType(node)));
+    }
+    std::vector<uint64_t> virtualValues(circuit.getNodeCount());
+    std::vector<uint64_t> pins;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t sweep = 0; sweep < sweeps; sweep++)
+    {
+        for (uint32_t i = 0; i < circuit.getInputCount(); i++)
+        {
+            virtualValues[circuit.getInputs()[i]] = inputWords[i];
+        }
+        for (Circuit::NodeId node : order)
+        {
+            pins.clear();
+            for (uint32_t pin = 0; pin < circuit.getFaninCount(node); pin++)
+            {
+                pins.push_back(virtualValues[circuit.getFanin(node)[pin]]);
+            }
+            virtualValues[node] = objects[node]->evaluateWord(pins);
+        }
+    }
+    double virtualRate = sweeps * circuit.getGateCount() / secondsSince(start);
+    std::cout << std::left << std::setw(22) << "virtual per gate" << std::setw(18) << virtualRate << std::setw(10) << 1.0 << "-" << std::endl;
+
+    // switch: same walk over the circuit arrays, one type switch per gate
+    std::vector<uint64_t> switchValues(circuit.getNodeCount());
+    start = std::chrono::steady_clock::now();
+    for (uint64_t sweep = 0; sweep < sweeps; sweep++)
+    {
+        for (uint32_t i = 0; i < circuit.getInputCount(); i++)
+        {
+            switchValues[circuit.getInputs()[i]] = inputWords[i];
+        }
+        for (Circuit::NodeId node : order)
+        {
+            switchValues[node] = evaluateGateWord(circuit.getGateType(node), switchValues.data(), circuit.getFanin(node), circuit.getFaninCount(node));
+        }
+    }
+    double switchRate = sweeps * circuit.getGateCount() / secondsSince(start);
+    std::cout << std::left << std::setw(22) << "switch per gate" << std::setw(18) << switchRate << std::setw(10) << switchRate / virtualRate
+              << (switchValues == virtualValues ? "identical" : "MISMATCH") << std::endl;
+
+    // grouped: the levelized simulator's opcode stream, one loop per (level, type) segment
+    start = std::chrono::steady_clock::now();
+    for (uint64_t sweep = 0; sweep < sweeps; sweep++)
+    {
+        for (uint32_t i = 0; i < circuit.getInputCount(); i++)
+        {
+            simulator.setInputWord(i, inputWords[i]);
+        }
+        simulator.evaluate();
+    }
+    double groupedRate = sweeps * circuit.getGateCount() / secondsSince(start);
+    bool identical = true;
+    for (Circuit::NodeId node = 0; node < circuit.getNodeCount() && identical; node++)
+    {
+        identical = simulator.getWord(node) == virtualValues[node];
+    }
+    std::cout << std::left << std::setw(22) << "type-grouped stream" << std::setw(18) << groupedRate << std::setw(10) << groupedRate / virtualRate
+              << (identical ? "identical" : "MISMATCH") << std::endl;
+}
+
+void Benchmark::runTruthTableBenchmark(int maxInputs)
+{
+    // the row-based table needs a heap-allocated input vector per row, stop it at a million rows
+    const int rowTableLimit = 20;
+    if (maxInputs < 2 || maxInputs > PackedTruthTable::MaxInputs)
+    {
+        throw std::invalid_argument("Truth table benchmark takes 2 to " + std::to_string(PackedTruthTable::MaxInputs) + " inputs");
+    }
+
+    std::cout << "Truth table benchmark: XOR gates, parity as expected output" << std::endl;
+    std::cout << std::left << std::setw(8) << "Inputs" << std::setw(12) << "Rows" << std::setw(14) << "Rows (ms)" << std::setw(16)
+              << "Rows RSS (KiB)" << std::setw(14) << "Packed (ms)" << std::setw(18) << "Packed mem (KiB)" << "Speedup" << std::endl;
+
+    std::vector<int> sizes;
+    for (int inputs = 4; inputs < maxInputs; inputs += 4)
+    {
+        sizes.push_back(inputs);
+    }
+    sizes.push_back(maxInputs);
+
+    for (int inputs : sizes)
+    {
+        XORGate gate("bench");
+        while (gate.getInputCount() < inputs)
+        {
+            gate.addInput(false);
+        }
+        uint64_t rows = 1ULL << inputs;
+        std::vector<bool> parity(rows);
+        for (uint64_t row = 0; row < rows; row++)
+        {
+            parity[row] = std::bitset<64>(row).count() & 1;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        PackedTruthTable packed(&gate, parity);
+        packed.evaluateGate();
+        bool packedPassing = packed.isPassing() && packed.getMismatches().empty();
+        double packedSeconds = secondsSince(start);
+
+        std::cout << std::left << std::setw(8) << inputs << std::setw(12) << rows;
+        if (inputs <= rowTableLimit)
+        {
+            long long rssBefore = currentRssBytes();
+            start = std::chrono::steady_clock::now();
+            TruthTable table(&gate, parity);
+            table.evaluateGate();
+            bool rowPassing = table.isPassing() && table.getMismatches().empty();
+            double rowSeconds = secondsSince(start);
+            long long rssAfter = currentRssBytes();
+            std::cout << std::setw(14) << rowSeconds * 1000 << std::setw(16)
+                      << (rssBefore >= 0 && rssAfter >= 0 ? std::to_string((rssAfter - rssBefore) / 1024) : "n/a")
+                      << std::setw(14) << packedSeconds * 1000 << std::setw(18) << packed.getMemoryUsage() / 1024
+                      << rowSeconds / packedSeconds << (rowPassing == packedPassing ? "" : "  MISMATCH") << std::endl;
+        }
+        else
+        {
+            std::cout << std::setw(14) << "skipped" << std::setw(16) << "-" << std::setw(14) << packedSeconds * 1000 << std::setw(18)
+                      << packed.getMemoryUsage() / 1024 << "-" << (packedPassing ? "" : "  FAILED") << std::endl;
+        }
+    }
+}
+
+void Benchmark::runVerifyBenchmark(int inputs, unsigned maxThreads)
+{
+    if (maxThreads == 0)
+    {
+        maxThreads = 1;
+    }
+    std::vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < maxThreads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    XORGate gate("bench");
+    while (gate.getInputCount() < inputs)
+    {
+        gate.addInput(false);
+    }
+    // the reference is off on one row, so every run has a known mismatch to find and merge
+    const uint64_t badRow = (1ULL << inputs) - 3;
+    TruthTableStream stream(&gate, [badRow](const uint64_t *inputWords, int numInputs)
+                            {
+        uint64_t parity = 0;
+        for (int i = 0; i < numInputs; i++)
+        {
+            parity ^= inputWords[i];
+        }
+        uint64_t base = 0;
+        for (int i = 6; i < numInputs; i++)
+        {
+            base |= (inputWords[i] & 1) << (i - 6);
+        }
+        return base == badRow / 64 ? parity ^ (1ULL << (badRow % 64)) : parity; });
+    stream.setStopOnMismatch(false);
+
+    TruthTableStream::Result serial = stream.run();
+    std::cout << "Verify benchmark: " << inputs << "-input XOR, " << serial.totalRows << " rows" << std::endl;
+    std::cout << std::left << std::setw(10) << "Threads" << std::setw(18) << "Rows/s"
+              << std::setw(10) << "Speedup" << "Check" << std::endl;
+    std::cout << std::left << std::setw(10) << "serial" << std::setw(18) << serial.rowsPerSecond()
+              << std::setw(10) << 1.0 << (serial.mismatches == 1 ? "-" : "MISMATCH") << std::endl;
+
+    for (unsigned threads : threadCounts)
+    {
+        ThreadPool pool(threads);
+        TruthTableStream::Result result = stream.run(pool);
+        // merged counters and mismatch rows must equal the serial walk
+        bool identical = result.rowsChecked == serial.rowsChecked && result.mismatches == serial.mismatches &&
+                         result.mismatchRows == serial.mismatchRows;
+        std::cout << std::left << std::setw(10) << threads << std::setw(18) << result.rowsPerSecond()
+                  << std::setw(10) << result.rowsPerSecond() / serial.rowsPerSecond()
+                  << (identical ? "identical" : "MISMATCH") << std::endl;
+    }
+}
+
+void Benchmark::runCircuitTableBenchmark(uint32_t bits)
+{
+    if (bits == 0 || 2 * bits + 1 > CircuitTruthTable::MaxInputs)
+    {
+        throw std::invalid_argument("Circuit table benchmark takes 1 to " + std::to_string((CircuitTruthTable::MaxInputs - 1) / 2) + " bits");
+    }
+    Circuit circuit = CircuitGenerator::adderArray(1, bits);
+
+    // inputs are a0 b0 a1 b1 ... cin, outputs s0 .. s(bits-1) then the carry out
+    auto reference = [bits](const uint64_t *inputWords, uint64_t *outputWords)
+    {
+        uint64_t carry = inputWords[2 * bits];
+        for (uint32_t j = 0; j < bits; j++)
+        {
+            uint64_t a = inputWords[2 * j];
+            uint64_t b = inputWords[2 * j + 1];
+            outputWords[j] = a ^ b ^ carry;
+            carry = (a & b) | (carry & (a ^ b));
+        }
+        outputWords[bits] = carry;
+    };
+
+    std::cout << "Circuit table benchmark: " << bits << "-bit ripple adder, " << circuit.getInputCount() << " inputs, "
+              << circuit.getOutputCount() << " outputs, " << circuit.getGateCount() << " gates" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    CircuitTruthTable table(circuit);
+    table.setExpectedFunction(reference);
+    table.evaluate();
+    double onePass = secondsSince(start);
+
+    // the single-output way: a full simulation of the circuit for every output
+    start = std::chrono::steady_clock::now();
+    LevelizedSimulator simulator(circuit);
+    std::vector<uint64_t> plane(table.getWordCount());
+    bool identical = true;
+    for (uint32_t output = 0; output < circuit.getOutputCount(); output++)
+    {
+        for (size_t word = 0; word < plane.size(); word++)
+        {
+            for (uint32_t bit = 0; bit < circuit.getInputCount(); bit++)
+            {
+                simulator.setInputWord(bit, PackedTruthTable::getInputWord(bit, word));
+            }
+            simulator.evaluate();
+            plane[word] = simulator.getWord(circuit.getOutputs()[output]);
+        }
+        identical = identical && std::equal(plane.begin(), plane.end(), table.getActualPlane(output));
+    }
+    double perOutput = secondsSince(start);
+
+    std::cout << std::left << std::setw(24) << "Evaluation" << std::setw(14) << "Time (ms)" << "Speedup" << std::endl;
+    std::cout << std::left << std::setw(24) << "one pass per output" << std::setw(14) << perOutput * 1000 << 1.0 << std::endl;
+    std::cout << std::left << std::setw(24) << "all outputs per pass" << std::setw(14) << onePass * 1000 << perOutput / onePass
+              << (identical ? "" : "  MISMATCH") << std::endl;
+    std::cout << "Table memory: " << table.getMemoryUsage() / 1024 << " KiB" << std::endl;
+    std::cout << std::endl;
+    table.printValidationReport();
+}
+
+void Benchmark::runKMapBenchmark(int numVariables, int numFunctions, unsigned threads)
+{
+    if (numVariables < 1 || numVariables > KMapSolver::MaxVariables)
+    {
+        throw std::invalid_argument("K-map benchmark takes 1 to " + std::to_string(KMapSolver::MaxVariables) + " variables");
+    }
+    ThreadPool pool(std::max(1u, threads));
+    std::mt19937_64 rng(5);
+
+    std::cout << "K-map benchmark: " << numFunctions << " random " << numVariables << "-variable functions, half the rows set, "
+              << pool.getThreadCount() << " threads" << std::endl;
+    std::cout << std::left << std::setw(10) << "Function" << std::setw(10) << "Primes" << std::setw(10) << "Terms"
+              << std::setw(10) << "Literals" << std::setw(14) << "Primes (ms)" << std::setw(14) << "Cover (ms)"
+              << std::setw(16) << "Threaded (ms)" << "Check" << std::endl;
+
+    double serialTotal = 0;
+    double threadedTotal = 0;
+    for (int f = 0; f < numFunctions; f++)
+    {
+        std::vector<uint32_t> minterms;
+        for (uint32_t row = 0; row < (1u << numVariables); row++)
+        {
+            if (rng() & 1)
+            {
+                minterms.push_back(row);
+            }
+        }
+        KMapSolver solver(numVariables, minterms);
+        KMapSolver::Solution serial = solver.minimizeSop();
+        KMapSolver::Solution threaded = solver.minimizeSop(&pool);
+        serialTotal += serial.primeSeconds + serial.coverSeconds;
+        threadedTotal += threaded.primeSeconds + threaded.coverSeconds;
+
+        bool valid = solver.verify(serial) && solver.verify(threaded) && serial.primes.size() == threaded.primes.size();
+        std::cout << std::left << std::setw(10) << f << std::setw(10) << serial.primes.size() << std::setw(10) << serial.cover.size()
+                  << std::setw(10) << serial.literalCount(numVariables) << std::setw(14) << serial.primeSeconds * 1000
+                  << std::setw(14) << serial.coverSeconds * 1000 << std::setw(16) << (threaded.primeSeconds + threaded.coverSeconds) * 1000
+                  << (valid ? "valid" : "INVALID") << std::endl;
+    }
+    std::cout << "Total: " << serialTotal * 1000 << " ms serial, " << threadedTotal * 1000 << " ms threaded" << std::endl;
+}
+
+void Benchmark::runEspressoBenchmark(int numInputs, int numOutputs, int numTerms)
+{
+    if (numInputs < 4 || numOutputs < 1 || numTerms < 1)
+    {
+        throw std::invalid_argument("Espresso benchmark needs at least 4 inputs, 1 output and 1 term");
+    }
+    std::mt19937_64 rng(9);
+    CubeList onSet(numInputs, numOutputs);
+    CubeList dontCares(numInputs, numOutputs);
+    for (int term = 0; term < numTerms; term++)
+    {
+        // about a quarter of the inputs fixed (never the first three, so there is room to split),
+        // the term drives about one output in eight
+        std::vector<int> literals(numInputs, 2);
+        std::vector<int> freeInputs;
+        for (int v = 0; v < numInputs; v++)
+        {
+            if (v >= 3 && rng() % 4 == 0)
+            {
+                literals[v] = rng() & 1;
+            }
+            else
+            {
+                freeInputs.push_back(v);
+            }
+        }
+        std::shuffle(freeInputs.begin(), freeInputs.end(), rng);
+        std::vector<int> outputs;
+        for (int o = 0; o < numOutputs; o++)
+        {
+            if (rng() % 8 == 0)
+            {
+                outputs.push_back(o);
+            }
+        }
+        if (outputs.empty())
+        {
+            outputs.push_back(rng() % numOutputs);
+        }
+
+        for (int split = 0; split < 8; split++)
+        {
+            size_t cube = onSet.addCube();
+            for (int v = 0; v < numInputs; v++)
+            {
+                if (literals[v] != 2)
+                {
+                    onSet.setInput(cube, v, literals[v]);
+                }
+            }
+            for (int k = 0; k < 3; k++)
+            {
+                onSet.setInput(cube, freeInputs[k], (split >> k) & 1);
+            }
+            for (int o : outputs)
+            {
+                onSet.setOutput(cube, o, true);
+            }
+        }
+    }
+
+    std::cout << "Espresso benchmark: " << numInputs << " inputs, " << numOutputs << " outputs, "
+              << numTerms << " terms split into " << onSet.size() << " cubes" << std::endl;
+    Espresso espresso(onSet, dontCares);
+    auto start = std::chrono::steady_clock::now();
+    const CubeList &cover = espresso.minimize();
+    double seconds = secondsSince(start);
+
+    std::cout << std::left << std::setw(11) << "Iteration" << std::setw(14) << "Phase" << std::setw(10) << "Cubes"
+              << std::setw(10) << "Literals" << "Time (ms)" << std::endl;
+    for (const Espresso::IterationStats &step : espresso.getStats())
+    {
+        std::cout << std::left << std::setw(11) << step.iteration << std::setw(14) << step.phase << std::setw(10) << step.cubes
+                  << std::setw(10) << step.literals << step.seconds * 1000 << std::endl;
+    }
+    std::cout << "Result: " << cover.size() << " cubes (" << numTerms << " expected), " << cover.literalCount() << " literals in "
+              << seconds * 1000 << " ms, " << espresso.getTautologyChecks() << " tautology checks, "
+              << espresso.getInconclusiveChecks() << " over budget" << std::endl;
+    std::cout << "Check: " << (espresso.verify() ? "valid" : "INVALID") << std::endl;
+}
+
+void Benchmark::runBddBenchmark(uint32_t adderBits, uint32_t multiplierBits)
+{
+    if (adderBits < 1 || multiplierBits < 2)
+    {
+        throw std::invalid_argument("BDD benchmark needs at least a 1-bit adder and a 2-bit multiplier");
+    }
+
+    // the generator's inputs are a0 b0 a1 b1 ... cin, already an interleaved order
+    auto start = std::chrono::steady_clock::now();
+    Circuit adder = CircuitGenerator::adderArray(1, adderBits);
+    BddManager manager;
+    std::vector<Bdd> outputs = manager.fromCircuit(adder);
+    double buildSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<Bdd> spec;
+    Bdd carry = manager.variable(2 * adderBits);
+    for (uint32_t j = 0; j < adderBits; j++)
+    {
+        Bdd a = manager.variable(2 * j);
+        Bdd b = manager.variable(2 * j + 1);
+        spec.push_back(a ^ b ^ carry);
+        carry = (a & b) | (carry & (a ^ b));
+    }
+    spec.push_back(carry);
+    bool equivalent = outputs == spec;
+    double checkSeconds = secondsSince(start);
+
+    std::cout << "BDD benchmark: " << adderBits << "-bit ripple-carry adder, 2^" << adder.getInputCount() << " input rows" << std::endl;
+    std::cout << "Build: " << buildSeconds * 1000 << " ms, " << manager.nodeCount(outputs) << " shared nodes" << std::endl;
+    std::cout << "Spec and equivalence: " << checkSeconds * 1000 << " ms, " << (equivalent ? "equivalent" : "NOT EQUIVALENT") << std::endl;
+    std::cout << "Carry-out is set on " << manager.satCount(outputs.back(), adder.getInputCount()) << " rows" << std::endl;
+    std::cout << "Computed table: " << manager.getCacheHits() << " hits of " << manager.getCacheLookups() << " lookups" << std::endl;
+    std::cout << std::endl;
+
+    std::cout << std::left << std::setw(8) << "Bits" << std::setw(12) << "Nodes" << std::setw(12) << "Peak"
+              << std::setw(8) << "GCs" << std::setw(14) << "Reclaimed" << "Time (ms)" << std::endl;
+    for (uint32_t bits = 2; bits <= multiplierBits; bits++)
+    {
+        Circuit multiplier = CircuitGenerator::multiplierArray(1, bits);
+        BddManager products;
+        start = std::chrono::steady_clock::now();
+        std::vector<Bdd> product = products.fromCircuit(multiplier);
+        double seconds = secondsSince(start);
+        std::cout << std::left << std::setw(8) << bits << std::setw(12) << products.nodeCount(product) << std::setw(12)
+                  << products.getPeakNodeCount() << std::setw(8) << products.getGarbageCollections() << std::setw(14)
+                  << products.getReclaimedNodes() << seconds * 1000 << std::endl;
+    }
+}
+
+void Benchmark::runExpressionBenchmark(int numVariables, int numTerms, uint64_t vectors)
+{
+    if (numVariables < 2 || numTerms < 1 || vectors < 64)
+    {
+        throw std::invalid_argument("Expression benchmark needs at least 2 variables, 1 term and 64 vectors");
+    }
+    std::mt19937_64 rng(11);
+
+    // terms like (x3 & ~x7) ^ (x1 & x12): few variables, so pairs repeat and get shared
+    std::string text;
+    size_t operators = 0;
+    for (int t = 0; t < numTerms; t++)
+    {
+        if (t > 0)
+        {
+            text += " | ";
+        }
+        auto literal = [&]()
+        {
+            return std::string(rng() & 1 ? "~" : "") + "x" + std::to_string(rng() % numVariables);
+        };
+        text += "(" + literal() + " & " + literal() + ") ^ (" + literal() + " & " + literal() + ")";
+        operators += 4;
+    }
+    operators += numTerms - 1;
+
+    ExpressionDag dag;
+    auto start = std::chrono::steady_clock::now();
+    ExpressionDag::NodeId root = ExpressionParser::parse(text, dag);
+    double parseSeconds = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    CompiledExpression compiled(dag, {root});
+    double compileSeconds = secondsSince(start);
+
+    std::cout << "Expression benchmark: " << numTerms << " terms over " << dag.getVariableCount() << " variables, "
+              << text.size() << " characters" << std::endl;
+    std::cout << "Parse: " << parseSeconds * 1000 << " ms, " << dag.countNodes({root}) << " shared nodes for "
+              << operators << " operators in the text" << std::endl;
+    std::cout << "Compile: " << compileSeconds * 1000 << " ms, " << compiled.getInstructions().size() << " instructions, "
+              << compiled.getRegisterCount() << " registers" << std::endl;
+
+    // the same graph as a netlist, one gate per operator node
+    Circuit circuit;
+    std::vector<Circuit::NodeId> nodeOf(dag.size(), Circuit::InvalidNode);
+    for (ExpressionDag::NodeId id = 0; id < dag.size(); id++)
+    {
+        if (dag.getNode(id).op == ExpressionDag::Op::Variable)
+        {
+            // variables are created in index order, so input v is variable v
+            nodeOf[id] = circuit.addInput(dag.getVariableNames()[dag.getNode(id).left]);
+        }
+    }
+    std::vector<char> reachable(dag.size(), 0);
+    std::vector<ExpressionDag::NodeId> stack{root};
+    while (!stack.empty())
+    {
+        ExpressionDag::NodeId id = stack.back();
+        stack.pop_back();
+        if (reachable[id])
+        {
+            continue;
+        }
+        reachable[id] = 1;
+        const ExpressionDag::Node &node = dag.getNode(id);
+        if (node.op == ExpressionDag::Op::Not || node.op == ExpressionDag::Op::And || node.op == ExpressionDag::Op::Or || node.op == ExpressionDag::Op::Xor)
+        {
+            stack.push_back(node.left);
+        }
+        if (node.op == ExpressionDag::Op::And || node.op == ExpressionDag::Op::Or || node.op == ExpressionDag::Op::Xor)
+        {
+            stack.push_back(node.right);
+        }
+    }
+    for (ExpressionDag::NodeId id = 0; id < dag.size(); id++)
+    {
+        const ExpressionDag::Node &node = dag.getNode(id);
+        if (!reachable[id] || node.op == ExpressionDag::Op::Variable)
+        {
+            continue;
+        }
+        if (node.op == ExpressionDag::Op::Not)
+        {
+            nodeOf[id] = circuit.addGate(GateType::Not, "n" + std::to_string(id), 1);
+            circuit.connect(nodeOf[node.left], nodeOf[id], 0);
+            continue;
+        }
+        GateType type = node.op == ExpressionDag::Op::And ? GateType::And : node.op == ExpressionDag::Op::Or ? GateType::Or : GateType::Xor;
+        nodeOf[id] = circuit.addGate(type, "n" + std::to_string(id), 2);
+        circuit.connect(nodeOf[node.left], nodeOf[id], 0);
+        circuit.connect(nodeOf[node.right], nodeOf[id], 1);
+    }
+    circuit.markOutput(nodeOf[root]);
+    circuit.freeze();
+    LevelizedSimulator simulator(circuit);
+
+    const size_t words = (vectors + 63) / 64;
+    std::vector<uint64_t> stimulus(dag.getVariableCount() * words);
+    for (auto &word : stimulus)
+    {
+        word = rng();
+    }
+    std::vector<const uint64_t *> columns(dag.getVariableCount());
+    for (uint32_t v = 0; v < dag.getVariableCount(); v++)
+    {
+        columns[v] = &stimulus[v * words];
+    }
+
+    std::vector<uint64_t> netlistOut(words);
+    start = std::chrono::steady_clock::now();
+    for (size_t w = 0; w < words; w++)
+    {
+        for (uint32_t v = 0; v < dag.getVariableCount(); v++)
+        {
+            simulator.setInputWord(v, columns[v][w]);
+        }
+        simulator.evaluate();
+        netlistOut[w] = simulator.getWord(nodeOf[root]);
+    }
+    double netlistSeconds = secondsSince(start);
+
+    std::vector<uint64_t> bytecodeOut(words);
+    uint64_t *outputColumn = bytecodeOut.data();
+    start = std::chrono::steady_clock::now();
+    compiled.evaluate(columns.data(), &outputColumn, words);
+    double bytecodeSeconds = secondsSince(start);
+
+    std::cout << std::left << std::setw(22) << "Engine" << std::setw(18) << "Vectors/s" << "Time (ms)" << std::endl;
+    std::cout << std::left << std::setw(22) << "gate netlist" << std::setw(18) << words * 64 / netlistSeconds << netlistSeconds * 1000 << std::endl;
+    std::cout << std::left << std::setw(22) << "bytecode" << std::setw(18) << words * 64 / bytecodeSeconds << bytecodeSeconds * 1000 << std::endl;
+    std::cout << "Netlist: " << circuit.getGateCount() << " gates, speedup " << netlistSeconds / bytecodeSeconds << "x, "
+              << (netlistOut == bytecodeOut ? "outputs match" : "MISMATCH") << std::endl;
+}
+
+void Benchmark::runImportBenchmark(uint32_t numGates)
+{
+    if (numGates < 1)
+    {
+        throw std::invalid_argument("Import benchmark needs at least one gate");
+    }
+    std::mt19937_64 rng(13);
+    const uint32_t numInputs = 256;
+    Circuit original = generateRandomCircuit(numInputs, numGates, 13);
+
+    std::string base = (std::filesystem::temp_directory_path() / "dls_import_bench").string();
+    auto start = std::chrono::steady_clock::now();
+    NetlistImporter::writeVerilog(original, base + ".v");
+    NetlistImporter::writeBlif(original, base + ".blif");
+    std::cout << "Import benchmark: " << numGates << " gates, " << numInputs << " inputs, " << original.getOutputCount()
+              << " outputs, written in " << secondsSince(start) << " s" << std::endl;
+
+    LevelizedSimulator reference(original);
+    std::cout << std::left << std::setw(10) << "Format" << std::setw(12) << "Size (MB)" << std::setw(12) << "Load (s)"
+              << std::setw(12) << "MB/s" << std::setw(14) << "M gates/s" << "Matches" << std::endl;
+    for (const char *extension : {".v", ".blif"})
+    {
+        NetlistImporter::Stats stats;
+        Circuit imported = NetlistImporter::load(base + extension, &stats);
+
+        // same inputs in the same order, every original node findable by name
+        bool matches = imported.getInputCount() == numInputs && imported.getGateCount() == numGates;
+        LevelizedSimulator simulator(imported);
+        std::vector<Circuit::NodeId> mapped(original.getNodeCount());
+        for (Circuit::NodeId node = 0; matches && node < original.getNodeCount(); node++)
+        {
+            mapped[node] = imported.findNode(original.getName(node));
+            matches = mapped[node] != Circuit::InvalidNode;
+        }
+        for (int round = 0; matches && round < 4; round++)
+        {
+            for (uint32_t i = 0; i < numInputs; i++)
+            {
+                uint64_t word = rng();
+                reference.setInputWord(i, word);
+                simulator.setInputWord(i, word);
+            }
+            reference.evaluate();
+            simulator.evaluate();
+            for (Circuit::NodeId node : original.getOutputs())
+            {
+                matches = matches && reference.getWord(node) == simulator.getWord(mapped[node]);
+            }
+        }
+
+        std::cout << std::left << std::setw(10) << extension + 1 << std::setw(12) << stats.bytes / 1e6 << std::setw(12) << stats.seconds
+                  << std::setw(12) << stats.bytes / 1e6 / stats.seconds << std::setw(14) << stats.gates / 1e6 / stats.seconds
+                  << (matches ? "yes" : "NO") << std::endl;
+        std::remove((base + extension).c_str());
+    }
+    std::cout << "Target: 1M gates in about 1 s, " << numGates / 1e6 << "M gates here" << std::endl;
+}
+
+Circuit Benchmark::generateRandomCircuit(uint32_t numInputs, uint32_t numGates, uint32_t seed)
+{
+    std::mt19937_64 rng(seed);
+    const uint32_t window = 4096;
+    static const GateType types[] = {GateType::And, GateType::Or, GateType::Nand, GateType::Nor,
+                                     GateType::Xor, GateType::Xnor, GateType::Not, GateType::Buffer};
+    Circuit circuit;
+    for (uint32_t i = 0; i < numInputs; i++)
+    {
+        circuit.addInput("in" + std::to_string(i));
+    }
+    for (uint32_t g = 0; g < numGates; g++)
+    {
+        GateType type = types[rng() % 8];
+        uint32_t fanin = type == GateType::Not || type == GateType::Buffer ? 1 : 2 + rng() % 3;
+        Circuit::NodeId node = circuit.addGate(type, "n" + std::to_string(g), fanin);
+        uint32_t span = std::min(node, window);
+        for (uint32_t pin = 0; pin < fanin; pin++)
+        {
+            circuit.connect(node - 1 - static_cast<uint32_t>(rng() % span), node, pin);
+        }
+    }
+    circuit.freeze();
+    return circuit;
+}
+
+void Benchmark::runImageBenchmark(uint32_t numGates)
+{
+    if (numGates < 1)
+    {
+        throw std::invalid_argument("Image benchmark needs at least one gate");
+    }
+    const uint32_t numInputs = 256;
+    Circuit original = generateRandomCircuit(numInputs, numGates, 17);
+    std::string base = (std::filesystem::temp_directory_path() / "dls_image_bench").string();
+    NetlistImporter::writeVerilog(original, base + ".v");
+    auto start = std::chrono::steady_clock::now();
+    BinaryNetlist::save(original, base + ".dlsn");
+    double saveSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    NetlistImporter::Stats parseStats;
+    Circuit parsed = NetlistImporter::load(base + ".v", &parseStats);
+    double parseSeconds = secondsSince(start);
+
+    // best of a few loads, each one maps the file afresh
+    double loadSeconds = 1e9;
+    for (int round = 0; round < 5; round++)
+    {
+        start = std::chrono::steady_clock::now();
+        Circuit mapped = BinaryNetlist::load(base + ".dlsn");
+        loadSeconds = std::min(loadSeconds, secondsSince(start));
+    }
+    Circuit mapped = BinaryNetlist::load(base + ".dlsn");
+    std::ifstream image(base + ".dlsn", std::ios::binary | std::ios::ate);
+    size_t imageBytes = static_cast<size_t>(image.tellg());
+
+    // the first simulation pays for the page faults that loading skipped
+    std::mt19937_64 rng(17);
+    start = std::chrono::steady_clock::now();
+    LevelizedSimulator simulator(mapped);
+    double setupSeconds = secondsSince(start);
+    LevelizedSimulator reference(original);
+    bool matches = mapped.getNodeCount() == original.getNodeCount();
+    for (int round = 0; matches && round < 4; round++)
+    {
+        for (uint32_t i = 0; i < numInputs; i++)
+        {
+            uint64_t word = rng();
+            simulator.setInputWord(i, word);
+            reference.setInputWord(i, word);
+        }
+        simulator.evaluate();
+        reference.evaluate();
+        for (Circuit::NodeId node : original.getOutputs())
+        {
+            matches = matches && simulator.getWord(node) == reference.getWord(node);
+        }
+    }
+    matches = matches && mapped.findNode("n" + std::to_string(numGates - 1)) == original.findNode("n" + std::to_string(numGates - 1));
+
+    std::cout << "Image benchmark: " << numGates << " gates, " << original.getOutputCount() << " outputs" << std::endl;
+    std::cout << std::left << std::setw(26) << "Step" << std::setw(14) << "Size (MB)" << "Time (ms)" << std::endl;
+    std::cout << std::left << std::setw(26) << "save image" << std::setw(14) << imageBytes / 1e6 << saveSeconds * 1000 << std::endl;
+    std::cout << std::left << std::setw(26) << "parse Verilog" << std::setw(14) << parseStats.bytes / 1e6 << parseSeconds * 1000 << std::endl;
+    std::cout << std::left << std::setw(26) << "map image" << std::setw(14) << imageBytes / 1e6 << loadSeconds * 1000 << std::endl;
+    std::cout << std::left << std::setw(26) << "levelize mapped circuit" << std::setw(14) << "" << setupSeconds * 1000 << std::endl;
+    std::cout << "Startup " << parseSeconds / loadSeconds << "x faster than parsing, mapped circuit "
+              << (matches ? "matches" : "DOES NOT MATCH") << " the original" << std::endl;
+    std::remove((base + ".v").c_str());
+    std::remove((base + ".dlsn").c_str());
+}
+
+void Benchmark::runCacheBenchmark(uint32_t numGates)
+{
+    if (numGates < 1)
+    {
+        throw std::invalid_argument("Cache benchmark needs at least one gate");
+    }
+    const uint32_t numInputs = 256;
+    std::string directory = (std::filesystem::temp_directory_path() / "dls_cache_bench").string();
+    std::filesystem::remove_all(directory);
+    CompiledCache cache(directory);
+    Circuit first = generateRandomCircuit(numInputs, numGates, 21);
+
+    auto start = std::chrono::steady_clock::now();
+    LevelizedSimulator plain(first);
+    double compileSeconds = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    CompiledCache::Key key = CompiledCache::computeKey(first, "levelized");
+    double hashSeconds = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    std::unique_ptr<LevelizedSimulator> cold = cache.getSimulator(first);
+    double missSeconds = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    std::unique_ptr<LevelizedSimulator> warm = cache.getSimulator(first);
+    double hitSeconds = secondsSince(start);
+
+    // the cached simulator must compute exactly what a freshly compiled one does
+    std::mt19937_64 rng(21);
+    bool matches = warm->getLevelCount() == plain.getLevelCount();
+    for (int round = 0; matches && round < 4; round++)
+    {
+        for (uint32_t i = 0; i < numInputs; i++)
+        {
+            uint64_t word = rng();
+            plain.setInputWord(i, word);
+            warm->setInputWord(i, word);
+        }
+        plain.evaluate();
+        warm->evaluate();
+        for (Circuit::NodeId node : first.getOutputs())
+        {
+            matches = matches && plain.getWord(node) == warm->getWord(node);
+        }
+    }
+
+    std::cout << "Cache benchmark: " << numGates << " gates in " << plain.getLevelCount() << " levels, key " << key.toString() << std::endl;
+    std::cout << std::left << std::setw(28) << "Setup" << "Time (ms)" << std::endl;
+    std::cout << std::left << std::setw(28) << "compile, no cache" << compileSeconds * 1000 << std::endl;
+    std::cout << std::left << std::setw(28) << "content hash" << hashSeconds * 1000 << std::endl;
+    std::cout << std::left << std::setw(28) << "miss: compile and store" << missSeconds * 1000 << std::endl;
+    std::cout << std::left << std::setw(28) << "hit: hash and read" << hitSeconds * 1000 << std::endl;
+    std::cout << "Hit is " << compileSeconds / hitSeconds << "x faster than compiling, results "
+              << (matches ? "match" : "DO NOT MATCH") << std::endl;
+
+    // room for two entries: touching the first again makes the second the one to go
+    uint64_t entryBytes = cache.getSizeBytes();
+    cache.setMaxBytes(entryBytes * 2 + entryBytes / 2);
+    Circuit second = generateRandomCircuit(numInputs, numGates, 22);
+    Circuit third = generateRandomCircuit(numInputs, numGates, 23);
+    cache.getSimulator(second);
+    cache.getSimulator(first);
+    cache.getSimulator(third);
+    uint64_t missesBefore = cache.getStats().misses;
+    cache.getSimulator(first);
+    bool firstKept = cache.getStats().misses == missesBefore;
+    cache.getSimulator(second);
+    bool secondEvicted = cache.getStats().misses == missesBefore + 1;
+
+    const CompiledCache::Stats &stats = cache.getStats();
+    std::cout << "LRU with room for 2 of 3 netlists: " << (firstKept && secondEvicted ? "least recently used entry evicted" : "WRONG ENTRY EVICTED")
+              << std::endl;
+    std::cout << "Hits: " << stats.hits << ", misses: " << stats.misses << ", stored: " << stats.stores
+              << ", evicted: " << stats.evictions << ", " << cache.getEntryCount() << " entries, "
+              << cache.getSizeBytes() / 1e6 << " MB on disk" << std::endl;
+    std::filesystem::remove_all(directory);
+}
+
+void Benchmark::runSequentialBenchmark(uint32_t instances, uint32_t bits)
+{
+    Circuit circuit = CircuitGenerator::counterArray(instances, bits);
+    const uint64_t cycles = std::max<uint64_t>(1, 20000000 / circuit.getGateCount());
+    SequentialSimulator simulator(circuit);
+    for (uint32_t i = 0; i < circuit.getInputCount(); i++)
+    {
+        simulator.setInput(i, true);
+    }
+    std::cout << "Sequential benchmark: " << circuit.getGateCount() << " gates, " << simulator.getRegisterCount()
+              << " flip-flops in " << simulator.getStateWordCount() << " state words, " << cycles << " cycles" << std::endl;
+    std::cout << std::left << std::setw(22) << "Engine" << std::setw(18) << "Cycles/s" << std::setw(18) << "Gate evals/s" << "Speedup" << std::endl;
+
+    // objects: one Gate per node, pins copied in before every evaluate, then every flip-flop
+    // samples its pins before any of them is clocked. The generator adds every gate after
+    // the gates driving it (flip-flops aside), so node order is an evaluation order.
+    GatePool pool(circuit.getGateCount());
+    std::vector<Gate *> objects(circuit.getNodeCount(), nullptr);
+    std::vector<SequentialGate *> registers;
+    for (Circuit::NodeId node = 0; node < circuit.getNodeCount(); node++)
+    {
+        if (!circuit.isInput(node))
+        {
+            objects[node] = pool.get(GateFactory::createGate(pool, circuit.getGateType(node)));
+            if (GateFactory::isSequential(circuit.getGateType(node)))
+            {
+                registers.push_back(static_cast<SequentialGate *>(objects[node]));
+            }
+        }
+    }
+    // the only inputs are the counter enables, held at 1
+    auto valueOf = [&](Circuit::NodeId node)
+    { return objects[node] ? objects[node]->getOutput() : true; };
+    auto loadPins = [&](Circuit::NodeId node)
+    {
+        for (uint32_t pin = 0; pin < circuit.getFaninCount(node); pin++)
+        {
+            objects[node]->setInput(pin, valueOf(circuit.getFanin(node)[pin]));
+        }
+    };
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t cycle = 0; cycle < cycles; cycle++)
+    {
+        for (Circuit::NodeId node = 0; node < circuit.getNodeCount(); node++)
+        {
+            if (objects[node] && !GateFactory::isSequential(circuit.getGateType(node)))
+            {
+                loadPins(node);
+                objects[node]->evaluate();
+            }
+        }
+        for (Circuit::NodeId node = 0; node < circuit.getNodeCount(); node++)
+        {
+            if (objects[node] && GateFactory::isSequential(circuit.getGateType(node)))
+            {
+                loadPins(node);
+                objects[node]->evaluate();
+            }
+        }
+        for (SequentialGate *reg : registers)
+        {
+            reg->clock();
+        }
+    }
+    double objectRate = cycles / secondsSince(start);
+    std::cout << std::left << std::setw(22) << "Gate objects" << std::setw(18) << objectRate << std::setw(18)
+              << objectRate * circuit.getGateCount() << 1.0 << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    simulator.clock(cycles);
+    double packedRate = cycles / secondsSince(start);
+    std::cout << std::left << std::setw(22) << "packed cycle-based" << std::setw(18) << packedRate << std::setw(18)
+              << packedRate * circuit.getGateCount() << packedRate / objectRate << std::endl;
+
+    // bit j of every counter is bit j of the cycle count, in both engines
+    size_t wrong = 0;
+    size_t disagree = 0;
+    for (Circuit::NodeId output : circuit.getOutputs())
+    {
+        std::string name = circuit.getName(output);
+        uint32_t bit = std::stoul(name.substr(name.rfind('q') + 1));
+        bool expected = bit < 64 && ((cycles >> bit) & 1);
+        wrong += simulator.getValue(output) != expected;
+        disagree += simulator.getValue(output) != objects[output]->getOutput();
+    }
+    std::cout << (wrong == 0 && disagree == 0 ? "Every counter reads " + std::to_string(cycles) + " in both engines"
+                                              : std::to_string(wrong) + " WRONG COUNTER BITS, " + std::to_string(disagree) + " DISAGREEING")
+              << std::endl;
+}
+
+void Benchmark::runModuleBenchmark(uint32_t instances)
+{
+    if (instances == 0)
+    {
+        throw std::invalid_argument("Benchmark: need at least one instance");
+    }
+    // the counter group of runSequentialBenchmark as a module: en in, 32 count bits out.
+    // Odd instances count on the design's enable, even ones on a bit of the instance before
+    HierarchicalCircuit design;
+    HierarchicalCircuit::DefinitionId counter = design.define("counter", CircuitGenerator::counterArray(1, 8));
+    const Circuit &body = design.getDefinition(counter).body;
+    HierarchicalCircuit::NetId enable = design.addInput("en");
+    for (uint32_t i = 0; i < instances; i++)
+    {
+        HierarchicalCircuit::NetId en = i % 2 || i == 0 ? enable : design.getFirstOutputNet(i - 1) + i % body.getOutputCount();
+        HierarchicalCircuit::InstanceId instance = design.instantiate(counter, "c" + std::to_string(i), {en});
+        for (uint32_t p = 0; p < body.getOutputCount(); p++)
+        {
+            design.markOutput(design.getFirstOutputNet(instance) + p);
+        }
+    }
+    const uint64_t cycles = std::max<uint64_t>(1, 20000000 / (uint64_t(instances) * body.getGateCount()));
+    std::cout << "Module benchmark: " << instances << " instances of a " << body.getGateCount() << "-gate counter module with "
+              << body.getOutputCount() << " flip-flops, " << cycles << " cycles" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    HierarchicalSimulator hierarchical(design);
+    hierarchical.setInput(0, ~0ULL);
+    hierarchical.evaluate();
+    double hierarchicalSetup = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    const Circuit &flat = design.flatten();
+    SequentialSimulator sequential(flat);
+    sequential.setInput(0, true);
+    sequential.evaluate();
+    double flatSetup = secondsSince(start);
+
+    // the structure is paid for once, an instance only adds its record and its signal state
+    size_t structure = design.getDefinitionMemoryUsage() + hierarchical.getProgramMemoryUsage();
+    size_t perInstance = design.getInstanceMemoryUsage() + hierarchical.getStateMemoryUsage();
+    std::cout << std::left << std::setw(22) << "Memory" << std::setw(16) << "Shared bytes" << std::setw(16) << "Per instance" << "Total" << std::endl;
+    std::cout << std::left << std::setw(22) << "Unflattened" << std::setw(16) << structure << std::setw(16)
+              << perInstance / instances << structure + perInstance << std::endl;
+    std::cout << std::left << std::setw(22) << "  of which state" << std::setw(16) << 0 << std::setw(16)
+              << hierarchical.getStateMemoryUsage() / instances << hierarchical.getStateMemoryUsage() << std::endl;
+    std::cout << std::left << std::setw(22) << "Flattened netlist" << std::setw(16) << 0 << std::setw(16)
+              << flat.getMemoryUsage() / instances << flat.getMemoryUsage() << std::endl;
+    std::cout << "State is a 64-lane word per output net and flip-flop: " << body.getOutputCount() * 2 * sizeof(uint64_t)
+              << " bytes per instance, against " << flat.getMemoryUsage() / instances << " bytes of flattened netlist" << std::endl;
+
+    std::cout << std::left << std::setw(22) << "Engine" << std::setw(16) << "Setup ms" << std::setw(16) << "Cycles/s" << "Lane cycles/s" << std::endl;
+    start = std::chrono::steady_clock::now();
+    sequential.clock(cycles);
+    double flatRate = cycles / secondsSince(start);
+    std::cout << std::left << std::setw(22) << "flattened, packed" << std::setw(16) << flatSetup * 1000 << std::setw(16)
+              << flatRate << flatRate << std::endl;
+    start = std::chrono::steady_clock::now();
+    hierarchical.clock(cycles);
+    double hierarchicalRate = cycles / secondsSince(start);
+    std::cout << std::left << std::setw(22) << "unflattened, 64 lanes" << std::setw(16) << hierarchicalSetup * 1000 << std::setw(16)
+              << hierarchicalRate << hierarchicalRate * 64 << std::endl;
+
+    size_t disagree = 0;
+    for (HierarchicalCircuit::NetId net : design.getOutputs())
+    {
+        bool expected = sequential.getValue(flat.findNode(design.getNetName(net)));
+        disagree += hierarchical.getWord(net) != (expected ? ~0ULL : 0);
+    }
+    std::cout << (disagree == 0 ? "All " + std::to_string(design.getOutputs().size()) + " count bits agree on every lane"
+                                : std::to_string(disagree) + " DISAGREEING COUNT BITS")
+              << std::endl;
+
+    // a 64-bit ripple-carry adder of full-adder instances, each lane a random sum
+    Circuit fullAdder;
+    auto addGate2 = [&](GateType type, const char *name, Circuit::NodeId x, Circuit::NodeId y)
+    {
+        Circuit::NodeId gate = fullAdder.addGate(type, name, 2);
+        fullAdder.connect(x, gate, 0);
+        fullAdder.connect(y, gate, 1);
+        return gate;
+    };
+    Circuit::NodeId a = fullAdder.addInput("a");
+    Circuit::NodeId b = fullAdder.addInput("b");
+    Circuit::NodeId cin = fullAdder.addInput("cin");
+    Circuit::NodeId half = addGate2(GateType::Xor, "h", a, b);
+    Circuit::NodeId sum = addGate2(GateType::Xor, "s", half, cin);
+    Circuit::NodeId carryOut = addGate2(GateType::Or, "cout", addGate2(GateType::And, "g", a, b), addGate2(GateType::And, "p", half, cin));
+    fullAdder.markOutput(sum);
+    fullAdder.markOutput(carryOut);
+    fullAdder.freeze();
+    HierarchicalCircuit adder;
+    HierarchicalCircuit::DefinitionId fa = adder.define("fa", std::move(fullAdder));
+    HierarchicalCircuit::NetId carry = adder.addInput("cin");
+    std::vector<HierarchicalCircuit::NetId> aNets, bNets;
+    for (uint32_t bit = 0; bit < 64; bit++)
+    {
+        aNets.push_back(adder.addInput("a" + std::to_string(bit)));
+        bNets.push_back(adder.addInput("b" + std::to_string(bit)));
+        HierarchicalCircuit::InstanceId instance = adder.instantiate(fa, "fa" + std::to_string(bit), {aNets[bit], bNets[bit], carry});
+        carry = adder.getFirstOutputNet(instance) + 1;
+    }
+    std::mt19937_64 random(7);
+    uint64_t operandA[64], operandB[64];
+    for (uint32_t lane = 0; lane < 64; lane++)
+    {
+        operandA[lane] = random();
+        operandB[lane] = random();
+    }
+    // input a<bit> carries bit `bit` of every lane's operand
+    HierarchicalSimulator adderSimulator(adder);
+    for (uint32_t bit = 0; bit < 64; bit++)
+    {
+        uint64_t aWord = 0, bWord = 0;
+        for (uint32_t lane = 0; lane < 64; lane++)
+        {
+            aWord |= ((operandA[lane] >> bit) & 1) << lane;
+            bWord |= ((operandB[lane] >> bit) & 1) << lane;
+        }
+        adderSimulator.setInputNet(aNets[bit], aWord);
+        adderSimulator.setInputNet(bNets[bit], bWord);
+    }
+    adderSimulator.evaluate();
+    uint32_t correct = 0;
+    for (uint32_t lane = 0; lane < 64; lane++)
+    {
+        uint64_t result = 0;
+        for (uint32_t bit = 0; bit < 64; bit++)
+        {
+            result |= static_cast<uint64_t>(adderSimulator.getValue(adder.getFirstOutputNet(bit), lane)) << bit;
+        }
+        correct += result == operandA[lane] + operandB[lane];
+    }
+    std::cout << "64-bit adder of 64 full-adder instances (" << adder.getDefinitionMemoryUsage() << " bytes of module): "
+              << (correct == 64 ? "all 64 lane sums correct" : std::to_string(64 - correct) + " WRONG LANE SUMS") << std::endl;
+}
+
+void Benchmark::runClockDomainBenchmark(uint32_t bits)
+{
+    Circuit circuit = CircuitGenerator::counterArray(4, bits);
+    std::vector<ClockDefinition> clocks = {
+        {"fast", 1, 0, "", "u0."},
+        {"div2", 2, 0, "", "u1."},
+        {"div4", 4, 1, "", "u2."},
+        {"gated", 1, 0, "u3.en", "u3."}};
+    const uint64_t instants = std::max<uint64_t>(64, 20000000 / circuit.getGateCount());
+    ClockScheduler scheduler(circuit, clocks);
+    SequentialSimulator &simulator = scheduler.getSimulator();
+    for (uint32_t i = 0; i < circuit.getInputCount(); i++)
+    {
+        simulator.setInput(i, true);
+    }
+    Circuit::NodeId gatedEnable = circuit.findNode("u3.en");
+    std::cout << "Clock domain benchmark: " << circuit.getGateCount() << " gates, " << simulator.getRegisterCount() << " flip-flops, "
+              << simulator.getSegmentCount() << " logic segments, " << instants << " edge instants" << std::endl;
+
+    // every counter group sees every instant, the reference for the work a single global clock costs
+    SequentialSimulator sweep(circuit);
+    for (uint32_t i = 0; i < circuit.getInputCount(); i++)
+    {
+        sweep.setInput(i, true);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < instants; i++)
+    {
+        sweep.setInputNode(gatedEnable, (i & 3) == 0);
+        sweep.tick(1);
+    }
+    double sweepSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < instants; i++)
+    {
+        simulator.setInputNode(gatedEnable, (i & 3) == 0);
+        scheduler.step();
+    }
+    simulator.evaluate();
+    double scheduledSeconds = secondsSince(start);
+
+    std::cout << std::left << std::setw(8) << "Clock" << std::right << std::setw(7) << "Period" << std::setw(7) << "Phase"
+              << std::setw(8) << "FFs" << std::setw(8) << "Cone" << std::setw(10) << "Edges" << std::setw(10) << "Gated"
+              << std::setw(14) << "Skipped" << std::endl;
+    std::vector<ClockScheduler::DomainReport> reports = scheduler.getReport();
+    for (size_t d = 0; d < reports.size(); d++)
+    {
+        const ClockScheduler::DomainReport &report = reports[d];
+        std::cout << std::left << std::setw(8) << report.name << std::right << std::setw(7) << clocks[d].period << std::setw(7)
+                  << clocks[d].phase << std::setw(8) << report.stats.flipFlops << std::setw(8) << report.stats.coneGates
+                  << std::setw(10) << report.stats.edges << std::setw(10) << report.stats.gatedOff << std::setw(14)
+                  << report.skippedEvaluations << std::endl;
+    }
+    std::cout << std::left << std::setw(26) << "Engine" << std::setw(16) << "Instants/s" << std::setw(18) << "Gate evals" << "Speedup" << std::endl;
+    std::cout << std::left << std::setw(26) << "full sweep every instant" << std::setw(16) << instants / sweepSeconds
+              << std::setw(18) << sweep.getGateEvaluations() << 1.0 << std::endl;
+    std::cout << std::left << std::setw(26) << "per-domain schedule" << std::setw(16) << instants / scheduledSeconds
+              << std::setw(18) << simulator.getGateEvaluations() << sweepSeconds / scheduledSeconds << std::endl;
+
+    // a counter in domain d reads the edges of d up to the last instant that found it enabled;
+    // the fast clock ticks every time unit, so instant i is time i
+    size_t wrong = 0;
+    for (Circuit::NodeId output : circuit.getOutputs())
+    {
+        std::string name = circuit.getName(output);
+        uint32_t domain = std::stoul(name.substr(1, name.find('.') - 1));
+        uint64_t expected = 0;
+        for (uint64_t time = 0; time < instants; time++)
+        {
+            bool edge = time >= clocks[domain].phase && (time - clocks[domain].phase) % clocks[domain].period == 0;
+            expected += edge && (clocks[domain].enable.empty() || (time & 3) == 0);
+        }
+        uint32_t bit = std::stoul(name.substr(name.rfind('q') + 1));
+        wrong += simulator.getValue(output) != (bit < 64 && ((expected >> bit) & 1));
+    }
+    std::cout << (wrong == 0 ? "Every counter reads the enabled edges of its clock" : std::to_string(wrong) + " WRONG COUNTER BITS")
+              << std::endl;
+}
+
+void Benchmark::runLogicBenchmark(uint32_t numGates)
+{
+    if (numGates < 1)
+    {
+        throw std::invalid_argument("Logic benchmark needs at least one gate");
+    }
+    const uint32_t numInputs = 256;
+    Circuit circuit = generateRandomCircuit(numInputs, numGates, 31);
+    const uint64_t cycles = std::max<uint64_t>(1024, 2000000000ULL / numGates);
+    LevelizedSimulator simulator(circuit);
+    simulator.run(cycles / 8);
+    std::cout << "Logic benchmark: " << numGates << " gates in " << simulator.getLevelCount() << " levels, "
+              << cycles << " random vectors per run" << std::endl;
+    std::cout << std::left << std::setw(30) << "Mode" << std::setw(18) << "Cycles/s" << "Relative" << std::endl;
+
+    LevelizedSimulator::RunStats twoValued = simulator.run(cycles);
+    std::cout << std::left << std::setw(30) << "two-valued" << std::setw(18) << twoValued.cyclesPerSecond() << 1.0 << std::endl;
+    simulator.setLogicMode(LogicMode::FourValued);
+    LevelizedSimulator::RunStats fourValued = simulator.run(cycles);
+    simulator.setLogicMode(LogicMode::TwoValued);
+    LevelizedSimulator::RunStats again = simulator.run(cycles);
+    std::cout << std::left << std::setw(30) << "four-valued" << std::setw(18) << fourValued.cyclesPerSecond()
+              << fourValued.cyclesPerSecond() / twoValued.cyclesPerSecond() << std::endl;
+    std::cout << std::left << std::setw(30) << "two-valued after four-valued" << std::setw(18) << again.cyclesPerSecond()
+              << again.cyclesPerSecond() / twoValued.cyclesPerSecond() << std::endl;
+
+    // known inputs: the same words, nothing unknown
+    LevelizedSimulator four(circuit);
+    four.setLogicMode(LogicMode::FourValued);
+    std::mt19937_64 rng(31);
+    std::vector<uint64_t> words(numInputs);
+    for (uint32_t i = 0; i < numInputs; i++)
+    {
+        words[i] = rng();
+        simulator.setInputWord(i, words[i]);
+        four.setInputWord(i, words[i]);
+    }
+    simulator.evaluate();
+    four.evaluate();
+    size_t mismatches = 0;
+    for (Circuit::NodeId node : circuit.getOutputs())
+    {
+        LogicWord word = four.getLogicWord(node);
+        mismatches += word.unknown != 0 || word.value != simulator.getWord(node);
+    }
+
+    // input 0 unknown in every lane: a known output lane must match both of its values,
+    // and an X lane where both agree is pessimism from reconvergent fan-out
+    four.setInputLogic(0, logicWord(Logic::X));
+    four.evaluate();
+    LevelizedSimulator low(circuit);
+    LevelizedSimulator high(circuit);
+    for (uint32_t i = 0; i < numInputs; i++)
+    {
+        low.setInputWord(i, i == 0 ? 0 : words[i]);
+        high.setInputWord(i, i == 0 ? ~0ULL : words[i]);
+    }
+    low.evaluate();
+    high.evaluate();
+    size_t unsound = 0;
+    uint64_t unknownLanes = 0;
+    uint64_t pessimisticLanes = 0;
+    for (Circuit::NodeId node : circuit.getOutputs())
+    {
+        LogicWord word = four.getLogicWord(node);
+        uint64_t known = ~word.unknown;
+        unsound += ((low.getWord(node) ^ word.value) & known) != 0 || ((high.getWord(node) ^ word.value) & known) != 0;
+        unknownLanes += std::bitset<64>(word.unknown).count();
+        pessimisticLanes += std::bitset<64>(word.unknown & ~(low.getWord(node) ^ high.getWord(node))).count();
+    }
+    std::cout << "Known inputs: " << (mismatches == 0 ? "four-valued matches two-valued on every output" : std::to_string(mismatches) + " OUTPUTS DIFFER")
+              << std::endl;
+    std::cout << "Input 0 at X: " << unknownLanes << " of " << circuit.getOutputCount() * 64 << " output lanes X, "
+              << pessimisticLanes << " of them pessimistic, " << (unsound == 0 ? "no known lane is wrong" : std::to_string(unsound) + " OUTPUTS WRONG")
+              << std::endl;
+}
+
+void Benchmark::runBusBenchmark(uint32_t drivers)
+{
+    if (drivers < 2)
+    {
+        throw std::invalid_argument("Bus benchmark needs at least two drivers per bus");
+    }
+    // every bus has its own enables and shares the data lines, a third of them of each kind
+    const uint32_t numBuses = 96;
+    const GateType kinds[] = {GateType::Bus, GateType::WiredAnd, GateType::WiredOr};
+    Circuit circuit;
+    std::vector<Circuit::NodeId> data;
+    for (uint32_t d = 0; d < drivers; d++)
+    {
+        data.push_back(circuit.addInput("d" + std::to_string(d)));
+    }
+    std::vector<Circuit::NodeId> buses;
+    for (uint32_t b = 0; b < numBuses; b++)
+    {
+        std::string name = "bus" + std::to_string(b);
+        Circuit::NodeId bus = circuit.addGate(kinds[b % 3], name, drivers);
+        for (uint32_t d = 0; d < drivers; d++)
+        {
+            Circuit::NodeId enable = circuit.addInput(name + ".en" + std::to_string(d));
+            Circuit::NodeId driver = circuit.addGate(GateType::TriState, name + ".drv" + std::to_string(d), 2);
+            circuit.connect(data[d], driver, 0);
+            circuit.connect(enable, driver, 1);
+            circuit.connect(driver, bus, d);
+        }
+        circuit.markOutput(bus);
+        buses.push_back(bus);
+    }
+    circuit.freeze();
+
+    // sparse enables, so lanes see one driver, none (Z) and several (contention) on the same bus
+    LevelizedSimulator simulator(circuit);
+    simulator.setLogicMode(LogicMode::FourValued);
+    std::mt19937_64 rng(24);
+    std::vector<LogicWord> inputs(circuit.getNodeCount());
+    for (uint32_t i = 0; i < circuit.getInputCount(); i++)
+    {
+        Circuit::NodeId node = circuit.getInputs()[i];
+        bool isData = i < drivers;
+        inputs[node] = LogicWord{isData ? rng() : rng() & rng() & rng() & rng(), isData ? rng() & rng() & rng() : 0};
+        simulator.setInputLogic(i, inputs[node]);
+    }
+    const uint64_t sweeps = std::max<uint64_t>(16, 200000000ULL / (numBuses * drivers));
+    std::cout << "Bus benchmark: " << numBuses << " buses of " << drivers << " tri-state drivers, "
+              << sweeps * 64 << " lanes per net" << std::endl;
+    std::cout << std::left << std::setw(30) << "Resolution" << std::setw(18) << "Nets/s" << "Relative" << std::endl;
+
+    simulator.evaluate();
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < sweeps; i++)
+    {
+        simulator.evaluate();
+    }
+    double parallelSeconds = secondsSince(start);
+    double parallelRate = sweeps * 64.0 * numBuses / parallelSeconds;
+    std::cout << std::left << std::setw(30) << "bit-parallel, 64 lanes" << std::setw(18) << parallelRate << 1.0 << std::endl;
+
+    // one lane, one driver at a time, the way a scalar simulator resolves a net
+    auto laneOf = [&](Circuit::NodeId node, int lane)
+    { return logicAt(inputs[node], lane); };
+    std::vector<Logic> resolved(numBuses * 64);
+    const uint64_t serialSweeps = std::max<uint64_t>(1, sweeps / 16);
+    start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < serialSweeps; i++)
+    {
+        for (uint32_t b = 0; b < numBuses; b++)
+        {
+            GateType kind = circuit.getGateType(buses[b]);
+            const Circuit::NodeId *fanin = circuit.getFanin(buses[b]);
+            for (int lane = 0; lane < 64; lane++)
+            {
+                bool anyOne = false;
+                bool anyZero = false;
+                bool anyX = false;
+                bool allZ = true;
+                for (uint32_t d = 0; d < drivers; d++)
+                {
+                    const Circuit::NodeId *pins = circuit.getFanin(fanin[d]);
+                    Logic value = laneOf(pins[0], lane);
+                    Logic enable = laneOf(pins[1], lane);
+                    Logic driven = enable == Logic::Zero ? Logic::Z : enable != Logic::One || value == Logic::Z ? Logic::X : value;
+                    anyOne |= driven == Logic::One;
+                    anyZero |= driven == Logic::Zero;
+                    anyX |= driven == Logic::X;
+                    allZ &= driven == Logic::Z;
+                }
+                Logic result;
+                if (allZ)
+                    result = Logic::Z;
+                else if (kind == GateType::WiredAnd)
+                    result = anyZero ? Logic::Zero : anyX ? Logic::X : Logic::One;
+                else if (kind == GateType::WiredOr)
+                    result = anyOne ? Logic::One : anyX ? Logic::X : Logic::Zero;
+                else
+                    result = anyX || (anyOne && anyZero) ? Logic::X : anyOne ? Logic::One : Logic::Zero;
+                resolved[b * 64 + lane] = result;
+            }
+        }
+    }
+    double serialSeconds = secondsSince(start);
+    double serialRate = serialSweeps * 64.0 * numBuses / serialSeconds;
+    std::cout << std::left << std::setw(30) << "per lane and driver" << std::setw(18) << serialRate
+              << serialRate / parallelRate << std::endl;
+
+    size_t mismatches = 0;
+    uint64_t counts[4] = {0, 0, 0, 0};
+    for (uint32_t b = 0; b < numBuses; b++)
+    {
+        for (int lane = 0; lane < 64; lane++)
+        {
+            Logic value = simulator.getLogic(buses[b], lane);
+            mismatches += value != resolved[b * 64 + lane];
+            counts[static_cast<int>(value)]++;
+        }
+    }
+    std::cout << "Bit-parallel speedup: " << parallelRate / serialRate << "x" << std::endl;
+    std::cout << "Resolved lanes: " << counts[0] << " 0, " << counts[1] << " 1, " << counts[2] << " X, " << counts[3] << " Z; "
+              << (mismatches == 0 ? "both agree on every lane" : std::to_string(mismatches) + " LANES DIFFER") << std::endl;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "core/Gate.h"
+
+class Circuit;
+
+class Benchmark
+{
+public:
+    // random levelized netlist shared by the lane benchmarks
+    struct RandomNetlist
+    {
+        int numInputs;
+        std::vector<GateType> types;      // one entry per gate
+        std::vector<uint32_t> faninStart; // gate g reads fanin[faninStart[g] .. faninStart[g + 1])
+        std::vector<uint32_t> fanin;      // signal ids, inputs first then gate outputs
+    };
+
+    static RandomNetlist generateRandomNetlist(int numInputs, int numGates, uint32_t seed = 1);
+
+    // compares one-pattern-per-visit scalar evaluation with the 64-bit and SIMD lane backends
+    static void runLaneBenchmark(int numGates, int numPatterns);
+
+    // level-parallel sweeps on generated adder and multiplier arrays, from 1 to maxThreads threads
+    static void runParallelBenchmark(uint32_t instances, uint32_t bits, unsigned maxThreads);
+
+    // virtual evaluateWord per gate vs a type switch per gate vs the type-grouped opcode stream
+    static void runDispatchBenchmark(uint32_t instances, uint32_t bits);
+
+    // row-based TruthTable vs PackedTruthTable on XOR gates from 4 up to maxInputs inputs
+    static void runTruthTableBenchmark(int maxInputs);
+
+    // exhaustive TruthTableStream check of an XOR gate, serial and on 1 to maxThreads threads
+    static void runVerifyBenchmark(int inputs, unsigned maxThreads);
+
+    // exhaustive truth table of one ripple-carry adder checked against bit-sliced addition,
+    // timed against re-simulating the circuit once per output
+    static void runCircuitTableBenchmark(uint32_t bits);
+
+    // Quine-McCluskey SOP minimization of random functions, serial and on a thread pool
+    static void runKMapBenchmark(int numVariables, int numFunctions, unsigned threads);
+
+    // Espresso on a wide multiple-output cover: random product terms, each split into
+    // eight subcubes on three extra variables, so the minimizer has a known target
+    static void runEspressoBenchmark(int numInputs, int numOutputs, int numTerms);
+
+    // BDDs of a ripple-carry adder checked for equivalence against a bit-level spec of
+    // addition, then the multiplier from 2 bits up to show the growth of its BDDs
+    static void runBddBenchmark(uint32_t adderBits, uint32_t multiplierBits);
+
+    // parses a random sum of XORed product terms, then evaluates it over `vectors` random
+    // vectors as compiled bytecode and as the equivalent gate netlist on LevelizedSimulator
+    static void runExpressionBenchmark(int numVariables, int numTerms, uint64_t vectors);
+
+    // writes a random netlist as Verilog and BLIF, imports both back, reports the load
+    // rate against the one-second-per-million-gates target and checks them by simulation
+    static void runImportBenchmark(uint32_t numGates);
+
+    // startup from a mapped binary netlist image against parsing the same netlist as Verilog,
+    // then a first simulation of the mapped circuit checked against the original
+    static void runImageBenchmark(uint32_t numGates);
+
+    // simulator setup through the compiled-netlist cache, cold and warm, against compiling
+    // from scratch, then LRU eviction with a bound that holds two of three netlists
+    static void runCacheBenchmark(uint32_t numGates);
+
+    // clocks generated counters of every flip-flop kind on the packed cycle-based engine and
+    // as one Gate object per node, and checks every counter reads the number of edges
+    static void runSequentialBenchmark(uint32_t instances, uint32_t bits);
+
+    // four counter groups on clocks of different periods and phases, one of them gated with
+    // its enable high on a quarter of the edges, scheduled per domain against sweeping the
+    // whole netlist at every edge; checks every counter reads its domain's enabled edges
+    static void runClockDomainBenchmark(uint32_t bits);
+
+    // two-valued sweeps before and after a round trip through four-valued mode, against
+    // four-valued sweeps; checks known inputs give the two-valued result, and that an X
+    // input only leaves lanes known where both of its values agree
+    static void runLogicBenchmark(uint32_t numGates);
+
+    // buses of tri-state drivers, resolved as contention-to-X, wired-AND and wired-OR nets, on
+    // the four-valued sweep against resolving every net one lane and one driver at a time;
+    // checks both agree on every net and lane
+    static void runBusBenchmark(uint32_t drivers);
+
+    // instances of one counter module chained through their enables, simulated unflattened
+    // against the flattened netlist on the cycle-based engine: memory per instance, setup and
+    // cycle rate, and the same counts in both; then a 64-bit adder of full-adder instances
+    // checked on random sums
+    static void runModuleBenchmark(uint32_t instances);
+
+    // builds and tears down the same gates through make_shared and through a GatePool
+    static void runAllocationBenchmark(size_t numGates);
+
+private:
+    // random frozen circuit whose gates read nodes from a window behind them, like a
+    // synthesized netlist written in order
+    static Circuit generateRandomCircuit(uint32_t numInputs, uint32_t numGates, uint32_t seed);
+    // resident set size in bytes, or -1 where the platform does not expose it
+    static long long currentRssBytes();
+    static double secondsSince(const std::chrono::steady_clock::time_point &start);
+};
@@ -0,0 +1,197 @@
+#include "BinaryNetlist.h"
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include "utils/parser.h"
+
+namespace
+{
+    constexpr char Magic[8] = {'D', 'L', 'S', 'N', 'E', 'T', '\r', '\n'};
+    constexpr uint32_t ByteOrderMark = 0x01020304;
+    // every section starts on its own cache line
+    constexpr uint64_t Alignment = 64;
+
+    enum Section
+    {
+        TypeCodes,
+        Delays,
+        FaninOffsets,
+        FaninIds,
+        FanoutOffsets,
+        FanoutIds,
+        Inputs,
+        Outputs,
+        Values,
+        NameOffsets,
+        NameSlots,
+        NameTable,
+        SectionCount
+    };
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t nodeCount;
+        uint32_t inputCount;
+        uint32_t outputCount;
+        uint32_t nameSlotCount;
+        uint64_t faninCount;
+        uint64_t nameBytes;
+        uint64_t fileBytes;
+        // byte offset of every section from the start of the file
+        uint64_t sections[SectionCount];
+    };
+
+    uint64_t sectionBytes(const Header &header, int section)
+    {
+        switch (section)
+        {
+        case TypeCodes:
+            return header.nodeCount;
+        case Delays:
+            return header.nodeCount * sizeof(uint32_t);
+        case FaninOffsets:
+        case FanoutOffsets:
+        case NameOffsets:
+            return (header.nodeCount + uint64_t(1)) * sizeof(uint32_t);
+        case FaninIds:
+        case FanoutIds:
+            return header.faninCount * sizeof(Circuit::NodeId);
+        case Inputs:
+            return header.inputCount * sizeof(Circuit::NodeId);
+        case Outputs:
+            return header.outputCount * sizeof(Circuit::NodeId);
+        case Values:
+            return (header.nodeCount + uint64_t(63)) / 64 * sizeof(uint64_t);
+        case NameSlots:
+            return header.nameSlotCount * sizeof(Circuit::NodeId);
+        default:
+            return header.nameBytes;
+        }
+    }
+
+    uint64_t alignUp(uint64_t offset)
+    {
+        return (offset + Alignment - 1) / Alignment * Alignment;
+    }
+}
+
+void BinaryNetlist::save(const Circuit &circuit, const std::string &path)
+{
+    Circuit::Image image = circuit.getImage();
+    Header header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.byteOrder = ByteOrderMark;
+    header.nodeCount = image.nodeCount;
+    header.inputCount = image.inputCount;
+    header.outputCount = image.outputCount;
+    header.nameSlotCount = image.nameSlotCount;
+    header.faninCount = image.faninOffsets[image.nodeCount];
+    header.nameBytes = image.nameOffsets[image.nodeCount];
+    uint64_t offset = alignUp(sizeof(Header));
+    for (int section = 0; section < SectionCount; section++)
+    {
+        header.sections[section] = offset;
+        offset = alignUp(offset + sectionBytes(header, section));
+    }
+    header.fileBytes = offset;
+
+    const void *data[SectionCount] = {image.typeCodes, image.delays, image.faninOffsets, image.faninIds,
+                                      image.fanoutOffsets, image.fanoutIds, image.inputs, image.outputs, image.values,
+                                      image.nameOffsets, image.nameSlots, image.nameTable};
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Cannot write netlist image: " + path);
+    }
+    static const char padding[Alignment] = {};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    uint64_t written = sizeof(Header);
+    for (int section = 0; section < SectionCount; section++)
+    {
+        file.write(padding, header.sections[section] - written);
+        file.write(static_cast<const char *>(data[section]), sectionBytes(header, section));
+        written = header.sections[section] + sectionBytes(header, section);
+    }
+    file.write(padding, header.fileBytes - written);
+    if (!file)
+    {
+        throw std::runtime_error("Cannot write netlist image: " + path);
+    }
+}
+
+Circuit BinaryNetlist::load(const std::string &path)
+{
+    auto file = std::make_shared<MappedFile>(path, MappedFile::Access::InPlace);
+    Header header;
+    if (file->size() < sizeof(Header))
+    {
+        throw std::runtime_error(path + " is not a netlist image");
+    }
+    std::memcpy(&header, file->data(), sizeof(Header));
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0)
+    {
+        throw std::runtime_error(path + " is not a netlist image");
+    }
+    if (header.byteOrder != ByteOrderMark)
+    {
+        throw std::runtime_error(path + " was written on a machine of the other byte order");
+    }
+    if (header.version != Version)
+    {
+        throw std::runtime_error(path + " is netlist image version " + std::to_string(header.version) +
+                                 ", this build reads version " + std::to_string(Version));
+    }
+    if (header.fileBytes != file->size())
+    {
+        throw std::runtime_error(path + " is truncated");
+    }
+    for (int section = 0; section < SectionCount; section++)
+    {
+        if (header.sections[section] % Alignment != 0 || header.sections[section] > file->size() ||
+            sectionBytes(header, section) > file->size() - header.sections[section])
+        {
+            throw std::runtime_error(path + " has a damaged section table");
+        }
+    }
+
+    const char *base = file->data();
+    auto section = [&](int index)
+    {
+        return base + header.sections[index];
+    };
+    Circuit::Image image;
+    image.nodeCount = header.nodeCount;
+    image.inputCount = header.inputCount;
+    image.outputCount = header.outputCount;
+    image.nameSlotCount = header.nameSlotCount;
+    image.typeCodes = reinterpret_cast<const uint8_t *>(section(TypeCodes));
+    image.delays = reinterpret_cast<const uint32_t *>(section(Delays));
+    image.faninOffsets = reinterpret_cast<const uint32_t *>(section(FaninOffsets));
+    image.faninIds = reinterpret_cast<const Circuit::NodeId *>(section(FaninIds));
+    image.fanoutOffsets = reinterpret_cast<const uint32_t *>(section(FanoutOffsets));
+    image.fanoutIds = reinterpret_cast<const Circuit::NodeId *>(section(FanoutIds));
+    image.inputs = reinterpret_cast<const Circuit::NodeId *>(section(Inputs));
+    image.outputs = reinterpret_cast<const Circuit::NodeId *>(section(Outputs));
+    image.values = reinterpret_cast<const uint64_t *>(section(Values));
+    image.nameOffsets = reinterpret_cast<const uint32_t *>(section(NameOffsets));
+    image.nameSlots = reinterpret_cast<const Circuit::NodeId *>(section(NameSlots));
+    image.nameTable = section(NameTable);
+
+    // the ends of the offset arrays must agree with the header, which catches most damage
+    // without reading more than a few words
+    bool consistent = image.faninOffsets[0] == 0 && image.faninOffsets[image.nodeCount] == header.faninCount &&
+                      image.fanoutOffsets[image.nodeCount] == header.faninCount &&
+                      image.nameOffsets[image.nodeCount] == header.nameBytes &&
+                      (image.nameSlotCount & (image.nameSlotCount - 1)) == 0 &&
+                      (image.nameSlotCount > image.nodeCount || image.nodeCount == 0);
+    if (!consistent)
+    {
+        throw std::runtime_error(path + " has inconsistent netlist arrays");
+    }
+    return Circuit::attach(image, std::move(file));
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "core/Circuit.h"
+
+// Versioned binary netlist: the arrays of a frozen Circuit written out exactly as they are
+// in memory, each section aligned to 64 bytes behind a fixed header. load() maps the file
+// and attaches a Circuit to the sections in place, so opening a netlist of any size costs
+// a header check plus the page faults of whatever the simulation goes on to read.
+//
+// Layout, in native byte order (a marker in the header rejects files of the other order):
+//   header    magic, version, byte-order marker, counts, file size, section offsets
+//   sections  type codes, delays, fan-in offsets, fan-in ids, fan-out offsets, fan-out ids,
+//             inputs, outputs, signal values, name offsets, name hash slots, name bytes
+// The name hash table is stored as built, so Circuit's name hash is part of the format;
+// changing the hash or the layout means bumping Version.
+class BinaryNetlist
+{
+public:
+    static constexpr uint32_t Version = 1;
+
+    static void save(const Circuit &circuit, const std::string &path);
+    // throws std::runtime_error for files that are not netlist images, come from another
+    // version or are truncated; only the header and section bounds are checked
+    static Circuit load(const std::string &path);
+};
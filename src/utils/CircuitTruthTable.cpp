@@ -0,0 +1,329 @@
+#include "CircuitTruthTable.h"
+#include <algorithm>
+#include <bitset>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "core/LevelizedSimulator.h"
+#include "PackedTruthTable.h"
+
+CircuitTruthTable::CircuitTruthTable(const Circuit &circuit)
+{
+    if (!circuit.isFrozen())
+    {
+        throw std::invalid_argument("Circuit truth table needs a frozen circuit");
+    }
+    if (circuit.getInputCount() > MaxInputs)
+    {
+        throw std::invalid_argument("Circuit truth table supports at most " + std::to_string(MaxInputs) + " inputs");
+    }
+    if (circuit.getOutputCount() == 0)
+    {
+        throw std::invalid_argument("Circuit has no outputs");
+    }
+    this->circuit = &circuit;
+    numInputs = static_cast<int>(circuit.getInputCount());
+    numOutputs = circuit.getOutputCount();
+    numRows = 1ULL << numInputs;
+    wordCount = (numRows + 63) / 64;
+    expected.assign(numOutputs * wordCount, 0);
+    actual.assign(numOutputs * wordCount, 0);
+    outputMismatches.assign(numOutputs, 0);
+    rowMismatches = 0;
+}
+
+uint64_t CircuitTruthTable::tailMask() const
+{
+    return numRows >= 64 ? ~0ULL : (1ULL << numRows) - 1;
+}
+
+uint64_t CircuitTruthTable::diffWord(uint32_t output, size_t word) const
+{
+    return expected[output * wordCount + word] ^ actual[output * wordCount + word];
+}
+
+// expected outputs
+
+void CircuitTruthTable::setExpectedFunction(const ExpectedFunction &reference)
+{
+    std::vector<uint64_t> inputWords(numInputs);
+    std::vector<uint64_t> outputWords(numOutputs);
+    for (size_t word = 0; word < wordCount; word++)
+    {
+        for (int bit = 0; bit < numInputs; bit++)
+        {
+            inputWords[bit] = PackedTruthTable::getInputWord(bit, word);
+        }
+        std::fill(outputWords.begin(), outputWords.end(), 0);
+        reference(inputWords.data(), outputWords.data());
+        for (uint32_t output = 0; output < numOutputs; output++)
+        {
+            expected[output * wordCount + word] = outputWords[output] & (word + 1 == wordCount ? tailMask() : ~0ULL);
+        }
+    }
+    compareResults();
+}
+
+void CircuitTruthTable::setExpectedWords(uint32_t output, const std::vector<uint64_t> &words)
+{
+    validateOutput(output);
+    if (words.size() != wordCount)
+    {
+        throw std::invalid_argument("Expected words size does not match number of rows");
+    }
+    std::copy(words.begin(), words.end(), expected.begin() + output * wordCount);
+    expected[output * wordCount + wordCount - 1] &= tailMask();
+    compareResults();
+}
+
+void CircuitTruthTable::setExpectedOutput(uint64_t row, uint32_t output, bool value)
+{
+    validateRow(row);
+    validateOutput(output);
+    // keep the counters current without rescanning the planes
+    bool outputWasMatch = getExpectedOutput(row, output) == getActualOutput(row, output);
+    bool rowWasMatch = isMatch(row);
+    uint64_t &word = expected[output * wordCount + row / 64];
+    uint64_t bit = 1ULL << (row % 64);
+    word = value ? word | bit : word & ~bit;
+    if (outputWasMatch != (value == getActualOutput(row, output)))
+    {
+        outputMismatches[output] += outputWasMatch ? 1 : -1;
+    }
+    if (rowWasMatch != isMatch(row))
+    {
+        rowMismatches += rowWasMatch ? 1 : -1;
+    }
+}
+
+// evaluation
+
+void CircuitTruthTable::evaluate()
+{
+    LevelizedSimulator simulator(*circuit);
+    Circuit::NodeList outputs = circuit->getOutputs();
+    for (size_t word = 0; word < wordCount; word++)
+    {
+        for (int bit = 0; bit < numInputs; bit++)
+        {
+            simulator.setInputWord(bit, PackedTruthTable::getInputWord(bit, word));
+        }
+        // one pass yields 64 rows of every output
+        simulator.evaluate();
+        for (uint32_t output = 0; output < numOutputs; output++)
+        {
+            actual[output * wordCount + word] = simulator.getWord(outputs[output]);
+        }
+    }
+    for (uint32_t output = 0; output < numOutputs; output++)
+    {
+        actual[output * wordCount + wordCount - 1] &= tailMask();
+    }
+    compareResults();
+}
+
+void CircuitTruthTable::compareResults()
+{
+    std::fill(outputMismatches.begin(), outputMismatches.end(), 0);
+    rowMismatches = 0;
+    for (size_t word = 0; word < wordCount; word++)
+    {
+        uint64_t rowDiff = 0;
+        for (uint32_t output = 0; output < numOutputs; output++)
+        {
+            uint64_t diff = diffWord(output, word);
+            outputMismatches[output] += std::bitset<64>(diff).count();
+            rowDiff |= diff;
+        }
+        rowMismatches += std::bitset<64>(rowDiff).count();
+    }
+}
+
+// row access
+
+bool CircuitTruthTable::getInput(uint64_t row, uint32_t input) const
+{
+    validateRow(row);
+    if (input >= static_cast<uint32_t>(numInputs))
+    {
+        throw std::out_of_range("Input index out of range");
+    }
+    return (row >> input) & 1;
+}
+
+bool CircuitTruthTable::getExpectedOutput(uint64_t row, uint32_t output) const
+{
+    validateRow(row);
+    validateOutput(output);
+    return (expected[output * wordCount + row / 64] >> (row % 64)) & 1;
+}
+
+bool CircuitTruthTable::getActualOutput(uint64_t row, uint32_t output) const
+{
+    validateRow(row);
+    validateOutput(output);
+    return (actual[output * wordCount + row / 64] >> (row % 64)) & 1;
+}
+
+bool CircuitTruthTable::isMatch(uint64_t row) const
+{
+    validateRow(row);
+    for (uint32_t output = 0; output < numOutputs; output++)
+    {
+        if ((diffWord(output, row / 64) >> (row % 64)) & 1)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// analysis
+
+uint64_t CircuitTruthTable::getMismatchCount(uint32_t output) const
+{
+    validateOutput(output);
+    return outputMismatches[output];
+}
+
+double CircuitTruthTable::getAccuracy(uint32_t output) const
+{
+    return static_cast<double>(numRows - getMismatchCount(output)) / numRows * 100;
+}
+
+std::vector<uint64_t> CircuitTruthTable::getMismatches(uint32_t output, size_t limit) const
+{
+    validateOutput(output);
+    std::vector<uint64_t> result;
+    for (size_t word = 0; word < wordCount && result.size() < limit; word++)
+    {
+        uint64_t diff = diffWord(output, word);
+        while (diff != 0 && result.size() < limit)
+        {
+            uint64_t lowest = diff & (~diff + 1);
+            result.push_back(word * 64 + std::bitset<64>(lowest - 1).count());
+            diff ^= lowest;
+        }
+    }
+    return result;
+}
+
+double CircuitTruthTable::getAccuracy() const
+{
+    return static_cast<double>(numRows - rowMismatches) / numRows * 100;
+}
+
+std::vector<uint64_t> CircuitTruthTable::getMismatches(size_t limit) const
+{
+    std::vector<uint64_t> result;
+    for (size_t word = 0; word < wordCount && result.size() < limit; word++)
+    {
+        uint64_t diff = 0;
+        for (uint32_t output = 0; output < numOutputs; output++)
+        {
+            diff |= diffWord(output, word);
+        }
+        while (diff != 0 && result.size() < limit)
+        {
+            uint64_t lowest = diff & (~diff + 1);
+            result.push_back(word * 64 + std::bitset<64>(lowest - 1).count());
+            diff ^= lowest;
+        }
+    }
+    return result;
+}
+
+size_t CircuitTruthTable::getMemoryUsage() const
+{
+    return (expected.capacity() + actual.capacity() + outputMismatches.capacity()) * sizeof(uint64_t);
+}
+
+// display
+
+void CircuitTruthTable::printToConsole(uint64_t maxRows) const
+{
+    std::string separator((numInputs + numOutputs + 2) * 6, '-');
+    std::cout << separator << std::endl;
+    std::cout << "Row";
+    for (Circuit::NodeId input : circuit->getInputs())
+    {
+        std::cout << "\t" << circuit->getName(input);
+    }
+    std::cout << "\t|";
+    for (Circuit::NodeId output : circuit->getOutputs())
+    {
+        std::cout << "\t" << circuit->getName(output);
+    }
+    std::cout << "\tMatch" << std::endl;
+    std::cout << separator << std::endl;
+
+    for (uint64_t row = 0; row < numRows && row < maxRows; row++)
+    {
+        std::cout << row;
+        for (int bit = 0; bit < numInputs; bit++)
+        {
+            std::cout << "\t" << ((row >> bit) & 1);
+        }
+        std::cout << "\t|";
+        for (uint32_t output = 0; output < numOutputs; output++)
+        {
+            // a mismatching output shows actual/expected
+            std::cout << "\t" << getActualOutput(row, output);
+            if (getActualOutput(row, output) != getExpectedOutput(row, output))
+            {
+                std::cout << "/" << getExpectedOutput(row, output);
+            }
+        }
+        std::cout << "\t" << isMatch(row) << std::endl;
+    }
+    if (numRows > maxRows)
+    {
+        std::cout << "... " << (numRows - maxRows) << " more rows" << std::endl;
+    }
+    std::cout << separator << std::endl;
+    std::cout << "Total Rows: " << numRows << std::endl;
+    std::cout << "Accuracy: " << getAccuracy() << std::endl;
+}
+
+void CircuitTruthTable::printValidationReport(size_t maxListed) const
+{
+    std::cout << "Total number of test cases: " << numRows << std::endl;
+    std::cout << "Number of passing test cases: " << (numRows - rowMismatches) << std::endl;
+    std::cout << "Number of failing test cases: " << rowMismatches << std::endl;
+    std::cout << "Accuracy: " << getAccuracy() << "%" << std::endl;
+    std::cout << "Per output:" << std::endl;
+    for (uint32_t output = 0; output < numOutputs; output++)
+    {
+        std::cout << "  " << circuit->getName(circuit->getOutputs()[output]) << ": " << getAccuracy(output) << "%, "
+                  << outputMismatches[output] << " mismatches";
+        if (outputMismatches[output] > 0)
+        {
+            std::cout << " (rows";
+            for (uint64_t row : getMismatches(output, maxListed))
+            {
+                std::cout << " " << row;
+            }
+            std::cout << (outputMismatches[output] > maxListed ? " ...)" : ")");
+        }
+        std::cout << std::endl;
+    }
+    std::cout << (isPassing() ? "Test passed!" : "Test failed!") << std::endl;
+}
+
+// helper methods
+
+void CircuitTruthTable::validateRow(uint64_t row) const
+{
+    if (row >= numRows)
+    {
+        throw std::out_of_range("Index out of range");
+    }
+}
+
+void CircuitTruthTable::validateOutput(uint32_t output) const
+{
+    if (output >= numOutputs)
+    {
+        throw std::out_of_range("Output index out of range");
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "core/Circuit.h"
+
+// Truth table of a whole circuit: N primary inputs, M primary outputs. Inputs are implicit
+// in the row number (input i of the circuit is bit i of the row) and every output is stored
+// as its own bit-plane, one bit per row, for expected and actual values alike. evaluate()
+// runs the levelized engine once per 64 rows and reads all M outputs from that pass.
+class CircuitTruthTable
+{
+public:
+    static constexpr int MaxInputs = 30;
+
+    // reference for 64 rows: one word per primary input in, one word per primary output out
+    using ExpectedFunction = std::function<void(const uint64_t *inputWords, uint64_t *outputWords)>;
+
+    // the circuit must be frozen and outlive the table; expected outputs start out all zero
+    explicit CircuitTruthTable(const Circuit &circuit);
+
+    // expected outputs
+    void setExpectedFunction(const ExpectedFunction &reference);
+    void setExpectedWords(uint32_t output, const std::vector<uint64_t> &words);
+    void setExpectedOutput(uint64_t row, uint32_t output, bool value);
+
+    // simulates every row, then compares
+    void evaluate();
+    void compareResults();
+
+    // row access
+    bool getInput(uint64_t row, uint32_t input) const;
+    bool getExpectedOutput(uint64_t row, uint32_t output) const;
+    bool getActualOutput(uint64_t row, uint32_t output) const;
+    // true when every output of the row matches
+    bool isMatch(uint64_t row) const;
+
+    // per-output analysis
+    uint64_t getMismatchCount(uint32_t output) const;
+    double getAccuracy(uint32_t output) const;
+    std::vector<uint64_t> getMismatches(uint32_t output, size_t limit = SIZE_MAX) const;
+
+    // whole-row analysis
+    uint64_t getMismatchCount() const { return rowMismatches; }
+    double getAccuracy() const;
+    std::vector<uint64_t> getMismatches(size_t limit = SIZE_MAX) const;
+    bool isPassing() const { return rowMismatches == 0; }
+
+    // display, large tables are cut off after maxRows rows
+    void printToConsole(uint64_t maxRows = 64) const;
+    void printValidationReport(size_t maxListed = 16) const;
+
+    // getters
+    int getNumInputs() const { return numInputs; }
+    uint32_t getNumOutputs() const { return numOutputs; }
+    uint64_t getNumRows() const { return numRows; }
+    size_t getWordCount() const { return wordCount; }
+    const uint64_t *getExpectedPlane(uint32_t output) const { return expected.data() + output * wordCount; }
+    const uint64_t *getActualPlane(uint32_t output) const { return actual.data() + output * wordCount; }
+    size_t getMemoryUsage() const;
+
+private:
+    const Circuit *circuit;
+    int numInputs;
+    uint32_t numOutputs;
+    uint64_t numRows;
+    size_t wordCount;
+    // plane o occupies words [o * wordCount, (o + 1) * wordCount)
+    std::vector<uint64_t> expected;
+    std::vector<uint64_t> actual;
+    std::vector<uint64_t> outputMismatches;
+    uint64_t rowMismatches;
+
+    uint64_t tailMask() const;
+    // mismatch bits of output `output` in word `word`
+    uint64_t diffWord(uint32_t output, size_t word) const;
+    void validateRow(uint64_t row) const;
+    void validateOutput(uint32_t output) const;
+};
@@ -0,0 +1,360 @@
+#include "CompiledCache.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr char Magic[8] = {'D', 'L', 'S', 'C', 'O', 'M', 'P', '1'};
+    // bumped whenever the compiled form or the hash changes, so stale entries miss
+    constexpr uint32_t FormatVersion = 1;
+    const char *const Extension = ".dlsc";
+
+    // a name no other writer, in this process or another, uses for its temporary file
+    std::string temporaryName(const std::string &path)
+    {
+        static std::atomic<uint64_t> counter{0};
+        return path + "." + std::to_string(getpid()) + "." + std::to_string(counter++) + ".tmp";
+    }
+
+    struct EntryHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t nodeCount;
+        uint64_t keyHigh;
+        uint64_t keyLow;
+        uint64_t gateCount;
+        uint64_t levelOffsetCount;
+        uint64_t programSize;
+        uint64_t segmentCount;
+    };
+
+    // fixed-size on-disk segment, independent of the padding of LevelizedSimulator::Segment
+    struct StoredSegment
+    {
+        uint32_t type;
+        uint32_t gates;
+        uint64_t programOffset;
+    };
+
+    // two independent multiply-xorshift lanes over 64-bit words, one per half of the key
+    class KeyHasher
+    {
+    public:
+        void add(const void *data, size_t bytes)
+        {
+            const char *bytePointer = static_cast<const char *>(data);
+            size_t words = bytes / 8;
+            for (size_t i = 0; i < words; i++)
+            {
+                uint64_t word;
+                std::memcpy(&word, bytePointer + i * 8, 8);
+                mix(word);
+            }
+            uint64_t tail = 0;
+            std::memcpy(&tail, bytePointer + words * 8, bytes % 8);
+            mix(tail ^ (static_cast<uint64_t>(bytes) << 56));
+        }
+
+        CompiledCache::Key finish() const
+        {
+            return CompiledCache::Key{finalize(high), finalize(low)};
+        }
+
+    private:
+        uint64_t high = 0x243F6A8885A308D3ULL;
+        uint64_t low = 0x13198A2E03707344ULL;
+
+        void mix(uint64_t word)
+        {
+            high = (high ^ word) * 0x9E3779B97F4A7C15ULL;
+            high ^= high >> 29;
+            low = (low + word) * 0xC2B2AE3D27D4EB4FULL;
+            low = (low << 31) | (low >> 33);
+        }
+
+        static uint64_t finalize(uint64_t value)
+        {
+            // murmur3 finalizer
+            value ^= value >> 33;
+            value *= 0xFF51AFD7ED558CCDULL;
+            value ^= value >> 33;
+            value *= 0xC4CEB9FE1A85EC53ULL;
+            value ^= value >> 33;
+            return value;
+        }
+    };
+
+    template <typename T>
+    void writeArray(std::ofstream &file, const std::vector<T> &values)
+    {
+        file.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+    }
+
+    template <typename T>
+    bool readArray(std::ifstream &file, std::vector<T> &values, uint64_t count)
+    {
+        values.resize(count);
+        file.read(reinterpret_cast<char *>(values.data()), count * sizeof(T));
+        return static_cast<bool>(file);
+    }
+}
+
+std::string CompiledCache::Key::toString() const
+{
+    std::ostringstream text;
+    text << std::hex << std::setfill('0') << std::setw(16) << high << std::setw(16) << low;
+    return text.str();
+}
+
+CompiledCache::CompiledCache(const std::string &directory, uint64_t maxBytes) : directory(directory), maxBytes(maxBytes)
+{
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (error || !fs::is_directory(directory))
+    {
+        throw std::runtime_error("Cannot use cache directory " + directory + (error ? ": " + error.message() : ""));
+    }
+}
+
+CompiledCache::Key CompiledCache::computeKey(const Circuit &circuit, const std::string &options)
+{
+    if (!circuit.isFrozen())
+    {
+        throw std::logic_error("CompiledCache: circuit must be frozen first");
+    }
+    // names, delays and outputs do not change the compiled form, so they stay out of the key
+    KeyHasher hasher;
+    uint32_t counts[3] = {FormatVersion, circuit.getNodeCount(), circuit.getInputCount()};
+    hasher.add(counts, sizeof(counts));
+    hasher.add(options.data(), options.size());
+    hasher.add(circuit.getTypeCodes(), circuit.getNodeCount());
+    hasher.add(circuit.getFaninOffsets(), (circuit.getNodeCount() + size_t(1)) * sizeof(uint32_t));
+    hasher.add(circuit.getFaninIds(), circuit.getFaninOffsets()[circuit.getNodeCount()] * sizeof(Circuit::NodeId));
+    hasher.add(circuit.getInputs().begin(), circuit.getInputCount() * sizeof(Circuit::NodeId));
+    return hasher.finish();
+}
+
+std::unique_ptr<LevelizedSimulator> CompiledCache::getSimulator(const Circuit &circuit, const std::string &options)
+{
+    Key key = computeKey(circuit, options);
+    std::string path = pathOf(key);
+    LevelizedSimulator::Compiled compiled;
+    if (read(path, key, circuit, compiled))
+    {
+        try
+        {
+            auto simulator = std::make_unique<LevelizedSimulator>(circuit, std::move(compiled));
+            stats.hits++;
+            // a hit makes the entry the most recently used
+            std::error_code error;
+            fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+            return simulator;
+        }
+        catch (const std::invalid_argument &)
+        {
+            // the arrays do not check out against the circuit, treat it like a damaged entry
+        }
+    }
+    if (fs::exists(path))
+    {
+        stats.rejected++;
+        std::error_code error;
+        fs::remove(path, error);
+    }
+
+    stats.misses++;
+    auto simulator = std::make_unique<LevelizedSimulator>(circuit);
+    write(path, key, simulator->getCompiled());
+    evict();
+    return simulator;
+}
+
+void CompiledCache::setMaxBytes(uint64_t bytes)
+{
+    maxBytes = bytes;
+    evict();
+}
+
+uint64_t CompiledCache::getSizeBytes() const
+{
+    uint64_t total = 0;
+    std::error_code error;
+    for (const auto &entry : fs::directory_iterator(directory, error))
+    {
+        if (entry.path().extension() == Extension)
+        {
+            total += entry.file_size(error);
+        }
+    }
+    return total;
+}
+
+size_t CompiledCache::getEntryCount() const
+{
+    size_t count = 0;
+    std::error_code error;
+    for (const auto &entry : fs::directory_iterator(directory, error))
+    {
+        count += entry.path().extension() == Extension;
+    }
+    return count;
+}
+
+void CompiledCache::clear()
+{
+    std::error_code error;
+    for (const auto &entry : fs::directory_iterator(directory, error))
+    {
+        if (entry.path().extension() == Extension)
+        {
+            fs::remove(entry.path(), error);
+        }
+    }
+}
+
+std::string CompiledCache::pathOf(const Key &key) const
+{
+    return (fs::path(directory) / (key.toString() + Extension)).string();
+}
+
+bool CompiledCache::read(const std::string &path, const Key &key, const Circuit &circuit, LevelizedSimulator::Compiled &compiled) const
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    EntryHeader header;
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) || std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 ||
+        header.version != FormatVersion || header.keyHigh != key.high || header.keyLow != key.low ||
+        header.nodeCount != circuit.getNodeCount() || header.gateCount != circuit.getGateCount())
+    {
+        return false;
+    }
+    // bound every count before allocating for it: there are at most one level per gate and
+    // one segment per gate, the program size follows from the netlist, and the arrays must
+    // fill the file exactly
+    std::error_code error;
+    uint64_t fileBytes = fs::file_size(path, error);
+    uint64_t expectedProgram = header.gateCount * 2 + circuit.getFaninOffsets()[circuit.getNodeCount()];
+    if (error || header.levelOffsetCount > header.gateCount + 1 || header.segmentCount > header.gateCount ||
+        header.programSize != expectedProgram ||
+        fileBytes != sizeof(header) + header.nodeCount * sizeof(uint32_t) + header.gateCount * sizeof(Circuit::NodeId) +
+                         header.levelOffsetCount * sizeof(uint32_t) + header.programSize * sizeof(uint32_t) +
+                         header.segmentCount * sizeof(StoredSegment))
+    {
+        return false;
+    }
+    std::vector<StoredSegment> stored;
+    if (!readArray(file, compiled.levels, header.nodeCount) || !readArray(file, compiled.order, header.gateCount) ||
+        !readArray(file, compiled.levelOffsets, header.levelOffsetCount) || !readArray(file, compiled.program, header.programSize) ||
+        !readArray(file, stored, header.segmentCount))
+    {
+        return false;
+    }
+    compiled.segments.resize(stored.size());
+    for (size_t i = 0; i < stored.size(); i++)
+    {
+        compiled.segments[i] = {static_cast<GateType>(stored[i].type), stored[i].gates, stored[i].programOffset};
+    }
+    return true;
+}
+
+void CompiledCache::write(const std::string &path, const Key &key, const LevelizedSimulator::Compiled &compiled)
+{
+    EntryHeader header{};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = FormatVersion;
+    header.nodeCount = static_cast<uint32_t>(compiled.levels.size());
+    header.keyHigh = key.high;
+    header.keyLow = key.low;
+    header.gateCount = compiled.order.size();
+    header.levelOffsetCount = compiled.levelOffsets.size();
+    header.programSize = compiled.program.size();
+    header.segmentCount = compiled.segments.size();
+    std::vector<StoredSegment> stored(compiled.segments.size());
+    for (size_t i = 0; i < stored.size(); i++)
+    {
+        const LevelizedSimulator::Segment &segment = compiled.segments[i];
+        stored[i] = {static_cast<uint32_t>(segment.type), segment.gates, segment.programOffset};
+    }
+
+    // written aside and renamed into place, so readers only ever see whole entries
+    std::string temporary = temporaryName(path);
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        writeArray(file, compiled.levels);
+        writeArray(file, compiled.order);
+        writeArray(file, compiled.levelOffsets);
+        writeArray(file, compiled.program);
+        writeArray(file, stored);
+        if (!file)
+        {
+            // a cache that cannot be written only costs speed
+            std::error_code error;
+            fs::remove(temporary, error);
+            return;
+        }
+    }
+    std::error_code error;
+    fs::rename(temporary, path, error);
+    if (error)
+    {
+        fs::remove(temporary, error);
+        return;
+    }
+    stats.stores++;
+}
+
+void CompiledCache::evict()
+{
+    struct Entry
+    {
+        fs::path path;
+        fs::file_time_type used;
+        uint64_t bytes;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code error;
+    for (const auto &entry : fs::directory_iterator(directory, error))
+    {
+        if (entry.path().extension() != Extension)
+        {
+            continue;
+        }
+        Entry item{entry.path(), entry.last_write_time(error), entry.file_size(error)};
+        total += item.bytes;
+        entries.push_back(item);
+    }
+    if (total <= maxBytes)
+    {
+        return;
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b)
+              { return a.used < b.used; });
+    for (const Entry &entry : entries)
+    {
+        if (total <= maxBytes)
+        {
+            break;
+        }
+        if (fs::remove(entry.path, error))
+        {
+            total -= entry.bytes;
+            stats.evictions++;
+        }
+    }
+}
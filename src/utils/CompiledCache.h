@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "core/Circuit.h"
+#include "core/LevelizedSimulator.h"
+
+// On-disk cache of compiled netlists. The key is a 128-bit hash of everything compilation
+// reads (gate types, fan-in lists, primary inputs) together with an options string, and
+// the value is the simulator's compiled form: levels, evaluation order and the packed
+// opcode stream. A hit rebuilds the simulator from the stored arrays and skips
+// levelization and compilation entirely.
+//
+// One file per entry, named after its key and written to a temporary name unique to the
+// writer first, so a crashed or concurrent writer never leaves a half-written entry behind.
+// Recency is the file's modification time, bumped on every hit; once the directory grows
+// past its size bound the least recently used entries are removed first.
+class CompiledCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stores = 0;
+        uint64_t evictions = 0;
+        // entries that could not be read back and were dropped
+        uint64_t rejected = 0;
+        double hitRate() const { return hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0; }
+    };
+
+    struct Key
+    {
+        uint64_t high;
+        uint64_t low;
+        std::string toString() const;
+    };
+
+    // creates the directory if needed, throws std::runtime_error if that fails
+    explicit CompiledCache(const std::string &directory, uint64_t maxBytes = 256ULL << 20);
+
+    // a simulator for the frozen circuit, from the cache when an entry for the same
+    // netlist and options exists, otherwise compiled now and stored
+    std::unique_ptr<LevelizedSimulator> getSimulator(const Circuit &circuit, const std::string &options = "levelized");
+    static Key computeKey(const Circuit &circuit, const std::string &options);
+
+    const Stats &getStats() const { return stats; }
+    const std::string &getDirectory() const { return directory; }
+    uint64_t getMaxBytes() const { return maxBytes; }
+    void setMaxBytes(uint64_t bytes);
+    // bytes and entries currently on disk
+    uint64_t getSizeBytes() const;
+    size_t getEntryCount() const;
+    void clear();
+
+private:
+    std::string directory;
+    uint64_t maxBytes;
+    Stats stats;
+
+    std::string pathOf(const Key &key) const;
+    bool read(const std::string &path, const Key &key, const Circuit &circuit, LevelizedSimulator::Compiled &compiled) const;
+    void write(const std::string &path, const Key &key, const LevelizedSimulator::Compiled &compiled);
+    // removes least recently used entries until the directory fits the bound
+    void evict();
+};
@@ -0,0 +1,295 @@
+#include "PackedTruthTable.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include "core/GateFactory.h"
+#include "core/GateKernels.h"
+
+namespace
+{
+    // row bit i repeats with period 2^(i+1) inside one word
+    constexpr uint64_t LowInputPatterns[6] = {
+        0xAAAAAAAAAAAAAAAAULL,
+        0xCCCCCCCCCCCCCCCCULL,
+        0xF0F0F0F0F0F0F0F0ULL,
+        0xFF00FF00FF00FF00ULL,
+        0xFFFF0000FFFF0000ULL,
+        0xFFFFFFFF00000000ULL};
+}
+
+PackedTruthTable::PackedTruthTable(Gate *gate)
+{
+    if (gate == nullptr)
+    {
+        throw std::invalid_argument("Gate pointer cannot be null");
+    }
+    if (gate->getInputCount() > MaxInputs)
+    {
+        throw std::invalid_argument("Packed truth table supports at most " + std::to_string(MaxInputs) + " inputs");
+    }
+    this->gate = gate;
+    numInputs = gate->getInputCount();
+    numRows = 1ULL << numInputs;
+    expected.assign((numRows + 63) / 64, 0);
+    actual.assign(expected.size(), 0);
+    mismatchCount = 0;
+}
+
+PackedTruthTable::PackedTruthTable(Gate *gate, const std::vector<bool> &expectedResults)
+    : PackedTruthTable(gate)
+{
+    setExpectedOutputs(expectedResults);
+}
+
+uint64_t PackedTruthTable::getInputWord(int bit, uint64_t wordIndex)
+{
+    if (bit < 6)
+    {
+        return LowInputPatterns[bit];
+    }
+    // from bit 6 up the input is constant across a word
+    return ((wordIndex >> (bit - 6)) & 1) ? ~0ULL : 0;
+}
+
+uint64_t PackedTruthTable::tailMask() const
+{
+    return numRows >= 64 ? ~0ULL : (1ULL << numRows) - 1;
+}
+
+// expected outputs
+
+void PackedTruthTable::setExpectedOutputs(const std::vector<bool> &expectedOutputs)
+{
+    if (expectedOutputs.size() != numRows)
+    {
+        throw std::invalid_argument("Expected outputs size does not match number of rows");
+    }
+    std::fill(expected.begin(), expected.end(), 0);
+    for (uint64_t row = 0; row < numRows; row++)
+    {
+        if (expectedOutputs[row])
+        {
+            expected[row / 64] |= 1ULL << (row % 64);
+        }
+    }
+    compareResults();
+}
+
+void PackedTruthTable::setExpectedWords(const std::vector<uint64_t> &expectedWords)
+{
+    if (expectedWords.size() != expected.size())
+    {
+        throw std::invalid_argument("Expected words size does not match number of rows");
+    }
+    expected = expectedWords;
+    expected.back() &= tailMask();
+    compareResults();
+}
+
+void PackedTruthTable::setExpectedOutput(uint64_t row, bool value)
+{
+    validateRow(row);
+    uint64_t bit = 1ULL << (row % 64);
+    bool wasMatch = isMatch(row);
+    expected[row / 64] = value ? expected[row / 64] | bit : expected[row / 64] & ~bit;
+    if (wasMatch != isMatch(row))
+    {
+        mismatchCount += wasMatch ? 1 : -1;
+    }
+}
+
+// evaluation
+
+void PackedTruthTable::evaluateGate()
+{
+    // validate once, the loop runs the non-virtual word kernel
+    GateType type = gate->getType();
+    if (gate->getInputCount() != numInputs)
+    {
+        throw std::invalid_argument("Number of inputs does not match gate's expected input count");
+    }
+    if (!GateFactory::isValidInputCount(type, numInputs))
+    {
+        throw std::invalid_argument("Gate type does not accept " + std::to_string(numInputs) + " inputs");
+    }
+    std::vector<uint64_t> inputWords(numInputs);
+    for (uint64_t word = 0; word < actual.size(); word++)
+    {
+        for (int bit = 0; bit < numInputs; bit++)
+        {
+            inputWords[bit] = getInputWord(bit, word);
+        }
+        actual[word] = evaluateGateWord(type, inputWords.data(), numInputs);
+    }
+    actual.back() &= tailMask();
+    compareResults();
+}
+
+void PackedTruthTable::compareResults()
+{
+    mismatchCount = 0;
+    for (size_t word = 0; word < expected.size(); word++)
+    {
+        mismatchCount += popcount(expected[word] ^ actual[word]);
+    }
+}
+
+// row access
+
+bool PackedTruthTable::getInput(uint64_t row, int bit) const
+{
+    validateRow(row);
+    if (bit < 0 || bit >= numInputs)
+    {
+        throw std::out_of_range("Input index out of range");
+    }
+    return (row >> bit) & 1;
+}
+
+bool PackedTruthTable::getExpectedOutput(uint64_t row) const
+{
+    validateRow(row);
+    return (expected[row / 64] >> (row % 64)) & 1;
+}
+
+bool PackedTruthTable::getActualOutput(uint64_t row) const
+{
+    validateRow(row);
+    return (actual[row / 64] >> (row % 64)) & 1;
+}
+
+bool PackedTruthTable::isMatch(uint64_t row) const
+{
+    return getExpectedOutput(row) == getActualOutput(row);
+}
+
+// analysis
+
+double PackedTruthTable::getAccuracy() const
+{
+    return static_cast<double>(numRows - mismatchCount) / numRows * 100;
+}
+
+uint64_t PackedTruthTable::getMismatchCount() const
+{
+    return mismatchCount;
+}
+
+std::vector<uint64_t> PackedTruthTable::getMismatches(size_t limit) const
+{
+    std::vector<uint64_t> result;
+    for (size_t word = 0; word < expected.size() && result.size() < limit; word++)
+    {
+        uint64_t diff = expected[word] ^ actual[word];
+        // walk the set bits lowest first
+        while (diff != 0 && result.size() < limit)
+        {
+            uint64_t lowest = diff & (~diff + 1);
+            result.push_back(word * 64 + popcount(lowest - 1));
+            diff ^= lowest;
+        }
+    }
+    return result;
+}
+
+bool PackedTruthTable::isPassing() const
+{
+    return mismatchCount == 0;
+}
+
+size_t PackedTruthTable::getMemoryUsage() const
+{
+    return (expected.capacity() + actual.capacity()) * sizeof(uint64_t);
+}
+
+// display
+
+void PackedTruthTable::printSeparator() const
+{
+    std::cout << std::string(numInputs * 5 + 5, '-') << std::endl;
+}
+
+void PackedTruthTable::printHeader() const
+{
+    std::cout << "Inputs";
+    for (int i = 0; i < numInputs; i++)
+    {
+        std::cout << "\t" << "I" << i;
+    }
+    std::cout << "\tExpected\tActual\tMatch" << std::endl;
+}
+
+void PackedTruthTable::printRow(uint64_t row) const
+{
+    std::cout << "Row";
+    for (int bit = 0; bit < numInputs; bit++)
+    {
+        std::cout << "\t" << ((row >> bit) & 1);
+    }
+    std::cout << "\t" << getExpectedOutput(row) << "\t" << getActualOutput(row) << "\t" << isMatch(row) << std::endl;
+}
+
+void PackedTruthTable::printToConsole(uint64_t maxRows) const
+{
+    printSeparator();
+    printHeader();
+    printSeparator();
+    for (uint64_t row = 0; row < numRows && row < maxRows; row++)
+    {
+        printRow(row);
+    }
+    if (numRows > maxRows)
+    {
+        std::cout << "... " << (numRows - maxRows) << " more rows" << std::endl;
+    }
+    printSeparator();
+    std::cout << "Total Rows: " << numRows << std::endl;
+    std::cout << "Accuracy: " << getAccuracy() << std::endl;
+}
+
+void PackedTruthTable::printValidationReport(size_t maxListed) const
+{
+    std::cout << "Total number of test cases: " << numRows << std::endl;
+    std::cout << "Number of passing test cases: " << (numRows - mismatchCount) << std::endl;
+    std::cout << "Number of failing test cases: " << mismatchCount << std::endl;
+    std::cout << "Accuracy: " << getAccuracy() << "%" << std::endl;
+    std::cout << "Mismatches: ";
+    for (uint64_t row : getMismatches(maxListed))
+    {
+        std::cout << row << " ";
+    }
+    if (mismatchCount > maxListed)
+    {
+        std::cout << "...";
+    }
+    std::cout << std::endl;
+    std::cout << (isPassing() ? "Test passed!" : "Test failed!") << std::endl;
+}
+
+void PackedTruthTable::highlightErrors(uint64_t maxRows) const
+{
+    for (uint64_t row : getMismatches(maxRows))
+    {
+        printRow(row);
+    }
+}
+
+// utilities
+
+void PackedTruthTable::reset()
+{
+    gate = nullptr;
+    numInputs = 0;
+    numRows = 0;
+    expected.clear();
+    actual.clear();
+    mismatchCount = 0;
+}
+
+void PackedTruthTable::validateRow(uint64_t row) const
+{
+    if (row >= numRows)
+    {
+        throw std::out_of_range("Index out of range");
+    }
+}
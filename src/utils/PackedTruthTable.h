@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "core/Gate.h"
+
+// Compact truth table for gates with many inputs. The inputs of a row are implicit
+// (bit i of row r is (r >> i) & 1) and expected/actual outputs are bitmaps with one
+// bit per row, so a 24-input table takes 4 MiB instead of 16M heap-allocated rows.
+// Comparison is an XOR plus popcount per 64 rows.
+class PackedTruthTable
+{
+public:
+    // two 2^30-bit bitmaps are 256 MiB, beyond that use a streaming check instead
+    static constexpr int MaxInputs = 30;
+
+    // expected outputs start out all zero
+    explicit PackedTruthTable(Gate *gate);
+    PackedTruthTable(Gate *gate, const std::vector<bool> &expectedResults);
+
+    // the 64 values of input `bit` for rows 64 * wordIndex .. 64 * wordIndex + 63
+    static uint64_t getInputWord(int bit, uint64_t wordIndex);
+
+    // expected outputs, one bool per row or one bit per row packed into words
+    void setExpectedOutputs(const std::vector<bool> &expectedOutputs);
+    void setExpectedWords(const std::vector<uint64_t> &expectedWords);
+    void setExpectedOutput(uint64_t row, bool value);
+
+    // evaluates the gate 64 rows per kernel call, then compares
+    void evaluateGate();
+    void compareResults();
+
+    // row access
+    bool getInput(uint64_t row, int bit) const;
+    bool getExpectedOutput(uint64_t row) const;
+    bool getActualOutput(uint64_t row) const;
+    bool isMatch(uint64_t row) const;
+
+    // analysis
+    double getAccuracy() const;
+    uint64_t getMismatchCount() const;
+    // failing row numbers in ascending order, at most `limit` of them
+    std::vector<uint64_t> getMismatches(size_t limit = SIZE_MAX) const;
+    bool isPassing() const;
+
+    // display, large tables are cut off after maxRows rows
+    void printToConsole(uint64_t maxRows = 64) const;
+    void printValidationReport(size_t maxListed = 32) const;
+    void highlightErrors(uint64_t maxRows = 64) const;
+
+    // getters
+    int getNumInputs() const { return numInputs; }
+    uint64_t getNumRows() const { return numRows; }
+    size_t getWordCount() const { return expected.size(); }
+    const std::vector<uint64_t> &getExpectedWords() const { return expected; }
+    const std::vector<uint64_t> &getActualWords() const { return actual; }
+    size_t getMemoryUsage() const;
+
+    void reset();
+
+private:
+    Gate *gate;
+    int numInputs;
+    uint64_t numRows;
+    std::vector<uint64_t> expected;
+    std::vector<uint64_t> actual;
+    uint64_t mismatchCount;
+
+    // valid bits of the last word, tables under 64 rows only fill part of it
+    uint64_t tailMask() const;
+    void validateRow(uint64_t row) const;
+    void printSeparator() const;
+    void printHeader() const;
+    void printRow(uint64_t row) const;
+};
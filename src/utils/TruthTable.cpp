@@ -1,4 +1,7 @@
 #include "TruthTable.h"
+#include <algorithm>
+#include "core/GateFactory.h"
+#include "core/GateKernels.h"
 // constructor
 
 TruthTable::TruthTable(Gate *gate, const std::vector<bool> &expectedresults)
@@ -21,7 +24,12 @@ TruthTable::TruthTable(Gate *gate, const std::vector<bool> &expectedresults)
     };
     this->gate = gate;
     this->numInputs = gate->getInputCount();
-    int expectedSize = 1 << numInputs;
+    // one heap-allocated row per combination, wider gates go through TruthTableStream
+    if (numInputs > 30)
+    {
+        throw std::invalid_argument("Too many inputs for an explicit truth table, use TruthTableStream");
+    }
+    uint64_t expectedSize = 1ULL << numInputs;
     if (expectedresults.size() != expectedSize)
     {
         throw std::invalid_argument("Expected results size does not match number of rows");
@@ -34,11 +42,11 @@ TruthTable::TruthTable(Gate *gate, const std::vector<bool> &expectedresults)
 
 void TruthTable::generateInputCombinations(int numInputs)
 {
-    int totalCombinations = 1 << numInputs; // bit shift
+    uint64_t totalCombinations = 1ULL << numInputs; // bit shift
     // clear existing rows
     rows.clear();
     // loop from 0 to totalCombinations
-    for (int i = 0; i < totalCombinations; i++)
+    for (uint64_t i = 0; i < totalCombinations; i++)
     {
         // vector of size inputs
         std::vector<bool> row(numInputs);
@@ -55,12 +63,38 @@ void TruthTable::generateInputCombinations(int numInputs)
 
 void TruthTable::evaluateGate()
 {
-    // loop through each row in rows vector
-    for (auto &row : rows)
+    // validate once here, the loop below runs the gate's word kernel without the vtable or per-call checks
+    GateType type = gate->getType();
+    if (gate->getInputCount() != numInputs)
+    {
+        throw std::invalid_argument("Number of inputs does not match gate's expected input count");
+    }
+    if (!GateFactory::isValidInputCount(type, numInputs) || numInputs > 64)
     {
-        setGateInputs(gate, row.inputs);
-        gate->evaluate();
-        row.actualOutput = gate->getOutput();
+        throw std::invalid_argument("Gate type does not accept " + std::to_string(numInputs) + " inputs");
+    }
+    std::vector<uint64_t> inputWords(numInputs);
+    // process the rows 64 at a time, one bit lane per row
+    for (size_t base = 0; base < rows.size(); base += 64)
+    {
+        size_t lanes = std::min<size_t>(64, rows.size() - base);
+        std::fill(inputWords.begin(), inputWords.end(), 0);
+        for (size_t lane = 0; lane < lanes; lane++)
+        {
+            const std::vector<bool> &inputs = rows[base + lane].inputs;
+            for (int bit = 0; bit < numInputs; bit++)
+            {
+                if (inputs[bit])
+                {
+                    inputWords[bit] |= 1ULL << lane;
+                }
+            }
+        }
+        uint64_t outputWord = evaluateGateWord(type, inputWords.data(), numInputs);
+        for (size_t lane = 0; lane < lanes; lane++)
+        {
+            rows[base + lane].actualOutput = (outputWord >> lane) & 1;
+        }
     }
     compareResults();
 };
@@ -0,0 +1,248 @@
+#include "TruthTableStream.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include "core/GateFactory.h"
+#include "core/GateKernels.h"
+#include "core/ThreadPool.h"
+#include "PackedTruthTable.h"
+
+double TruthTableStream::Result::getAccuracy() const
+{
+    return rowsChecked == 0 ? 0 : static_cast<double>(rowsChecked - mismatches) / rowsChecked * 100;
+}
+
+TruthTableStream::TruthTableStream(Gate *gate, ExpectedFunction expected, uint64_t chunkRows)
+{
+    if (gate == nullptr)
+    {
+        throw std::invalid_argument("Gate pointer cannot be null");
+    }
+    if (!expected)
+    {
+        throw std::invalid_argument("Truth table stream needs a reference function");
+    }
+    numInputs = gate->getInputCount();
+    if (numInputs > MaxInputs)
+    {
+        throw std::invalid_argument("Truth table stream supports at most " + std::to_string(MaxInputs) + " inputs");
+    }
+    if (!GateFactory::isValidInputCount(gate->getType(), numInputs))
+    {
+        throw std::invalid_argument("Gate type does not accept " + std::to_string(numInputs) + " inputs");
+    }
+    this->gate = gate;
+    this->expected = std::move(expected);
+    numRows = 1ULL << numInputs;
+    // whole words only, so chunks never split a 64-row word
+    chunkWords = std::max<uint64_t>(1, chunkRows / 64);
+}
+
+void TruthTableStream::setProgressCallback(ProgressCallback callback, double intervalSeconds)
+{
+    progress = std::move(callback);
+    progressInterval = intervalSeconds;
+}
+
+TruthTableStream::Result TruthTableStream::run()
+{
+    return run(0, numRows);
+}
+
+void TruthTableStream::validateRange(uint64_t firstRow, uint64_t endRow) const
+{
+    if (firstRow % 64 != 0 || firstRow > endRow || endRow > numRows)
+    {
+        throw std::out_of_range("Truth table stream: invalid row range");
+    }
+}
+
+TruthTableStream::ChunkBuffers TruthTableStream::makeBuffers() const
+{
+    // the only per-table allocations: one chunk of each bitmap and the input words
+    ChunkBuffers buffers;
+    buffers.actualWords.resize(chunkWords);
+    buffers.expectedWords.resize(chunkWords);
+    buffers.inputWords.resize(numInputs);
+    return buffers;
+}
+
+void TruthTableStream::checkChunk(uint64_t firstRow, uint64_t endRow, ChunkBuffers &buffers, Result &result) const
+{
+    GateType type = gate->getType();
+    uint64_t firstWord = firstRow / 64;
+    uint64_t words = (endRow - firstRow + 63) / 64;
+    for (uint64_t i = 0; i < words; i++)
+    {
+        for (int bit = 0; bit < numInputs; bit++)
+        {
+            buffers.inputWords[bit] = PackedTruthTable::getInputWord(bit, firstWord + i);
+        }
+        buffers.actualWords[i] = evaluateGateWord(type, buffers.inputWords.data(), numInputs);
+        buffers.expectedWords[i] = expected(buffers.inputWords.data(), numInputs);
+    }
+
+    // compare the chunk, the last word of the range may be partial
+    for (uint64_t i = 0; i < words; i++)
+    {
+        uint64_t diff = buffers.actualWords[i] ^ buffers.expectedWords[i];
+        uint64_t wordRow = (firstWord + i) * 64;
+        if (endRow - wordRow < 64)
+        {
+            diff &= (1ULL << (endRow - wordRow)) - 1;
+        }
+        if (diff == 0)
+        {
+            continue;
+        }
+        result.mismatches += popcount(diff);
+        while (diff != 0 && result.mismatchRows.size() < MaxRecordedMismatches)
+        {
+            uint64_t lowest = diff & (~diff + 1);
+            result.mismatchRows.push_back(wordRow + popcount(lowest - 1));
+            diff ^= lowest;
+        }
+    }
+    result.rowsChecked += endRow - firstRow;
+}
+
+TruthTableStream::Result TruthTableStream::run(uint64_t firstRow, uint64_t endRow)
+{
+    validateRange(firstRow, endRow);
+    auto start = std::chrono::steady_clock::now();
+    auto lastReport = start;
+
+    Result result;
+    result.totalRows = endRow - firstRow;
+    ChunkBuffers buffers = makeBuffers();
+    for (uint64_t chunkFirst = firstRow; chunkFirst < endRow; chunkFirst += chunkWords * 64)
+    {
+        checkChunk(chunkFirst, std::min(endRow, chunkFirst + chunkWords * 64), buffers, result);
+        if (stopOnMismatch && result.mismatches > 0)
+        {
+            result.stoppedEarly = result.rowsChecked < result.totalRows;
+            break;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (progress && std::chrono::duration<double>(now - lastReport).count() >= progressInterval)
+        {
+            lastReport = now;
+            result.seconds = std::chrono::duration<double>(now - start).count();
+            progress(result);
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+TruthTableStream::Result TruthTableStream::run(ThreadPool &pool)
+{
+    return run(pool, 0, numRows);
+}
+
+TruthTableStream::Result TruthTableStream::run(ThreadPool &pool, uint64_t firstRow, uint64_t endRow)
+{
+    validateRange(firstRow, endRow);
+    auto start = std::chrono::steady_clock::now();
+    auto lastReport = start;
+
+    Result merged;
+    merged.totalRows = endRow - firstRow;
+    const uint64_t chunkRows = chunkWords * 64;
+    const uint64_t chunks = (merged.totalRows + chunkRows - 1) / chunkRows;
+    // lowest failing chunk so far, chunks above it are skipped when stopping early
+    std::atomic<uint64_t> firstFailure{UINT64_MAX};
+    // its own result, which is all a serial walk would report besides the passing rows below it
+    Result firstFailing;
+    uint64_t firstFailingChunk = UINT64_MAX;
+    std::mutex mergeMutex;
+
+    // one chunk per task, the pool's stealing keeps the threads busy to the end
+    std::function<void(size_t, size_t)> body = [&](size_t begin, size_t end)
+    {
+        ChunkBuffers buffers = makeBuffers();
+        for (size_t chunk = begin; chunk < end; chunk++)
+        {
+            if (stopOnMismatch && chunk > firstFailure.load(std::memory_order_relaxed))
+            {
+                continue;
+            }
+            uint64_t chunkFirst = firstRow + chunk * chunkRows;
+            Result local;
+            checkChunk(chunkFirst, std::min(endRow, chunkFirst + chunkRows), buffers, local);
+            if (local.mismatches > 0)
+            {
+                uint64_t seen = firstFailure.load(std::memory_order_relaxed);
+                while (chunk < seen && !firstFailure.compare_exchange_weak(seen, chunk))
+                {
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mergeMutex);
+            if (local.mismatches > 0 && chunk < firstFailingChunk)
+            {
+                firstFailingChunk = chunk;
+                firstFailing = local;
+            }
+            merged.rowsChecked += local.rowsChecked;
+            merged.mismatches += local.mismatches;
+            // both lists are ascending, keep only the lowest rows so memory stays flat
+            size_t middle = merged.mismatchRows.size();
+            merged.mismatchRows.insert(merged.mismatchRows.end(), local.mismatchRows.begin(), local.mismatchRows.end());
+            std::inplace_merge(merged.mismatchRows.begin(), merged.mismatchRows.begin() + middle, merged.mismatchRows.end());
+            if (merged.mismatchRows.size() > MaxRecordedMismatches)
+            {
+                merged.mismatchRows.resize(MaxRecordedMismatches);
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (progress && std::chrono::duration<double>(now - lastReport).count() >= progressInterval)
+            {
+                lastReport = now;
+                merged.seconds = std::chrono::duration<double>(now - start).count();
+                progress(merged);
+            }
+        }
+    };
+    pool.parallelFor(chunks, 1, body);
+
+    if (stopOnMismatch && firstFailingChunk != UINT64_MAX)
+    {
+        // every chunk below the first failing one passed, the ones above it do not count,
+        // which is exactly where the serial walk stops
+        uint64_t failingEnd = std::min(endRow, firstRow + (firstFailingChunk + 1) * chunkRows);
+        merged.rowsChecked = failingEnd - firstRow;
+        merged.mismatches = firstFailing.mismatches;
+        merged.mismatchRows = firstFailing.mismatchRows;
+    }
+    merged.stoppedEarly = merged.rowsChecked < merged.totalRows;
+    merged.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return merged;
+}
+
+void TruthTableStream::printValidationReport(const Result &result)
+{
+    std::cout << "Total number of test cases: " << result.totalRows << std::endl;
+    std::cout << "Number of checked test cases: " << result.rowsChecked << std::endl;
+    std::cout << "Number of passing test cases: " << (result.rowsChecked - result.mismatches) << std::endl;
+    std::cout << "Number of failing test cases: " << result.mismatches << std::endl;
+    std::cout << "Accuracy: " << result.getAccuracy() << "%" << std::endl;
+    std::cout << "Mismatches: ";
+    for (uint64_t row : result.mismatchRows)
+    {
+        std::cout << row << " ";
+    }
+    if (result.mismatches > result.mismatchRows.size())
+    {
+        std::cout << "...";
+    }
+    std::cout << std::endl;
+    if (result.stoppedEarly)
+    {
+        std::cout << "Stopped at the first failing chunk" << std::endl;
+    }
+    std::cout << (result.isPassing() ? "Test passed!" : "Test failed!") << std::endl;
+}
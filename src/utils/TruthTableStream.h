@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "core/Gate.h"
+
+class ThreadPool;
+
+// Exhaustive check of a gate against a reference without materializing the table.
+// The input space is walked with 64-bit row counters in fixed-size chunks: each chunk's
+// actual and expected outputs are computed into a reused bitmap buffer, compared with
+// XOR plus popcount and then dropped, so memory stays flat whatever the input count.
+class TruthTableStream
+{
+public:
+    // 2^63 rows still fit the 64-bit counters
+    static constexpr int MaxInputs = 63;
+    static constexpr uint64_t DefaultChunkRows = 1ULL << 20;
+    // mismatching row numbers kept for the report, the count itself is exact
+    static constexpr size_t MaxRecordedMismatches = 32;
+
+    // reference outputs for 64 rows, given one word per input (bit i of every word is row base + i)
+    // parallel runs call it from several threads at once, so it must not share mutable state
+    using ExpectedFunction = std::function<uint64_t(const uint64_t *inputWords, int numInputs)>;
+
+    struct Result
+    {
+        uint64_t totalRows = 0;
+        uint64_t rowsChecked = 0;
+        uint64_t mismatches = 0;
+        // first few failing rows in ascending order
+        std::vector<uint64_t> mismatchRows;
+        bool stoppedEarly = false;
+        double seconds = 0;
+
+        bool isPassing() const { return mismatches == 0; }
+        bool isComplete() const { return rowsChecked == totalRows; }
+        // accuracy over the rows actually checked
+        double getAccuracy() const;
+        double rowsPerSecond() const { return seconds > 0 ? rowsChecked / seconds : 0; }
+    };
+
+    // called between chunks at most once per progress interval, never concurrently
+    using ProgressCallback = std::function<void(const Result &partial)>;
+
+    TruthTableStream(Gate *gate, ExpectedFunction expected, uint64_t chunkRows = DefaultChunkRows);
+
+    void setStopOnMismatch(bool stop) { stopOnMismatch = stop; }
+    void setProgressCallback(ProgressCallback callback, double intervalSeconds = 0.5);
+
+    uint64_t getNumRows() const { return numRows; }
+    int getNumInputs() const { return numInputs; }
+
+    // checks every row
+    Result run();
+    // checks rows [firstRow, endRow), firstRow must be a multiple of 64
+    Result run(uint64_t firstRow, uint64_t endRow);
+    // same check with the chunks spread over the pool's threads, each with its own buffers;
+    // the merged result is the one the serial run returns, when stopping on a mismatch too
+    Result run(ThreadPool &pool);
+    Result run(ThreadPool &pool, uint64_t firstRow, uint64_t endRow);
+
+    // print a result in the same layout as TruthTable::printValidationReport
+    static void printValidationReport(const Result &result);
+
+private:
+    // per-thread evaluation state, reused from chunk to chunk
+    struct ChunkBuffers
+    {
+        std::vector<uint64_t> actualWords;
+        std::vector<uint64_t> expectedWords;
+        std::vector<uint64_t> inputWords;
+    };
+
+    Gate *gate;
+    ExpectedFunction expected;
+    int numInputs;
+    uint64_t numRows;
+    uint64_t chunkWords;
+    bool stopOnMismatch = true;
+    ProgressCallback progress;
+    double progressInterval = 0.5;
+
+    void validateRange(uint64_t firstRow, uint64_t endRow) const;
+    ChunkBuffers makeBuffers() const;
+    // evaluates and compares rows [firstRow, endRow) of at most one chunk, adding to `result`
+    void checkChunk(uint64_t firstRow, uint64_t endRow, ChunkBuffers &buffers, Result &result) const;
+};
@@ -0,0 +1,2298 @@
+#include "parser.h"
+#include <algorithm>
+#include <bitset>
+#include <cctype>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include "core/GateFactory.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DLS_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// expression graph
+
+ExpressionDag::ExpressionDag()
+{
+    nodes.push_back({Op::Zero, 0, 0});
+    nodes.push_back({Op::One, 0, 0});
+}
+
+ExpressionDag::NodeId ExpressionDag::intern(Op op, NodeId left, NodeId right)
+{
+    // ids up to 2^30 fit next to each other in the key
+    uint64_t key = (static_cast<uint64_t>(op) << 60) | (static_cast<uint64_t>(left) << 30) | right;
+    auto it = unique.find(key);
+    if (it != unique.end())
+    {
+        return it->second;
+    }
+    if (nodes.size() >= (1u << 30))
+    {
+        throw std::length_error("Expression graph is full");
+    }
+    NodeId id = static_cast<NodeId>(nodes.size());
+    nodes.push_back({op, left, right});
+    unique.emplace(key, id);
+    return id;
+}
+
+ExpressionDag::NodeId ExpressionDag::variable(const std::string &name)
+{
+    auto it = variableNodes.find(name);
+    if (it != variableNodes.end())
+    {
+        return it->second;
+    }
+    NodeId id = intern(Op::Variable, static_cast<NodeId>(variableNames.size()), 0);
+    variableNames.push_back(name);
+    variableNodes.emplace(name, id);
+    return id;
+}
+
+bool ExpressionDag::isComplement(NodeId a, NodeId b) const
+{
+    return (nodes[a].op == Op::Not && nodes[a].left == b) || (nodes[b].op == Op::Not && nodes[b].left == a) ||
+           (a == ZeroNode && b == OneNode) || (a == OneNode && b == ZeroNode);
+}
+
+ExpressionDag::NodeId ExpressionDag::makeNot(NodeId operand)
+{
+    if (operand == ZeroNode)
+    {
+        return OneNode;
+    }
+    if (operand == OneNode)
+    {
+        return ZeroNode;
+    }
+    if (nodes[operand].op == Op::Not)
+    {
+        return nodes[operand].left;
+    }
+    return intern(Op::Not, operand, 0);
+}
+
+ExpressionDag::NodeId ExpressionDag::makeAnd(NodeId left, NodeId right)
+{
+    if (left > right)
+    {
+        std::swap(left, right);
+    }
+    // constants have the lowest ids, so they always end up on the left
+    if (left == ZeroNode || isComplement(left, right))
+    {
+        return ZeroNode;
+    }
+    if (left == OneNode || left == right)
+    {
+        return right;
+    }
+    return intern(Op::And, left, right);
+}
+
+ExpressionDag::NodeId ExpressionDag::makeOr(NodeId left, NodeId right)
+{
+    if (left > right)
+    {
+        std::swap(left, right);
+    }
+    if (left == OneNode || isComplement(left, right))
+    {
+        return OneNode;
+    }
+    if (left == ZeroNode || left == right)
+    {
+        return right;
+    }
+    return intern(Op::Or, left, right);
+}
+
+ExpressionDag::NodeId ExpressionDag::makeXor(NodeId left, NodeId right)
+{
+    if (left > right)
+    {
+        std::swap(left, right);
+    }
+    if (left == right)
+    {
+        return ZeroNode;
+    }
+    if (isComplement(left, right))
+    {
+        return OneNode;
+    }
+    if (left == ZeroNode)
+    {
+        return right;
+    }
+    if (left == OneNode)
+    {
+        return makeNot(right);
+    }
+    return intern(Op::Xor, left, right);
+}
+
+size_t ExpressionDag::countNodes(const std::vector<NodeId> &roots) const
+{
+    std::vector<char> seen(nodes.size(), 0);
+    std::vector<NodeId> stack(roots.begin(), roots.end());
+    size_t count = 0;
+    while (!stack.empty())
+    {
+        NodeId id = stack.back();
+        stack.pop_back();
+        if (seen[id])
+        {
+            continue;
+        }
+        seen[id] = 1;
+        count++;
+        const Node &node = nodes[id];
+        if (node.op == Op::Not)
+        {
+            stack.push_back(node.left);
+        }
+        else if (node.op == Op::And || node.op == Op::Or || node.op == Op::Xor)
+        {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+    return count;
+}
+
+void ExpressionDag::appendString(NodeId id, int parentPrecedence, std::string &out) const
+{
+    const Node &node = nodes[id];
+    switch (node.op)
+    {
+    case Op::Zero:
+        out += '0';
+        return;
+    case Op::One:
+        out += '1';
+        return;
+    case Op::Variable:
+        out += variableNames[node.left];
+        return;
+    case Op::Not:
+        out += '~';
+        appendString(node.left, 4, out);
+        return;
+    default:
+        break;
+    }
+    // same precedence as the parser: | loosest, then ^, then &
+    int precedence = node.op == Op::Or ? 1 : node.op == Op::Xor ? 2 : 3;
+    const char *symbol = node.op == Op::Or ? " | " : node.op == Op::Xor ? " ^ " : " & ";
+    if (precedence < parentPrecedence)
+    {
+        out += '(';
+    }
+    appendString(node.left, precedence, out);
+    out += symbol;
+    appendString(node.right, precedence, out);
+    if (precedence < parentPrecedence)
+    {
+        out += ')';
+    }
+}
+
+std::string ExpressionDag::toString(NodeId root) const
+{
+    std::string out;
+    appendString(root, 0, out);
+    return out;
+}
+
+bool ExpressionDag::evaluate(NodeId root, const std::vector<bool> &values) const
+{
+    if (values.size() < variableNames.size())
+    {
+        throw std::invalid_argument("Expression needs " + std::to_string(variableNames.size()) + " variable values");
+    }
+    // ids are topological, so one forward pass up to the root settles everything
+    std::vector<char> result(root + 1, 0);
+    for (NodeId id = 0; id <= root; id++)
+    {
+        const Node &node = nodes[id];
+        switch (node.op)
+        {
+        case Op::Zero:
+            result[id] = 0;
+            break;
+        case Op::One:
+            result[id] = 1;
+            break;
+        case Op::Variable:
+            result[id] = values[node.left];
+            break;
+        case Op::Not:
+            result[id] = !result[node.left];
+            break;
+        case Op::And:
+            result[id] = result[node.left] & result[node.right];
+            break;
+        case Op::Or:
+            result[id] = result[node.left] | result[node.right];
+            break;
+        case Op::Xor:
+            result[id] = result[node.left] ^ result[node.right];
+            break;
+        }
+    }
+    return result[root];
+}
+
+// parser
+
+ExpressionDag::NodeId ExpressionParser::parse(const std::string &text, ExpressionDag &dag)
+{
+    ExpressionParser parser(text, dag);
+    if (parser.peek() == '\0')
+    {
+        parser.fail("empty expression");
+    }
+    ExpressionDag::NodeId root = parser.parseOr();
+    if (parser.peek() != '\0')
+    {
+        parser.fail(std::string("unexpected '") + parser.peek() + "'");
+    }
+    return root;
+}
+
+char ExpressionParser::peek()
+{
+    while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position])))
+    {
+        position++;
+    }
+    return position < text.size() ? text[position] : '\0';
+}
+
+void ExpressionParser::fail(const std::string &message) const
+{
+    throw std::invalid_argument("Expression: " + message + " at column " + std::to_string(position + 1));
+}
+
+ExpressionDag::NodeId ExpressionParser::parseOr()
+{
+    ExpressionDag::NodeId left = parseXor();
+    while (peek() == '|' || peek() == '+')
+    {
+        position++;
+        left = dag.makeOr(left, parseXor());
+    }
+    return left;
+}
+
+ExpressionDag::NodeId ExpressionParser::parseXor()
+{
+    ExpressionDag::NodeId left = parseAnd();
+    while (peek() == '^')
+    {
+        position++;
+        left = dag.makeXor(left, parseAnd());
+    }
+    return left;
+}
+
+ExpressionDag::NodeId ExpressionParser::parseAnd()
+{
+    ExpressionDag::NodeId left = parseUnary();
+    while (true)
+    {
+        char c = peek();
+        if (c == '&' || c == '*')
+        {
+            position++;
+        }
+        else if (!(std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '(' || c == '~' || c == '!'))
+        {
+            break;
+        }
+        // juxtaposition is an AND as well: A'B, (A + B)(C + D)
+        left = dag.makeAnd(left, parseUnary());
+    }
+    return left;
+}
+
+ExpressionDag::NodeId ExpressionParser::parseUnary()
+{
+    if (peek() == '~' || peek() == '!')
+    {
+        position++;
+        return dag.makeNot(parseUnary());
+    }
+    ExpressionDag::NodeId operand = parsePrimary();
+    while (peek() == '\'')
+    {
+        position++;
+        operand = dag.makeNot(operand);
+    }
+    return operand;
+}
+
+ExpressionDag::NodeId ExpressionParser::parsePrimary()
+{
+    char c = peek();
+    if (c == '(')
+    {
+        position++;
+        ExpressionDag::NodeId inner = parseOr();
+        if (peek() != ')')
+        {
+            fail("missing ')'");
+        }
+        position++;
+        return inner;
+    }
+    if (c == '0' || c == '1')
+    {
+        position++;
+        if (position < text.size() && std::isalnum(static_cast<unsigned char>(text[position])))
+        {
+            fail("constants are 0 and 1");
+        }
+        return dag.constant(c == '1');
+    }
+    if (std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+    {
+        size_t start = position;
+        while (position < text.size() &&
+               (std::isalnum(static_cast<unsigned char>(text[position])) || text[position] == '_' || text[position] == '.'))
+        {
+            position++;
+        }
+        return dag.variable(text.substr(start, position - start));
+    }
+    if (c == '\0')
+    {
+        fail("unexpected end of expression");
+    }
+    fail(std::string("unexpected '") + c + "'");
+}
+
+// compiled form
+
+CompiledExpression::CompiledExpression(const ExpressionDag &dag, const std::vector<ExpressionDag::NodeId> &roots)
+    : numInputs(dag.getVariableCount())
+{
+    using Op = ExpressionDag::Op;
+    using NodeId = ExpressionDag::NodeId;
+    const uint32_t Unused = std::numeric_limits<uint32_t>::max();
+
+    // inverters are never materialized, so liveness is tracked on the node under the ~
+    auto base = [&](NodeId id)
+    {
+        return dag.getNode(id).op == Op::Not ? dag.getNode(id).left : id;
+    };
+
+    // reachable nodes in id order, which is a topological order
+    std::vector<char> reachable(dag.size(), 0);
+    std::vector<NodeId> stack(roots.begin(), roots.end());
+    while (!stack.empty())
+    {
+        NodeId id = stack.back();
+        stack.pop_back();
+        if (reachable[id])
+        {
+            continue;
+        }
+        reachable[id] = 1;
+        const ExpressionDag::Node &node = dag.getNode(id);
+        if (node.op == Op::Not || node.op == Op::And || node.op == Op::Or || node.op == Op::Xor)
+        {
+            stack.push_back(node.left);
+        }
+        if (node.op == Op::And || node.op == Op::Or || node.op == Op::Xor)
+        {
+            stack.push_back(node.right);
+        }
+    }
+
+    // position of the last instruction reading each node, roots live to the end
+    std::vector<uint32_t> lastUse(dag.size(), 0);
+    std::vector<char> consumed(dag.size(), 0);
+    for (NodeId id = 0; id < dag.size(); id++)
+    {
+        const ExpressionDag::Node &node = dag.getNode(id);
+        if (reachable[id] && (node.op == Op::And || node.op == Op::Or || node.op == Op::Xor))
+        {
+            for (NodeId operand : {base(node.left), base(node.right)})
+            {
+                lastUse[operand] = std::max(lastUse[operand], id);
+                consumed[operand] = 1;
+            }
+        }
+    }
+    for (NodeId root : roots)
+    {
+        lastUse[base(root)] = Unused;
+    }
+
+    // value of a node: a register and whether the register holds its complement
+    std::vector<uint32_t> registerOf(dag.size(), Unused);
+    std::vector<char> inverted(dag.size(), 0);
+    std::vector<uint32_t> instructionOf(dag.size(), Unused);
+    std::vector<uint16_t> freeRegisters;
+    numRegisters = numInputs;
+    auto allocate = [&]() -> uint16_t
+    {
+        if (!freeRegisters.empty())
+        {
+            uint16_t reg = freeRegisters.back();
+            freeRegisters.pop_back();
+            return reg;
+        }
+        if (numRegisters > std::numeric_limits<uint16_t>::max())
+        {
+            throw std::length_error("Compiled expression needs more than 65536 registers");
+        }
+        return static_cast<uint16_t>(numRegisters++);
+    };
+
+    for (NodeId id = 0; id < dag.size(); id++)
+    {
+        if (!reachable[id])
+        {
+            continue;
+        }
+        const ExpressionDag::Node &node = dag.getNode(id);
+        if (node.op == Op::Variable)
+        {
+            registerOf[id] = node.left;
+            continue;
+        }
+        if (node.op == Op::Not)
+        {
+            registerOf[id] = registerOf[node.left];
+            inverted[id] = !inverted[node.left];
+            continue;
+        }
+        if (node.op == Op::Zero || node.op == Op::One)
+        {
+            // only reachable as a whole root, the graph folds constants everywhere else
+            continue;
+        }
+
+        uint16_t a = static_cast<uint16_t>(registerOf[node.left]);
+        uint16_t b = static_cast<uint16_t>(registerOf[node.right]);
+        bool invertA = inverted[node.left];
+        bool invertB = inverted[node.right];
+        // operands read for the last time give their registers back before the result is placed
+        for (NodeId operand : {base(node.left), base(node.right)})
+        {
+            if (lastUse[operand] == id && registerOf[operand] >= numInputs)
+            {
+                freeRegisters.push_back(static_cast<uint16_t>(registerOf[operand]));
+            }
+        }
+        uint16_t dst = allocate();
+        registerOf[id] = dst;
+
+        Instruction instruction{Opcode::And, dst, a, b};
+        if (node.op == Op::Xor)
+        {
+            // ~a ^ b is ~(a ^ b): keep the polarity in the flag
+            instruction.op = Opcode::Xor;
+            inverted[id] = invertA != invertB;
+        }
+        else if (invertA && invertB)
+        {
+            // De Morgan: ~a & ~b is ~(a | b), ~a | ~b is ~(a & b)
+            instruction.op = node.op == Op::And ? Opcode::Nor : Opcode::Nand;
+        }
+        else if (invertA || invertB)
+        {
+            if (invertA)
+            {
+                std::swap(instruction.a, instruction.b);
+            }
+            instruction.op = node.op == Op::And ? Opcode::AndNot : Opcode::OrNot;
+        }
+        else
+        {
+            instruction.op = node.op == Op::And ? Opcode::And : Opcode::Or;
+        }
+        instructionOf[id] = static_cast<uint32_t>(program.size());
+        program.push_back(instruction);
+    }
+
+    // polarities each node is wanted in as a root: 1 plain, 2 complemented
+    std::vector<uint8_t> rootPolarity(dag.size(), 0);
+    for (NodeId root : roots)
+    {
+        rootPolarity[base(root)] |= inverted[root] ? 2 : 1;
+    }
+    std::vector<char> complemented(dag.size(), 0);
+    for (NodeId root : roots)
+    {
+        const ExpressionDag::Node &node = dag.getNode(root);
+        NodeId under = base(root);
+        if (node.op == Op::Zero || node.op == Op::One)
+        {
+            uint16_t dst = allocate();
+            program.push_back({node.op == Op::One ? Opcode::One : Opcode::Zero, dst, 0, 0});
+            outputRegisters.push_back(dst);
+        }
+        else if (inverted[root] && !consumed[under] && rootPolarity[under] == 2 && instructionOf[under] != Unused)
+        {
+            // nobody else reads the value, so the instruction can produce the complement itself
+            if (!complemented[under])
+            {
+                Instruction &producer = program[instructionOf[under]];
+                switch (producer.op)
+                {
+                case Opcode::And:
+                    producer.op = Opcode::Nand;
+                    break;
+                case Opcode::Or:
+                    producer.op = Opcode::Nor;
+                    break;
+                case Opcode::Xor:
+                    producer.op = Opcode::Xnor;
+                    break;
+                case Opcode::Nand:
+                    producer.op = Opcode::And;
+                    break;
+                case Opcode::Nor:
+                    producer.op = Opcode::Or;
+                    break;
+                case Opcode::AndNot:
+                    // ~(a & ~b) is b | ~a
+                    producer = {Opcode::OrNot, producer.dst, producer.b, producer.a};
+                    break;
+                default:
+                    // ~(a | ~b) is b & ~a
+                    producer = {Opcode::AndNot, producer.dst, producer.b, producer.a};
+                    break;
+                }
+                complemented[under] = 1;
+            }
+            outputRegisters.push_back(static_cast<uint16_t>(registerOf[root]));
+        }
+        else if (inverted[root])
+        {
+            uint16_t dst = allocate();
+            program.push_back({Opcode::Not, dst, static_cast<uint16_t>(registerOf[root]), 0});
+            outputRegisters.push_back(dst);
+        }
+        else
+        {
+            outputRegisters.push_back(static_cast<uint16_t>(registerOf[root]));
+        }
+    }
+}
+
+void CompiledExpression::run(uint64_t *registers) const
+{
+    for (const Instruction &instruction : program)
+    {
+        uint64_t *dst = registers + instruction.dst * BlockWords;
+        const uint64_t *a = registers + instruction.a * BlockWords;
+        const uint64_t *b = registers + instruction.b * BlockWords;
+        switch (instruction.op)
+        {
+        case Opcode::Zero:
+            for (size_t j = 0; j < BlockWords; j++)
+                dst[j] = 0;
+            break;
+        case Opcode::One:
+            for (size_t j = 0; j < BlockWords; j++)
+                dst[j] = ~0ULL;
+            break;
+        case Opcode::Not:
+            for (size_t j = 0; j < BlockWords; j++)
+                dst[j] = ~a[j];
+            break;
+        case Opcode::And:
+            for (size_t j = 0; j < BlockWords; j++)
+                dst[j] = a[j] & b[j];
+            break;
+        case Opcode::Or:
+            for (size_t j = 0; j < BlockWords; j++)
+                dst[j] = a[j] | b[j];
+            break;
+        case Opcode::Xor:
+            for (size_t j = 0; j < BlockWords; j++)
+                dst[j] = a[j] ^ b[j];
+            break;
+        case Opcode::Nand:
+            for (size_t j = 0; j < BlockWords; j++)
+                dst[j] = ~(a[j] & b[j]);
+            break;
+        case Opcode::Nor:
+            for (size_t j = 0; j < BlockWords; j++)
+                dst[j] = ~(a[j] | b[j]);
+            break;
+        case Opcode::Xnor:
+            for (size_t j = 0; j < BlockWords; j++)
+                dst[j] = ~(a[j] ^ b[j]);
+            break;
+        case Opcode::AndNot:
+            for (size_t j = 0; j < BlockWords; j++)
+                dst[j] = a[j] & ~b[j];
+            break;
+        case Opcode::OrNot:
+            for (size_t j = 0; j < BlockWords; j++)
+                dst[j] = a[j] | ~b[j];
+            break;
+        }
+    }
+}
+
+void CompiledExpression::evaluate(const uint64_t *const *inputs, uint64_t *const *outputs, size_t words) const
+{
+    std::vector<uint64_t> registers(static_cast<size_t>(numRegisters) * BlockWords, 0);
+    for (size_t first = 0; first < words; first += BlockWords)
+    {
+        // a short last block runs on whatever the unused lanes hold and only copies back its own words
+        size_t lanes = std::min(BlockWords, words - first);
+        for (uint32_t i = 0; i < numInputs; i++)
+        {
+            std::copy(inputs[i] + first, inputs[i] + first + lanes, registers.begin() + i * BlockWords);
+        }
+        run(registers.data());
+        for (size_t o = 0; o < outputRegisters.size(); o++)
+        {
+            const uint64_t *result = registers.data() + outputRegisters[o] * BlockWords;
+            std::copy(result, result + lanes, outputs[o] + first);
+        }
+    }
+}
+
+void CompiledExpression::evaluate(const uint64_t *inputs, uint64_t *outputs) const
+{
+    std::vector<const uint64_t *> inputColumns(numInputs);
+    for (uint32_t i = 0; i < numInputs; i++)
+    {
+        inputColumns[i] = inputs + i;
+    }
+    std::vector<uint64_t *> outputColumns(outputRegisters.size());
+    for (size_t o = 0; o < outputRegisters.size(); o++)
+    {
+        outputColumns[o] = outputs + o;
+    }
+    evaluate(inputColumns.data(), outputColumns.data(), 1);
+}
+
+std::string CompiledExpression::disassemble() const
+{
+    static const char *names[] = {"zero", "one", "not", "and", "or", "xor", "nand", "nor", "xnor", "andnot", "ornot"};
+    std::ostringstream out;
+    for (const Instruction &instruction : program)
+    {
+        out << "r" << instruction.dst << " = " << names[static_cast<int>(instruction.op)];
+        if (instruction.op != Opcode::Zero && instruction.op != Opcode::One)
+        {
+            out << " r" << instruction.a;
+        }
+        if (instruction.op >= Opcode::And)
+        {
+            out << ", r" << instruction.b;
+        }
+        out << "\n";
+    }
+    for (size_t o = 0; o < outputRegisters.size(); o++)
+    {
+        out << "out" << o << " = r" << outputRegisters[o] << "\n";
+    }
+    return out.str();
+}
+
+// mapped files
+
+MappedFile::MappedFile(const std::string &path, Access access)
+{
+#ifdef DLS_HAVE_MMAP
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+    {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    struct stat info;
+    if (::fstat(descriptor, &info) == 0 && info.st_size > 0)
+    {
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        if (access == Access::Sequential)
+        {
+            flags |= MAP_POPULATE;
+        }
+#endif
+        void *address = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, flags, descriptor, 0);
+        if (address != MAP_FAILED)
+        {
+            if (access == Access::Sequential)
+            {
+                ::madvise(address, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+            }
+            bytes = static_cast<const char *>(address);
+            length = static_cast<size_t>(info.st_size);
+            mapped = true;
+        }
+    }
+    ::close(descriptor);
+    if (mapped)
+    {
+        return;
+    }
+#endif
+    // empty files, pipes and platforms without mmap are read the ordinary way
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Cannot open file: " + path);
+    }
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    bytes = buffer.data();
+    length = buffer.size();
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef DLS_HAVE_MMAP
+    if (mapped)
+    {
+        ::munmap(const_cast<char *>(bytes), length);
+    }
+#endif
+}
+
+// netlist import
+
+namespace
+{
+    // nets of the netlist being read and the gates between them, turned into a Circuit at the end
+    class NetlistBuilder
+    {
+    public:
+        static constexpr uint32_t NoNet = 0xFFFFFFFF;
+
+        // id of the named net, created on first use; the view must stay valid until build()
+        uint32_t intern(std::string_view name) { return intern(name, false); }
+        // same for a name held in a temporary, which is copied if the net is new
+        uint32_t internCopy(std::string_view name) { return intern(name, true); }
+        std::string_view getName(uint32_t net) const { return names[net]; }
+
+        void addInput(uint32_t net) { inputs.push_back(net); }
+        void addOutput(uint32_t net) { outputs.push_back(net); }
+        // a gate driving `output`, its inputs follow through addPin
+        void beginGate(GateType type, uint32_t output, uint32_t delay = 1)
+        {
+            gates.push_back({type, output, static_cast<uint32_t>(pins.size()), delay});
+        }
+        void addPin(uint32_t net) { pins.push_back(net); }
+        // power-up value of the flip-flop or latch driving `net`
+        void setInitial(uint32_t net, bool value) { initialValues.push_back({net, value}); }
+        // lets several gates drive one net, which then resolves them (a Bus unless set here)
+        void allowMultipleDrivers() { multipleDrivers = true; }
+        void setResolution(uint32_t net, GateType type) { resolutions.push_back({net, type}); }
+        // fixes up the gate just finished, false if it has no inputs
+        bool endGate();
+
+        Circuit build() const;
+
+    private:
+        struct GateRecord
+        {
+            GateType type;
+            uint32_t output;
+            uint32_t firstPin;
+            uint32_t delay;
+        };
+
+        struct Slot
+        {
+            uint32_t net;
+            uint32_t hash;
+        };
+
+        std::vector<std::string_view> names;
+        // open addressing with the hash next to the net id, so most probes touch one line
+        std::vector<Slot> slots = std::vector<Slot>(1024, Slot{NoNet, 0});
+        // storage for names that are not in the source text, such as expanded bus bits
+        std::deque<std::string> ownedNames;
+        std::vector<uint32_t> inputs;
+        std::vector<uint32_t> outputs;
+        std::vector<GateRecord> gates;
+        std::vector<uint32_t> pins;
+        std::vector<std::pair<uint32_t, bool>> initialValues;
+        std::vector<std::pair<uint32_t, GateType>> resolutions;
+        bool multipleDrivers = false;
+
+        uint32_t intern(std::string_view name, bool copy);
+        void growSlots();
+    };
+
+    uint32_t hashName(std::string_view name)
+    {
+        // FNV-1a
+        uint32_t hash = 2166136261u;
+        for (char c : name)
+        {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+        }
+        return hash;
+    }
+
+    uint32_t NetlistBuilder::intern(std::string_view name, bool copy)
+    {
+        uint32_t hash = hashName(name);
+        size_t mask = slots.size() - 1;
+        size_t slot = hash & mask;
+        while (slots[slot].net != NoNet)
+        {
+            if (slots[slot].hash == hash && names[slots[slot].net] == name)
+            {
+                return slots[slot].net;
+            }
+            slot = (slot + 1) & mask;
+        }
+
+        uint32_t net = static_cast<uint32_t>(names.size());
+        if (copy)
+        {
+            ownedNames.emplace_back(name);
+            name = ownedNames.back();
+        }
+        names.push_back(name);
+        slots[slot] = {net, hash};
+        // keep the table at most half full
+        if (names.size() * 2 > slots.size())
+        {
+            growSlots();
+        }
+        return net;
+    }
+
+    void NetlistBuilder::growSlots()
+    {
+        std::vector<Slot> old(slots.size() * 2, Slot{NoNet, 0});
+        old.swap(slots);
+        size_t mask = slots.size() - 1;
+        for (const Slot &entry : old)
+        {
+            if (entry.net == NoNet)
+            {
+                continue;
+            }
+            size_t slot = entry.hash & mask;
+            while (slots[slot].net != NoNet)
+            {
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = entry;
+        }
+    }
+
+    bool NetlistBuilder::endGate()
+    {
+        GateRecord &gate = gates.back();
+        size_t count = pins.size() - gate.firstPin;
+        if (count == 0)
+        {
+            gates.pop_back();
+            return false;
+        }
+        // a one-input AND is a buffer and a one-input NAND an inverter, as in Verilog
+        if (count == 1 && gate.type != GateType::Not && gate.type != GateType::Buffer && !GateFactory::isSequential(gate.type) &&
+            !GateFactory::isTriState(gate.type))
+        {
+            bool inverting = gate.type == GateType::Nand || gate.type == GateType::Nor || gate.type == GateType::Xnor;
+            gate.type = inverting ? GateType::Not : GateType::Buffer;
+        }
+        return true;
+    }
+
+    Circuit NetlistBuilder::build() const
+    {
+        Circuit circuit;
+        std::vector<Circuit::NodeId> nodeOf(names.size(), Circuit::InvalidNode);
+        for (uint32_t net : inputs)
+        {
+            if (nodeOf[net] != Circuit::InvalidNode)
+            {
+                throw std::runtime_error("Input " + std::string(names[net]) + " is declared twice");
+            }
+            nodeOf[net] = circuit.addInput(names[net]);
+        }
+        // a net with several drivers is a resolved net with one pin per driver, and each
+        // driver becomes a node of its own named net$0, net$1, ... in the order they were read
+        std::vector<uint32_t> driverCount(names.size(), 0);
+        std::vector<GateType> resolution;
+        if (multipleDrivers)
+        {
+            for (const GateRecord &gate : gates)
+            {
+                driverCount[gate.output]++;
+            }
+            resolution.assign(names.size(), GateType::Bus);
+            for (const auto &entry : resolutions)
+            {
+                resolution[entry.first] = entry.second;
+            }
+        }
+        std::vector<Circuit::NodeId> gateNode(gates.size());
+        std::vector<uint32_t> driverPin(gates.size(), 0);
+        std::vector<uint32_t> driversSeen(multipleDrivers ? names.size() : 0, 0);
+        std::string driverName;
+        for (size_t g = 0; g < gates.size(); g++)
+        {
+            const GateRecord &gate = gates[g];
+            uint32_t endPin = g + 1 < gates.size() ? gates[g + 1].firstPin : static_cast<uint32_t>(pins.size());
+            bool resolved = driverCount[gate.output] > 1;
+            // a second driver of an input, or of anything when the format has no resolved nets
+            if (nodeOf[gate.output] != Circuit::InvalidNode && (!resolved || driversSeen[gate.output] == 0))
+            {
+                throw std::runtime_error("Net " + std::string(names[gate.output]) + " has more than one driver");
+            }
+            if (resolved)
+            {
+                if (driversSeen[gate.output] == 0)
+                {
+                    nodeOf[gate.output] = circuit.addGate(resolution[gate.output], names[gate.output], driverCount[gate.output]);
+                }
+                driverPin[g] = driversSeen[gate.output]++;
+                driverName.assign(names[gate.output]);
+                driverName += '$';
+                driverName += std::to_string(driverPin[g]);
+                gateNode[g] = circuit.addGate(gate.type, driverName, endPin - gate.firstPin);
+            }
+            else
+            {
+                nodeOf[gate.output] = gateNode[g] = circuit.addGate(gate.type, names[gate.output], endPin - gate.firstPin);
+            }
+            if (gate.delay != 1)
+            {
+                circuit.setDelay(gateNode[g], gate.delay);
+            }
+        }
+        for (size_t g = 0; g < gates.size(); g++)
+        {
+            const GateRecord &gate = gates[g];
+            uint32_t endPin = g + 1 < gates.size() ? gates[g + 1].firstPin : static_cast<uint32_t>(pins.size());
+            for (uint32_t pin = gate.firstPin; pin < endPin; pin++)
+            {
+                if (nodeOf[pins[pin]] == Circuit::InvalidNode)
+                {
+                    throw std::runtime_error("Net " + std::string(names[pins[pin]]) + " is never driven");
+                }
+                circuit.connect(nodeOf[pins[pin]], gateNode[g], pin - gate.firstPin);
+            }
+            if (gateNode[g] != nodeOf[gate.output])
+            {
+                circuit.connect(gateNode[g], nodeOf[gate.output], driverPin[g]);
+            }
+        }
+        for (const auto &initial : initialValues)
+        {
+            circuit.setValue(nodeOf[initial.first], initial.second);
+        }
+        std::vector<char> marked(names.size(), 0);
+        for (uint32_t net : outputs)
+        {
+            if (nodeOf[net] == Circuit::InvalidNode)
+            {
+                throw std::runtime_error("Output " + std::string(names[net]) + " is never driven");
+            }
+            if (!marked[net])
+            {
+                marked[net] = 1;
+                circuit.markOutput(nodeOf[net]);
+            }
+        }
+        circuit.freeze();
+        return circuit;
+    }
+
+    bool primitiveType(std::string_view word, GateType &type)
+    {
+        static const std::pair<std::string_view, GateType> primitives[] = {
+            {"and", GateType::And}, {"or", GateType::Or}, {"nand", GateType::Nand}, {"nor", GateType::Nor},
+            {"xor", GateType::Xor}, {"xnor", GateType::Xnor}, {"not", GateType::Not}, {"buf", GateType::Buffer},
+            {"bufif1", GateType::TriState}, {"nmos", GateType::TransmissionGate}};
+        for (const auto &primitive : primitives)
+        {
+            if (word == primitive.first)
+            {
+                type = primitive.second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // net kinds, and how each resolves several drivers
+    bool netType(std::string_view word, GateType &resolution)
+    {
+        static const std::pair<std::string_view, GateType> netTypes[] = {
+            {"wire", GateType::Bus}, {"tri", GateType::Bus}, {"wand", GateType::WiredAnd},
+            {"triand", GateType::WiredAnd}, {"wor", GateType::WiredOr}, {"trior", GateType::WiredOr}};
+        for (const auto &netType : netTypes)
+        {
+            if (word == netType.first)
+            {
+                resolution = netType.second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Verilog
+
+    // character classes, looked up instead of calling the locale-aware <cctype> functions
+    enum CharClass : uint8_t
+    {
+        IdentifierStart = 1,
+        IdentifierChar = 2,
+        Digit = 4,
+        Space = 8
+    };
+
+    struct CharClasses
+    {
+        uint8_t table[256] = {};
+
+        CharClasses()
+        {
+            for (int c = 0; c < 256; c++)
+            {
+                bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+                bool digit = c >= '0' && c <= '9';
+                table[c] = (letter ? IdentifierStart | IdentifierChar : 0) | (digit ? Digit | IdentifierChar : 0) |
+                           (c == '$' ? IdentifierChar : 0) | (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f' ? Space : 0);
+            }
+        }
+
+        bool is(char c, uint8_t mask) const { return table[static_cast<uint8_t>(c)] & mask; }
+    };
+
+    const CharClasses charClasses;
+
+    struct Token
+    {
+        enum class Kind : uint8_t
+        {
+            End,
+            Identifier,
+            Number,
+            Symbol
+        };
+        Kind kind;
+        std::string_view text;
+
+        bool is(char symbol) const { return kind == Kind::Symbol && text[0] == symbol; }
+        bool is(std::string_view word) const { return kind == Kind::Identifier && text == word; }
+    };
+
+    class VerilogReader
+    {
+    public:
+        VerilogReader(const char *text, size_t length) : position(text), end(text + length)
+        {
+            builder.allowMultipleDrivers();
+            advance();
+        }
+
+        Circuit read();
+
+    private:
+        enum class Direction
+        {
+            Input,
+            Output,
+            Wire
+        };
+
+        const char *position;
+        const char *end;
+        uint32_t line = 1;
+        // line of the current token, which is what errors point at
+        uint32_t tokenLine = 1;
+        Token current;
+        NetlistBuilder builder;
+        // terminals of the instance being read, reused for every instance
+        std::vector<uint32_t> terminals;
+        std::string scratch;
+
+        [[noreturn]] void fail(const std::string &message) const
+        {
+            throw std::runtime_error("Verilog line " + std::to_string(tokenLine) + ": " + message);
+        }
+        void skipSpace();
+        void advance();
+        void expect(char symbol);
+        std::string_view expectIdentifier();
+        uint32_t parseNumber();
+        uint32_t parseNet();
+        uint32_t parseDelay();
+        void parseRange(int &msb, int &lsb);
+        void declare(std::string_view name, Direction direction, bool hasRange, int msb, int lsb, GateType resolution);
+        void parsePortList();
+        void parseDeclaration(Direction direction);
+        void parseInstances(GateType type);
+        void parseAssign();
+    };
+
+    void VerilogReader::skipSpace()
+    {
+        while (position < end)
+        {
+            char c = *position;
+            if (c == '\n')
+            {
+                line++;
+                position++;
+            }
+            else if (c == ' ' || c == '\t' || c == '\r')
+            {
+                position++;
+            }
+            else if (c == '/' && position + 1 < end && position[1] == '/')
+            {
+                while (position < end && *position != '\n')
+                {
+                    position++;
+                }
+            }
+            else if (c == '/' && position + 1 < end && position[1] == '*')
+            {
+                position += 2;
+                while (position < end && !(*position == '*' && position + 1 < end && position[1] == '/'))
+                {
+                    line += *position == '\n';
+                    position++;
+                }
+                position = std::min(position + 2, end);
+            }
+            else if (c == '`')
+            {
+                // compiler directives such as `timescale take the rest of the line
+                while (position < end && *position != '\n')
+                {
+                    position++;
+                }
+            }
+            else
+            {
+                return;
+            }
+        }
+    }
+
+    void VerilogReader::advance()
+    {
+        skipSpace();
+        tokenLine = line;
+        const char *start = position;
+        if (position == end)
+        {
+            current = {Token::Kind::End, std::string_view()};
+            return;
+        }
+        char c = *position;
+        if (charClasses.is(c, IdentifierStart))
+        {
+            while (position < end && charClasses.is(*position, IdentifierChar))
+            {
+                position++;
+            }
+            current = {Token::Kind::Identifier, std::string_view(start, position - start)};
+        }
+        else if (c == '\\')
+        {
+            // escaped identifier, everything up to the next white space
+            start++;
+            position++;
+            while (position < end && !charClasses.is(*position, Space))
+            {
+                position++;
+            }
+            current = {Token::Kind::Identifier, std::string_view(start, position - start)};
+        }
+        else if (charClasses.is(c, Digit) || c == '\'')
+        {
+            // plain and sized numbers, 12 or 1'b0
+            while (position < end && (charClasses.is(*position, IdentifierChar) || *position == '\''))
+            {
+                position++;
+            }
+            current = {Token::Kind::Number, std::string_view(start, position - start)};
+        }
+        else
+        {
+            position++;
+            current = {Token::Kind::Symbol, std::string_view(start, 1)};
+        }
+    }
+
+    void VerilogReader::expect(char symbol)
+    {
+        if (!current.is(symbol))
+        {
+            fail(std::string("expected '") + symbol + "'" + (current.kind == Token::Kind::End ? " before the end of the file" : " before '" + std::string(current.text) + "'"));
+        }
+        advance();
+    }
+
+    std::string_view VerilogReader::expectIdentifier()
+    {
+        if (current.kind != Token::Kind::Identifier)
+        {
+            fail(current.kind == Token::Kind::End ? "unexpected end of file" : "expected a name before '" + std::string(current.text) + "'");
+        }
+        std::string_view name = current.text;
+        advance();
+        return name;
+    }
+
+    uint32_t VerilogReader::parseNumber()
+    {
+        if (current.kind != Token::Kind::Number)
+        {
+            fail("expected a number");
+        }
+        uint32_t value = 0;
+        for (char c : current.text)
+        {
+            if (!charClasses.is(c, Digit) || value > 100000000)
+            {
+                fail("unsupported number '" + std::string(current.text) + "'");
+            }
+            value = value * 10 + (c - '0');
+        }
+        advance();
+        return value;
+    }
+
+    uint32_t VerilogReader::parseNet()
+    {
+        if (current.kind == Token::Kind::Number)
+        {
+            fail("constant " + std::string(current.text) + " is not supported, drive the pin from an input instead");
+        }
+        std::string_view name = expectIdentifier();
+        if (!current.is('['))
+        {
+            return builder.intern(name);
+        }
+        const char *open = current.text.data();
+        advance();
+        std::string_view index = current.text;
+        parseNumber();
+        if (current.is(':'))
+        {
+            fail("part-select of " + std::string(name) + " is not supported, connect single bits");
+        }
+        const char *close = current.text.data();
+        expect(']');
+        // x[3] written without spaces is its own name in the file, anything else is rebuilt
+        if (open == name.data() + name.size() && index.data() == open + 1 && close == index.data() + index.size())
+        {
+            return builder.intern(std::string_view(name.data(), close + 1 - name.data()));
+        }
+        scratch.assign(name.data(), name.size());
+        scratch += '[';
+        scratch.append(index.data(), index.size());
+        scratch += ']';
+        return builder.internCopy(scratch);
+    }
+
+    uint32_t VerilogReader::parseDelay()
+    {
+        if (!current.is('#'))
+        {
+            return 1;
+        }
+        advance();
+        if (current.is('('))
+        {
+            advance();
+            uint32_t delay = parseNumber();
+            expect(')');
+            return delay;
+        }
+        return parseNumber();
+    }
+
+    void VerilogReader::parseRange(int &msb, int &lsb)
+    {
+        expect('[');
+        msb = static_cast<int>(parseNumber());
+        expect(':');
+        lsb = static_cast<int>(parseNumber());
+        expect(']');
+    }
+
+    void VerilogReader::declare(std::string_view name, Direction direction, bool hasRange, int msb, int lsb, GateType resolution)
+    {
+        // plain wires need no record, nets are created where they are used
+        if (direction == Direction::Wire && resolution == GateType::Bus)
+        {
+            return;
+        }
+        auto add = [&](uint32_t net)
+        {
+            if (resolution != GateType::Bus)
+                builder.setResolution(net, resolution);
+            if (direction == Direction::Input)
+                builder.addInput(net);
+            else if (direction == Direction::Output)
+                builder.addOutput(net);
+        };
+        if (!hasRange)
+        {
+            add(builder.intern(name));
+            return;
+        }
+        // a bus is one net per bit, named name[i], most significant bit first
+        int step = msb >= lsb ? -1 : 1;
+        for (int bit = msb;; bit += step)
+        {
+            scratch.assign(name.data(), name.size());
+            scratch += '[';
+            scratch += std::to_string(bit);
+            scratch += ']';
+            add(builder.internCopy(scratch));
+            if (bit == lsb)
+            {
+                break;
+            }
+        }
+    }
+
+    void VerilogReader::parsePortList()
+    {
+        // plain port lists only name the ports, ANSI lists also declare them
+        bool ansi = false;
+        Direction direction = Direction::Wire;
+        GateType resolution = GateType::Bus;
+        bool hasRange = false;
+        int msb = 0;
+        int lsb = 0;
+        expect('(');
+        while (!current.is(')'))
+        {
+            if (current.is("input") || current.is("output"))
+            {
+                direction = current.is("input") ? Direction::Input : Direction::Output;
+                ansi = true;
+                hasRange = false;
+                resolution = GateType::Bus;
+                advance();
+                if (current.kind == Token::Kind::Identifier && netType(current.text, resolution))
+                {
+                    advance();
+                }
+                if (current.is('['))
+                {
+                    parseRange(msb, lsb);
+                    hasRange = true;
+                }
+            }
+            else if (current.is("inout"))
+            {
+                fail("inout ports are not supported");
+            }
+            else if (current.is(','))
+            {
+                advance();
+            }
+            else
+            {
+                std::string_view name = expectIdentifier();
+                if (ansi)
+                {
+                    declare(name, direction, hasRange, msb, lsb, resolution);
+                }
+            }
+        }
+        advance();
+    }
+
+    void VerilogReader::parseDeclaration(Direction direction)
+    {
+        // wire, tri, wand, ... either as the declaration itself or after input or output
+        GateType resolution = GateType::Bus;
+        if (direction == Direction::Wire)
+        {
+            netType(current.text, resolution);
+        }
+        advance();
+        if (current.kind == Token::Kind::Identifier && netType(current.text, resolution))
+        {
+            advance();
+        }
+        else if (current.is("reg"))
+        {
+            fail("reg is not supported in a gate-level netlist");
+        }
+        bool hasRange = current.is('[');
+        int msb = 0;
+        int lsb = 0;
+        if (hasRange)
+        {
+            parseRange(msb, lsb);
+        }
+        while (true)
+        {
+            declare(expectIdentifier(), direction, hasRange, msb, lsb, resolution);
+            if (current.is(';'))
+            {
+                break;
+            }
+            expect(',');
+        }
+        advance();
+    }
+
+    void VerilogReader::parseInstances(GateType type)
+    {
+        advance();
+        uint32_t delay = parseDelay();
+        while (true)
+        {
+            // the instance name is optional for primitives, and gates are named by their outputs anyway
+            if (current.kind == Token::Kind::Identifier)
+            {
+                advance();
+            }
+            expect('(');
+            terminals.clear();
+            while (true)
+            {
+                terminals.push_back(parseNet());
+                if (current.is(')'))
+                {
+                    break;
+                }
+                expect(',');
+            }
+            advance();
+            if (terminals.size() < 2)
+            {
+                fail("a primitive needs an output and at least one input");
+            }
+
+            if (type == GateType::Not || type == GateType::Buffer)
+            {
+                // not and buf drive every terminal but the last from the last one
+                for (size_t t = 0; t + 1 < terminals.size(); t++)
+                {
+                    builder.beginGate(type, terminals[t], delay);
+                    builder.addPin(terminals.back());
+                    builder.endGate();
+                }
+            }
+            else
+            {
+                builder.beginGate(type, terminals[0], delay);
+                for (size_t t = 1; t < terminals.size(); t++)
+                {
+                    builder.addPin(terminals[t]);
+                }
+                builder.endGate();
+            }
+
+            if (current.is(';'))
+            {
+                break;
+            }
+            expect(',');
+        }
+        advance();
+    }
+
+    void VerilogReader::parseAssign()
+    {
+        advance();
+        uint32_t delay = parseDelay();
+        while (true)
+        {
+            uint32_t target = parseNet();
+            expect('=');
+            bool inverted = false;
+            bool grouped = false;
+            if (current.is('~'))
+            {
+                inverted = true;
+                advance();
+                if (current.is('('))
+                {
+                    grouped = true;
+                    advance();
+                }
+            }
+
+            terminals.clear();
+            terminals.push_back(parseNet());
+            char op = 0;
+            while (current.is('&') || current.is('|') || current.is('^'))
+            {
+                if (op != 0 && current.text[0] != op)
+                {
+                    fail("mixed operators in one assign are not supported, use one gate per assign");
+                }
+                op = current.text[0];
+                advance();
+                terminals.push_back(parseNet());
+            }
+            if (grouped)
+            {
+                expect(')');
+            }
+            else if (inverted && op != 0)
+            {
+                fail("write ~(a op b) for an inverted gate");
+            }
+
+            GateType type = inverted ? GateType::Not : GateType::Buffer;
+            if (op == '&')
+                type = inverted ? GateType::Nand : GateType::And;
+            else if (op == '|')
+                type = inverted ? GateType::Nor : GateType::Or;
+            else if (op == '^')
+                type = inverted ? GateType::Xnor : GateType::Xor;
+            builder.beginGate(type, target, delay);
+            for (uint32_t net : terminals)
+            {
+                builder.addPin(net);
+            }
+            builder.endGate();
+
+            if (current.is(';'))
+            {
+                break;
+            }
+            if (!current.is(','))
+            {
+                fail("unsupported expression, only ~a, a & b & ..., a | b | ..., a ^ b ^ ... and their ~(...) forms are");
+            }
+            advance();
+        }
+        advance();
+    }
+
+    Circuit VerilogReader::read()
+    {
+        while (!current.is("module"))
+        {
+            if (current.kind == Token::Kind::End)
+            {
+                fail("no module found");
+            }
+            advance();
+        }
+        advance();
+        expectIdentifier();
+        if (current.is('#'))
+        {
+            fail("module parameters are not supported");
+        }
+        if (current.is('('))
+        {
+            parsePortList();
+        }
+        expect(';');
+
+        // only the first module is read, a flattened netlist has just one
+        GateType type;
+        GateType resolution;
+        while (!current.is("endmodule"))
+        {
+            if (current.kind != Token::Kind::Identifier)
+            {
+                fail(current.kind == Token::Kind::End ? "missing endmodule" : "unexpected '" + std::string(current.text) + "'");
+            }
+            if (current.is("input"))
+                parseDeclaration(Direction::Input);
+            else if (current.is("output"))
+                parseDeclaration(Direction::Output);
+            else if (netType(current.text, resolution))
+                parseDeclaration(Direction::Wire);
+            else if (current.is("assign"))
+                parseAssign();
+            else if (primitiveType(current.text, type))
+                parseInstances(type);
+            else if (current.is("inout") || current.is("reg") || current.is("always") || current.is("initial"))
+                fail(std::string(current.text) + " is not supported in a gate-level netlist");
+            else
+                fail("instance of module " + std::string(current.text) + " is not supported, flatten the design first");
+        }
+        return builder.build();
+    }
+
+    // BLIF
+
+    class BlifReader
+    {
+    public:
+        BlifReader(const char *text, size_t length) : position(text), end(text + length) {}
+
+        Circuit read();
+
+    private:
+        const char *position;
+        const char *end;
+        uint32_t line = 1;
+        uint32_t commandLine = 1;
+        NetlistBuilder builder;
+        // nets of the open .names, output last, and its cover rows back to back
+        std::vector<uint32_t> terminals;
+        std::string rows;
+        std::string outputBits;
+        std::vector<uint32_t> literals;
+        std::vector<uint32_t> inverted;
+        std::vector<uint32_t> terms;
+        std::string scratch;
+
+        [[noreturn]] void fail(const std::string &message) const
+        {
+            throw std::runtime_error("BLIF line " + std::to_string(commandLine) + ": " + message);
+        }
+        // next token on the current logical line, empty at its end
+        std::string_view next();
+        // moves past the end of the current logical line
+        void skipLine();
+        void finishCover();
+        uint32_t synthesize(uint32_t output, char kind, size_t index);
+        uint32_t literal(size_t input, char value);
+    };
+
+    std::string_view BlifReader::next()
+    {
+        while (position < end)
+        {
+            char c = *position;
+            if (c == ' ' || c == '\t' || c == '\r')
+            {
+                position++;
+            }
+            else if (c == '\\')
+            {
+                // a backslash continues the line
+                position++;
+                while (position < end && (*position == ' ' || *position == '\t' || *position == '\r'))
+                {
+                    position++;
+                }
+                if (position < end && *position == '\n')
+                {
+                    position++;
+                    line++;
+                }
+            }
+            else if (c == '#')
+            {
+                while (position < end && *position != '\n')
+                {
+                    position++;
+                }
+            }
+            else if (c == '\n')
+            {
+                return std::string_view();
+            }
+            else
+            {
+                const char *start = position;
+                while (position < end && *position != ' ' && *position != '\t' && *position != '\r' && *position != '\n' && *position != '#')
+                {
+                    position++;
+                }
+                return std::string_view(start, position - start);
+            }
+        }
+        return std::string_view();
+    }
+
+    void BlifReader::skipLine()
+    {
+        while (!next().empty())
+        {
+        }
+        if (position < end)
+        {
+            position++;
+            line++;
+        }
+    }
+
+    uint32_t BlifReader::synthesize(uint32_t output, char kind, size_t index)
+    {
+        std::string_view name = builder.getName(output);
+        scratch.assign(name.data(), name.size());
+        scratch += '$';
+        scratch += kind;
+        scratch += std::to_string(index);
+        return builder.internCopy(scratch);
+    }
+
+    uint32_t BlifReader::literal(size_t input, char value)
+    {
+        if (value == '1')
+        {
+            return terminals[input];
+        }
+        // one shared inverter per complemented input of the cover
+        if (inverted[input] == NetlistBuilder::NoNet)
+        {
+            inverted[input] = synthesize(terminals.back(), 'n', input);
+            builder.beginGate(GateType::Not, inverted[input]);
+            builder.addPin(terminals[input]);
+            builder.endGate();
+        }
+        return inverted[input];
+    }
+
+    void BlifReader::finishCover()
+    {
+        size_t numInputs = terminals.size() - 1;
+        uint32_t output = terminals.back();
+        size_t numRows = outputBits.size();
+        if (numInputs == 0 || numRows == 0)
+        {
+            fail("constant net " + std::string(builder.getName(output)) + " is not supported");
+        }
+        // rows either all list the on-set (output 1) or all list the off-set (output 0)
+        bool onSet = outputBits[0] == '1';
+        if (outputBits.find(onSet ? '0' : '1') != std::string::npos)
+        {
+            fail("cover of " + std::string(builder.getName(output)) + " mixes on-set and off-set rows");
+        }
+
+        auto emit = [&](GateType type)
+        {
+            builder.beginGate(type, output);
+            for (size_t i = 0; i < numInputs; i++)
+            {
+                builder.addPin(terminals[i]);
+            }
+            builder.endGate();
+        };
+        auto countOf = [&](size_t row, char value)
+        {
+            return static_cast<size_t>(std::count(rows.begin() + row * numInputs, rows.begin() + (row + 1) * numInputs, value));
+        };
+
+        // library gates first: one row of all 1s or all 0s is an AND or a NOR ...
+        if (numRows == 1 && numInputs > 1 && (countOf(0, '1') == numInputs || countOf(0, '0') == numInputs))
+        {
+            bool ones = countOf(0, '1') == numInputs;
+            emit(ones ? (onSet ? GateType::And : GateType::Nand) : (onSet ? GateType::Nor : GateType::Or));
+            return;
+        }
+        if (numInputs == 1 && numRows == 1 && rows[0] != '-')
+        {
+            emit((rows[0] == '1') == onSet ? GateType::Buffer : GateType::Not);
+            return;
+        }
+        // ... one single-literal row per input is an OR or a NAND ...
+        bool singleLiterals = numRows == numInputs && numInputs > 1;
+        char literalValue = rows[0] == '-' ? rows[numInputs > 1 ? 1 : 0] : rows[0];
+        for (size_t r = 0; singleLiterals && r < numRows; r++)
+        {
+            singleLiterals = countOf(r, '-') == numInputs - 1 && rows[r * numInputs + r] == literalValue && literalValue != '-';
+        }
+        if (singleLiterals)
+        {
+            bool ones = literalValue == '1';
+            emit(ones ? (onSet ? GateType::Or : GateType::Nor) : (onSet ? GateType::Nand : GateType::And));
+            return;
+        }
+        // ... and every odd (or every even) row without don't-cares is a parity
+        if (numInputs > 1 && numInputs <= 16 && numRows == (size_t(1) << (numInputs - 1)))
+        {
+            std::vector<char> seen(size_t(1) << numInputs, 0);
+            size_t parity = countOf(0, '1') & 1;
+            bool isParity = true;
+            for (size_t r = 0; isParity && r < numRows; r++)
+            {
+                size_t pattern = 0;
+                for (size_t i = 0; i < numInputs; i++)
+                {
+                    char value = rows[r * numInputs + i];
+                    isParity = isParity && value != '-';
+                    pattern |= size_t(value == '1') << i;
+                }
+                isParity = isParity && !seen[pattern] && (countOf(r, '1') & 1) == parity;
+                seen[pattern] = 1;
+            }
+            if (isParity)
+            {
+                emit((parity == 1) == onSet ? GateType::Xor : GateType::Xnor);
+                return;
+            }
+        }
+
+        // anything else becomes inverters, one AND per row and an OR of the rows
+        inverted.assign(numInputs, NetlistBuilder::NoNet);
+        terms.clear();
+        for (size_t r = 0; r < numRows; r++)
+        {
+            literals.clear();
+            for (size_t i = 0; i < numInputs; i++)
+            {
+                char value = rows[r * numInputs + i];
+                if (value != '-')
+                {
+                    literals.push_back(literal(i, value));
+                }
+            }
+            if (literals.empty())
+            {
+                fail("constant net " + std::string(builder.getName(output)) + " is not supported");
+            }
+            if (numRows == 1)
+            {
+                // a single product drives the output directly
+                builder.beginGate(literals.size() == 1 ? (onSet ? GateType::Buffer : GateType::Not) : (onSet ? GateType::And : GateType::Nand), output);
+                for (uint32_t net : literals)
+                {
+                    builder.addPin(net);
+                }
+                builder.endGate();
+                return;
+            }
+            if (literals.size() == 1)
+            {
+                terms.push_back(literals[0]);
+                continue;
+            }
+            terms.push_back(synthesize(output, 't', r));
+            builder.beginGate(GateType::And, terms.back());
+            for (uint32_t net : literals)
+            {
+                builder.addPin(net);
+            }
+            builder.endGate();
+        }
+        builder.beginGate(onSet ? GateType::Or : GateType::Nor, output);
+        for (uint32_t net : terms)
+        {
+            builder.addPin(net);
+        }
+        builder.endGate();
+    }
+
+    Circuit BlifReader::read()
+    {
+        bool inCover = false;
+        bool sawModel = false;
+        while (position < end)
+        {
+            std::string_view word = next();
+            if (word.empty())
+            {
+                skipLine();
+                continue;
+            }
+            if (word[0] != '.')
+            {
+                // a row of the open cover: input part (absent for constants) then the output bit
+                if (!inCover)
+                {
+                    commandLine = line;
+                    fail("cover row outside .names");
+                }
+                size_t numInputs = terminals.size() - 1;
+                std::string_view outputBit = numInputs == 0 ? word : next();
+                if (numInputs > 0 && word.size() != numInputs)
+                {
+                    commandLine = line;
+                    fail("cover row '" + std::string(word) + "' needs " + std::to_string(numInputs) + " input columns");
+                }
+                if (outputBit.size() != 1 || (outputBit[0] != '0' && outputBit[0] != '1') ||
+                    word.find_first_not_of(numInputs == 0 ? "01" : "01-") != std::string_view::npos)
+                {
+                    commandLine = line;
+                    fail("bad cover row");
+                }
+                if (numInputs > 0)
+                {
+                    rows.append(word.data(), word.size());
+                }
+                outputBits += outputBit[0];
+                skipLine();
+                continue;
+            }
+
+            if (inCover)
+            {
+                finishCover();
+                inCover = false;
+            }
+            commandLine = line;
+            if (word == ".model")
+            {
+                if (sawModel)
+                {
+                    fail("only one .model per file is supported");
+                }
+                sawModel = true;
+            }
+            else if (word == ".inputs" || word == ".outputs")
+            {
+                bool isInput = word == ".inputs";
+                for (std::string_view name = next(); !name.empty(); name = next())
+                {
+                    uint32_t net = builder.intern(name);
+                    if (isInput)
+                        builder.addInput(net);
+                    else
+                        builder.addOutput(net);
+                }
+            }
+            else if (word == ".names")
+            {
+                terminals.clear();
+                for (std::string_view name = next(); !name.empty(); name = next())
+                {
+                    terminals.push_back(builder.intern(name));
+                }
+                if (terminals.empty())
+                {
+                    fail(".names needs an output");
+                }
+                rows.clear();
+                outputBits.clear();
+                inCover = true;
+            }
+            else if (word == ".end")
+            {
+                break;
+            }
+            else if (word == ".latch")
+            {
+                // .latch <input> <output> [<type> <control>] [<init>], every flip-flop is on the one
+                // global clock, and an ah latch becomes a level-sensitive latch enabled by its control
+                std::string_view input = next();
+                std::string_view output = next();
+                if (input.empty() || output.empty())
+                {
+                    fail(".latch needs an input and an output");
+                }
+                std::string_view field = next();
+                bool latch = false;
+                if (field == "re" || field == "fe" || field == "ah" || field == "al" || field == "as")
+                {
+                    std::string_view control = next();
+                    if (field != "re" && field != "ah")
+                    {
+                        fail(std::string(field) + " latches are not supported, only re flip-flops and ah latches");
+                    }
+                    latch = field == "ah";
+                    if (latch && (control.empty() || control == "NIL"))
+                    {
+                        fail("an ah latch needs a control net");
+                    }
+                    field = next();
+                    if (latch)
+                    {
+                        builder.beginGate(GateType::Latch, builder.intern(output));
+                        builder.addPin(builder.intern(input));
+                        builder.addPin(builder.intern(control));
+                        builder.endGate();
+                    }
+                }
+                if (!latch)
+                {
+                    builder.beginGate(GateType::FlipFlop, builder.intern(output));
+                    builder.addPin(builder.intern(input));
+                    builder.endGate();
+                }
+                if (!field.empty() && (field.size() != 1 || field[0] < '0' || field[0] > '3'))
+                {
+                    fail("bad .latch initial value '" + std::string(field) + "'");
+                }
+                // 2 (don't care) and 3 (unknown) power up as 0
+                builder.setInitial(builder.intern(output), field == "1");
+            }
+            else if (word == ".mlatch")
+            {
+                fail(".mlatch is not supported");
+            }
+            else if (word == ".subckt" || word == ".gate")
+            {
+                fail(std::string(word) + " is not supported, flatten the design first");
+            }
+            else
+            {
+                fail("unsupported command " + std::string(word));
+            }
+            skipLine();
+        }
+        if (inCover)
+        {
+            finishCover();
+        }
+        return builder.build();
+    }
+
+    // names that are not plain Verilog identifiers are written escaped
+    void writeVerilogName(std::ostream &out, const std::string &name)
+    {
+        bool simple = !name.empty() && (std::isalpha(static_cast<unsigned char>(name[0])) || name[0] == '_');
+        for (char c : name)
+        {
+            simple = simple && (std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$');
+        }
+        if (simple)
+            out << name;
+        else
+            out << '\\' << name << ' ';
+    }
+}
+
+Circuit NetlistImporter::load(const std::string &path, Stats *stats)
+{
+    auto start = std::chrono::steady_clock::now();
+    MappedFile file(path);
+    bool blif = path.size() >= 5 && path.compare(path.size() - 5, 5, ".blif") == 0;
+    Circuit circuit = blif ? parseBlif(file.data(), file.size()) : parseVerilog(file.data(), file.size());
+    if (stats)
+    {
+        stats->bytes = file.size();
+        stats->inputs = circuit.getInputCount();
+        stats->outputs = circuit.getOutputCount();
+        stats->gates = circuit.getGateCount();
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return circuit;
+}
+
+Circuit NetlistImporter::parseVerilog(const char *text, size_t length)
+{
+    return VerilogReader(text, length).read();
+}
+
+Circuit NetlistImporter::parseBlif(const char *text, size_t length)
+{
+    return BlifReader(text, length).read();
+}
+
+void NetlistImporter::writeVerilog(const Circuit &circuit, const std::string &path, const std::string &module)
+{
+    std::ofstream out(path);
+    if (!out)
+    {
+        throw std::runtime_error("Cannot write Verilog file: " + path);
+    }
+    std::vector<char> isOutput(circuit.getNodeCount(), 0);
+    for (Circuit::NodeId node : circuit.getOutputs())
+    {
+        isOutput[node] = 1;
+    }
+    // the drivers of a resolved net are written as driving the net itself, as they are read
+    std::vector<Circuit::NodeId> drives(circuit.getNodeCount(), Circuit::InvalidNode);
+    for (Circuit::NodeId node = 0; node < circuit.getNodeCount(); node++)
+    {
+        if (circuit.isInput(node) || !GateFactory::isResolvedNet(circuit.getGateType(node)))
+        {
+            continue;
+        }
+        for (uint32_t pin = 0; pin < circuit.getFaninCount(node); pin++)
+        {
+            Circuit::NodeId driver = circuit.getFanin(node)[pin];
+            if (circuit.isInput(driver) || isOutput[driver] || circuit.getFanoutCount(driver) != 1 ||
+                GateFactory::isResolvedNet(circuit.getGateType(driver)))
+            {
+                throw std::runtime_error("Cannot write " + circuit.getName(driver) + " as a driver of net " + circuit.getName(node) +
+                                         ", it has to be a gate that drives nothing else");
+            }
+            drives[driver] = node;
+        }
+    }
+    auto netKeyword = [&](Circuit::NodeId node)
+    {
+        GateType type = circuit.isInput(node) ? GateType::Buffer : circuit.getGateType(node);
+        return type == GateType::WiredAnd ? "wand " : type == GateType::WiredOr ? "wor " : type == GateType::Bus ? "tri " : "";
+    };
+
+    out << "module ";
+    writeVerilogName(out, module);
+    out << "(";
+    const char *separator = "";
+    for (Circuit::NodeList ports : {circuit.getInputs(), circuit.getOutputs()})
+    {
+        for (Circuit::NodeId node : ports)
+        {
+            out << separator;
+            writeVerilogName(out, circuit.getName(node));
+            separator = ", ";
+        }
+    }
+    out << ");\n";
+    for (Circuit::NodeId node : circuit.getInputs())
+    {
+        out << "  input ";
+        writeVerilogName(out, circuit.getName(node));
+        out << ";\n";
+    }
+    for (Circuit::NodeId node : circuit.getOutputs())
+    {
+        out << "  output " << netKeyword(node);
+        writeVerilogName(out, circuit.getName(node));
+        out << ";\n";
+    }
+    for (Circuit::NodeId node = 0; node < circuit.getNodeCount(); node++)
+    {
+        if (!circuit.isInput(node) && !isOutput[node] && drives[node] == Circuit::InvalidNode)
+        {
+            const char *keyword = netKeyword(node);
+            out << "  " << (*keyword ? keyword : "wire ");
+            writeVerilogName(out, circuit.getName(node));
+            out << ";\n";
+        }
+    }
+
+    static const char *const keywords[] = {"and", "or", "not", "nor", "nand", "xor", "xnor", "buf"};
+    for (Circuit::NodeId node = 0; node < circuit.getNodeCount(); node++)
+    {
+        if (circuit.isInput(node) || GateFactory::isResolvedNet(circuit.getGateType(node)))
+        {
+            continue;
+        }
+        GateType type = circuit.getGateType(node);
+        if (type == GateType::TriState || type == GateType::TransmissionGate)
+        {
+            out << "  " << (type == GateType::TriState ? "bufif1" : "nmos");
+        }
+        else if (static_cast<size_t>(type) > static_cast<size_t>(GateType::Buffer))
+        {
+            throw std::runtime_error("Cannot write " + circuit.getName(node) + " as a Verilog primitive");
+        }
+        else
+        {
+            out << "  " << keywords[static_cast<size_t>(type)];
+        }
+        if (circuit.getDelay(node) != 1)
+        {
+            out << " #" << circuit.getDelay(node);
+        }
+        out << " (";
+        writeVerilogName(out, circuit.getName(drives[node] != Circuit::InvalidNode ? drives[node] : node));
+        for (uint32_t pin = 0; pin < circuit.getFaninCount(node); pin++)
+        {
+            out << ", ";
+            writeVerilogName(out, circuit.getName(circuit.getFanin(node)[pin]));
+        }
+        out << ");\n";
+    }
+    out << "endmodule\n";
+}
+
+void NetlistImporter::writeBlif(const Circuit &circuit, const std::string &path, const std::string &model)
+{
+    // .latch covers D flip-flops and latches only, checked before anything is written
+    for (Circuit::NodeId node = 0; node < circuit.getNodeCount(); node++)
+    {
+        if (!circuit.isInput(node) && GateFactory::isSequential(circuit.getGateType(node)) &&
+            circuit.getGateType(node) != GateType::FlipFlop && circuit.getGateType(node) != GateType::Latch)
+        {
+            throw std::runtime_error("Cannot write " + circuit.getName(node) + " as a BLIF latch, only D flip-flops and latches");
+        }
+    }
+    std::ofstream out(path);
+    if (!out)
+    {
+        throw std::runtime_error("Cannot write BLIF file: " + path);
+    }
+    out << ".model " << model << "\n.inputs";
+    for (Circuit::NodeId node : circuit.getInputs())
+    {
+        out << " " << circuit.getName(node);
+    }
+    out << "\n.outputs";
+    for (Circuit::NodeId node : circuit.getOutputs())
+    {
+        out << " " << circuit.getName(node);
+    }
+    out << "\n";
+
+    std::string row;
+    for (Circuit::NodeId node = 0; node < circuit.getNodeCount(); node++)
+    {
+        if (circuit.isInput(node))
+        {
+            continue;
+        }
+        uint32_t numInputs = circuit.getFaninCount(node);
+        GateType type = circuit.getGateType(node);
+        if (type == GateType::FlipFlop || type == GateType::Latch)
+        {
+            // flip-flops are on the global clock, latches are enabled by their second pin
+            out << ".latch " << circuit.getName(circuit.getFanin(node)[0]) << " " << circuit.getName(node);
+            if (type == GateType::Latch)
+            {
+                out << " ah " << circuit.getName(circuit.getFanin(node)[1]);
+            }
+            out << " " << circuit.getValue(node) << "\n";
+            continue;
+        }
+        out << ".names";
+        for (uint32_t pin = 0; pin < numInputs; pin++)
+        {
+            out << " " << circuit.getName(circuit.getFanin(node)[pin]);
+        }
+        out << " " << circuit.getName(node) << "\n";
+
+        switch (type)
+        {
+        case GateType::Buffer:
+        case GateType::Not:
+            out << (type == GateType::Buffer ? "1 1\n" : "0 1\n");
+            break;
+        case GateType::And:
+        case GateType::Nand:
+            out << std::string(numInputs, '1') << (type == GateType::And ? " 1\n" : " 0\n");
+            break;
+        case GateType::Or:
+        case GateType::Nor:
+            for (uint32_t pin = 0; pin < numInputs; pin++)
+            {
+                row.assign(numInputs, '-');
+                row[pin] = '1';
+                out << row << (type == GateType::Or ? " 1\n" : " 0\n");
+            }
+            break;
+        case GateType::Xor:
+        case GateType::Xnor:
+            if (numInputs > 16)
+            {
+                throw std::runtime_error("XOR " + circuit.getName(node) + " is too wide for a BLIF cover");
+            }
+            // the odd rows are the on-set of an XOR and the off-set of an XNOR
+            for (uint32_t pattern = 0; pattern < (1u << numInputs); pattern++)
+            {
+                if (std::bitset<32>(pattern).count() & 1)
+                {
+                    row.resize(numInputs);
+                    for (uint32_t pin = 0; pin < numInputs; pin++)
+                    {
+                        row[pin] = (pattern >> pin) & 1 ? '1' : '0';
+                    }
+                    out << row << (type == GateType::Xor ? " 1\n" : " 0\n");
+                }
+            }
+            break;
+        default:
+            throw std::runtime_error("Cannot write " + circuit.getName(node) + " as a BLIF cover");
+        }
+    }
+    out << ".end\n";
+}
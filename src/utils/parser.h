@@ -0,0 +1,235 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "core/Circuit.h"
+
+// Hash-consed Boolean expression graph. Every distinct subexpression exists once, so
+// `(A & B) | ~(A & B)` holds a single A & B node, and operands of commutative operators
+// are stored in id order so `A & B` and `B & A` are the same node. Children are always
+// created before their parents, which makes node ids a topological order.
+// Local rewrites run on construction: constants fold, ~~x is x, x & x is x, x & ~x is 0,
+// x ^ x is 0, and so on, so trivial redundancy never reaches the compiler.
+class ExpressionDag
+{
+public:
+    using NodeId = uint32_t;
+
+    enum class Op : uint8_t
+    {
+        Zero,
+        One,
+        Variable,
+        Not,
+        And,
+        Or,
+        Xor
+    };
+
+    struct Node
+    {
+        Op op;
+        NodeId left;  // variable index for Variable
+        NodeId right;
+    };
+
+    ExpressionDag();
+
+    NodeId constant(bool value) const { return value ? OneNode : ZeroNode; }
+    // the variable with that name, created on first use
+    NodeId variable(const std::string &name);
+    NodeId makeNot(NodeId operand);
+    NodeId makeAnd(NodeId left, NodeId right);
+    NodeId makeOr(NodeId left, NodeId right);
+    NodeId makeXor(NodeId left, NodeId right);
+
+    const Node &getNode(NodeId id) const { return nodes[id]; }
+    size_t size() const { return nodes.size(); }
+    // variables in order of first appearance, variable i is input i of a compiled expression
+    const std::vector<std::string> &getVariableNames() const { return variableNames; }
+    uint32_t getVariableCount() const { return static_cast<uint32_t>(variableNames.size()); }
+    // nodes reachable from the roots, shared subexpressions counted once
+    size_t countNodes(const std::vector<NodeId> &roots) const;
+
+    // fully parenthesized only where precedence needs it
+    std::string toString(NodeId root) const;
+    // one assignment, values[i] for variable i
+    bool evaluate(NodeId root, const std::vector<bool> &values) const;
+
+private:
+    static constexpr NodeId ZeroNode = 0;
+    static constexpr NodeId OneNode = 1;
+
+    std::vector<Node> nodes;
+    // (op, left, right) packed into one key
+    std::unordered_map<uint64_t, NodeId> unique;
+    std::vector<std::string> variableNames;
+    std::unordered_map<std::string, NodeId> variableNodes;
+
+    NodeId intern(Op op, NodeId left, NodeId right);
+    // true if a is the complement of b
+    bool isComplement(NodeId a, NodeId b) const;
+    void appendString(NodeId id, int parentPrecedence, std::string &out) const;
+};
+
+// Recursive-descent parser for Boolean expressions, loosest binding first:
+//   or:   xor { ('|' | '+') xor }
+//   xor:  and { '^' and }
+//   and:  unary { ['&' | '*'] unary }
+//   unary: ('~' | '!') unary | primary { '\'' }
+//   primary: identifier | '0' | '1' | '(' or ')'
+// So `(A & B) | ~C ^ D` is (A & B) | ((~C) ^ D). A' is the complement of A, and writing
+// terms next to each other ANDs them, so A'B + (A + C)(B + D) reads as in the textbook.
+// Identifiers are letters, digits, '_' and '.', not starting with a digit, so
+// multi-letter names must be separated by an operator or a space.
+// Errors throw std::invalid_argument naming the offending column.
+class ExpressionParser
+{
+public:
+    static ExpressionDag::NodeId parse(const std::string &text, ExpressionDag &dag);
+
+private:
+    ExpressionParser(const std::string &text, ExpressionDag &dag) : text(text), dag(dag) {}
+
+    const std::string &text;
+    ExpressionDag &dag;
+    size_t position = 0;
+
+    char peek();
+    [[noreturn]] void fail(const std::string &message) const;
+    ExpressionDag::NodeId parseOr();
+    ExpressionDag::NodeId parseXor();
+    ExpressionDag::NodeId parseAnd();
+    ExpressionDag::NodeId parseUnary();
+    ExpressionDag::NodeId parsePrimary();
+};
+
+// Register bytecode for one or more roots of an ExpressionDag. Inverters cost nothing:
+// a complemented operand folds into the consuming instruction (AndNot, OrNot, Nand, Nor,
+// Xnor), and a complemented XOR result just flips a polarity flag. Registers are reused
+// as soon as their last reader has run, so the register file stays small and hot.
+//
+// Each instruction runs on a block of BlockWords words, so one dispatch covers
+// 64 * BlockWords patterns and the inner loop is a plain word loop the compiler can unroll.
+class CompiledExpression
+{
+public:
+    static constexpr size_t BlockWords = 8;
+
+    enum class Opcode : uint8_t
+    {
+        Zero,
+        One,
+        Not,
+        And,
+        Or,
+        Xor,
+        Nand,
+        Nor,
+        Xnor,
+        AndNot, // a & ~b
+        OrNot   // a | ~b
+    };
+
+    struct Instruction
+    {
+        Opcode op;
+        uint16_t dst;
+        uint16_t a;
+        uint16_t b;
+    };
+
+    // registers 0 .. variables - 1 hold the inputs, the rest are temporaries
+    // throws std::length_error past 65536 registers
+    CompiledExpression(const ExpressionDag &dag, const std::vector<ExpressionDag::NodeId> &roots);
+
+    uint32_t getNumInputs() const { return numInputs; }
+    uint32_t getNumOutputs() const { return static_cast<uint32_t>(outputRegisters.size()); }
+    uint32_t getRegisterCount() const { return numRegisters; }
+    const std::vector<Instruction> &getInstructions() const { return program; }
+
+    // 64 patterns: inputs[i] is the word of variable i, outputs[o] the word of root o
+    void evaluate(const uint64_t *inputs, uint64_t *outputs) const;
+    // `words` words per column: inputs[i] points to variable i's words, outputs[o] to root o's
+    void evaluate(const uint64_t *const *inputs, uint64_t *const *outputs, size_t words) const;
+
+    std::string disassemble() const;
+
+private:
+    uint32_t numInputs;
+    uint32_t numRegisters;
+    std::vector<Instruction> program;
+    std::vector<uint16_t> outputRegisters;
+
+    // runs the program on one block, register r is registers[r * BlockWords ..]
+    void run(uint64_t *registers) const;
+};
+
+// Read-only view of a whole file, memory-mapped where the platform allows it and read
+// into one buffer otherwise. Throws std::runtime_error if the file cannot be opened.
+class MappedFile
+{
+public:
+    enum class Access
+    {
+        Sequential, // read front to back once, so the whole file is faulted in up front
+        InPlace     // used where it lies, pages are faulted in as they are touched
+    };
+
+    explicit MappedFile(const std::string &path, Access access = Access::Sequential);
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    const char *data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const char *bytes = nullptr;
+    size_t length = 0;
+    bool mapped = false;
+    std::vector<char> buffer;
+};
+
+// Gate-level netlist import in one pass over the mapped file. The tokenizer hands out
+// views into the file, net names are interned in a flat hash table the first time they
+// appear, and gates are recorded as (type, output net, pin range) until the end of the
+// file, when the netlist is built into a Circuit. Memory is allocated per distinct net,
+// never per token. Every gate is named after the net it drives.
+//
+// Verilog: one module of primitive instances (and, or, nand, nor, xor, xnor, not, buf)
+// with optional #delay and instance names, input/output/wire declarations with [msb:lsb]
+// ranges, bit-selects, escaped identifiers, and continuous assignments of the forms
+// `assign y = a;`, `assign y = ~a;` and `assign y = a & b & ...` (or | and ^). bufif1 is a
+// tri-state buffer and nmos a transmission gate. A net with several drivers becomes a
+// resolved net, wired-AND if declared wand or triand, wired-OR for wor or trior and a
+// contention-to-X bus otherwise; its drivers are the nodes net$0, net$1, ...
+// BLIF: .model, .inputs, .outputs, .names with a single-output cover, .latch, .end. Covers
+// that match a library gate become that gate, any other cover becomes a NOT/AND/OR network.
+// A .latch is a D flip-flop on the global clock, or a latch for type ah.
+//
+// Syntax errors and unsupported constructs throw std::runtime_error naming the line,
+// undriven nets, and multiply driven nets in BLIF or on an input, throw naming the net.
+class NetlistImporter
+{
+public:
+    struct Stats
+    {
+        size_t bytes;
+        uint32_t inputs;
+        uint32_t outputs;
+        uint32_t gates;
+        double seconds;
+    };
+
+    // picks the format from the extension, .blif for BLIF and Verilog otherwise
+    static Circuit load(const std::string &path, Stats *stats = nullptr);
+    static Circuit parseVerilog(const char *text, size_t length);
+    static Circuit parseBlif(const char *text, size_t length);
+
+    // write a frozen circuit back out, so imported netlists round-trip
+    static void writeVerilog(const Circuit &circuit, const std::string &path, const std::string &module = "top");
+    static void writeBlif(const Circuit &circuit, const std::string &path, const std::string &model = "top");
+};